@@ -28,26 +28,18 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <poll.h>
+#include <pthread.h>
 #include <dlfcn.h>
 #include <execinfo.h>
 
 #include "rpv3_options.h"
-
-/* Simple kernel name storage (array-based for C compatibility) */
-#define MAX_KERNELS 256
-
-typedef struct {
-    rocprofiler_kernel_id_t kernel_id;
-    char kernel_name[256];
-    int valid;
-} kernel_info_t;
+#include "rpv3_kernel_table.h"
 
 /* Global state */
 static atomic_uint_fast64_t kernel_count = ATOMIC_VAR_INIT(0);
 static rocprofiler_context_id_t client_ctx = {0};
 static rocprofiler_client_id_t* client_id = NULL;
-static kernel_info_t kernel_table[MAX_KERNELS];
-static atomic_int kernel_table_size = ATOMIC_VAR_INIT(0);
+static rpv3_kernel_table_t kernel_table;  /* Grows as symbols register; lock-free lookups */
 
 /* Timeline mode state */
 static int timeline_enabled = 0;
@@ -77,6 +69,15 @@ static int rocblas_pipe_fd = -1;
 /* RocBLAS log file handle */
 static FILE* rocblas_log_file = NULL;
 
+/* Buffered RocBLAS pipe reader. Each read() takes as much as is available;
+ * a partial line at the end of the buffer is kept for the next call. */
+#define ROCBLAS_READ_BUFFER_SIZE (64 * 1024)
+static char rocblas_read_buffer[ROCBLAS_READ_BUFFER_SIZE];
+static size_t rocblas_read_begin = 0;
+static size_t rocblas_read_end = 0;
+static int rocblas_read_discarding = 0; /* Dropping the tail of an overlong line */
+static pthread_mutex_t rocblas_read_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /* Output macro for trace data (CSV or human-readable kernel details) */
 #define TRACE_PRINTF(...) fprintf(output_file ? output_file : stdout, __VA_ARGS__)
 
@@ -85,29 +86,51 @@ static FILE* rocblas_log_file = NULL;
 /* Otherwise, they follow the trace output (to file if set, else stdout) */
 #define STATUS_PRINTF(...) fprintf((output_file && csv_enabled) ? stdout : (output_file ? output_file : stdout), __VA_ARGS__)
 
-/* Agent profile storage */
-#define MAX_AGENTS 16
+/* Agent profile storage. Filled in tool_init before the context starts and
+ * only read afterwards, so the dispatch counting callback needs no lock. */
 typedef struct {
     rocprofiler_agent_id_t agent_id;
     rocprofiler_profile_config_id_t profile_id;
-    int valid;
 } agent_profile_t;
 
-static agent_profile_t agent_profiles[MAX_AGENTS];
-static atomic_int agent_profiles_count = ATOMIC_VAR_INIT(0);
+static agent_profile_t* agent_profiles = NULL;
+static size_t agent_profiles_count = 0;
+static size_t agent_profiles_capacity = 0;
+
+/* GPU agents found during counter setup */
+typedef struct {
+    rocprofiler_agent_id_t* agents;
+    size_t count;
+    size_t capacity;
+} agent_list_t;
 
 /* Temporary storage for counter discovery */
-#define MAX_COUNTERS 1024
 typedef struct {
-    char name[256];
+    char* name;
     rocprofiler_counter_id_t id;
 } counter_entry_t;
 
 typedef struct {
-    counter_entry_t counters[MAX_COUNTERS];
+    counter_entry_t* counters;
     size_t count;
+    size_t capacity;
 } counter_list_t;
 
+/* Double a heap array's capacity when it is full. Returns 0 on success. */
+static int grow_array(void** items, size_t* capacity, size_t count, size_t item_size) {
+    if (count < *capacity) {
+        return 0;
+    }
+    size_t new_capacity = *capacity ? *capacity * 2 : 16;
+    void* grown = realloc(*items, new_capacity * item_size);
+    if (!grown) {
+        return -1;
+    }
+    *items = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
 /* Interceptors for RocBLAS logging */
 typedef FILE* (*fopen_t)(const char*, const char*);
 typedef FILE* (*fdopen_t)(int, const char*);
@@ -200,38 +223,15 @@ FILE* fdopen(int fd, const char* mode) {
 void store_kernel_name(rocprofiler_kernel_id_t kernel_id, const char* name) {
     if (!name) return;
     
-    int size = atomic_load(&kernel_table_size);
-    
-    /* Check if kernel already exists */
-    for (int i = 0; i < size && i < MAX_KERNELS; i++) {
-        if (kernel_table[i].valid && kernel_table[i].kernel_id == kernel_id) {
-            return; /* Already stored */
-        }
-    }
-    
-    /* Add new kernel */
-    if (size < MAX_KERNELS) {
-        int idx = atomic_fetch_add(&kernel_table_size, 1);
-        if (idx < MAX_KERNELS) {
-            kernel_table[idx].kernel_id = kernel_id;
-            strncpy(kernel_table[idx].kernel_name, name, sizeof(kernel_table[idx].kernel_name) - 1);
-            kernel_table[idx].kernel_name[sizeof(kernel_table[idx].kernel_name) - 1] = '\0';
-            kernel_table[idx].valid = 1;
-        }
+    if (rpv3_kernel_table_insert(&kernel_table, kernel_id, name) != 0) {
+        fprintf(stderr, "[Kernel Tracer] Warning: Out of memory storing kernel name %s\n", name);
     }
 }
 
 /* Helper function to lookup kernel name */
 const char* lookup_kernel_name(rocprofiler_kernel_id_t kernel_id) {
-    int size = atomic_load(&kernel_table_size);
-    
-    for (int i = 0; i < size && i < MAX_KERNELS; i++) {
-        if (kernel_table[i].valid && kernel_table[i].kernel_id == kernel_id) {
-            return kernel_table[i].kernel_name;
-        }
-    }
-    
-    return "<unknown>";
+    const char* name = rpv3_kernel_table_lookup(&kernel_table, kernel_id);
+    return name ? name : "<unknown>";
 }
 
 /* Helper function to check if a kernel is a Tensile routine */
@@ -313,6 +313,101 @@ void kernel_symbol_callback(rocprofiler_callback_tracing_record_t record,
     }
 }
 
+/* Copy the next complete RocBLAS log line into line (CR/LF stripped, truncated
+ * to size - 1). Returns 0 when no complete line is available yet, or at EOF. */
+static int rocblas_next_line(char* line, size_t size) {
+    while (1) {
+        char* start = rocblas_read_buffer + rocblas_read_begin;
+        char* newline = memchr(start, '\n', rocblas_read_end - rocblas_read_begin);
+        if (newline) {
+            size_t length = (size_t)(newline - start);
+            int dropped = rocblas_read_discarding;
+            rocblas_read_begin += length + 1;
+            rocblas_read_discarding = 0;
+            if (dropped) {
+                continue;
+            }
+            if (length > 0 && start[length - 1] == '\r') {
+                length--;
+            }
+            if (length > size - 1) {
+                length = size - 1;
+            }
+            memcpy(line, start, length);
+            line[length] = '\0';
+            return 1;
+        }
+
+        /* Move the partial line to the front */
+        if (rocblas_read_begin > 0) {
+            memmove(rocblas_read_buffer, start, rocblas_read_end - rocblas_read_begin);
+            rocblas_read_end -= rocblas_read_begin;
+            rocblas_read_begin = 0;
+        }
+        if (rocblas_read_end == ROCBLAS_READ_BUFFER_SIZE) {
+            /* No newline in a full buffer: return it truncated, drop the rest */
+            int first_chunk = !rocblas_read_discarding;
+            size_t length = size - 1 < rocblas_read_end ? size - 1 : rocblas_read_end;
+            rocblas_read_end = 0;
+            rocblas_read_discarding = 1;
+            if (first_chunk) {
+                memcpy(line, rocblas_read_buffer, length);
+                line[length] = '\0';
+                return 1;
+            }
+        }
+
+        ssize_t bytes_read;
+        do {
+            bytes_read = read(rocblas_pipe_fd, rocblas_read_buffer + rocblas_read_end,
+                              ROCBLAS_READ_BUFFER_SIZE - rocblas_read_end);
+        } while (bytes_read < 0 && errno == EINTR);
+        if (bytes_read <= 0) {
+            return 0; /* EAGAIN, EOF or error */
+        }
+
+        /* Write to log file if enabled (raw stream) */
+        if (rocblas_log_file) {
+            fwrite(rocblas_read_buffer + rocblas_read_end, 1, (size_t)bytes_read, rocblas_log_file);
+            fflush(rocblas_log_file);
+        }
+        rocblas_read_end += (size_t)bytes_read;
+    }
+}
+
+/* Print the next RocBLAS call, skipping handle/stream bookkeeping lines.
+ * If nothing is buffered, wait up to timeout_ms for the pipe once. */
+static void print_rocblas_line(int timeout_ms) {
+    char line_buffer[4096];
+    int attempt;
+
+    pthread_mutex_lock(&rocblas_read_lock);
+    for (attempt = 0; attempt < 2; attempt++) {
+        while (rocblas_next_line(line_buffer, sizeof(line_buffer))) {
+            /* Check filters */
+            if (line_buffer[0] == '\0' ||
+                strstr(line_buffer, "rocblas_create_handle") != NULL ||
+                strstr(line_buffer, "rocblas_destroy_handle") != NULL ||
+                strstr(line_buffer, "rocblas_set_stream") != NULL) {
+                continue;
+            }
+            TRACE_PRINTF("# %s\n", line_buffer);
+            pthread_mutex_unlock(&rocblas_read_lock);
+            return;
+        }
+        if (timeout_ms <= 0) {
+            break;
+        }
+        struct pollfd pfd;
+        pfd.fd = rocblas_pipe_fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, timeout_ms) <= 0 || !(pfd.revents & POLLIN)) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&rocblas_read_lock);
+}
+
 /* Buffer callback function for timeline mode (batch processing) */
 void timeline_buffer_callback(
     rocprofiler_context_id_t context,
@@ -416,60 +511,7 @@ void timeline_buffer_callback(
             /* Read from RocBLAS log if available and kernel matches pattern */
             /* In timeline mode, we only support reading from files, not pipes */
             if (rocblas_pipe_fd != -1 && is_tensile_kernel(kernel_name)) {
-                char line_buffer[4096];
-                int line_pos = 0;
-                int valid_line_found = 0;
-                
-                /* Read char-by-char to handle filtering and stop after one valid line */
-                while (!valid_line_found) {
-                    char c;
-                    ssize_t bytes_read = read(rocblas_pipe_fd, &c, 1);
-                    
-                    if (bytes_read > 0) {
-                        /* Write to log file if enabled (raw stream) */
-                        if (rocblas_log_file) {
-                            fputc(c, rocblas_log_file);
-                        }
-                        
-                        if (c == '\n') {
-                            line_buffer[line_pos] = '\0';
-                            
-                            /* Clean up carriage return if present */
-                            if (line_pos > 0 && line_buffer[line_pos-1] == '\r') {
-                                line_buffer[line_pos-1] = '\0';
-                            }
-                            
-                            /* Check filters */
-                            if (strstr(line_buffer, "rocblas_create_handle") != NULL || 
-                                strstr(line_buffer, "rocblas_destroy_handle") != NULL ||
-                                strstr(line_buffer, "rocblas_set_stream") != NULL) {
-                                /* Skip this line, reset buffer and continue reading */
-                                line_pos = 0;
-                            } else {
-                                /* Valid line found */
-                                if (strlen(line_buffer) > 0) {
-                                    TRACE_PRINTF("# %s\n", line_buffer);
-                                    valid_line_found = 1; /* Stop reading */
-                                } else {
-                                    /* Empty line, just reset */
-                                    line_pos = 0;
-                                }
-                            }
-                        } else {
-                            if (line_pos < sizeof(line_buffer) - 1) {
-                                line_buffer[line_pos++] = c;
-                            }
-                            /* Else: line too long, truncate */
-                        }
-                    } else {
-                        /* EOF or error */
-                        break;
-                    }
-                }
-                
-                if (rocblas_log_file) {
-                    fflush(rocblas_log_file);
-                }
+                print_rocblas_line(0);
             }
         }
     }
@@ -587,69 +629,8 @@ void kernel_dispatch_callback(rocprofiler_callback_tracing_record_t record,
             
         /* Read from RocBLAS pipe if available and kernel matches pattern */
         if (rocblas_pipe_fd != -1 && is_tensile_kernel(kernel_name)) {
-            struct pollfd pfd;
-            pfd.fd = rocblas_pipe_fd;
-            pfd.events = POLLIN;
-            
             /* Wait up to 500ms for data */
-            int ret = poll(&pfd, 1, 500);
-            
-            if (ret > 0 && (pfd.revents & POLLIN)) {
-                char line_buffer[4096];
-                int line_pos = 0;
-                int valid_line_found = 0;
-                
-                /* Read char-by-char to handle pipe correctly and stop after one valid line */
-                while (!valid_line_found) {
-                    char c;
-                    ssize_t bytes_read = read(rocblas_pipe_fd, &c, 1);
-                    
-                    if (bytes_read > 0) {
-                        /* Write to log file if enabled (raw stream) */
-                        if (rocblas_log_file) {
-                            fputc(c, rocblas_log_file);
-                        }
-                        
-                        if (c == '\n') {
-                            line_buffer[line_pos] = '\0';
-                            
-                            /* Clean up carriage return if present */
-                            if (line_pos > 0 && line_buffer[line_pos-1] == '\r') {
-                                line_buffer[line_pos-1] = '\0';
-                            }
-                            
-                            /* Check filters */
-                            if (strstr(line_buffer, "rocblas_create_handle") != NULL || 
-                                strstr(line_buffer, "rocblas_destroy_handle") != NULL ||
-                                strstr(line_buffer, "rocblas_set_stream") != NULL) {
-                                /* Skip this line, reset buffer and continue reading */
-                                line_pos = 0;
-                            } else {
-                                /* Valid line found */
-                                if (strlen(line_buffer) > 0) {
-                                    TRACE_PRINTF("# %s\n", line_buffer);
-                                    valid_line_found = 1; /* Stop reading */
-                                } else {
-                                    /* Empty line, just reset */
-                                    line_pos = 0;
-                                }
-                            }
-                        } else {
-                            if (line_pos < sizeof(line_buffer) - 1) {
-                                line_buffer[line_pos++] = c;
-                            }
-                            /* Else: line too long, truncate (ignore extra chars until newline) */
-                        }
-                    } else {
-                        /* EAGAIN or error or EOF */
-                        break;
-                    }
-                }
-                
-                if (rocblas_log_file) {
-                    fflush(rocblas_log_file);
-                }
-            }
+            print_rocblas_line(500);
         }
     }
 }
@@ -744,21 +725,20 @@ int setup_callback_tracing() {
 
 /* Helper to store agent profile */
 void store_agent_profile(rocprofiler_agent_id_t agent_id, rocprofiler_profile_config_id_t profile_id) {
-    int idx = atomic_fetch_add(&agent_profiles_count, 1);
-    if (idx < MAX_AGENTS) {
-        agent_profiles[idx].agent_id = agent_id;
-        agent_profiles[idx].profile_id = profile_id;
-        agent_profiles[idx].valid = 1;
-    } else {
-        fprintf(stderr, "[Kernel Tracer] Warning: Max agents reached, cannot store profile\n");
+    if (grow_array((void**)&agent_profiles, &agent_profiles_capacity, agent_profiles_count,
+                   sizeof(agent_profile_t)) != 0) {
+        fprintf(stderr, "[Kernel Tracer] Warning: Out of memory, cannot store profile\n");
+        return;
     }
+    agent_profiles[agent_profiles_count].agent_id = agent_id;
+    agent_profiles[agent_profiles_count].profile_id = profile_id;
+    agent_profiles_count++;
 }
 
 /* Helper to find agent profile */
 int find_agent_profile(rocprofiler_agent_id_t agent_id, rocprofiler_profile_config_id_t* profile_id) {
-    int count = atomic_load(&agent_profiles_count);
-    for (int i = 0; i < count && i < MAX_AGENTS; i++) {
-        if (agent_profiles[i].valid && agent_profiles[i].agent_id.handle == agent_id.handle) {
+    for (size_t i = 0; i < agent_profiles_count; i++) {
+        if (agent_profiles[i].agent_id.handle == agent_id.handle) {
             *profile_id = agent_profiles[i].profile_id;
             return 1;
         }
@@ -855,10 +835,12 @@ rocprofiler_status_t counter_info_callback(
         );
         
         if (status == ROCPROFILER_STATUS_SUCCESS && info.name) {
-            if (list->count < MAX_COUNTERS) {
-                strncpy(list->counters[list->count].name, info.name, 255);
-                list->counters[list->count].name[255] = '\0';
-                list->counters[list->count].id = counters[i];
+            if (grow_array((void**)&list->counters, &list->capacity, list->count, sizeof(counter_entry_t)) != 0) {
+                return ROCPROFILER_STATUS_ERROR;
+            }
+            list->counters[list->count].name = strdup(info.name);
+            list->counters[list->count].id = counters[i];
+            if (list->counters[list->count].name) {
                 list->count++;
             }
         }
@@ -874,21 +856,17 @@ rocprofiler_status_t agent_query_callback(
     void* user_data
 ) {
     (void) version;
-    /* We passed a struct pointer, but need to cast appropriately */
-    /* Let's define the struct here to match */
-    struct agent_data_t {
-        rocprofiler_agent_id_t agents[MAX_AGENTS];
-        size_t count;
-    };
-    struct agent_data_t* data = (struct agent_data_t*)user_data;
+    agent_list_t* data = (agent_list_t*)user_data;
     
     for (size_t i = 0; i < num_agents; i++) {
         const rocprofiler_agent_v0_t* info = (const rocprofiler_agent_v0_t*)agents[i];
         if (info->type == ROCPROFILER_AGENT_TYPE_GPU) {
-            if (data->count < MAX_AGENTS) {
-                data->agents[data->count] = info->id;
-                data->count++;
+            if (grow_array((void**)&data->agents, &data->capacity, data->count,
+                           sizeof(rocprofiler_agent_id_t)) != 0) {
+                return ROCPROFILER_STATUS_ERROR;
             }
+            data->agents[data->count] = info->id;
+            data->count++;
         }
     }
     return ROCPROFILER_STATUS_SUCCESS;
@@ -897,8 +875,7 @@ rocprofiler_status_t agent_query_callback(
 /* Create profile for agent */
 void create_profile_for_agent(rocprofiler_agent_id_t agent_id) {
     /* 1. Get all supported counters */
-    counter_list_t supported_counters;
-    supported_counters.count = 0;
+    counter_list_t supported_counters = {NULL, 0, 0};
     
     rocprofiler_iterate_agent_supported_counters(
         agent_id,
@@ -931,6 +908,11 @@ void create_profile_for_agent(rocprofiler_agent_id_t agent_id) {
         }
     }
     
+    for (size_t j = 0; j < supported_counters.count; j++) {
+        free(supported_counters.counters[j].name);
+    }
+    free(supported_counters.counters);
+    
     if (selected_count == 0) {
         STATUS_PRINTF("[Kernel Tracer] Warning: No matching counters found for this agent\n");
         return;
@@ -974,11 +956,7 @@ int setup_counter_collection() {
     }
     
     /* 1. Query agents */
-    struct agent_data_t {
-        rocprofiler_agent_id_t agents[MAX_AGENTS];
-        size_t count;
-    } agent_data;
-    agent_data.count = 0;
+    agent_list_t agent_data = {NULL, 0, 0};
     
     rocprofiler_query_available_agents(
         ROCPROFILER_AGENT_INFO_VERSION_0,
@@ -989,6 +967,7 @@ int setup_counter_collection() {
     
     if (agent_data.count == 0) {
         STATUS_PRINTF("[Kernel Tracer] No GPU agents found for counter collection\n");
+        free(agent_data.agents);
         return 0;
     }
     
@@ -1002,6 +981,7 @@ int setup_counter_collection() {
             any_agent_supported = 1;
         }
     }
+    free(agent_data.agents);
     
     if (!any_agent_supported) {
         STATUS_PRINTF("[Kernel Tracer] Warning: No agents support counter collection or no counters found. Counter collection disabled.\n");
@@ -1103,6 +1083,27 @@ int tool_init(rocprofiler_client_finalize_t fini_func,
     /* Check if CSV mode is enabled (from rpv3_options) */
     csv_enabled = (rpv3_csv_enabled != 0);
     
+    /* Binary output is implemented by the C++ tracer only */
+    if (rpv3_output_format == RPV3_FORMAT_BINARY) {
+        fprintf(stderr, "[Kernel Tracer] Warning: --format binary is not supported by the C tracer, using CSV\n");
+        csv_enabled = 1;
+    }
+    
+    /* Summary mode is implemented by the C++ tracer only */
+    if (rpv3_summary_enabled) {
+        fprintf(stderr, "[Kernel Tracer] Warning: --summary is not supported by the C tracer, tracing every dispatch\n");
+    }
+    
+    /* Sampling is implemented by the C++ tracer only */
+    if (rpv3_sample_mode != RPV3_SAMPLE_NONE) {
+        fprintf(stderr, "[Kernel Tracer] Warning: --sample is not supported by the C tracer, tracing every dispatch\n");
+    }
+    
+    /* Kernel filters are implemented by the C++ tracer only */
+    if (rpv3_include_count > 0 || rpv3_exclude_count > 0 || rpv3_filter_expr) {
+        fprintf(stderr, "[Kernel Tracer] Warning: --include/--exclude/--filter are not supported by the C tracer, tracing every dispatch\n");
+    }
+    
     /* Check if backtrace mode is enabled (from rpv3_options) */
     backtrace_enabled = (rpv3_backtrace_enabled != 0);
     
@@ -1220,6 +1221,24 @@ int tool_init(rocprofiler_client_finalize_t fini_func,
     /* Check if counter mode is enabled */
     counter_mode = rpv3_counter_mode;
     
+    /* Counter lists and derived metrics are implemented by the C++ tracer only */
+    if (counter_mode == RPV3_COUNTER_MODE_CUSTOM) {
+        fprintf(stderr, "[Kernel Tracer] Warning: --counters is not supported by the C tracer, counter collection disabled\n");
+        counter_mode = RPV3_COUNTER_MODE_NONE;
+    }
+    /* Timeline and counters on one context are implemented by the C++ tracer only */
+    if (counter_mode != RPV3_COUNTER_MODE_NONE && timeline_enabled) {
+        fprintf(stderr, "[Kernel Tracer] Warning: --counter with --timeline is not supported by the C tracer, counter collection disabled\n");
+        counter_mode = RPV3_COUNTER_MODE_NONE;
+    }
+    if (counter_mode != RPV3_COUNTER_MODE_NONE &&
+        (rpv3_counter_kernel_count > 0 || rpv3_counter_first > 0 || rpv3_counter_every > 1)) {
+        fprintf(stderr, "[Kernel Tracer] Warning: --counter-kernels/--counter-first/--counter-every are not supported by the C tracer, counting every dispatch\n");
+    }
+    if (counter_mode != RPV3_COUNTER_MODE_NONE && rpv3_counter_cache) {
+        fprintf(stderr, "[Kernel Tracer] Warning: --counter-cache is not supported by the C tracer, querying counters every run\n");
+    }
+    
     if (timeline_enabled) {
         STATUS_PRINTF("[Kernel Tracer] Timeline mode enabled\n");
         /* Capture baseline timestamp when tracer starts */
@@ -1234,7 +1253,10 @@ int tool_init(rocprofiler_client_finalize_t fini_func,
     }
     
     /* Initialize kernel table */
-    memset(kernel_table, 0, sizeof(kernel_table));
+    if (rpv3_kernel_table_init(&kernel_table, 1024) != 0) {
+        fprintf(stderr, "[Kernel Tracer] Failed to allocate kernel table\n");
+        return -1;
+    }
     
     /* Create a context for profiling */
     if (rocprofiler_create_context(&client_ctx) != ROCPROFILER_STATUS_SUCCESS) {
@@ -1298,8 +1320,8 @@ void tool_fini(void* tool_data) {
     
     STATUS_PRINTF("[Kernel Tracer] Total kernels traced: %lu\n", 
            (unsigned long)atomic_load(&kernel_count));
-    STATUS_PRINTF("[Kernel Tracer] Unique kernel symbols tracked: %d\n",
-           atomic_load(&kernel_table_size));
+    STATUS_PRINTF("[Kernel Tracer] Unique kernel symbols tracked: %zu\n",
+           rpv3_kernel_table_size(&kernel_table));
     
     /* Stop context if still active */
     if (client_ctx.handle != 0) {
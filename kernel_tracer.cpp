@@ -12,19 +12,19 @@
 #include <rocprofiler-sdk/buffer.h>
 #include <rocprofiler-sdk/buffer_tracing.h>
 
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <atomic>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
-#include <regex>
-#include <regex>
-#include <cxxabi.h>
 #include <unistd.h>
 #include <cerrno>
+#include <cstdarg>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -33,39 +33,116 @@
 #include <mutex>
 #include <atomic>
 #include <chrono>
+#include <memory>
+#include <algorithm>
 
 #include "rpv3_options.h"
+#include "rpv3_trace_writer.h"
+#include "rpv3_binary_format.h"
+#include "rpv3_counter_catalog.h"
+#include "rpv3_counter_metrics.h"
+#include "rpv3_counter_join.h"
+#include "rpv3_counter_passes.h"
+#include "rpv3_counter_select.h"
+#include "rpv3_counter_table.h"
+#include "rpv3_record_format.h"
+#include "rpv3_kernel_stats.h"
+#include "rpv3_sampler.h"
+#include "rpv3_filter.h"
+#include "rpv3_histogram.h"
+#include "rpv3_kernel_registry.h"
+#include "rpv3_demangle.h"
+#include "rpv3_line_reader.h"
+#include "rpv3_log_correlator.h"
+#include "rpv3_blas_parser.h"
+#include "rpv3_blas_perf.h"
+#include "rpv3_blas_bench.h"
+#include "rpv3_tensile.h"
+#include "rpv3_path_set.h"
+#include "rpv3_library_log.h"
 #include <dlfcn.h>
 #include <execinfo.h>
 
 extern "C" {
-    // Intercept fopen to force line buffering on pipes
+    // Intercept fopen and friends to unbuffer the streams math libraries log
+    // through, so lines reach the pipe as they are written. The targets are
+    // resolved once (see rpv3_path_set.h); while none are configured each
+    // wrapper adds a single atomic load to the real call.
     typedef FILE* (*fopen_t)(const char*, const char*);
+    typedef FILE* (*fdopen_t)(int, const char*);
+    typedef int (*open_t)(const char*, int, ...);
+    typedef int (*openat_t)(int, const char*, int, ...);
     static fopen_t real_fopen = nullptr;
     static fopen_t real_fopen64 = nullptr;
+    static fdopen_t real_fdopen = nullptr;
+    static open_t real_open = nullptr;
+    static open_t real_open64 = nullptr;
+    static openat_t real_openat = nullptr;
+    static openat_t real_openat64 = nullptr;
+
+    // Published once from the environment at load and again once the log
+    // pipe options are known. Sets are never freed: the wrappers may still
+    // run during exit.
+    static std::atomic<const rpv3::PathSet*> log_paths{nullptr};
+    static rpv3::FdSet log_fds;
+
+    static void publish_log_paths() {
+        auto* paths = new rpv3::PathSet();
+        for (const rpv3::LibraryLog* library : rpv3::library_logs()) {
+            for (const char* const* name = library->log_env(); *name; name++) {
+                const char* path = getenv(*name);
+                if (path) {
+                    paths->add(path);
+                }
+            }
+        }
+        for (const char* pipe : {rpv3_rocblas_pipe, rpv3_hipblaslt_pipe, rpv3_miopen_pipe, rpv3_rocsolver_pipe}) {
+            if (pipe) {
+                paths->add(pipe);
+            }
+        }
+        if (paths->empty()) {
+            delete paths;
+            return;
+        }
+        log_paths.store(paths, std::memory_order_release);
+    }
+
+    __attribute__((constructor)) static void init_log_paths() {
+        publish_log_paths();
+    }
+
+    static bool is_log_path(const char* path) {
+        const rpv3::PathSet* paths = log_paths.load(std::memory_order_acquire);
+        return paths && paths->contains(path);
+    }
+
+    static void unbuffer_if_log(FILE* fp, const char* path) {
+        if (fp && is_log_path(path)) {
+            setvbuf(fp, nullptr, _IONBF, 0);
+        }
+    }
+
+    // Remember whether a new descriptor refers to a target, for fdopen()
+    static int track_fd(int fd, const char* path) {
+        if (fd >= 0 && log_paths.load(std::memory_order_acquire)) {
+            log_fds.set(fd, is_log_path(path));
+        }
+        return fd;
+    }
+
+    // open() and openat() take a mode only when they may create a file.
+    // O_TMPFILE includes the O_DIRECTORY bit, so it must match in full.
+    static mode_t open_mode(int flags, va_list args) {
+        return ((flags & O_CREAT) || (flags & O_TMPFILE) == O_TMPFILE) ? (mode_t)va_arg(args, int) : 0;
+    }
 
     FILE* fopen(const char* path, const char* mode) {
         if (!real_fopen) {
             real_fopen = (fopen_t)dlsym(RTLD_NEXT, "fopen");
         }
         FILE* fp = real_fopen(path, mode);
-        
-        // Check against environment variables directly to handle early initialization
-        const char* trace_path = getenv("ROCBLAS_LOG_TRACE_PATH");
-        const char* bench_path = getenv("ROCBLAS_LOG_BENCH_PATH");
-        const char* profile_path = getenv("ROCBLAS_LOG_PROFILE_PATH");
-        
-        bool match = false;
-        if (path) {
-            if (trace_path && strcmp(path, trace_path) == 0) match = true;
-            else if (bench_path && strcmp(path, bench_path) == 0) match = true;
-            else if (profile_path && strcmp(path, profile_path) == 0) match = true;
-            else if (rpv3_rocblas_pipe && strcmp(path, rpv3_rocblas_pipe) == 0) match = true;
-        }
-
-        if (fp && match) {
-             setvbuf(fp, nullptr, _IONBF, 0);
-        }
+        unbuffer_if_log(fp, path);
         return fp;
     }
 
@@ -75,66 +152,94 @@ extern "C" {
             if (!real_fopen64) real_fopen64 = (fopen_t)dlsym(RTLD_NEXT, "fopen");
         }
         FILE* fp = real_fopen64(path, mode);
-        
-        const char* trace_path = getenv("ROCBLAS_LOG_TRACE_PATH");
-        const char* bench_path = getenv("ROCBLAS_LOG_BENCH_PATH");
-        const char* profile_path = getenv("ROCBLAS_LOG_PROFILE_PATH");
-        
-        bool match = false;
-        if (path) {
-            if (trace_path && strcmp(path, trace_path) == 0) match = true;
-            else if (bench_path && strcmp(path, bench_path) == 0) match = true;
-            else if (profile_path && strcmp(path, profile_path) == 0) match = true;
-            else if (rpv3_rocblas_pipe && strcmp(path, rpv3_rocblas_pipe) == 0) match = true;
-        }
-        
-        if (fp && match) {
-             setvbuf(fp, nullptr, _IONBF, 0);
-        }
+        unbuffer_if_log(fp, path);
         return fp;
     }
 
-    typedef FILE* (*fdopen_t)(int, const char*);
-    static fdopen_t real_fdopen = nullptr;
-
     FILE* fdopen(int fd, const char* mode) {
         if (!real_fdopen) {
             real_fdopen = (fdopen_t)dlsym(RTLD_NEXT, "fdopen");
         }
         FILE* fp = real_fdopen(fd, mode);
-        
-        if (fp) {
+        if (!fp || !log_paths.load(std::memory_order_acquire)) {
+            return fp;
+        }
+
+        bool match = log_fds.contains(fd);
+        if (!rpv3::FdSet::tracked(fd)) {
+            // Beyond the tracked range: resolve the descriptor's path
             char path[1024];
             char proc_path[64];
             snprintf(proc_path, sizeof(proc_path), "/proc/self/fd/%d", fd);
             ssize_t len = readlink(proc_path, path, sizeof(path) - 1);
             if (len != -1) {
                 path[len] = '\0';
-                
-                const char* trace_path = getenv("ROCBLAS_LOG_TRACE_PATH");
-                const char* bench_path = getenv("ROCBLAS_LOG_BENCH_PATH");
-                const char* profile_path = getenv("ROCBLAS_LOG_PROFILE_PATH");
-                
-                bool match = false;
-                if (trace_path && strcmp(path, trace_path) == 0) match = true;
-                else if (bench_path && strcmp(path, bench_path) == 0) match = true;
-                else if (profile_path && strcmp(path, profile_path) == 0) match = true;
-                else if (rpv3_rocblas_pipe && strcmp(path, rpv3_rocblas_pipe) == 0) match = true;
-                
-        if (fp && match) {
-             setvbuf(fp, nullptr, _IONBF, 0);
+                match = is_log_path(path);
+            }
         }
+        if (match) {
+            setvbuf(fp, nullptr, _IONBF, 0);
         }
-            }
         return fp;
     }
+
+    int open(const char* path, int flags, ...) {
+        if (!real_open) {
+            real_open = (open_t)dlsym(RTLD_NEXT, "open");
+        }
+        va_list args;
+        va_start(args, flags);
+        mode_t mode = open_mode(flags, args);
+        va_end(args);
+        return track_fd(real_open(path, flags, mode), path);
+    }
+
+    int open64(const char* path, int flags, ...) {
+        if (!real_open64) {
+            real_open64 = (open_t)dlsym(RTLD_NEXT, "open64");
+            if (!real_open64) real_open64 = (open_t)dlsym(RTLD_NEXT, "open");
+        }
+        va_list args;
+        va_start(args, flags);
+        mode_t mode = open_mode(flags, args);
+        va_end(args);
+        return track_fd(real_open64(path, flags, mode), path);
+    }
+
+    int openat(int dirfd, const char* path, int flags, ...) {
+        if (!real_openat) {
+            real_openat = (openat_t)dlsym(RTLD_NEXT, "openat");
+        }
+        va_list args;
+        va_start(args, flags);
+        mode_t mode = open_mode(flags, args);
+        va_end(args);
+        return track_fd(real_openat(dirfd, path, flags, mode), path);
+    }
+
+    int openat64(int dirfd, const char* path, int flags, ...) {
+        if (!real_openat64) {
+            real_openat64 = (openat_t)dlsym(RTLD_NEXT, "openat64");
+            if (!real_openat64) real_openat64 = (openat_t)dlsym(RTLD_NEXT, "openat");
+        }
+        va_list args;
+        va_start(args, flags);
+        mode_t mode = open_mode(flags, args);
+        va_end(args);
+        return track_fd(real_openat64(dirfd, path, flags, mode), path);
+    }
 }
 
 namespace {
     std::atomic<uint64_t> kernel_count{0};
     rocprofiler_context_id_t client_ctx = {};
     rocprofiler_client_id_t* client_id = nullptr;
-    std::unordered_map<rocprofiler_kernel_id_t, std::string> kernel_names;
+    // Kernel symbols, written by the code object callback and read lock-free
+    // from dispatch and buffer callbacks
+    rpv3::KernelRegistry kernel_symbols;
+    constexpr uint32_t kKernelSelected = 1u << 0;  // Passed --include/--exclude
+    constexpr uint32_t kKernelCounted = 1u << 1;   // Matched --counter-kernels
+    constexpr uint32_t kKernelChannelShift = 8;     // Bits above: library channel index + 1
     
     // Timeline mode state
     bool timeline_enabled = false;
@@ -143,77 +248,570 @@ namespace {
 
     // CSV output mode state
     bool csv_enabled = false;
+    bool blas_columns = false;  // Typed rocBLAS call columns (--csv with --rocblas)
+
+    // Binary output mode state (--format binary)
+    bool binary_enabled = false;
+    rpv3::binary::Writer binary_writer;
 
     // Backtrace mode state
     bool backtrace_enabled = false;
 
+    // Summary mode state (--summary): per-kernel statistics replace dispatch records
+    bool summary_enabled = false;
+    rpv3::KernelStatsTable kernel_stats;
+
+    // Solution parameters of Tensile kernels, decoded at registration for
+    // the summary's solution table
+    rpv3::TensileSolutionTable tensile_solutions;
+
+    // Dispatch sampling state (--sample)
+    rpv3::DispatchSampler sampler;
+    constexpr uint64_t kSampledAway = 1ull << 63;  // Text mode ENTER -> EXIT: selected, not sampled
+
+    // Kernel filter state (--include, --exclude, --filter)
+    rpv3::NameFilter name_filter;
+    rpv3::DispatchFilter dispatch_filter;
+    // Name verdicts are decided once when a symbol registers (kKernelSelected)
+    bool unknown_kernel_verdict = true;  // Dispatches of kernels with no symbol
+
+    // Per-kernel latency histograms (--histogram), null when disabled
+    std::unique_ptr<rpv3::HistogramTable> histograms;
+
     // Counter collection state
     rpv3_counter_mode_t counter_mode = RPV3_COUNTER_MODE_NONE;
-    
-    struct AgentIdComparator {
-        bool operator()(const rocprofiler_agent_id_t& lhs, const rocprofiler_agent_id_t& rhs) const {
-            return lhs.handle < rhs.handle;
-        }
+    // Counters to collect and the columns written from them (--counter
+    // groups and --counters lists alike)
+    rpv3::CounterMetrics counter_metrics;
+    
+    // Profiles of each agent, one per pass; agents whose counters fit one
+    // profile have one. Built at setup and read-only afterwards. There are
+    // only a few agents, so a linear scan beats a tree lookup per dispatch.
+    struct AgentProfiles {
+        uint64_t agent = 0;
+        std::vector<rocprofiler_profile_config_id_t> passes;
     };
-    
-    std::map<rocprofiler_agent_id_t, rocprofiler_profile_config_id_t, AgentIdComparator> agent_profiles;
+    std::vector<AgentProfiles> agent_profiles;
+    bool counters_multiplexed = false;  // Some agent needs more than one pass
+
+    // Counter ids and pass plans per kind of agent, cached on disk
+    // (--counter-cache) so later runs skip the counter queries
+    rpv3::CounterCatalog counter_catalog;
+
+    // Which dispatches are counted (--counter-kernels/-first/-every). Name
+    // verdicts are decided once when a symbol registers (kKernelCounted).
+    rpv3::NameFilter counter_kernel_filter;
+    bool unknown_kernel_counted = true;  // Dispatches of kernels with no symbol
+    rpv3::CounterSelector counter_selector;
+    bool counter_selector_enabled = false;  // Per-kernel state needed
     rocprofiler_buffer_id_t counter_buffer = {};
 
+    // Counter records reduced to one row per dispatch, with a named column
+    // per counter selected by any agent's profile
+    rpv3::CounterTable counter_table;
+    std::vector<uint32_t> counter_name_ids;  // Binary string id per output column
+    uint64_t counter_rows = 0;               // Only written from the buffer callback
+    rpv3::CounterEstimates counter_estimates;  // Per-kernel merge of multiplexed rows
+
+    // --timeline with counters: each timeline record is written with its
+    // dispatch's counter columns, whichever half arrives first waits
+    bool counters_joined = false;
+    rpv3::CounterJoin counter_join;
+
     // Output file state
     FILE* output_file = nullptr;
     char output_filename[512];
 
-    // RocBLAS Log Pipe state
-    int rocblas_pipe_fd = -1;
-    // RocBLAS log pipe path
-    static char rocblas_pipe_path[256] = {0};
+    // Library call logs (--rocblas, --hipblaslt, --miopen, --rocsolver). One
+    // reader thread drains every log through its channel's buffered reader
+    // and queues stamped call lines; each channel's correlator pairs them with
+    // dispatches of the kernels its library claimed, so no callback ever
+    // waits on a pipe. Channels are set up in tool_init and fixed afterwards.
+    struct LibraryChannel {
+        const rpv3::LibraryLog* library = nullptr;
+        int fd = -1;
+        rpv3::LineReader reader;  // --rocblas-log tees here, with tee(2)/splice(2) from a FIFO
+        std::unique_ptr<rpv3::LogCorrelator> correlator;
+        rpv3::LogCorrelator::Sink sink;
+        bool at_eof = false;
+    };
+    std::vector<std::unique_ptr<LibraryChannel>> library_channels;
+    std::vector<const rpv3::LibraryLog*> channel_libraries;  // Same order, for route_kernel()
+    LibraryChannel* rocblas_channel = nullptr;  // The channel with typed BLAS calls
+    std::thread library_log_thread;
+    std::atomic<bool> library_log_stop{false};
+    constexpr int kLibraryLogPollMs = 20;
+    // Span pairing (rocSOLVER): how late a call line may arrive after a
+    // kernel it launched started; short, as later calls may follow closely
+    constexpr uint64_t kSpanWindowNs = 100000;
 
     // RocBLAS log file handle
     static FILE* rocblas_log_file = NULL;
 
-    // Output macro for trace data (CSV or human-readable kernel details)
-    // Protected by a mutex to ensure atomic lines
+    // Per-shape achieved throughput of correlated BLAS dispatches, printed at
+    // exit. Only written from the correlator sink.
+    rpv3::BlasEfficiencyTable blas_efficiency;
+    rpv3::BlasPeak blas_peak;
+
+    // Distinct rocBLAS calls for --rocblas-bench, same writer as above
+    rpv3::BlasBenchTable blas_bench;
+
+    // Async output engine (--async): per-thread rings drained by a writer thread
+    std::unique_ptr<rpv3::TraceWriter> trace_writer;
+
+    // Synchronous output path, protected by a mutex to ensure atomic lines
     std::mutex output_mutex;
-    #define TRACE_PRINTF(...) do { \
-        std::lock_guard<std::mutex> lock(output_mutex); \
-        fprintf(output_file ? output_file : stdout, __VA_ARGS__); \
-    } while(0)
+
+    // Hand one complete trace record to the active sink
+    void trace_write(const char* data, size_t len) {
+        if (trace_writer) {
+            trace_writer->write(data, len);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(output_mutex);
+        fwrite(data, 1, len, output_file ? output_file : stdout);
+    }
+
+    void trace_write(const rpv3::RecordBuffer& buffer) {
+        trace_write(buffer.data(), buffer.size());
+    }
+
+    // Per-thread buffer that collects one complete record before it is written,
+    // so every record reaches the sink in a single write
+    rpv3::RecordBuffer& record_buffer() {
+        thread_local rpv3::RecordBuffer buffer;
+        buffer.clear();
+        return buffer;
+    }
+
+    // CSV header output (once per process)
+    void write_csv_header() {
+        static std::once_flag header_once;
+        std::call_once(header_once, [] {
+            std::string header = counters_joined ? rpv3::joined_csv_header(blas_columns, counter_metrics.columns())
+                                                 : rpv3::csv_header(blas_columns);
+            trace_write(header.data(), header.size());
+        });
+    }
+
+    // Normalize a rocprofiler dispatch into the record shared by all output formats
+    rpv3::DispatchRecord make_dispatch_record(const rocprofiler_kernel_dispatch_info_t& info,
+                                              uint64_t thread_id, uint64_t correlation_id,
+                                              uint64_t start_ns, uint64_t end_ns) {
+        rpv3::DispatchRecord dispatch;
+        dispatch.thread_id = thread_id;
+        dispatch.correlation_id = correlation_id;
+        dispatch.kernel_id = info.kernel_id;
+        dispatch.dispatch_id = info.dispatch_id;
+        dispatch.grid[0] = info.grid_size.x;
+        dispatch.grid[1] = info.grid_size.y;
+        dispatch.grid[2] = info.grid_size.z;
+        dispatch.workgroup[0] = info.workgroup_size.x;
+        dispatch.workgroup[1] = info.workgroup_size.y;
+        dispatch.workgroup[2] = info.workgroup_size.z;
+        dispatch.private_segment_size = info.private_segment_size;
+        dispatch.group_segment_size = info.group_segment_size;
+        dispatch.start_ns = start_ns;
+        dispatch.end_ns = end_ns;
+        return dispatch;
+    }
 
     // Output macro for status messages (init, summary, errors)
-    // If CSV output is enabled AND we are writing to a file, status messages go to stdout
+    // If CSV or binary output is enabled AND we are writing to a file, status messages go to stdout
     // Otherwise, they follow the trace output (to file if set, else stdout)
-    #define STATUS_PRINTF(...) fprintf((output_file && csv_enabled) ? stdout : (output_file ? output_file : stdout), __VA_ARGS__)
-}
+    FILE* status_stream() {
+        return (output_file && (csv_enabled || binary_enabled)) ? stdout : (output_file ? output_file : stdout);
+    }
+    #define STATUS_PRINTF(...) fprintf(status_stream(), __VA_ARGS__)
 
-// Helper function to demangle C++ kernel names
-std::string demangle_kernel_name(const char* mangled_name) {
-    if (!mangled_name) return "<unknown>";
-    
-    // Remove .kd suffix if present
-    std::string name = std::regex_replace(mangled_name, std::regex{R"((\.kd)$)"}, "");
-    
-    // Try to demangle C++ names
-    int status = 0;
-    char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
-    
-    if (status == 0 && demangled) {
-        std::string result(demangled);
-        free(demangled);
-        return result;
+    // Encode a dispatch record into out, which may be held back before it is written
+    void binary_format_dispatch(rpv3::RecordBuffer& out, const rpv3::DispatchRecord& dispatch, uint32_t name_id) {
+        rpv3::binary::Record record;
+        record.kind = rpv3::binary::kRecordDispatch;
+        record.string_id = name_id;
+        record.dispatch = dispatch;
+        unsigned char buffer[rpv3::binary::kRecordSize];
+        binary_writer.encode(record, buffer);
+        out.append(std::string_view(reinterpret_cast<const char*>(buffer), sizeof(buffer)));
+    }
+
+    // String table id for a kernel name. Cached per thread by kernel id so the
+    // shared table is only consulted the first time a thread sees a kernel.
+    // Names are stored mangled (kFlagMangledNames); rpv3-convert demangles them.
+    uint32_t binary_name_id(uint64_t kernel_id, const rpv3::KernelSymbol* symbol) {
+        if (!symbol) {
+            return rpv3::binary::kUnknownStringId;
+        }
+        thread_local std::unordered_map<uint64_t, uint32_t> name_ids;
+        auto it = name_ids.find(kernel_id);
+        if (it != name_ids.end()) {
+            return it->second;
+        }
+        uint32_t id = binary_writer.intern(symbol->mangled);
+        name_ids.emplace(kernel_id, id);
+        return id;
+    }
+
+    // Append a rocBLAS log line, and in binary mode its parsed call, after the
+    // record of the dispatch it belongs to
+    void append_annotation(rpv3::RecordBuffer& out, const std::string& line,
+                           const rpv3::BlasCall* call, uint64_t dispatch_id) {
+        if (binary_enabled) {
+            unsigned char buffer[rpv3::binary::kRecordSize];
+            rpv3::binary::Record record;
+            record.kind = rpv3::binary::kRecordAnnotation;
+            record.string_id = binary_writer.intern(line);
+            record.dispatch.dispatch_id = dispatch_id;
+            binary_writer.encode(record, buffer);
+            out.append(std::string_view(reinterpret_cast<const char*>(buffer), sizeof(buffer)));
+            if (call) {
+                binary_writer.encode(rpv3::binary::BlasRecord{dispatch_id, *call}, buffer);
+                out.append(std::string_view(reinterpret_cast<const char*>(buffer), sizeof(buffer)));
+            }
+        } else {
+            out.append("# ").append(line).append('\n');
+        }
+    }
+
+    void join_dispatch(const rpv3::TimedDispatch& timed);
+
+    // Correlator sink: write a held-back record together with the line that
+    // belongs to it. A CSV record was held without its line terminator so the
+    // parsed call can complete the row. A joined record is handed to the
+    // counter join instead, its counter columns going between the two.
+    void write_correlated(const LibraryChannel& channel, const rpv3::PendingDispatch& dispatch,
+                          const rpv3::LogLine* line) {
+        if (!dispatch.recorded) {
+            // Skipped dispatch; the pipe is still drained so the library never
+            // blocks on a full FIFO
+            return;
+        }
+        rpv3::BlasCall call;
+        const bool parsed = line && channel.library->parse_call(line->text, call);
+        rpv3::BlasWork work;
+        if (parsed) {
+            blas_efficiency.record(call, dispatch.duration_ns);
+            if (rpv3_rocblas_bench_file) {
+                blas_bench.record(call, dispatch.duration_ns);
+            }
+            if (rpv3::blas_one_kernel(call)) {
+                work = rpv3::blas_work(call);
+            }
+        }
+        if (dispatch.record.empty()) {
+            return;  // Summary mode
+        }
+
+        const double tflops = rpv3::achieved_tflops(work, dispatch.duration_ns);
+        const double gbps = rpv3::achieved_gbps(work, dispatch.duration_ns);
+        rpv3::RecordBuffer& out = record_buffer();
+        out.append(dispatch.record);
+        if (counters_joined) {
+            if (blas_columns) {
+                rpv3::format_csv_blas_fields(out, parsed ? &call : nullptr, tflops, gbps);
+            }
+            rpv3::TimedDispatch timed;
+            timed.dispatch.dispatch_id = dispatch.dispatch_id;
+            timed.dispatch.start_ns = dispatch.timestamp_ns;
+            timed.dispatch.end_ns = dispatch.timestamp_ns + dispatch.duration_ns;
+            timed.record.assign(out.data(), out.size());
+            if (line) {
+                out.clear();
+                append_annotation(out, line->text, parsed ? &call : nullptr, dispatch.dispatch_id);
+                timed.annotation.assign(out.data(), out.size());
+            }
+            join_dispatch(timed);
+            return;
+        }
+        if (blas_columns) {
+            rpv3::format_csv_blas_columns(out, parsed ? &call : nullptr, tflops, gbps);
+        }
+        if (line) {
+            append_annotation(out, line->text, parsed ? &call : nullptr, dispatch.dispatch_id);
+        }
+        trace_write(out);
+    }
+
+    // Library channel whose kernel this is, or nullptr
+    LibraryChannel* kernel_channel(const rpv3::KernelSymbol* symbol) {
+        const uint32_t slot = symbol ? symbol->flags >> kKernelChannelShift : 0;
+        return slot ? library_channels[slot - 1].get() : nullptr;
+    }
+
+    // Queue a claimed dispatch for its library's log line. The formatted
+    // record in out (empty for skipped dispatches) is held until the line is
+    // matched. Matching is attempted at once but skipped if another thread
+    // is at it.
+    void defer_to_library(LibraryChannel& channel, const rpv3::DispatchRecord& dispatch, bool recorded,
+                          const rpv3::RecordBuffer& out) {
+        uint64_t now = 0;
+        rocprofiler_get_timestamp(&now);
+
+        rpv3::PendingDispatch pending;
+        pending.dispatch_id = dispatch.dispatch_id;
+        pending.timestamp_ns = dispatch.start_ns ? dispatch.start_ns : now;
+        pending.duration_ns = dispatch.duration_ns();
+        pending.recorded = recorded;
+        pending.record.assign(out.data(), out.size());
+        channel.correlator->push_dispatch(std::move(pending));
+        channel.correlator->try_match(now, channel.sink);
+    }
+
+    // Reader thread: drain every library log, stamp each call line with its
+    // arrival time and resolve dispatches whose window has passed. Once asked
+    // to stop it drains what is left and exits.
+    void library_log_loop() {
+        std::string line;
+        std::vector<struct pollfd> pfds(library_channels.size());
+        while (true) {
+            const bool stopping = library_log_stop.load(std::memory_order_acquire);
+            // A drained regular file or a FIFO without a writer polls ready
+            // forever, so such a channel is only read again after a sleep
+            size_t polled = 0;
+            for (const auto& channel : library_channels) {
+                if (!channel->at_eof) {
+                    pfds[polled].fd = channel->fd;
+                    pfds[polled].events = POLLIN;
+                    pfds[polled].revents = 0;
+                    polled++;
+                }
+            }
+            if (stopping) {
+                // Final drain
+            } else if (polled == 0) {
+                poll(nullptr, 0, kLibraryLogPollMs);
+            } else {
+                poll(pfds.data(), polled, kLibraryLogPollMs);
+            }
+
+            size_t index = 0;
+            for (const auto& entry : library_channels) {
+                LibraryChannel& channel = *entry;
+                bool readable = true;
+                if (!channel.at_eof) {
+                    readable = stopping || pfds[index++].revents != 0;
+                }
+
+                const uint64_t before = channel.reader.bytes_read();
+                while (channel.reader.next_line(channel.fd, line)) {
+                    if (!channel.library->is_call_line(line)) {
+                        continue;
+                    }
+                    uint64_t arrived = 0;
+                    rocprofiler_get_timestamp(&arrived);
+                    channel.correlator->push_line(arrived, line, channel.library->spans_kernels(line));
+                }
+                channel.at_eof = readable && channel.reader.bytes_read() == before;
+
+                uint64_t now = 0;
+                rocprofiler_get_timestamp(&now);
+                channel.correlator->match(now, channel.sink);
+            }
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    // Cached --include/--exclude verdict for a kernel
+    bool kernel_selected(uint64_t kernel_id) {
+        if (name_filter.empty()) {
+            return true;
+        }
+        const rpv3::KernelSymbol* symbol = kernel_symbols.find(kernel_id);
+        return symbol ? (symbol->flags & kKernelSelected) != 0 : unknown_kernel_verdict;
+    }
+
+    // Cached --counter-kernels verdict for a kernel
+    bool kernel_counted(uint64_t kernel_id) {
+        if (counter_kernel_filter.empty()) {
+            return true;
+        }
+        const rpv3::KernelSymbol* symbol = kernel_symbols.find(kernel_id);
+        return symbol ? (symbol->flags & kKernelCounted) != 0 : unknown_kernel_counted;
+    }
+
+    const AgentProfiles* find_agent_profiles(rocprofiler_agent_id_t agent) {
+        for (const AgentProfiles& profiles : agent_profiles) {
+            if (profiles.agent == agent.handle) {
+                return &profiles;
+            }
+        }
+        return nullptr;
+    }
+
+    // Name verdict and the --filter predicates known at launch (everything but duration)
+    bool launch_selected(const rocprofiler_kernel_dispatch_info_t& info) {
+        if (!kernel_selected(info.kernel_id)) {
+            return false;
+        }
+        return dispatch_filter.empty() ||
+               dispatch_filter.matches_launch(make_dispatch_record(info, 0, 0, 0, 0));
     }
-    
-    return name;
-}
 
-// Helper function to check if a kernel is a Tensile routine
-bool is_tensile_kernel(const std::string& name) {
-    return (name.find("Cijk") != std::string::npos || 
-            name.find("assembly") != std::string::npos || 
-            name.find("Tensile") != std::string::npos);
+    void record_latency(const rpv3::DispatchRecord& dispatch) {
+        if (histograms && dispatch.end_ns > 0) {
+            histograms->record(dispatch.kernel_id, dispatch.duration_ns());
+        }
+    }
+
+    // Demangled kernel name; demangling happens on the kernel's first use
+    std::string_view kernel_display_name(const rpv3::KernelSymbol* symbol) {
+        return symbol ? kernel_symbols.name(*symbol) : std::string_view("<unknown>");
+    }
+
+    // Format one completed dispatch in the active output mode into out. Text
+    // records carry the timeline offset in timeline mode and only the duration
+    // otherwise. Summary mode only updates statistics and formats nothing.
+    // Summary and binary records never need the demangled name. With rocBLAS
+    // columns, a row held for the correlator (blas_pending) is left open for
+    // write_correlated to finish.
+    void format_dispatch(rpv3::RecordBuffer& out, const rpv3::DispatchRecord& dispatch,
+                         uint64_t sequence, const rpv3::KernelSymbol* symbol, bool blas_pending) {
+        record_latency(dispatch);
+        if (summary_enabled) {
+            if (dispatch.end_ns > 0) {
+                kernel_stats.record(dispatch.kernel_id, dispatch.duration_ns());
+            }
+            return;
+        }
+        if (binary_enabled) {
+            binary_format_dispatch(out, dispatch, binary_name_id(dispatch.kernel_id, symbol));
+            return;
+        }
+        std::string_view kernel_name = kernel_display_name(symbol);
+        if (csv_enabled && blas_columns) {
+            rpv3::format_csv_fields(out, kernel_name, dispatch, tracer_start_timestamp);
+            if (!blas_pending) {
+                rpv3::format_csv_blas_columns(out, nullptr, 0.0, 0.0);
+            }
+        } else if (csv_enabled) {
+            rpv3::format_csv_row(out, kernel_name, dispatch, tracer_start_timestamp);
+        } else {
+            rpv3::TextTimestamps timestamps = rpv3::TextTimestamps::None;
+            if (dispatch.end_ns > 0) {
+                timestamps = timeline_enabled ? rpv3::TextTimestamps::Timeline : rpv3::TextTimestamps::Duration;
+            }
+            rpv3::format_text_record(out, sequence, kernel_name, dispatch, timestamps, tracer_start_timestamp);
+        }
+    }
+
+    // Write one completed dispatch in the active output mode
+    void emit_dispatch(const rpv3::DispatchRecord& dispatch, uint64_t sequence,
+                       const rpv3::KernelSymbol* symbol) {
+        rpv3::RecordBuffer& out = record_buffer();
+        format_dispatch(out, dispatch, sequence, symbol, false);
+        if (out.size() > 0) {
+            trace_write(out);
+        }
+    }
+
+    // Every output column of a counter row (counters and metrics computed
+    // from them), NaN where not computable. Table columns are
+    // counter_metrics.counters(), declared in that order; a null row is a
+    // dispatch that was not counted. duration_ns is NaN when unknown.
+    const std::vector<double>& counter_columns(const rpv3::CounterRow* row, double duration_ns) {
+        thread_local std::vector<double> counters;
+        thread_local std::vector<double> values;
+        if (row) {
+            rpv3::counter_values(*row, counters);
+        } else {
+            counters.assign(counter_metrics.counters().size(), NAN);
+        }
+        values.resize(counter_metrics.columns().size());
+        counter_metrics.evaluate(counters.data(), duration_ns, values.data());
+        return values;
+    }
+
+    // One binary counter record per computable column
+    void binary_format_counters(rpv3::RecordBuffer& out, const rpv3::CounterRow& row,
+                                const std::vector<double>& values) {
+        unsigned char buffer[rpv3::binary::kRecordSize];
+        for (size_t i = 0; i < values.size(); i++) {
+            if (std::isnan(values[i])) {
+                continue;
+            }
+            // Metrics are not summed from instances
+            const int counter = counter_metrics.counter_of(i);
+            rpv3::binary::CounterValue value;
+            value.dispatch_id = row.dispatch.dispatch_id;
+            value.name_id = counter_name_ids[i];
+            value.instances = counter >= 0 ? row.instances[counter] : 0;
+            value.flags = counter >= 0 ? 0 : rpv3::binary::kCounterMetric;
+            value.agent_id = row.agent_id;
+            value.value = values[i];
+            binary_writer.encode(value, buffer);
+            out.append(std::string_view(reinterpret_cast<const char*>(buffer), sizeof(buffer)));
+        }
+    }
+
+    // The part of a joined record before its counter columns: the record of
+    // format_dispatch, except that a CSV row is left open. With rocBLAS
+    // columns, a row held for the correlator (blas_pending) gets them from
+    // write_correlated.
+    void format_joined_record(rpv3::RecordBuffer& out, const rpv3::DispatchRecord& dispatch,
+                              uint64_t sequence, const rpv3::KernelSymbol* symbol, bool blas_pending) {
+        if (!csv_enabled || summary_enabled || binary_enabled) {
+            format_dispatch(out, dispatch, sequence, symbol, false);
+            return;
+        }
+        record_latency(dispatch);
+        rpv3::format_csv_fields(out, kernel_display_name(symbol), dispatch, tracer_start_timestamp);
+        if (blas_columns && !blas_pending) {
+            rpv3::format_csv_blas_fields(out, nullptr, 0.0, 0.0);
+        }
+    }
+
+    // Write a timeline record together with its dispatch's counter columns,
+    // which are empty when the dispatch was not counted (row is null), and
+    // its library log line if any. DurationNs comes from the timeline
+    // timestamps.
+    void emit_joined(const rpv3::TimedDispatch& timed, const rpv3::CounterRow* row) {
+        const rpv3::DispatchRecord& dispatch = timed.dispatch;
+        const std::vector<double>& values = counter_columns(row, (double)dispatch.duration_ns());
+        rpv3::RecordBuffer& out = record_buffer();
+        if (timed.record.empty()) {
+            format_joined_record(out, dispatch, timed.sequence, kernel_symbols.find(dispatch.kernel_id), false);
+        } else {
+            out.append(timed.record);
+        }
+        if (summary_enabled) {
+            // Statistics only
+        } else if (binary_enabled) {
+            if (row) {
+                binary_format_counters(out, *row, values);
+            }
+        } else if (csv_enabled) {
+            rpv3::format_counter_fields(out, values);
+            out.append('\n');
+        } else {
+            rpv3::format_counter_line(out, counter_metrics.columns(), values);
+        }
+        out.append(timed.annotation);
+        if (out.size() > 0) {
+            trace_write(out);
+        }
+    }
+
+    // Timeline side of a joined dispatch: written now if its counter row is
+    // in or it was not counted, else held until the row arrives
+    void join_dispatch(const rpv3::TimedDispatch& timed) {
+        rpv3::CounterRow row;
+        switch (counter_join.add_dispatch(timed, row)) {
+            case rpv3::CounterJoin::Match::Uncounted:
+                emit_joined(timed, nullptr);
+                break;
+            case rpv3::CounterJoin::Match::Joined:
+                emit_joined(timed, &row);
+                break;
+            case rpv3::CounterJoin::Match::Held:
+                break;
+        }
+    }
 }
 
-// Helper function to print backtrace
-void print_backtrace() {
+// Helper function to append the current call stack to a record
+void append_backtrace(rpv3::RecordBuffer& out) {
     const int max_frames = 64;
     void* buffer[max_frames];
     
@@ -221,11 +819,11 @@ void print_backtrace() {
     int nptrs = backtrace(buffer, max_frames);
     
     if (nptrs <= 0) {
-        TRACE_PRINTF("  (backtrace unavailable)\n");
+        out.append("  (backtrace unavailable)\n");
         return;
     }
     
-    TRACE_PRINTF("\nCall Stack (%d frames):\n", nptrs);
+    out.append("\nCall Stack (").append_i64(nptrs).append(" frames):\n");
     
     // Process each frame
     for (int i = 0; i < nptrs; i++) {
@@ -241,29 +839,31 @@ void print_backtrace() {
             
             // Get function name
             if (info.dli_sname) {
-                // Try to demangle C++ names
-                std::string demangled = demangle_kernel_name(info.dli_sname);
-                
                 // Skip internal profiler frames
                 if (strstr(lib_name, "libkernel_tracer") != nullptr ||
                     strstr(lib_name, "librocprofiler") != nullptr) {
                     continue;
                 }
                 
+                // Try to demangle C++ names
+                std::string demangled = rpv3::demangle_symbol(info.dli_sname);
+                
                 // Calculate offset
-                void* offset = (void*)((char*)buffer[i] - (char*)info.dli_saddr);
+                uintptr_t offset = (uintptr_t)((char*)buffer[i] - (char*)info.dli_saddr);
                 
-                TRACE_PRINTF("  #%-2d %s: %s + %p\n", i, lib_name, demangled.c_str(), offset);
+                out.append("  #").append_left(i, 2).append(' ').append(lib_name).append(": ")
+                   .append(demangled).append(" + ").append_pointer(offset).append('\n');
             } else {
                 // No symbol name available
-                TRACE_PRINTF("  #%-2d %s: [0x%lx]\n", i, lib_name, (unsigned long)buffer[i]);
+                out.append("  #").append_left(i, 2).append(' ').append(lib_name).append(": [")
+                   .append_hex((uintptr_t)buffer[i]).append("]\n");
             }
         } else {
             // dladdr failed
-            TRACE_PRINTF("  #%-2d [0x%lx]\n", i, (unsigned long)buffer[i]);
+            out.append("  #").append_left(i, 2).append(" [").append_hex((uintptr_t)buffer[i]).append("]\n");
         }
     }
-    TRACE_PRINTF("\n");
+    out.append('\n');
 }
 
 // Callback function for kernel symbol registration
@@ -279,15 +879,39 @@ void kernel_symbol_callback(rocprofiler_callback_tracing_record_t record,
         auto* data = static_cast<rocprofiler_callback_tracing_code_object_kernel_symbol_register_data_t*>(record.payload);
         
         if (record.phase == ROCPROFILER_CALLBACK_PHASE_LOAD && data && data->kernel_name) {
-            // Store the kernel name with demangling
-            kernel_names[data->kernel_id] = demangle_kernel_name(data->kernel_name);
-        }
-        else if (record.phase == ROCPROFILER_CALLBACK_PHASE_UNLOAD && data) {
-            // Don't remove kernel names in timeline mode - buffer callback needs them
-            if (!timeline_enabled) {
-                kernel_names.erase(data->kernel_id);
+            // Only the mangled name is stored; it is demangled on the kernel's
+            // first use, so symbols that never dispatch cost no demangling
+            uint32_t flags = kKernelSelected;
+            
+            // Name patterns are matched here once, never per dispatch. They apply
+            // to demangled names, so filtering demangles every symbol up front.
+            std::string_view demangled;
+            if (!name_filter.empty() || !counter_kernel_filter.empty()) {
+                demangled = kernel_symbols.demangled(data->kernel_name);
             }
+            if (!name_filter.empty() && !name_filter.matches(demangled)) {
+                flags = 0;
+            }
+            if (!counter_kernel_filter.empty() && counter_kernel_filter.matches(demangled)) {
+                flags |= kKernelCounted;
+            }
+            // Library kernels are extern "C" or keep their identifiers in the
+            // mangled form, so they are classified without demangling
+            if (!channel_libraries.empty()) {
+                int channel = rpv3::route_kernel(channel_libraries, data->kernel_name);
+                if (channel >= 0) {
+                    flags |= (uint32_t)(channel + 1) << kKernelChannelShift;
+                }
+            }
+            if (summary_enabled && rpv3::is_tensile_kernel(data->kernel_name)) {
+                tensile_solutions.insert(data->kernel_id, data->kernel_name);
+            }
+            kernel_symbols.insert(data->kernel_id, data->kernel_name, flags);
         }
+        // Symbols stay registered when their code object unloads: buffered
+        // records arrive later, and tool_fini names summary rows, reservoirs,
+        // histograms and counter estimates by kernel id. The registry keeps
+        // every entry alive anyway, so erasing would save nothing.
     }
 }
 
@@ -308,13 +932,8 @@ void timeline_buffer_callback(
         fprintf(stderr, "[Kernel Tracer] Warning: Dropped %lu records\n", drop_count);
     }
     
-    // CSV header output (once per process)
-    if (csv_enabled) {
-        static bool csv_header_printed = false;
-        if (!csv_header_printed) {
-            TRACE_PRINTF("KernelName,ThreadID,CorrelationID,KernelID,DispatchID,GridX,GridY,GridZ,WorkgroupX,WorkgroupY,WorkgroupZ,PrivateSeg,GroupSeg,StartTimestamp,EndTimestamp,DurationNs,DurationUs,TimeSinceStartMs\n");
-            csv_header_printed = true;
-        }
+    if (csv_enabled && !summary_enabled) {
+        write_csv_header();
     }
     
     // Process batch of records
@@ -329,124 +948,70 @@ void timeline_buffer_callback(
             
             uint64_t count = kernel_count.fetch_add(1) + 1;
             
-            // Extract timestamps (guaranteed non-zero in buffer mode)
-            uint64_t start_ns = record->start_timestamp;
-            uint64_t end_ns = record->end_timestamp;
-            uint64_t duration_ns = end_ns - start_ns;
-            double duration_us = duration_ns / 1000.0;
+            // Filtering and sampling are decided before any record is built; skipped
+            // dispatches are only counted unless their library log line must be consumed.
+            // A sampled-away dispatch is built only to tell whether it passes --filter.
+            bool passed = kernel_selected(record->dispatch_info.kernel_id);
+            bool recorded = passed && sampler.keep(count, record->start_timestamp);
+            const bool tally = passed && sampler.tallies();
+            if (!recorded && library_channels.empty() && (!tally || dispatch_filter.empty())) {
+                if (tally) {
+                    sampler.tally(false);
+                }
+                if (counters_joined) {
+                    counter_join.discard(record->dispatch_info.dispatch_id);
+                }
+                continue;
+            }
             
-            // Calculate time since tracer started
-            double time_since_start_ms = (start_ns - tracer_start_timestamp) / 1000000.0;
+            // Timestamps are guaranteed non-zero in buffer mode
+            rpv3::DispatchRecord dispatch = make_dispatch_record(
+                record->dispatch_info, record->thread_id, record->correlation_id.internal,
+                record->start_timestamp, record->end_timestamp);
             
             // Look up kernel name
-            std::string kernel_name = "<unknown>";
-            auto it = kernel_names.find(record->dispatch_info.kernel_id);
-            if (it != kernel_names.end()) {
-                kernel_name = it->second;
+            const rpv3::KernelSymbol* symbol = kernel_symbols.find(record->dispatch_info.kernel_id);
+            
+            if (passed && !dispatch_filter.empty() && !dispatch_filter.matches(dispatch)) {
+                passed = false;
+                recorded = false;
+            }
+            if (tally && passed) {
+                sampler.tally(recorded);
             }
             
-            if (csv_enabled) {
-                TRACE_PRINTF("\"%s\",%lu,%lu,%lu,%lu,%u,%u,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu,%.3f,%.3f\n",
-                       kernel_name.c_str(),
-                       (unsigned long)record->thread_id,
-                       (unsigned long)record->correlation_id.internal,
-                       (unsigned long)record->dispatch_info.kernel_id,
-                       (unsigned long)record->dispatch_info.dispatch_id,
-                       record->dispatch_info.grid_size.x, record->dispatch_info.grid_size.y, record->dispatch_info.grid_size.z,
-                       record->dispatch_info.workgroup_size.x, record->dispatch_info.workgroup_size.y, record->dispatch_info.workgroup_size.z,
-                       record->dispatch_info.private_segment_size,
-                       record->dispatch_info.group_segment_size,
-                       (unsigned long)start_ns,
-                       (unsigned long)end_ns,
-                       (unsigned long)(end_ns - start_ns),
-                       duration_us,
-                       time_since_start_ms);
-            } else {
-                // Human-readable output
-                TRACE_PRINTF("\n[Kernel Trace #%lu]\n", (unsigned long)count);
-                TRACE_PRINTF("  Kernel Name: %s\n", kernel_name.c_str());
-                TRACE_PRINTF("  Thread ID: %lu\n", (unsigned long)record->thread_id);
-                TRACE_PRINTF("  Correlation ID: %lu\n", (unsigned long)record->correlation_id.internal);
-                TRACE_PRINTF("  Kernel ID: %lu\n", (unsigned long)record->dispatch_info.kernel_id);
-                TRACE_PRINTF("  Dispatch ID: %lu\n", (unsigned long)record->dispatch_info.dispatch_id);
-                TRACE_PRINTF("  Grid Size: [%u, %u, %u]\n", 
-                       record->dispatch_info.grid_size.x,
-                       record->dispatch_info.grid_size.y,
-                       record->dispatch_info.grid_size.z);
-                TRACE_PRINTF("  Workgroup Size: [%u, %u, %u]\n",
-                       record->dispatch_info.workgroup_size.x,
-                       record->dispatch_info.workgroup_size.y,
-                       record->dispatch_info.workgroup_size.z);
-                TRACE_PRINTF("  Private Segment Size: %u bytes (scratch memory per work-item)\n",
-                       record->dispatch_info.private_segment_size);
-                TRACE_PRINTF("  Group Segment Size: %u bytes (LDS memory per work-group)\n",
-                       record->dispatch_info.group_segment_size);
-                
-                // Timeline information (only in buffer mode)
-                TRACE_PRINTF("  Start Timestamp: %lu ns\n", (unsigned long)start_ns);
-                TRACE_PRINTF("  End Timestamp: %lu ns\n", (unsigned long)end_ns);
-                TRACE_PRINTF("  Duration: %.3f μs\n", duration_us);
-                TRACE_PRINTF("  Time Since Start: %.3f ms\n", time_since_start_ms);
+            // Library kernels wait for their log line; everything else is written now
+            LibraryChannel* channel = kernel_channel(symbol);
+            const bool deferred = channel != nullptr;
+            if (counters_joined && recorded && !deferred && !sampler.buffered()) {
+                // Written with the counter row, now or when it arrives
+                join_dispatch({dispatch, count, {}, {}});
+                continue;
             }
-
-            // Read from RocBLAS log if available and kernel matches pattern
-            // In timeline mode, we only support reading from files, not pipes
-            if (rocblas_pipe_fd != -1 && is_tensile_kernel(kernel_name)) {
-                char line_buffer[4096];
-                int line_pos = 0;
-                bool valid_line_found = false;
-                
-                // Read char-by-char to handle filtering and stop after one valid line
-                while (!valid_line_found) {
-                    char c;
-                    ssize_t bytes_read = read(rocblas_pipe_fd, &c, 1);
-                    
-                    if (bytes_read > 0) {
-                        // Write to log file if enabled (raw stream)
-                        if (rocblas_log_file) {
-                            fputc(c, rocblas_log_file);
-                        }
-                        
-                        if (c == '\n') {
-                            line_buffer[line_pos] = '\0';
-                            
-                            // Clean up carriage return if present
-                            if (line_pos > 0 && line_buffer[line_pos-1] == '\r') {
-                                line_buffer[line_pos-1] = '\0';
-                            }
-                            
-                            // Check filters
-                            if (strstr(line_buffer, "rocblas_create_handle") != nullptr || 
-                                strstr(line_buffer, "rocblas_destroy_handle") != nullptr ||
-                                strstr(line_buffer, "rocblas_set_stream") != nullptr) {
-                                // Skip this line, reset buffer and continue reading
-                                line_pos = 0;
-                            } else {
-                                // Valid line found
-                                if (strlen(line_buffer) > 0) {
-                                    TRACE_PRINTF("# %s\n", line_buffer);
-                                    valid_line_found = true; // Stop reading
-                                } else {
-                                    // Empty line, just reset
-                                    line_pos = 0;
-                                }
-                            }
-                        } else {
-                            if (line_pos < (int)sizeof(line_buffer) - 1) {
-                                line_buffer[line_pos++] = c;
-                            }
-                            // Else: line too long, truncate
-                        }
-                    } else {
-                        // EOF or error
-                        break;
-                    }
-                }
-                
-                if (rocblas_log_file) {
-                    fflush(rocblas_log_file);
+            if (counters_joined) {
+                // Library records are handed over with their log line (none
+                // are written in summary mode), reservoir samples at exit
+                if (recorded && !(deferred && summary_enabled)) {
+                    counter_join.defer(dispatch.dispatch_id);
+                } else {
+                    counter_join.discard(dispatch.dispatch_id);
                 }
             }
+            rpv3::RecordBuffer& out = record_buffer();
+            if (recorded && sampler.buffered()) {
+                sampler.offer(count, dispatch);
+                recorded = false;  // Written at exit, without rocBLAS annotations
+            } else if (recorded && counters_joined) {
+                format_joined_record(out, dispatch, count, symbol, deferred);
+            } else if (recorded) {
+                format_dispatch(out, dispatch, count, symbol, deferred);
+            }
+
+            if (deferred) {
+                defer_to_library(*channel, dispatch, recorded, out);
+            } else if (out.size() > 0) {
+                trace_write(out);
+            }
         }
     }
 }
@@ -456,213 +1021,244 @@ void timeline_buffer_callback(
 void kernel_dispatch_callback(rocprofiler_callback_tracing_record_t record,
                               rocprofiler_user_data_t* user_data,
                               void* callback_data) {
-    (void) user_data;
     (void) callback_data;
     
-    // CSV header output (once per process)
-    if (csv_enabled) {
-        static bool csv_header_printed = false;
-        if (!csv_header_printed) {
-            TRACE_PRINTF("KernelName,ThreadID,CorrelationID,KernelID,DispatchID,GridX,GridY,GridZ,WorkgroupX,WorkgroupY,WorkgroupZ,PrivateSeg,GroupSeg,StartTimestamp,EndTimestamp,DurationNs,DurationUs,TimeSinceStartMs\n");
-            csv_header_printed = true;
-        }
+    if (csv_enabled && !summary_enabled) {
+        write_csv_header();
     }
     
-    // Only process kernel dispatch events on entry
-    if (record.kind == ROCPROFILER_CALLBACK_TRACING_KERNEL_DISPATCH &&
-        record.phase == ROCPROFILER_CALLBACK_PHASE_ENTER) {
-        
-        // In CSV mode, suppress ENTER phase output
-        if (csv_enabled) {
+    if (record.kind != ROCPROFILER_CALLBACK_TRACING_KERNEL_DISPATCH) {
+        return;
+    }
+    
+    // Cast payload to kernel dispatch data
+    auto* dispatch_data = static_cast<rocprofiler_callback_tracing_kernel_dispatch_data_t*>(record.payload);
+    
+    if (record.phase == ROCPROFILER_CALLBACK_PHASE_ENTER) {
+        // CSV, binary, summary and text records are written complete on EXIT
+        if (csv_enabled || binary_enabled || summary_enabled) {
             return;
         }
         
         uint64_t count = kernel_count.fetch_add(1) + 1;
         
-        // Cast payload to kernel dispatch data
-        auto* dispatch_data = static_cast<rocprofiler_callback_tracing_kernel_dispatch_data_t*>(record.payload);
+        bool selected = !dispatch_data || launch_selected(dispatch_data->dispatch_info);
         
-        if (!dispatch_data) {
-            TRACE_PRINTF("[Kernel Trace #%lu] <no dispatch data>\n", (unsigned long)count);
-            return;
+        uint64_t now = 0;
+        if (selected && sampler.needs_timestamp()) {
+            rocprofiler_get_timestamp(&now);
         }
         
-        const auto& info = dispatch_data->dispatch_info;
+        // Carry the trace number to the EXIT phase of this dispatch (0 = filtered,
+        // flagged kSampledAway when not sampled)
+        if (!selected) {
+            user_data->value = 0;
+            return;
+        }
+        if (!sampler.keep(count, now)) {
+            user_data->value = count | kSampledAway;
+            return;
+        }
+        user_data->value = count;
         
-        // Look up kernel name
-        std::string kernel_name = "<unknown>";
-        auto it = kernel_names.find(info.kernel_id);
-        if (it != kernel_names.end()) {
-            kernel_name = it->second;
+        if (!dispatch_data) {
+            rpv3::RecordBuffer& out = record_buffer();
+            out.append("[Kernel Trace #").append_u64(count).append("] <no dispatch data>\n");
+            trace_write(out);
+            return;
         }
         
-        // Backtrace mode: print kernel info and call stack
+        // Backtrace mode: the call stack only exists on the dispatching thread at ENTER
         if (backtrace_enabled) {
-            TRACE_PRINTF("\n[Kernel Trace #%lu]\n", (unsigned long)count);
-            TRACE_PRINTF("  Kernel Name: %s\n", kernel_name.c_str());
-            TRACE_PRINTF("  Dispatch ID: %lu\n", (unsigned long)info.dispatch_id);
-            TRACE_PRINTF("  Grid Size: [%u, %u, %u]\n", 
-                   info.grid_size.x, info.grid_size.y, info.grid_size.z);
-            
-            // Print the backtrace
-            print_backtrace();
+            const auto& info = dispatch_data->dispatch_info;
+            std::string_view kernel_name = kernel_symbols.name(info.kernel_id);
             
-            TRACE_PRINTF("----------------------------------------\n");
-            return;
+            rpv3::DispatchRecord dispatch = make_dispatch_record(
+                info, record.thread_id, record.correlation_id.internal, 0, 0);
+            rpv3::RecordBuffer& out = record_buffer();
+            rpv3::format_backtrace_header(out, count, kernel_name, dispatch);
+            append_backtrace(out);
+            out.append("----------------------------------------\n");
+            trace_write(out);
         }
-        
-        // Normal mode: print full kernel details
-        TRACE_PRINTF("\n[Kernel Trace #%lu]\n", (unsigned long)count);
-        TRACE_PRINTF("  Kernel Name: %s\n", kernel_name.c_str());
-        TRACE_PRINTF("  Thread ID: %lu\n", (unsigned long)record.thread_id);
-        TRACE_PRINTF("  Correlation ID: %lu\n", (unsigned long)record.correlation_id.internal);
-        TRACE_PRINTF("  Kernel ID: %lu\n", (unsigned long)info.kernel_id);
-        TRACE_PRINTF("  Dispatch ID: %lu\n", (unsigned long)info.dispatch_id);
-        TRACE_PRINTF("  Grid Size: [%u, %u, %u]\n", 
-               info.grid_size.x, info.grid_size.y, info.grid_size.z);
-        TRACE_PRINTF("  Workgroup Size: [%u, %u, %u]\n",
-               info.workgroup_size.x, info.workgroup_size.y, info.workgroup_size.z);
-        TRACE_PRINTF("  Private Segment Size: %u bytes (scratch memory per work-item)\n",
-               info.private_segment_size);
-        TRACE_PRINTF("  Group Segment Size: %u bytes (LDS memory per work-group)\n",
-               info.group_segment_size);
-    }
-    else if (record.kind == ROCPROFILER_CALLBACK_TRACING_KERNEL_DISPATCH &&
-             record.phase == ROCPROFILER_CALLBACK_PHASE_EXIT) {
-        
-        // Cast payload to kernel dispatch data
-        auto* dispatch_data = static_cast<rocprofiler_callback_tracing_kernel_dispatch_data_t*>(record.payload);
+    }
+    else if (record.phase == ROCPROFILER_CALLBACK_PHASE_EXIT) {
         
         if (!dispatch_data) {
             return;
         }
         
-        // Common data retrieval
-        const auto& info = dispatch_data->dispatch_info;
-        std::string kernel_name = "<unknown>";
-        auto it = kernel_names.find(info.kernel_id);
-        if (it != kernel_names.end()) {
-            kernel_name = it->second;
+        // Text modes numbered and sampled the dispatch at ENTER
+        uint64_t sequence;
+        bool passed;
+        bool recorded;
+        if (csv_enabled || binary_enabled || summary_enabled) {
+            sequence = kernel_count.fetch_add(1) + 1;
+            passed = launch_selected(dispatch_data->dispatch_info);
+            recorded = passed && sampler.keep(sequence, dispatch_data->start_timestamp);
         } else {
-            // Only print debug if not in CSV mode to avoid breaking CSV format? 
-            // Or print to stderr?
-            // STATUS_PRINTF("[Kernel Tracer] Debug: Kernel name lookup failed for ID %lu\n", (unsigned long)info.kernel_id);
+            sequence = user_data->value & ~kSampledAway;
+            passed = (user_data->value != 0);
+            recorded = passed && (user_data->value & kSampledAway) == 0;
+        }
+        // Duration predicates are checked here; backtrace records only honour
+        // launch predicates
+        const bool filtered = !dispatch_filter.empty() && !backtrace_enabled;
+        const bool tally = passed && sampler.tallies();
+        if (!recorded && library_channels.empty() && (!tally || !filtered)) {
+            if (tally) {
+                sampler.tally(false);
+            }
+            return;
         }
+        
+        // Common data retrieval
+        const auto& info = dispatch_data->dispatch_info;
+        const rpv3::KernelSymbol* symbol = kernel_symbols.find(info.kernel_id);
+        
+        rpv3::DispatchRecord dispatch = make_dispatch_record(
+            info, record.thread_id, record.correlation_id.internal,
+            dispatch_data->start_timestamp, dispatch_data->end_timestamp);
 
-        if (csv_enabled) {
-            // CSV mode: output complete line on EXIT
-            uint64_t count = kernel_count.fetch_add(1) + 1;
-            (void)count;  // Suppress unused variable warning
-            
-            uint64_t start_ns = dispatch_data->start_timestamp;
-            uint64_t end_ns = dispatch_data->end_timestamp;
-            uint64_t duration_ns = (end_ns > start_ns) ? (end_ns - start_ns) : 0;
-            double duration_us = duration_ns / 1000.0;
-            double time_since_start_ms = (start_ns > tracer_start_timestamp) ? 
-                                         ((start_ns - tracer_start_timestamp) / 1000000.0) : 0.0;
-            
-            TRACE_PRINTF("\"%s\",%lu,%lu,%lu,%lu,%u,%u,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu,%.3f,%.3f\n",
-                   kernel_name.c_str(),
-                   (unsigned long)record.thread_id,
-                   (unsigned long)record.correlation_id.internal,
-                   (unsigned long)info.kernel_id,
-                   (unsigned long)info.dispatch_id,
-                   info.grid_size.x,
-                   info.grid_size.y,
-                   info.grid_size.z,
-                   info.workgroup_size.x,
-                   info.workgroup_size.y,
-                   info.workgroup_size.z,
-                   info.private_segment_size,
-                   info.group_segment_size,
-                   (unsigned long)start_ns,
-                   (unsigned long)end_ns,
-                   (unsigned long)duration_ns,
-                   duration_us,
-                   time_since_start_ms);
-        } else {
-            // Standard mode: display timestamps on exit
+        // Duration predicates need the completion timestamp. Backtrace records
+        // were already written at ENTER, so they only honour launch predicates.
+        if (passed && filtered && !dispatch_filter.matches(dispatch)) {
+            passed = false;
+            recorded = false;
+        }
+        if (tally && passed) {
+            sampler.tally(recorded);
+        }
+        
+        LibraryChannel* channel = kernel_channel(symbol);
+        const bool deferred = channel != nullptr;
+        rpv3::RecordBuffer& out = record_buffer();
+        if (recorded && sampler.buffered()) {
+            // Reservoir sampling: kept records are written at exit
+            sampler.offer(sequence, dispatch);
+            recorded = false;
+        } else if (recorded && backtrace_enabled) {
+            // Kernel details and call stack were written at ENTER
+            record_latency(dispatch);
             if (dispatch_data->end_timestamp > 0) {
-                uint64_t duration_ns = dispatch_data->end_timestamp - dispatch_data->start_timestamp;
-                double duration_us = duration_ns / 1000.0;
-                
-                TRACE_PRINTF("  Start Timestamp: %lu ns\n", (unsigned long)dispatch_data->start_timestamp);
-                TRACE_PRINTF("  End Timestamp: %lu ns\n", (unsigned long)dispatch_data->end_timestamp);
-                TRACE_PRINTF("  Duration: %.3f μs\n", duration_us);
+                rpv3::format_text_timestamps(out, dispatch);
             }
+        } else if (recorded) {
+            // Complete record (CSV line, binary record, statistics or text block) on EXIT
+            format_dispatch(out, dispatch, sequence, symbol, deferred);
         }
         
-        // Read from RocBLAS pipe if available and kernel matches pattern
-        // This is now outside the if/else block so it runs for both CSV and Standard modes
-        if (rocblas_pipe_fd != -1 && is_tensile_kernel(kernel_name)) {
-            // Use poll to wait for data with timeout (robust against timing issues)
-            struct pollfd pfd;
-            pfd.fd = rocblas_pipe_fd;
-            pfd.events = POLLIN;
-            
-            // Wait up to 500ms for data
-            int ret = poll(&pfd, 1, 500);
-            
-            if (ret > 0 && (pfd.revents & POLLIN)) {
-                char line_buffer[4096];
-                int line_pos = 0;
-                bool valid_line_found = false;
-                
-                // Read char-by-char to handle pipe correctly and stop after one valid line
-                while (!valid_line_found) {
-                    char c;
-                    ssize_t bytes_read = read(rocblas_pipe_fd, &c, 1);
-                    
-                    if (bytes_read > 0) {
-                        // Write to log file if enabled (raw stream)
-                        if (rocblas_log_file) {
-                            fputc(c, rocblas_log_file);
-                        }
-                        
-                        if (c == '\n') {
-                            line_buffer[line_pos] = '\0';
-                            
-                            // Clean up carriage return if present
-                            if (line_pos > 0 && line_buffer[line_pos-1] == '\r') {
-                                line_buffer[line_pos-1] = '\0';
-                            }
-                            
-                            // Check filters
-                            if (strstr(line_buffer, "rocblas_create_handle") != nullptr || 
-                                strstr(line_buffer, "rocblas_destroy_handle") != nullptr ||
-                                strstr(line_buffer, "rocblas_set_stream") != nullptr) {
-                                // Skip this line, reset buffer and continue reading
-                                line_pos = 0;
-                            } else {
-                                // Valid line found
-                                if (strlen(line_buffer) > 0) {
-                                    TRACE_PRINTF("# %s\n", line_buffer);
-                                    valid_line_found = true; // Stop reading
-                                } else {
-                                    // Empty line, just reset
-                                    line_pos = 0;
-                                }
-                            }
-                        } else {
-                            if (line_pos < (int)sizeof(line_buffer) - 1) {
-                                line_buffer[line_pos++] = c;
-                            }
-                            // Else: line too long, truncate (ignore extra chars until newline)
-                        }
-                    } else {
-                        // EAGAIN or error or EOF
-                        break;
-                    }
-                }
-                
-                if (rocblas_log_file) {
-                    fflush(rocblas_log_file);
-                }
-            }
+        // Library kernels are handed to their channel's correlator, which writes
+        // the record once its log line is in; the callback never waits for the pipe
+        if (deferred) {
+            defer_to_library(*channel, dispatch, recorded, out);
+        } else if (out.size() > 0) {
+            trace_write(out);
         }
     }
 }
 
+// Open a library's log and set up its channel. A path that is not a regular
+// file must be where the library writes (one of its log_env variables);
+// otherwise the option is cleared, as nothing would ever arrive.
+void open_library_log(const rpv3::LibraryLog& library, char*& path) {
+    struct stat st;
+    bool is_reg_file = false;
+    bool is_fifo = false;
+    if (stat(path, &st) == 0) {
+        if (S_ISREG(st.st_mode)) is_reg_file = true;
+        if (S_ISFIFO(st.st_mode)) is_fifo = true;
+    }
+
+    // Libraries that only log to stderr (MIOpen) are fed by a redirect
+    const char* const* env = library.log_env();
+    if (!is_reg_file && *env) {
+        std::string names;
+        bool set = false;
+        bool matched = false;
+        for (const char* const* name = env; *name; name++) {
+            names += (names.empty() ? "" : "/");
+            names += *name;
+            const char* value = getenv(*name);
+            set = set || value;
+            matched = matched || (value && strcmp(path, value) == 0);
+        }
+        if (!set) {
+            fprintf(stderr, "[Kernel Tracer] Warning: --%s specified '%s' but %s is not set.\n",
+                    library.id(), path, names.c_str());
+            fprintf(stderr, "[Kernel Tracer] %s will not write to the pipe. Logging disabled.\n", library.name());
+            path = nullptr;
+            return;
+        }
+        if (!matched) {
+            fprintf(stderr, "[Kernel Tracer] Error: --%s '%s' does not match %s.\n", library.id(), path, names.c_str());
+            fprintf(stderr, "[Kernel Tracer] Logging disabled to prevent mismatch.\n");
+            path = nullptr;
+            return;
+        }
+    }
+
+    if (!is_fifo && !is_reg_file) {
+        STATUS_PRINTF("[Kernel Tracer] Pipe '%s' is not a FIFO or not found.\n", path);
+        return;
+    }
+    // The reader thread drains a FIFO continuously, so pipes also work with
+    // --timeline, where dispatches arrive in late batches
+    STATUS_PRINTF("[Kernel Tracer] Detected %s log file/pipe: %s\n", library.name(), path);
+    int fd = open(path, O_RDONLY | O_NONBLOCK);
+    if (fd == -1) {
+        fprintf(stderr, "[Kernel Tracer] Failed to open %s log pipe: %s\n", library.name(), strerror(errno));
+        return;
+    }
+    STATUS_PRINTF("[Kernel Tracer] Successfully opened %s log pipe\n", library.name());
+
+    auto channel = std::make_unique<LibraryChannel>();
+    LibraryChannel* raw = channel.get();
+    channel->library = &library;
+    channel->fd = fd;
+    channel->correlator = std::make_unique<rpv3::LogCorrelator>(
+        library.pairing() == rpv3::LogPairing::Span ? kSpanWindowNs : rpv3::LogCorrelator::kDefaultWindowNs,
+        library.pairing());
+    channel->sink = [raw](const rpv3::PendingDispatch& dispatch, const rpv3::LogLine* line) {
+        write_correlated(*raw, dispatch, line);
+    };
+    if (&library == &rpv3::rocblas_log()) {
+        rocblas_channel = raw;
+    }
+    library_channels.push_back(std::move(channel));
+    channel_libraries.push_back(&library);
+}
+
+// Peaks for the BLAS efficiency table: --peak-tflops/--peak-gbps, otherwise
+// the first GPU agent, whose peak is estimated per datatype
+rpv3::BlasPeak query_blas_peak() {
+    rpv3::BlasPeak peak;
+    peak.tflops = rpv3_peak_tflops;
+    peak.gbps = rpv3_peak_gbps;
+    if (peak.tflops > 0.0) {
+        return peak;
+    }
+    rocprofiler_query_available_agents(
+        ROCPROFILER_AGENT_INFO_VERSION_0,
+        [](rocprofiler_agent_version_t version, const void** agents, size_t num_agents, void* data) {
+            (void) version;
+            auto* found = static_cast<rpv3::BlasPeak*>(data);
+            for (size_t i = 0; i < num_agents && found->target.empty(); i++) {
+                const auto* info = static_cast<const rocprofiler_agent_v0_t*>(agents[i]);
+                if (info->type == ROCPROFILER_AGENT_TYPE_GPU && info->cu_count > 0 && info->name) {
+                    found->target = info->name;
+                    found->cu_count = info->cu_count;
+                    found->clock_mhz = info->max_engine_clk_fcompute;
+                }
+            }
+            return ROCPROFILER_STATUS_SUCCESS;
+        },
+        sizeof(rocprofiler_agent_v0_t),
+        &peak
+    );
+    return peak;
+}
+
 // Setup buffer tracing (for timeline mode)
 int setup_buffer_tracing() {
     STATUS_PRINTF("[Kernel Tracer] Setting up buffer tracing for timeline mode...\n");
@@ -751,7 +1347,7 @@ int setup_callback_tracing() {
     return 0;
 }
 
-// Get target counters for the selected mode
+// Get target counters for a --counter group
 std::vector<std::string> get_target_counters(rpv3_counter_mode_t mode) {
     std::vector<std::string> counters;
     
@@ -772,58 +1368,67 @@ std::vector<std::string> get_target_counters(rpv3_counter_mode_t mode) {
     return counters;
 }
 
-// Create a profile for a specific agent
-void create_profile_for_agent(rocprofiler_agent_id_t agent_id) {
-    // 1. Get all supported counters for this agent
-    std::map<std::string, rocprofiler_counter_id_t> supported_counters;
-    
-    STATUS_PRINTF("[Kernel Tracer] Debug: Querying counters for agent handle %lu\n", agent_id.handle);
-    
+// Counter catalog key of an agent: its kind and the rocprofiler release
+std::string agent_catalog_key(const rocprofiler_agent_v0_t& agent) {
+    uint32_t major = 0, minor = 0, patch = 0;
+    rocprofiler_get_version(&major, &minor, &patch);
+    char version[48];
+    snprintf(version, sizeof(version), "%u.%u.%u", major, minor, patch);
+    return rpv3::counter_catalog_key(agent.product_name ? agent.product_name : "",
+                                     agent.name ? agent.name : "", version);
+}
+
+// Every counter an agent supports, straight from rocprofiler: one info
+// query per counter. Only on a counter catalog miss.
+std::vector<rpv3::CatalogCounter> query_agent_counters(rocprofiler_agent_id_t agent_id, bool& failed) {
+    std::vector<rpv3::CatalogCounter> supported;
     rocprofiler_status_t status = rocprofiler_iterate_agent_supported_counters(
         agent_id,
         [](rocprofiler_agent_id_t agent, rocprofiler_counter_id_t* counters, size_t num_counters, void* user_data) {
             (void) agent;
-            auto* available_counters = static_cast<std::map<std::string, rocprofiler_counter_id_t>*>(user_data);
-            
-            STATUS_PRINTF("[Kernel Tracer] Debug: Callback received %zu counters\n", num_counters);
-            
+            auto* supported = static_cast<std::vector<rpv3::CatalogCounter>*>(user_data);
             for (size_t i = 0; i < num_counters; i++) {
                 rocprofiler_counter_info_v0_t info;
-                rocprofiler_status_t status = rocprofiler_query_counter_info(
-                    counters[i],
-                    ROCPROFILER_COUNTER_INFO_VERSION_0,
-                    &info
-                );
-                
-                if (status == ROCPROFILER_STATUS_SUCCESS && info.name) {
-                    (*available_counters)[std::string(info.name)] = counters[i];
-                    // Print first few counters for debug
-                    if (i < 5) STATUS_PRINTF("[Kernel Tracer] Debug: Found counter %s\n", info.name);
-                } else {
-                    STATUS_PRINTF("[Kernel Tracer] Debug: Failed to query info for counter %zu (status: %d)\n", i, status);
+                if (rocprofiler_query_counter_info(counters[i], ROCPROFILER_COUNTER_INFO_VERSION_0, &info) ==
+                        ROCPROFILER_STATUS_SUCCESS && info.name) {
+                    supported->push_back(rpv3::CatalogCounter{info.name, counters[i].handle});
                 }
             }
             return ROCPROFILER_STATUS_SUCCESS;
         },
-        &supported_counters
+        &supported
     );
     
     if (status != ROCPROFILER_STATUS_SUCCESS) {
-        STATUS_PRINTF("[Kernel Tracer] Debug: rocprofiler_iterate_agent_supported_counters failed with status %d\n", status);
+        fprintf(stderr, "[Kernel Tracer] Warning: Could not list the counters of agent %lu (status %d)\n",
+                agent_id.handle, status);
+        failed = true;
     }
+    return supported;
+}
+
+// Create the profiles of one agent. Returns false, with nothing created,
+// when the cached catalog turns out not to match the agent.
+bool build_agent_profiles(rocprofiler_agent_id_t agent_id, const std::string& key, bool& query_failed) {
+    // 1. Counter names to ids: cached per kind of agent, queried on a miss
+    bool queried = false;
+    const std::vector<rpv3::CatalogCounter>& supported = counter_catalog.counters(
+        key, [&]() { return query_agent_counters(agent_id, query_failed); }, &queried);
+    const bool cached = counter_catalog.loaded(key);
     
     // 2. Select counters that match our target list
-    std::vector<std::string> target_names = get_target_counters(counter_mode);
+    const std::vector<std::string>& target_names = counter_metrics.counters();
     std::vector<rocprofiler_counter_id_t> selected_counters;
+    std::vector<std::string> selected_names;
     
-    STATUS_PRINTF("[Kernel Tracer] Creating profile for agent. Targets: %zu, Supported: %zu\n", 
-           target_names.size(), supported_counters.size());
+    STATUS_PRINTF("[Kernel Tracer] Creating profile for agent %s. Targets: %zu, Supported: %zu (%s)\n",
+                  key.c_str(), target_names.size(), supported.size(), queried ? "queried" : "cached");
            
     for (const auto& name : target_names) {
-        auto it = supported_counters.find(name);
-        if (it != supported_counters.end()) {
-            selected_counters.push_back(it->second);
-            STATUS_PRINTF("  + Added counter: %s\n", name.c_str());
+        rocprofiler_counter_id_t id = {};
+        if (counter_catalog.find(key, name, id.handle)) {
+            selected_counters.push_back(id);
+            selected_names.push_back(name);
         } else {
             STATUS_PRINTF("  - Counter not found: %s\n", name.c_str());
         }
@@ -831,23 +1436,86 @@ void create_profile_for_agent(rocprofiler_agent_id_t agent_id) {
     
     if (selected_counters.empty()) {
         STATUS_PRINTF("[Kernel Tracer] Warning: No matching counters found for this agent\n");
-        return;
+        return true;
     }
     
-    // 3. Create the profile
-    rocprofiler_profile_config_id_t profile_id = {};
-    status = rocprofiler_create_profile_config(
-        agent_id,
-        selected_counters.data(),
-        selected_counters.size(),
-        &profile_id
-    );
-    
-    if (status == ROCPROFILER_STATUS_SUCCESS) {
-        agent_profiles[agent_id] = profile_id;
-        STATUS_PRINTF("[Kernel Tracer] Profile created successfully with %zu counters\n", selected_counters.size());
-    } else {
-        fprintf(stderr, "[Kernel Tracer] Failed to create profile config: %d\n", status);
+    // 3. Plan the profiles. Counters that cannot be counted together are
+    // split into passes, counted on alternate dispatches of each kernel.
+    // Plans are cached with the catalog; a new one is tried out first.
+    auto create_profile = [&](const std::vector<size_t>& pass, rocprofiler_profile_config_id_t* profile_id) {
+        std::vector<rocprofiler_counter_id_t> ids;
+        for (size_t i : pass) {
+            ids.push_back(selected_counters[i]);
+        }
+        return rocprofiler_create_profile_config(agent_id, ids.data(), ids.size(), profile_id);
+    };
+    bool planned = false;
+    const rpv3::CounterPlan& plan = counter_catalog.plan(
+        key, selected_names,
+        [&](const std::vector<size_t>& pass) {
+            rocprofiler_profile_config_id_t trial = {};
+            if (create_profile(pass, &trial) != ROCPROFILER_STATUS_SUCCESS) {
+                return false;
+            }
+            rocprofiler_destroy_profile_config(trial);
+            return true;
+        },
+        &planned);
+    if (cached && planned && !plan.rejected.empty()) {
+        // Maybe a cached id the agent no longer knows
+        return false;
+    }
+
+    // 4. Create them
+    std::vector<rocprofiler_profile_config_id_t> profiles;
+    std::vector<size_t> created;
+    for (size_t p = 0; p < plan.passes.size(); p++) {
+        rocprofiler_profile_config_id_t profile_id = {};
+        rocprofiler_status_t status = create_profile(plan.passes[p], &profile_id);
+        if (status != ROCPROFILER_STATUS_SUCCESS) {
+            if (cached) {
+                for (rocprofiler_profile_config_id_t profile : profiles) {
+                    rocprofiler_destroy_profile_config(profile);
+                }
+                return false;
+            }
+            fprintf(stderr, "[Kernel Tracer] Failed to create profile config: %d\n", status);
+            continue;
+        }
+        profiles.push_back(profile_id);
+        created.push_back(p);
+        STATUS_PRINTF("[Kernel Tracer] Profile created successfully with %zu counters (pass %zu of %zu)\n",
+                      plan.passes[p].size(), p + 1, plan.passes.size());
+    }
+    for (size_t i : plan.rejected) {
+        fprintf(stderr, "[Kernel Tracer] Warning: Counter %s cannot be collected on this agent\n",
+                selected_names[i].c_str());
+    }
+    for (size_t p : created) {
+        for (size_t i : plan.passes[p]) {
+            counter_table.add_counter(selected_counters[i].handle, selected_names[i]);
+        }
+    }
+    if (profiles.size() > 1) {
+        counters_multiplexed = true;
+    }
+    if (!profiles.empty()) {
+        agent_profiles.push_back({agent_id.handle, std::move(profiles)});
+    }
+    return true;
+}
+
+// Create the profiles of an agent, querying again if its cached catalog is stale
+void create_profile_for_agent(rocprofiler_agent_id_t agent_id, const std::string& key) {
+    bool query_failed = false;
+    if (!build_agent_profiles(agent_id, key, query_failed)) {
+        STATUS_PRINTF("[Kernel Tracer] Cached counters of %s do not match the agent, querying again\n", key.c_str());
+        counter_catalog.forget(key);
+        build_agent_profiles(agent_id, key, query_failed);
+    }
+    if (query_failed) {
+        // An incomplete catalog is not kept
+        counter_catalog.forget(key);
     }
 }
 
@@ -861,10 +1529,61 @@ void dispatch_counting_callback(
     (void) user_data;
     (void) callback_data_args;
     
-    // Find the profile for this agent
-    auto it = agent_profiles.find(dispatch_data.dispatch_info.agent_id);
-    if (it != agent_profiles.end()) {
-        *config = it->second;
+    // Dispatches left without a profile run uncounted, at full speed
+    const rocprofiler_kernel_dispatch_info_t& info = dispatch_data.dispatch_info;
+    const AgentProfiles* profiles = find_agent_profiles(info.agent_id);
+    if (!profiles || !kernel_counted(info.kernel_id)) {
+        return;
+    }
+    uint32_t pass = 0;
+    if (counter_selector_enabled &&
+        !counter_selector.select(info.kernel_id, (uint32_t)profiles->passes.size(), pass)) {
+        return;
+    }
+
+    // Kernel, grid and agent are only known here, so they are kept until
+    // the dispatch's counter records arrive
+    *config = profiles->passes[pass];
+    if (counters_joined) {
+        counter_join.expect(info.dispatch_id);
+    }
+    counter_table.begin_dispatch(make_dispatch_record(info, 0, dispatch_data.correlation_id.internal, 0, 0),
+                                 info.agent_id.handle);
+}
+
+// Write one dispatch's columns (counters and metrics computed from them) in
+// the active output mode: a text line, a CSV row with a column each, or a
+// dispatch record followed by one counter record per computable column
+void emit_counter_row(const rpv3::CounterRow& row) {
+    // DurationNs is not measured while counting dispatches alone
+    const std::vector<double>& values = counter_columns(&row, NAN);
+    const rpv3::KernelSymbol* symbol = kernel_symbols.find(row.dispatch.kernel_id);
+    rpv3::RecordBuffer& out = record_buffer();
+    if (binary_enabled) {
+        binary_format_dispatch(out, row.dispatch, binary_name_id(row.dispatch.kernel_id, symbol));
+        binary_format_counters(out, row, values);
+    } else if (csv_enabled) {
+        rpv3::format_counter_csv_row(out, kernel_display_name(symbol), row, values);
+    } else {
+        rpv3::format_counter_text(out, kernel_display_name(symbol), row, counter_metrics.columns(), values);
+    }
+    trace_write(out);
+}
+
+// A dispatch's counter row is complete. Called from the counter buffer
+// callback only (and at exit, after the last flush).
+void counter_row_ready(rpv3::CounterRow& row) {
+    counter_rows++;
+    if (counters_multiplexed) {
+        counter_estimates.add(row);
+    }
+    if (!counters_joined) {
+        emit_counter_row(row);
+        return;
+    }
+    rpv3::TimedDispatch timed;
+    if (counter_join.add_row(row, timed) == rpv3::CounterJoin::Match::Joined) {
+        emit_joined(timed, &row);
     }
 }
 
@@ -892,73 +1611,83 @@ void counter_record_callback(
             header->kind == ROCPROFILER_COUNTER_RECORD_VALUE) {
             
             auto* record = static_cast<rocprofiler_counter_record_t*>(header->payload);
-            
-            // We can correlate with kernel info if we tracked correlation_id
-            // For now, just print the counter values
-            
-            // Note: To get the kernel name here, we would need to map correlation_id 
-            // to the kernel name stored in kernel_symbol_callback.
-            // Since this is asynchronous, we might print it separately.
-            
-            // However, the record contains dispatch_id which we can use if we tracked it.
-            // But let's keep it simple and just print the counter record.
-            
-            // Wait, rocprofiler_counter_record_t doesn't have the counter name directly.
-            // It has counter_id. We would need to look up the name.
-            // For simplicity in this step, we will just print the ID and value.
-            // A full implementation would map IDs back to names.
-            
-            // To make it useful, let's try to print the kernel ID at least.
-            // But the record structure is:
-            // struct rocprofiler_counter_record_t {
-            //   rocprofiler_dispatch_id_t dispatch_id;
-            //   rocprofiler_counter_id_t counter_id;
-            //   rocprofiler_counter_value_t value;
-            //   ...
-            // }
-            
-            // We'll just print: [Counters] Dispatch ID: X, Counter ID: Y, Value: Z
-            
-            // We'll just print: [Counters] Dispatch ID: X, Value: Z
-            
-            STATUS_PRINTF("[Counters] Dispatch ID: %lu, Value: %f\n",
-                   record->dispatch_id, record->counter_value);
+
+            // One record per counter instance; rows are complete once the
+            // next dispatch's records start
+            rocprofiler_counter_id_t counter_id = {};
+            if (rocprofiler_query_record_counter_id(record->id, &counter_id) != ROCPROFILER_STATUS_SUCCESS) {
+                continue;
+            }
+            rpv3::CounterRow row;
+            if (counter_table.add(record->dispatch_id, counter_id.handle, record->counter_value, row)) {
+                counter_row_ready(row);
+            }
         }
     }
 }
 
 // Setup counter collection
-int setup_counter_collection() {
-    STATUS_PRINTF("[Kernel Tracer] Setting up counter collection...\n");
-    
-    // IMPORTANT: Counter collection also needs code object callback for kernel symbols
-    // Configure callback tracing for code object/kernel symbol registration
+// Counters are unavailable: trace dispatches without them. With --timeline
+// the buffer already traces every dispatch; otherwise add the callback.
+int counter_fallback() {
+    if (timeline_enabled) {
+        STATUS_PRINTF("[Kernel Tracer] Continuing with timeline tracing only...\n");
+        return 0;
+    }
+    STATUS_PRINTF("[Kernel Tracer] Falling back to callback tracing mode...\n");
+    // Code object callback is already configured, just add kernel dispatches
     rocprofiler_status_t status = rocprofiler_configure_callback_tracing_service(
         client_ctx,
-        ROCPROFILER_CALLBACK_TRACING_CODE_OBJECT,
+        ROCPROFILER_CALLBACK_TRACING_KERNEL_DISPATCH,
         nullptr,
         0,
-        kernel_symbol_callback,
+        kernel_dispatch_callback,
         nullptr
     );
     
+    if (status != ROCPROFILER_STATUS_SUCCESS) {
+        fprintf(stderr, "[Kernel Tracer] Failed to configure kernel dispatch callback tracing\n");
+        return -1;
+    }
+    
+    return 0;
+}
+
+// Setup counter collection, alone or on the timeline's context
+int setup_counter_collection() {
+    STATUS_PRINTF("[Kernel Tracer] Setting up counter collection...\n");
+    
+    // IMPORTANT: Counter collection also needs code object callback for kernel symbols.
+    // setup_buffer_tracing has configured it already in timeline mode.
+    rocprofiler_status_t status = ROCPROFILER_STATUS_SUCCESS;
+    if (!timeline_enabled) {
+        status = rocprofiler_configure_callback_tracing_service(
+            client_ctx,
+            ROCPROFILER_CALLBACK_TRACING_CODE_OBJECT,
+            nullptr,
+            0,
+            kernel_symbol_callback,
+            nullptr
+        );
+    }
+    
     if (status != ROCPROFILER_STATUS_SUCCESS) {
         fprintf(stderr, "[Kernel Tracer] Failed to configure code object callback tracing\n");
         return -1;
     }
     
-    // 1. Query available agents
-    std::vector<rocprofiler_agent_id_t> agents;
+    // 1. Query available agents, with the key of each one's catalog entry
+    std::vector<std::pair<rocprofiler_agent_id_t, std::string>> agents;
     rocprofiler_query_available_agents(
         ROCPROFILER_AGENT_INFO_VERSION_0,
         [](rocprofiler_agent_version_t version, const void** agents, size_t num_agents, void* data) {
             (void) version;
-            auto* agents_vec = static_cast<std::vector<rocprofiler_agent_id_t>*>(data);
+            auto* agents_vec = static_cast<std::vector<std::pair<rocprofiler_agent_id_t, std::string>>*>(data);
             
             for (size_t i = 0; i < num_agents; i++) {
                 const auto* info = static_cast<const rocprofiler_agent_v0_t*>(agents[i]);
                 if (info->type == ROCPROFILER_AGENT_TYPE_GPU) {
-                    agents_vec->push_back(info->id);
+                    agents_vec->emplace_back(info->id, agent_catalog_key(*info));
                 }
             }
             return ROCPROFILER_STATUS_SUCCESS;
@@ -972,37 +1701,41 @@ int setup_counter_collection() {
         return 0;
     }
     
-    // 2. Check if any agent supports counters and create profiles
+    // 2. Check if any agent supports counters and create profiles. Columns
+    // follow counter_metrics.counters(), whatever each agent supports.
+    for (const std::string& name : counter_metrics.counters()) {
+        counter_table.add_column(name);
+    }
     bool any_agent_supported = false;
+
+    // The counter catalog cache answers for agents seen before
+    std::string catalog_path;
+    if (!rpv3_counter_cache) {
+        catalog_path = rpv3::default_counter_catalog_path();
+    } else if (strcmp(rpv3_counter_cache, "off") != 0) {
+        catalog_path = rpv3_counter_cache;
+    }
+    std::string catalog_error;
+    if (!catalog_path.empty() && !counter_catalog.load(catalog_path, &catalog_error) && !catalog_error.empty()) {
+        fprintf(stderr, "[Kernel Tracer] Warning: Ignoring counter catalog cache %s\n", catalog_error.c_str());
+    }
     
-    for (auto agent_id : agents) {
-        create_profile_for_agent(agent_id);
-        if (agent_profiles.find(agent_id) != agent_profiles.end()) {
+    for (const auto& [agent_id, key] : agents) {
+        create_profile_for_agent(agent_id, key);
+        if (find_agent_profiles(agent_id)) {
             any_agent_supported = true;
         }
     }
+    if (!catalog_path.empty() && counter_catalog.dirty() && !counter_catalog.save(catalog_path, &catalog_error)) {
+        fprintf(stderr, "[Kernel Tracer] Warning: Could not save the counter catalog cache: %s\n",
+                catalog_error.c_str());
+    }
+    // Multiplexed passes rotate per kernel, which needs per-kernel state
+    counter_selector_enabled = counter_selector_enabled || counters_multiplexed;
     
     if (!any_agent_supported) {
         STATUS_PRINTF("[Kernel Tracer] Warning: No agents support counter collection or no counters found. Counter collection disabled.\n");
-        STATUS_PRINTF("[Kernel Tracer] Falling back to callback tracing mode...\n");
-        // Fall back to regular callback tracing since counters aren't available
-        // Code object callback is already configured above
-        // Just need to add kernel dispatch callback
-        status = rocprofiler_configure_callback_tracing_service(
-            client_ctx,
-            ROCPROFILER_CALLBACK_TRACING_KERNEL_DISPATCH,
-            nullptr,
-            0,
-            kernel_dispatch_callback,
-            nullptr
-        );
-        
-        if (status != ROCPROFILER_STATUS_SUCCESS) {
-            fprintf(stderr, "[Kernel Tracer] Failed to configure kernel dispatch callback tracing\n");
-            return -1;
-        }
-        
-        return 0;
+        return counter_fallback();
     }
     
     // 3. Create buffer for counter records
@@ -1035,7 +1768,6 @@ int setup_counter_collection() {
     if (status != ROCPROFILER_STATUS_SUCCESS) {
         fprintf(stderr, "[Kernel Tracer] Warning: Failed to configure dispatch counting service (status: %d)\n", status);
         fprintf(stderr, "[Kernel Tracer] This hardware/ROCm version may not support counter collection.\n");
-        fprintf(stderr, "[Kernel Tracer] Falling back to callback tracing mode...\n");
         
         // Destroy the counter buffer since we won't use it
         if (counter_buffer.handle != 0) {
@@ -1043,27 +1775,34 @@ int setup_counter_collection() {
             counter_buffer.handle = 0;
         }
         
-        // Fall back to callback tracing
-        // Code object callback is already configured
-        // Just need to add kernel dispatch callback
-        status = rocprofiler_configure_callback_tracing_service(
-            client_ctx,
-            ROCPROFILER_CALLBACK_TRACING_KERNEL_DISPATCH,
-            nullptr,
-            0,
-            kernel_dispatch_callback,
-            nullptr
-        );
-        
-        if (status != ROCPROFILER_STATUS_SUCCESS) {
-            fprintf(stderr, "[Kernel Tracer] Failed to configure kernel dispatch callback tracing\n");
-            return -1;
-        }
-        
-        return 0;
+        return counter_fallback();
     }
     
-    STATUS_PRINTF("[Kernel Tracer] Counter collection configured successfully\n");
+    // With --timeline, counter rows complete the timeline records of the
+    // same dispatches instead of being written on their own
+    counters_joined = timeline_enabled;
+    
+    // Binary counter records name their column by string id. The columns
+    // are declared up front so rpv3-convert writes them in this order.
+    if (binary_enabled) {
+        rpv3::RecordBuffer& out = record_buffer();
+        unsigned char buffer[rpv3::binary::kRecordSize];
+        for (size_t i = 0; i < counter_metrics.columns().size(); i++) {
+            counter_name_ids.push_back(binary_writer.intern(counter_metrics.columns()[i]));
+            binary_writer.encode_column(counter_name_ids.back(),
+                                        counter_metrics.counter_of(i) >= 0 ? 0 : rpv3::binary::kCounterMetric,
+                                        buffer);
+            out.append(std::string_view(reinterpret_cast<const char*>(buffer), sizeof(buffer)));
+        }
+        trace_write(out);
+    }
+    if (csv_enabled && !counters_joined) {
+        std::string header = rpv3::counter_csv_header(counter_metrics.columns());
+        trace_write(header.data(), header.size());
+    }
+
+    STATUS_PRINTF("[Kernel Tracer] Counter collection configured successfully (%zu counters, %zu columns)\n",
+                  counter_metrics.counters().size(), counter_metrics.columns().size());
     return 0;
 }
 
@@ -1082,9 +1821,41 @@ int tool_init(rocprofiler_client_finalize_t fini_func,
     // Check if CSV mode is enabled (from rpv3_options)
     csv_enabled = (rpv3_csv_enabled != 0);
     
+    // Check if binary output is selected (from rpv3_options)
+    binary_enabled = (rpv3_output_format == RPV3_FORMAT_BINARY);
+    
     // Check if backtrace mode is enabled (from rpv3_options)
     backtrace_enabled = (rpv3_backtrace_enabled != 0);
     
+    // Check if summary mode is enabled (from rpv3_options)
+    summary_enabled = (rpv3_summary_enabled != 0);
+    
+    if (rpv3_histogram_enabled) {
+        histograms = std::make_unique<rpv3::HistogramTable>();
+    }
+    
+    // Kernel filters must be ready before the first symbol registers
+    for (int i = 0; i < rpv3_include_count; i++) {
+        name_filter.add_include(rpv3_include_patterns[i]);
+    }
+    for (int i = 0; i < rpv3_exclude_count; i++) {
+        name_filter.add_exclude(rpv3_exclude_patterns[i]);
+    }
+    unknown_kernel_verdict = name_filter.matches("<unknown>");
+    for (int i = 0; i < rpv3_counter_kernel_count; i++) {
+        counter_kernel_filter.add_include(rpv3_counter_kernel_patterns[i]);
+    }
+    unknown_kernel_counted = counter_kernel_filter.matches("<unknown>");
+    if (rpv3_filter_expr) {
+        std::string error;
+        if (!dispatch_filter.compile(rpv3_filter_expr, &error)) {
+            fprintf(stderr, "[Kernel Tracer] Error: Invalid --filter '%s': %s (filter ignored)\n",
+                    rpv3_filter_expr, error.c_str());
+        } else if (backtrace_enabled && dispatch_filter.uses_duration()) {
+            fprintf(stderr, "[Kernel Tracer] Warning: duration predicates are ignored in backtrace mode\n");
+        }
+    }
+    
     // Validate: backtrace is incompatible with timeline and CSV
     // (This should already be caught in rpv3_parse_options, but double-check here)
     if (backtrace_enabled) {
@@ -1096,6 +1867,10 @@ int tool_init(rocprofiler_client_finalize_t fini_func,
             fprintf(stderr, "[Kernel Tracer] Error: Backtrace mode is incompatible with CSV mode\n");
             return -1;
         }
+        if (binary_enabled) {
+            fprintf(stderr, "[Kernel Tracer] Error: Backtrace mode is incompatible with binary output\n");
+            return -1;
+        }
     }
 
     // Handle output redirection
@@ -1110,7 +1885,7 @@ int tool_init(rocprofiler_client_finalize_t fini_func,
         }
     } else if (rpv3_output_dir) {
         pid_t pid = getpid();
-        const char* ext = csv_enabled ? ".csv" : ".txt";
+        const char* ext = binary_enabled ? ".rpv3" : (csv_enabled ? ".csv" : ".txt");
         snprintf(output_filename, sizeof(output_filename), "%s/rpv3_%d%s", 
                  rpv3_output_dir, pid, ext);
         
@@ -1124,62 +1899,42 @@ int tool_init(rocprofiler_client_finalize_t fini_func,
         }
     }
 
-    // Handle RocBLAS Log Pipe
-    if (rpv3_rocblas_pipe) {
-        // Check if it's a FIFO or regular file first
-        struct stat st;
-        bool is_reg_file = false;
-        bool is_fifo = false;
-        
-        if (stat(rpv3_rocblas_pipe, &st) == 0) {
-            if (S_ISREG(st.st_mode)) is_reg_file = true;
-            if (S_ISFIFO(st.st_mode)) is_fifo = true;
-        }
+    // Binary records need a file: the string table and footer are appended at exit
+    if (binary_enabled && !output_file) {
+        fprintf(stderr, "[Kernel Tracer] Warning: --format binary requires --output or --outputdir\n");
+        fprintf(stderr, "[Kernel Tracer] Falling back to CSV output\n");
+        binary_enabled = false;
+        csv_enabled = true;
+    }
 
-        // Verify against ROCBLAS_LOG_TRACE or ROCBLAS_LOG_TRACE_PATH environment variable
-        // Only enforce this check if it is NOT a regular file (i.e. it is a pipe or we don't know yet)
-        if (!is_reg_file) {
-            const char* env_pipe = getenv("ROCBLAS_LOG_TRACE");
-            if (!env_pipe) {
-                env_pipe = getenv("ROCBLAS_LOG_TRACE_PATH");
-            }
-            
-            if (!env_pipe) {
-                fprintf(stderr, "[Kernel Tracer] Warning: --rocblas specified '%s' but ROCBLAS_LOG_TRACE/ROCBLAS_LOG_TRACE_PATH is not set.\n", rpv3_rocblas_pipe);
-                fprintf(stderr, "[Kernel Tracer] RocBLAS will not write to the pipe. Logging disabled.\n");
-                rpv3_rocblas_pipe = nullptr; // Disable logging
-            } else if (strcmp(rpv3_rocblas_pipe, env_pipe) != 0) {
-                fprintf(stderr, "[Kernel Tracer] Error: --rocblas '%s' does not match ROCBLAS_LOG_TRACE/PATH '%s'.\n", 
-                        rpv3_rocblas_pipe, env_pipe);
-                fprintf(stderr, "[Kernel Tracer] Logging disabled to prevent mismatch.\n");
-                rpv3_rocblas_pipe = nullptr; // Disable logging
-            }
+    // Start the async output engine once the destination is known
+    if (rpv3_async_enabled) {
+        rpv3::TraceWriterConfig writer_config;
+        writer_config.ring_size = rpv3_ring_size;
+        switch (rpv3_ring_policy) {
+            case RPV3_RING_POLICY_DROP:  writer_config.policy = rpv3::RingFullPolicy::Drop; break;
+            case RPV3_RING_POLICY_SPILL: writer_config.policy = rpv3::RingFullPolicy::Spill; break;
+            default:                     writer_config.policy = rpv3::RingFullPolicy::Block; break;
         }
-        
-        if (rpv3_rocblas_pipe) {
-            if (is_fifo || is_reg_file) {
-                // Check for timeline mode + pipe incompatibility
-                if (timeline_enabled && is_fifo) {
-                    fprintf(stderr, "[Kernel Tracer] Warning: RocBLAS logging with named pipes is not supported in timeline mode.\n");
-                    fprintf(stderr, "[Kernel Tracer] Please use a regular file for --rocblas with --timeline.\n");
-                    rpv3_rocblas_pipe = nullptr; // Disable logging
-                } else {
-                    STATUS_PRINTF("[Kernel Tracer] Detected RocBLAS log file/pipe: %s\n", rpv3_rocblas_pipe);
-                    
-                    // Open non-blocking
-                    rocblas_pipe_fd = open(rpv3_rocblas_pipe, O_RDONLY | O_NONBLOCK);
-                    if (rocblas_pipe_fd != -1) {
-                        strncpy(rocblas_pipe_path, rpv3_rocblas_pipe, sizeof(rocblas_pipe_path) - 1);
-                        STATUS_PRINTF("[Kernel Tracer] Successfully opened RocBLAS log pipe\n");
-                    } else {
-                        fprintf(stderr, "[Kernel Tracer] Failed to open RocBLAS log pipe: %s\n", strerror(errno));
-                    }
-                }
-            } else {
-                STATUS_PRINTF("[Kernel Tracer] Pipe '%s' is not a FIFO or not found.\n", rpv3_rocblas_pipe);
-            }
+        trace_writer.reset(new rpv3::TraceWriter(output_file ? output_file : stdout, writer_config));
+        trace_writer->start();
+        STATUS_PRINTF("[Kernel Tracer] Async output enabled (ring: %zu bytes per thread)\n",
+                      trace_writer->ring_size());
+    }
+
+    // Library log pipes; a channel is set up for every log that opens
+    const std::pair<const rpv3::LibraryLog*, char**> library_pipes[] = {
+        {&rpv3::rocblas_log(), &rpv3_rocblas_pipe},
+        {&rpv3::hipblaslt_log(), &rpv3_hipblaslt_pipe},
+        {&rpv3::miopen_log(), &rpv3_miopen_pipe},
+        {&rpv3::rocsolver_log(), &rpv3_rocsolver_pipe},
+    };
+    for (const auto& [library, path] : library_pipes) {
+        if (*path) {
+            open_library_log(*library, *path);
         }
     }
+    publish_log_paths();
 
     // Handle RocBLAS Log File
     if (rpv3_rocblas_log_file) {
@@ -1192,22 +1947,106 @@ int tool_init(rocprofiler_client_finalize_t fini_func,
                         rpv3_rocblas_log_file, strerror(errno));
             } else {
                 STATUS_PRINTF("[Kernel Tracer] Redirecting RocBLAS logs to: %s\n", rpv3_rocblas_log_file);
+                if (rocblas_channel) {
+                    rocblas_channel->reader.set_tee(rocblas_log_file);
+                }
             }
         }
     }
+
+    if (rpv3_rocblas_bench_file && !rocblas_channel) {
+        fprintf(stderr, "[Kernel Tracer] Warning: --rocblas-bench specified but no rocBLAS log is read. Ignoring.\n");
+        rpv3_rocblas_bench_file = nullptr;
+    }
+
+    // Start reading only once the tee is in place, so --rocblas-log misses nothing
+    if (rocblas_channel) {
+        blas_columns = csv_enabled && !summary_enabled;
+        blas_peak = query_blas_peak();
+    }
+    if (!library_channels.empty()) {
+        library_log_thread = std::thread(library_log_loop);
+    }
     
     // Check if counter mode is enabled
     counter_mode = rpv3_counter_mode;
+    if (counter_mode != RPV3_COUNTER_MODE_NONE) {
+        // A --counter group is a list of plain counters
+        std::string spec;
+        if (counter_mode == RPV3_COUNTER_MODE_CUSTOM) {
+            spec = rpv3_counters_spec ? rpv3_counters_spec : "";
+        } else {
+            for (const std::string& name : get_target_counters(counter_mode)) {
+                spec.append(spec.empty() ? "" : ",").append(name);
+            }
+        }
+        std::string error;
+        if (!counter_metrics.compile(spec, &error)) {
+            fprintf(stderr, "[Kernel Tracer] Error: Invalid --counters '%s': %s (counter collection disabled)\n",
+                    spec.c_str(), error.c_str());
+            counter_mode = RPV3_COUNTER_MODE_NONE;
+        } else if (counter_metrics.uses_duration() && !timeline_enabled) {
+            fprintf(stderr, "[Kernel Tracer] Warning: DurationNs is only measured with --timeline; "
+                            "metrics using it are left empty\n");
+        }
+        counter_selector.configure(rpv3_counter_first, rpv3_counter_every);
+        counter_selector_enabled = rpv3_counter_first > 0 || rpv3_counter_every > 1;
+    }
     
     if (timeline_enabled) {
         STATUS_PRINTF("[Kernel Tracer] Timeline mode enabled\n");
         // Capture baseline timestamp when tracer starts
         rocprofiler_get_timestamp(&tracer_start_timestamp);
-    } else if (csv_enabled) {
-        // CSV mode needs start timestamp even without timeline
+    } else if (csv_enabled || binary_enabled || rpv3_sample_mode == RPV3_SAMPLE_WINDOW) {
+        // CSV and binary modes need start timestamp even without timeline,
+        // and sampling windows are aligned to it
         rocprofiler_get_timestamp(&tracer_start_timestamp);
     }
     
+    if (rpv3_sample_mode != RPV3_SAMPLE_NONE) {
+        rpv3::SamplerConfig sample_config;
+        switch (rpv3_sample_mode) {
+            case RPV3_SAMPLE_EVERY:
+                sample_config.mode = rpv3::SampleMode::Every;
+                sample_config.every = rpv3_sample_every;
+                break;
+            case RPV3_SAMPLE_WINDOW:
+                sample_config.mode = rpv3::SampleMode::Window;
+                sample_config.window_on_ns = rpv3_sample_window_on_ms * 1000000ULL;
+                sample_config.window_off_ns = rpv3_sample_window_off_ms * 1000000ULL;
+                break;
+            default:
+                sample_config.mode = rpv3::SampleMode::Reservoir;
+                sample_config.reservoir_size = rpv3_sample_reservoir;
+                break;
+        }
+        sample_config.origin_ns = tracer_start_timestamp;
+        sampler.configure(sample_config);
+        STATUS_PRINTF("[Kernel Tracer] Sampling dispatches (%s)\n", sampler.describe().c_str());
+    }
+    
+    // The header goes out before the context starts, so it precedes every record
+    if (binary_enabled) {
+        uint32_t flags = rpv3::binary::kFlagMangledNames;
+        if (rocblas_channel) {
+            flags |= rpv3::binary::kFlagBlasColumns;
+        }
+        if (!binary_writer.begin(output_file, tracer_start_timestamp, flags)) {
+            fprintf(stderr, "[Kernel Tracer] Error: Failed to write binary trace header\n");
+            return -1;
+        }
+        STATUS_PRINTF("[Kernel Tracer] Binary output enabled (convert with rpv3-convert)\n");
+    }
+    
+    if (summary_enabled) {
+        STATUS_PRINTF("[Kernel Tracer] Summary mode enabled (per-kernel statistics at exit)\n");
+    }
+    
+    if (histograms) {
+        STATUS_PRINTF("[Kernel Tracer] Latency histograms enabled (%zu bytes per kernel, up to %zu kernels)\n",
+                      rpv3::kHistogramBytes, histograms->capacity());
+    }
+    
     if (counter_mode != RPV3_COUNTER_MODE_NONE) {
         STATUS_PRINTF("[Kernel Tracer] Counter collection enabled (mode: %d)\n", counter_mode);
     }
@@ -1221,7 +2060,11 @@ int tool_init(rocprofiler_client_finalize_t fini_func,
     // Setup tracing based on mode
     int result;
     if (timeline_enabled) {
+        // Counters can share the timeline's context
         result = setup_buffer_tracing();
+        if (result == 0 && counter_mode != RPV3_COUNTER_MODE_NONE) {
+            result = setup_counter_collection();
+        }
     } else if (counter_mode != RPV3_COUNTER_MODE_NONE) {
         result = setup_counter_collection();
     } else {
@@ -1257,27 +2100,73 @@ void tool_fini(void* tool_data) {
     
     STATUS_PRINTF("\n[Kernel Tracer] Finalizing profiler tool...\n");
     
-    // Stop background thread
+    // Flush buffer if in timeline mode
+    if (timeline_enabled && trace_buffer.handle != 0) {
+        rocprofiler_flush_buffer(trace_buffer);
+    }
+
+    // Flush counter records and write the last dispatch's row
+    if (counter_buffer.handle != 0) {
+        rocprofiler_flush_buffer(counter_buffer);
+        rpv3::CounterRow row;
+        if (counter_table.finish(row)) {
+            counter_row_ready(row);
+        }
+        STATUS_PRINTF("[Kernel Tracer] Counter rows written: %lu\n", (unsigned long)counter_rows);
+        if (counter_selector.skipped() > 0) {
+            STATUS_PRINTF("[Kernel Tracer] Dispatches counted: %lu, run uncounted: %lu\n",
+                          (unsigned long)counter_selector.counted(), (unsigned long)counter_selector.skipped());
+        }
+    }
     
-    if (rocblas_pipe_fd != -1) {
-        close(rocblas_pipe_fd);
-        rocblas_pipe_fd = -1;
+    // Stop the library log reader after its last drain, then resolve every
+    // dispatch still waiting for a line before the output is drained
+    if (library_log_thread.joinable()) {
+        library_log_stop.store(true, std::memory_order_release);
+        library_log_thread.join();
+    }
+    for (const auto& channel : library_channels) {
+        channel->correlator->flush(channel->sink);
+        close(channel->fd);
+        channel->fd = -1;
     }
 
     if (rocblas_log_file) {
+        if (rocblas_channel && rocblas_channel->reader.spliced_bytes() > 0) {
+            STATUS_PRINTF("[Kernel Tracer] RocBLAS log: %lu bytes mirrored in the kernel (tee/splice)\n",
+                          (unsigned long)rocblas_channel->reader.spliced_bytes());
+        }
+        if (rocblas_channel) {
+            rocblas_channel->reader.set_tee(nullptr);
+        }
         fclose(rocblas_log_file);
         rocblas_log_file = NULL;
     }
-
-
     
-    // Flush buffer if in timeline mode
-    if (timeline_enabled && trace_buffer.handle != 0) {
-        rocprofiler_flush_buffer(trace_buffer);
+    // Drain the async rings so all records precede the summary lines.
+    // Late callbacks after this point fall back to synchronous writes.
+    if (trace_writer) {
+        trace_writer->stop();
+        if (trace_writer->dropped_records() > 0) {
+            fprintf(stderr, "[Kernel Tracer] Warning: Async output dropped %lu records (ring full)\n",
+                    (unsigned long)trace_writer->dropped_records());
+        }
+        if (trace_writer->spilled_records() > 0) {
+            STATUS_PRINTF("[Kernel Tracer] Async output spilled %lu records to overflow buffers\n",
+                          (unsigned long)trace_writer->spilled_records());
+        }
     }
     
     STATUS_PRINTF("[Kernel Tracer] Total kernels traced: %lu\n", kernel_count.load());
-    STATUS_PRINTF("[Kernel Tracer] Unique kernel symbols tracked: %zu\n", kernel_names.size());
+    STATUS_PRINTF("[Kernel Tracer] Unique kernel symbols tracked: %zu\n", kernel_symbols.size());
+    STATUS_PRINTF("[Kernel Tracer] Kernel names demangled: %zu\n", kernel_symbols.demangled_count());
+    for (const auto& channel : library_channels) {
+        STATUS_PRINTF("[Kernel Tracer] %s lines matched: %lu (dispatches without a line: %lu, unclaimed lines: %lu)\n",
+                      channel->library->name(),
+                      (unsigned long)channel->correlator->matched(),
+                      (unsigned long)channel->correlator->unmatched_dispatches(),
+                      (unsigned long)channel->correlator->unmatched_lines());
+    }
     
     // Stop context if still active
     if (client_ctx.handle != 0) {
@@ -1293,6 +2182,182 @@ void tool_fini(void* tool_data) {
         rocprofiler_destroy_buffer(counter_buffer);
     }
 
+    // Context is stopped, so no callback can reach the writer any more
+    trace_writer.reset();
+
+    // Reservoir sampling: write the kept dispatches in start time order
+    std::vector<rpv3::ReservoirCount> reservoirs;
+    if (sampler.buffered()) {
+        for (const rpv3::SampledDispatch& sample : sampler.drain(&reservoirs)) {
+            if (counters_joined) {
+                join_dispatch({sample.record, sample.sequence, {}, {}});
+            } else {
+                emit_dispatch(sample.record, sample.sequence, kernel_symbols.find(sample.record.kernel_id));
+            }
+        }
+    }
+
+    // Both buffers are flushed and every library and reservoir record handed
+    // over: what is still held lost its partner
+    if (counters_joined) {
+        std::vector<rpv3::TimedDispatch> dispatches;
+        std::vector<rpv3::CounterRow> rows;
+        counter_join.drain(dispatches, rows);
+        for (const rpv3::TimedDispatch& timed : dispatches) {
+            emit_joined(timed, nullptr);
+        }
+        if (!dispatches.empty() || !rows.empty()) {
+            fprintf(stderr, "[Kernel Tracer] Warning: %zu timeline records written without counters, "
+                            "%zu counter rows without a timeline record dropped\n",
+                    dispatches.size(), rows.size());
+        }
+    }
+
+    // Report the ratio so sampled counts and totals can be scaled back up. It
+    // is taken over the dispatches that passed the filters; each reservoir
+    // fills at its own rate, so reservoir kernels are scaled one by one.
+    if (sampler.enabled()) {
+        const uint64_t total = sampler.population();
+        const double ratio = total ? (double)sampler.kept() / (double)total : 0.0;
+        STATUS_PRINTF("[Kernel Tracer] Sampling (%s): recorded %lu of %lu dispatches (ratio %.6f)\n",
+                      sampler.describe().c_str(), (unsigned long)sampler.kept(),
+                      (unsigned long)total, ratio);
+        for (const rpv3::ReservoirCount& reservoir : reservoirs) {
+            std::string_view name = kernel_symbols.name(reservoir.kernel_id);
+            STATUS_PRINTF("[Kernel Tracer]   %.*s: kept %lu of %lu (scale %.3f)\n", (int)name.size(), name.data(),
+                          (unsigned long)reservoir.kept, (unsigned long)reservoir.seen,
+                          (double)reservoir.seen / (double)reservoir.kept);
+        }
+        if (summary_enabled) {
+            rpv3::RecordBuffer& out = record_buffer();
+            out.append("# Sampling ").append(sampler.describe()).append(": recorded ")
+               .append_u64(sampler.kept()).append(" of ").append_u64(total).append(" dispatches");
+            if (ratio > 0.0 && sampler.tallies()) {
+                out.append(", scale counts and totals by ").append_fixed3(1.0 / ratio);
+            }
+            out.append('\n');
+            for (const rpv3::ReservoirCount& reservoir : reservoirs) {
+                out.append("# Reservoir ").append(kernel_symbols.name(reservoir.kernel_id)).append(": kept ")
+                   .append_u64(reservoir.kept).append(" of ").append_u64(reservoir.seen)
+                   .append(" dispatches, scale by ").append_fixed3((double)reservoir.seen / (double)reservoir.kept);
+                out.append('\n');
+            }
+            trace_write(out);
+        }
+    }
+
+    // Summary mode: one table replaces the per-dispatch records
+    if (summary_enabled) {
+        std::vector<rpv3::KernelSummaryRow> rows = kernel_stats.rows();
+        for (auto& row : rows) {
+            row.name = kernel_symbols.name(row.kernel_id);
+        }
+        rpv3::RecordBuffer& out = record_buffer();
+        if (csv_enabled) {
+            rpv3::format_summary_csv(out, rows);
+        } else {
+            rpv3::format_summary_text(out, rows);
+        }
+
+        // The same GPU time grouped by Tensile solution parameters
+        std::vector<rpv3::TensileGroupRow> solutions = rpv3::group_tensile_solutions(rows, tensile_solutions);
+        if (!solutions.empty()) {
+            uint64_t total_ns = 0;
+            for (const auto& row : rows) {
+                total_ns += row.stats.total_ns;
+            }
+            if (csv_enabled) {
+                out.append("\n# Tensile solutions\n");
+                rpv3::format_tensile_summary_csv(out, solutions, total_ns);
+            } else {
+                rpv3::format_tensile_summary_text(out, solutions, total_ns);
+            }
+        }
+        trace_write(out);
+    }
+
+    // Multiplexed counters: each kernel's estimate from all of its passes
+    if (counters_multiplexed && counter_estimates.size() > 0) {
+        std::vector<rpv3::CounterEstimateRow> rows = counter_estimates.rows();
+        std::vector<std::vector<double>> values(rows.size());
+        for (size_t r = 0; r < rows.size(); r++) {
+            rows[r].name = kernel_symbols.name(rows[r].kernel_id);
+            rows[r].means.resize(counter_metrics.counters().size(), NAN);
+            values[r].resize(counter_metrics.columns().size());
+            counter_metrics.evaluate(rows[r].means.data(), NAN, values[r].data());
+        }
+        rpv3::RecordBuffer& out = record_buffer();
+        if (csv_enabled) {
+            out.append("\n# Counter estimates\n");
+            rpv3::format_estimates_csv(out, rows, counter_metrics.columns(), values, counter_metrics.counters());
+        } else {
+            rpv3::format_estimates_text(out, rows, counter_metrics.columns(), values, counter_metrics.counters());
+        }
+        if (binary_enabled) {
+            // Binary traces keep the rows; the estimates are a report
+            fwrite(out.data(), 1, out.size(), status_stream());
+            out.clear();
+        } else {
+            trace_write(out);
+        }
+    }
+
+    // Achieved throughput per rocBLAS call shape, most GPU time first
+    if (blas_efficiency.size() > 0) {
+        rpv3::print_blas_efficiency(status_stream(), blas_efficiency.rows(), blas_peak);
+    }
+    if (rpv3_rocblas_bench_file) {
+        FILE* bench = fopen(rpv3_rocblas_bench_file, "w");
+        if (!bench || !rpv3::write_bench_yaml(bench, blas_bench.rows())) {
+            fprintf(stderr, "[Kernel Tracer] Warning: Could not write rocblas-bench reproducers to '%s': %s\n",
+                    rpv3_rocblas_bench_file, strerror(errno));
+        } else {
+            STATUS_PRINTF("[Kernel Tracer] %zu rocblas-bench reproducers written to: %s\n",
+                          blas_bench.size(), rpv3_rocblas_bench_file);
+        }
+        if (bench) {
+            fclose(bench);
+        }
+    }
+
+    // Latency percentiles per kernel, busiest kernels first
+    if (histograms) {
+        std::vector<rpv3::NamedHistogram> kernels;
+        for (const rpv3::HistogramEntry& entry : histograms->entries()) {
+            kernels.push_back({std::string(kernel_symbols.name(entry.kernel_id)),
+                               entry.kernel_id, entry.histogram});
+        }
+        std::sort(kernels.begin(), kernels.end(), [](const rpv3::NamedHistogram& a, const rpv3::NamedHistogram& b) {
+            return a.histogram->count() > b.histogram->count();
+        });
+        rpv3::print_percentiles(status_stream(), kernels);
+        if (histograms->overflow() > 0) {
+            fprintf(stderr, "[Kernel Tracer] Warning: %lu dispatches not in histograms (more than %zu kernels)\n",
+                    (unsigned long)histograms->overflow(), histograms->capacity());
+        }
+        if (rpv3_histogram_file) {
+            FILE* dump = fopen(rpv3_histogram_file, "w");
+            if (!dump || !rpv3::write_histogram_csv(dump, kernels)) {
+                fprintf(stderr, "[Kernel Tracer] Warning: Could not write histograms to '%s': %s\n",
+                        rpv3_histogram_file, strerror(errno));
+            } else {
+                STATUS_PRINTF("[Kernel Tracer] Latency histograms written to: %s\n", rpv3_histogram_file);
+            }
+            if (dump) {
+                fclose(dump);
+            }
+        }
+    }
+
+    // All records are on disk; append the string table and footer
+    if (binary_enabled && output_file) {
+        if (!binary_writer.finish(output_file)) {
+            fprintf(stderr, "[Kernel Tracer] Warning: Failed to finalize binary trace\n");
+        }
+        STATUS_PRINTF("[Kernel Tracer] Binary trace: %lu records, %zu strings\n",
+                      (unsigned long)binary_writer.record_count(), binary_writer.string_count());
+    }
+
     // Close output file if open
     if (output_file) {
         fprintf(stderr, "[Kernel Tracer] Output saved to: %s\n", 
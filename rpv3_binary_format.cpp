@@ -0,0 +1,694 @@
+// MIT License
+// RPV3 Binary Format - Implementation
+// See rpv3_binary_format.h for the file layout
+
+#include "rpv3_binary_format.h"
+#include "rpv3_blas_perf.h"
+#include "rpv3_counter_table.h"
+#include "rpv3_demangle.h"
+#include "rpv3_record_format.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rpv3 {
+namespace binary {
+
+namespace {
+    // Explicit little-endian helpers so files are portable regardless of host order
+    void put_u16(unsigned char* p, uint16_t v) {
+        p[0] = (unsigned char)v;
+        p[1] = (unsigned char)(v >> 8);
+    }
+
+    void put_u32(unsigned char* p, uint32_t v) {
+        for (int i = 0; i < 4; i++) p[i] = (unsigned char)(v >> (8 * i));
+    }
+
+    void put_u64(unsigned char* p, uint64_t v) {
+        for (int i = 0; i < 8; i++) p[i] = (unsigned char)(v >> (8 * i));
+    }
+
+    uint16_t get_u16(const unsigned char* p) {
+        return (uint16_t)(p[0] | (p[1] << 8));
+    }
+
+    uint32_t get_u32(const unsigned char* p) {
+        uint32_t v = 0;
+        for (int i = 3; i >= 0; i--) v = (v << 8) | p[i];
+        return v;
+    }
+
+    uint64_t get_u64(const unsigned char* p) {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+        return v;
+    }
+
+    // Header field offsets
+    constexpr size_t kHdrVersion = 8;
+    constexpr size_t kHdrHeaderSize = 10;
+    constexpr size_t kHdrRecordSize = 12;
+    constexpr size_t kHdrFlags = 16;
+    constexpr size_t kHdrStartTs = 24;
+    constexpr size_t kHdrRecordCount = 32;
+    constexpr size_t kHdrStringOffset = 40;
+    constexpr size_t kHdrStringCount = 48;
+
+    // Dimensions are rocblas_int on disk; kBlasNone (-1) survives the round trip
+    uint32_t put_dim(int64_t v) {
+        if (v > INT32_MAX) v = INT32_MAX;
+        if (v < INT32_MIN) v = INT32_MIN;
+        return (uint32_t)(int32_t)v;
+    }
+
+    int64_t get_dim(uint32_t v) {
+        return (int64_t)(int32_t)v;
+    }
+
+    void put_f64(unsigned char* p, double v) {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        put_u64(p, bits);
+    }
+
+    double get_f64(const unsigned char* p) {
+        uint64_t bits = get_u64(p);
+        double v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    // Footer field offsets
+    constexpr size_t kFtrStringOffset = 8;
+    constexpr size_t kFtrStringCount = 16;
+    constexpr size_t kFtrRecordCount = 24;
+}
+
+// Record layout:
+//   0 kind u16 | 2 reserved u16 | 4 string_id u32 | 8 thread_id | 16 correlation_id
+//   24 kernel_id | 32 dispatch_id | 40 start_ns | 48 end_ns | 56 grid[3] u32
+//   68 workgroup[3] u32 | 80 private_segment u32 | 84 group_segment u32 | 88 reserved u64
+void encode_record(const Record& record, unsigned char* out) {
+    const DispatchRecord& d = record.dispatch;
+    memset(out, 0, kRecordSize);
+    put_u16(out + 0, record.kind);
+    put_u32(out + 4, record.string_id);
+    put_u64(out + 8, d.thread_id);
+    put_u64(out + 16, d.correlation_id);
+    put_u64(out + 24, d.kernel_id);
+    put_u64(out + 32, d.dispatch_id);
+    put_u64(out + 40, d.start_ns);
+    put_u64(out + 48, d.end_ns);
+    for (int i = 0; i < 3; i++) {
+        put_u32(out + 56 + 4 * i, d.grid[i]);
+        put_u32(out + 68 + 4 * i, d.workgroup[i]);
+    }
+    put_u32(out + 80, d.private_segment_size);
+    put_u32(out + 84, d.group_segment_size);
+}
+
+Record decode_record(const unsigned char* in) {
+    Record record;
+    DispatchRecord& d = record.dispatch;
+    record.kind = get_u16(in + 0);
+    record.string_id = get_u32(in + 4);
+    d.thread_id = get_u64(in + 8);
+    d.correlation_id = get_u64(in + 16);
+    d.kernel_id = get_u64(in + 24);
+    d.dispatch_id = get_u64(in + 32);
+    d.start_ns = get_u64(in + 40);
+    d.end_ns = get_u64(in + 48);
+    for (int i = 0; i < 3; i++) {
+        d.grid[i] = get_u32(in + 56 + 4 * i);
+        d.workgroup[i] = get_u32(in + 68 + 4 * i);
+    }
+    d.private_segment_size = get_u32(in + 80);
+    d.group_segment_size = get_u32(in + 84);
+    return record;
+}
+
+// BLAS call layout:
+//   0 kind u16 | 2 trans_a u8 | 3 trans_b u8 | 4 function id u32 | 8 dispatch_id
+//   16 precision id u32 | 20 compute type id u32 | 24 m | 28 n | 32 k | 36 lda
+//   40 ldb | 44 ldc | 48 batch_count (i32 each) | 52 side u8 | 53 uplo u8
+//   54 diag u8 | 55 family u8 | 56 stride_a | 64 stride_b | 72 stride_c (i64)
+//   80 alpha f64 | 88 beta f64
+// The precision string is A's datatype, or "a,b,c,d" when the datatypes of
+// an _ex routine differ; traces from before the B/C/D types have no commas.
+namespace {
+    std::string datatypes_string(const BlasCall& c) {
+        auto same = [&c](const std::string& type) { return type.empty() || type == c.precision; };
+        if (same(c.b_type) && same(c.c_type) && same(c.d_type)) {
+            return c.precision;
+        }
+        return c.precision + "," + c.b_type + "," + c.c_type + "," + c.d_type;
+    }
+
+    void set_datatypes(BlasCall& c, std::string_view text) {
+        std::string_view types[4];
+        size_t count = 0;
+        while (count < 4) {
+            size_t comma = text.find(',');
+            types[count++] = text.substr(0, comma);
+            if (comma == std::string_view::npos) {
+                break;
+            }
+            text.remove_prefix(comma + 1);
+        }
+        c.precision = std::string(types[0]);
+        c.b_type = count == 4 ? std::string(types[1]) : c.precision;
+        c.c_type = count == 4 ? std::string(types[2]) : c.precision;
+        c.d_type = count == 4 ? std::string(types[3]) : c.precision;
+    }
+
+
+    void encode_blas_record(const BlasRecord& record, const uint32_t (&ids)[3], unsigned char* out) {
+        const BlasCall& c = record.call;
+        memset(out, 0, kRecordSize);
+        put_u16(out + 0, kRecordBlasCall);
+        out[2] = (unsigned char)c.trans_a;
+        out[3] = (unsigned char)c.trans_b;
+        put_u32(out + 4, ids[0]);
+        put_u64(out + 8, record.dispatch_id);
+        put_u32(out + 16, ids[1]);
+        put_u32(out + 20, ids[2]);
+        const int64_t dims[] = {c.m, c.n, c.k, c.lda, c.ldb, c.ldc, c.batch_count};
+        for (int i = 0; i < 7; i++) {
+            put_u32(out + 24 + 4 * i, put_dim(dims[i]));
+        }
+        out[52] = (unsigned char)c.side;
+        out[53] = (unsigned char)c.uplo;
+        out[54] = (unsigned char)c.diag;
+        out[55] = (unsigned char)c.family;
+        put_u64(out + 56, (uint64_t)c.stride_a);
+        put_u64(out + 64, (uint64_t)c.stride_b);
+        put_u64(out + 72, (uint64_t)c.stride_c);
+        put_f64(out + 80, c.alpha);
+        put_f64(out + 88, c.beta);
+    }
+
+    BlasRecord decode_blas_record(const unsigned char* in, uint32_t (&ids)[3]) {
+        BlasRecord record;
+        BlasCall& c = record.call;
+        c.trans_a = (char)in[2];
+        c.trans_b = (char)in[3];
+        ids[0] = get_u32(in + 4);
+        record.dispatch_id = get_u64(in + 8);
+        ids[1] = get_u32(in + 16);
+        ids[2] = get_u32(in + 20);
+        int64_t* dims[] = {&c.m, &c.n, &c.k, &c.lda, &c.ldb, &c.ldc, &c.batch_count};
+        for (int i = 0; i < 7; i++) {
+            *dims[i] = get_dim(get_u32(in + 24 + 4 * i));
+        }
+        c.side = (char)in[52];
+        c.uplo = (char)in[53];
+        c.diag = (char)in[54];
+        c.family = (BlasFamily)in[55];
+        c.stride_a = (int64_t)get_u64(in + 56);
+        c.stride_b = (int64_t)get_u64(in + 64);
+        c.stride_c = (int64_t)get_u64(in + 72);
+        c.alpha = get_f64(in + 80);
+        c.beta = get_f64(in + 88);
+        return record;
+    }
+}
+
+// Counter value layout:
+//   0 kind u16 | 4 name id u32 | 8 dispatch_id | 16 value f64 | 24 instances u32
+//   28 flags u32 | 32 agent_id
+namespace {
+    void encode_counter_value(const CounterValue& record, uint16_t kind, unsigned char* out) {
+        memset(out, 0, kRecordSize);
+        put_u16(out + 0, kind);
+        put_u32(out + 4, record.name_id);
+        put_u64(out + 8, record.dispatch_id);
+        put_f64(out + 16, record.value);
+        put_u32(out + 24, record.instances);
+        put_u32(out + 28, record.flags);
+        put_u64(out + 32, record.agent_id);
+    }
+
+    CounterValue decode_counter_value(const unsigned char* in) {
+        CounterValue record;
+        record.name_id = get_u32(in + 4);
+        record.dispatch_id = get_u64(in + 8);
+        record.value = get_f64(in + 16);
+        record.instances = get_u32(in + 24);
+        record.flags = get_u32(in + 28);
+        record.agent_id = get_u64(in + 32);
+        return record;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+
+bool Writer::begin(FILE* out, uint64_t tracer_start_ns, uint32_t flags) {
+    intern("<unknown>");
+
+    unsigned char header[kHeaderSize] = {0};
+    memcpy(header, kFileMagic, sizeof(kFileMagic));
+    put_u16(header + kHdrVersion, kVersion);
+    put_u16(header + kHdrHeaderSize, (uint16_t)kHeaderSize);
+    put_u32(header + kHdrRecordSize, (uint32_t)kRecordSize);
+    put_u32(header + kHdrFlags, flags);
+    put_u64(header + kHdrStartTs, tracer_start_ns);
+    return fwrite(header, 1, sizeof(header), out) == sizeof(header);
+}
+
+uint32_t Writer::intern(std::string_view text) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(std::string(text));
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    uint32_t id = (uint32_t)strings_.size();
+    auto inserted = ids_.emplace(std::string(text), id);
+    strings_.push_back(&inserted.first->first);
+    return id;
+}
+
+void Writer::encode(const Record& record, unsigned char* out) {
+    encode_record(record, out);
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_++;
+}
+
+void Writer::encode(const BlasRecord& record, unsigned char* out) {
+    const uint32_t ids[3] = {intern(record.call.function), intern(datatypes_string(record.call)),
+                             intern(record.call.compute_type)};
+    encode_blas_record(record, ids, out);
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_++;
+}
+
+void Writer::encode(const CounterValue& record, unsigned char* out) {
+    encode_counter_value(record, kRecordCounter, out);
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_++;
+}
+
+void Writer::encode_column(uint32_t name_id, uint32_t flags, unsigned char* out) {
+    CounterValue column;
+    column.name_id = name_id;
+    column.flags = flags;
+    encode_counter_value(column, kRecordCounterColumn, out);
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_++;
+}
+
+bool Writer::finish(FILE* out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    fflush(out);
+    long table_pos = ftell(out);
+    bool seekable = (table_pos >= 0);
+    // On a pipe the offset is implied by the record count
+    uint64_t table_offset = seekable ? (uint64_t)table_pos : kHeaderSize + records_ * kRecordSize;
+
+    bool ok = true;
+    unsigned char len_bytes[4];
+    for (const std::string* s : strings_) {
+        put_u32(len_bytes, (uint32_t)s->size());
+        ok &= fwrite(len_bytes, 1, sizeof(len_bytes), out) == sizeof(len_bytes);
+        ok &= fwrite(s->data(), 1, s->size(), out) == s->size();
+    }
+
+    unsigned char footer[kFooterSize] = {0};
+    memcpy(footer, kFooterMagic, sizeof(kFooterMagic));
+    put_u64(footer + kFtrStringOffset, table_offset);
+    put_u64(footer + kFtrStringCount, strings_.size());
+    put_u64(footer + kFtrRecordCount, records_);
+    ok &= fwrite(footer, 1, sizeof(footer), out) == sizeof(footer);
+
+    if (seekable) {
+        unsigned char counts[24];
+        put_u64(counts, records_);
+        put_u64(counts + 8, table_offset);
+        put_u64(counts + 16, strings_.size());
+        if (fseek(out, (long)kHdrRecordCount, SEEK_SET) == 0) {
+            ok &= fwrite(counts, 1, sizeof(counts), out) == sizeof(counts);
+            fseek(out, 0, SEEK_END);
+        }
+    }
+    fflush(out);
+    return ok;
+}
+
+uint64_t Writer::record_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
+
+size_t Writer::string_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return strings_.size();
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+
+Reader::~Reader() {
+    close();
+}
+
+void Reader::close() {
+    if (data_) {
+        munmap(const_cast<unsigned char*>(data_), size_);
+        data_ = nullptr;
+    }
+    size_ = 0;
+    record_count_ = 0;
+    strings_.clear();
+}
+
+bool Reader::fail(const std::string& message) {
+    error_ = message;
+    close();
+    return false;
+}
+
+bool Reader::open(const char* path) {
+    close();
+    error_.clear();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return fail(std::string("cannot open ") + path + ": " + strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)(kHeaderSize + kFooterSize)) {
+        ::close(fd);
+        return fail("file too small to be an rpv3 binary trace");
+    }
+    size_ = (size_t)st.st_size;
+    void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        size_ = 0;
+        return fail(std::string("mmap failed: ") + strerror(errno));
+    }
+    data_ = static_cast<const unsigned char*>(mapped);
+
+    if (memcmp(data_, kFileMagic, sizeof(kFileMagic)) != 0) {
+        return fail("bad magic, not an rpv3 binary trace");
+    }
+    version_ = get_u16(data_ + kHdrVersion);
+    if (version_ != kVersion) {
+        return fail("unsupported format version " + std::to_string(version_));
+    }
+    if (get_u16(data_ + kHdrHeaderSize) != kHeaderSize ||
+        get_u32(data_ + kHdrRecordSize) != kRecordSize) {
+        return fail("unexpected header or record size");
+    }
+    flags_ = get_u32(data_ + kHdrFlags);
+    tracer_start_ns_ = get_u64(data_ + kHdrStartTs);
+
+    // The footer is authoritative; the header counts may be unpatched on pipes
+    const unsigned char* footer = data_ + size_ - kFooterSize;
+    if (memcmp(footer, kFooterMagic, sizeof(kFooterMagic)) != 0) {
+        return fail("missing footer, trace was not closed cleanly");
+    }
+    uint64_t table_offset = get_u64(footer + kFtrStringOffset);
+    uint64_t string_count = get_u64(footer + kFtrStringCount);
+    record_count_ = get_u64(footer + kFtrRecordCount);
+
+    if (table_offset != kHeaderSize + record_count_ * kRecordSize ||
+        table_offset > size_ - kFooterSize) {
+        return fail("record count does not match file size");
+    }
+
+    size_t pos = (size_t)table_offset;
+    const size_t table_end = size_ - kFooterSize;
+    strings_.reserve((size_t)string_count);
+    for (uint64_t i = 0; i < string_count; i++) {
+        if (pos + 4 > table_end) {
+            return fail("truncated string table");
+        }
+        uint32_t len = get_u32(data_ + pos);
+        pos += 4;
+        if (pos + len > table_end) {
+            return fail("truncated string table");
+        }
+        strings_.emplace_back(reinterpret_cast<const char*>(data_ + pos), len);
+        pos += len;
+    }
+    return true;
+}
+
+Record Reader::record(uint64_t index) const {
+    return decode_record(data_ + kHeaderSize + index * kRecordSize);
+}
+
+BlasRecord Reader::blas_record(uint64_t index) const {
+    uint32_t ids[3];
+    BlasRecord record = decode_blas_record(data_ + kHeaderSize + index * kRecordSize, ids);
+    record.call.function = std::string(string(ids[0]));
+    set_datatypes(record.call, string(ids[1]));
+    record.call.compute_type = std::string(string(ids[2]));
+    return record;
+}
+
+CounterValue Reader::counter_value(uint64_t index) const {
+    return decode_counter_value(data_ + kHeaderSize + index * kRecordSize);
+}
+
+std::string_view Reader::string(uint32_t id) const {
+    if (id < strings_.size()) {
+        return strings_[id];
+    }
+    return "<unknown>";
+}
+
+// ---------------------------------------------------------------------------
+// CSV expansion
+// ---------------------------------------------------------------------------
+
+namespace {
+    // Kernel name of a dispatch record, demangled once per string for
+    // kFlagMangledNames traces
+    class KernelNames {
+    public:
+        explicit KernelNames(const Reader& reader)
+            : reader_(reader),
+              names_((reader.flags() & kFlagMangledNames) ? reader.string_count() : 0),
+              demangled_(names_.size(), false) {}
+
+        std::string_view operator()(uint32_t id) {
+            std::string_view text = reader_.string(id);
+            if (id >= names_.size() || id == kUnknownStringId) {
+                return text;
+            }
+            if (!demangled_[id]) {
+                names_[id] = demangle_symbol(text);
+                demangled_[id] = true;
+            }
+            return names_[id];
+        }
+
+    private:
+        const Reader& reader_;
+        std::vector<std::string> names_;
+        std::vector<bool> demangled_;
+    };
+}
+
+namespace {
+    // BLAS call of dispatch record i. The tracer writes a dispatch's
+    // annotation and BLAS call right after it (after its counter values in
+    // a joined trace).
+    bool find_blas_call(const Reader& reader, uint64_t i, BlasRecord& blas) {
+        const uint64_t dispatch_id = reader.record(i).dispatch.dispatch_id;
+        for (uint64_t j = i + 1; j < reader.record_count(); j++) {
+            Record next = reader.record(j);
+            if (next.kind == kRecordDispatch) {
+                break;
+            }
+            if (next.kind == kRecordBlasCall) {
+                blas = reader.blas_record(j);
+                return blas.dispatch_id == dispatch_id;
+            }
+        }
+        return false;
+    }
+}
+
+void write_csv(const Reader& reader, FILE* out) {
+    const bool blas_columns = (reader.flags() & kFlagBlasColumns) != 0;
+    fputs(csv_header(blas_columns).c_str(), out);
+
+    const uint64_t tracer_start = reader.tracer_start_ns();
+    KernelNames kernel_name(reader);
+    RecordBuffer buffer;
+    for (uint64_t i = 0; i < reader.record_count(); i++) {
+        Record record = reader.record(i);
+        std::string_view text = reader.string(record.string_id);
+
+        if (record.kind == kRecordAnnotation) {
+            fprintf(out, "# %.*s\n", (int)text.size(), text.data());
+            continue;
+        }
+        if (record.kind != kRecordDispatch) {
+            // BLAS calls are folded into their dispatch row; counter values
+            // go to write_counter_csv; unknown kinds are skipped
+            continue;
+        }
+        text = kernel_name(record.string_id);
+
+        buffer.clear();
+        if (!blas_columns) {
+            format_csv_row(buffer, text, record.dispatch, tracer_start);
+        } else {
+            BlasRecord blas;
+            const bool found = find_blas_call(reader, i, blas);
+            format_csv_fields(buffer, text, record.dispatch, tracer_start);
+            const BlasWork work = found && blas_one_kernel(blas.call) ? blas_work(blas.call) : BlasWork();
+            const uint64_t duration_ns = record.dispatch.duration_ns();
+            format_csv_blas_columns(buffer, found ? &blas.call : nullptr,
+                                    achieved_tflops(work, duration_ns), achieved_gbps(work, duration_ns));
+        }
+        fwrite(buffer.data(), 1, buffer.size(), out);
+    }
+}
+
+std::vector<uint32_t> counter_columns(const Reader& reader) {
+    std::vector<uint32_t> declared;
+    std::vector<uint32_t> seen;
+    for (uint64_t i = 0; i < reader.record_count(); i++) {
+        const uint16_t kind = reader.record(i).kind;
+        if (kind != kRecordCounter && kind != kRecordCounterColumn) {
+            continue;
+        }
+        std::vector<uint32_t>& names = (kind == kRecordCounterColumn) ? declared : seen;
+        const uint32_t name_id = reader.counter_value(i).name_id;
+        if (std::find(names.begin(), names.end(), name_id) == names.end()) {
+            names.push_back(name_id);
+        }
+    }
+    return declared.empty() ? seen : declared;
+}
+
+namespace {
+    // Counter columns of a trace by name id, in output order
+    struct CounterColumns {
+        std::vector<std::string> names;
+        std::unordered_map<uint32_t, size_t> index;
+
+        explicit CounterColumns(const Reader& reader) {
+            for (uint32_t name_id : counter_columns(reader)) {
+                index.emplace(name_id, names.size());
+                names.emplace_back(reader.string(name_id));
+            }
+        }
+    };
+
+    // Counter values of dispatch record i, summed into row. The tracer
+    // writes them after the dispatch, before the next one; in a timeline
+    // trace a library line (annotation and BLAS call) follows them. Returns
+    // false for a dispatch traced without counters.
+    bool collect_counters(const Reader& reader, uint64_t i, const CounterColumns& columns, CounterRow& row) {
+        const Record record = reader.record(i);
+        row.dispatch = record.dispatch;
+        row.values.assign(columns.names.size(), 0.0);
+        row.instances.assign(columns.names.size(), 0);
+        bool counted = false;
+        for (uint64_t j = i + 1; j < reader.record_count(); j++) {
+            const uint16_t kind = reader.record(j).kind;
+            if (kind == kRecordDispatch) {
+                break;
+            }
+            if (kind != kRecordCounter) {
+                continue;
+            }
+            CounterValue value = reader.counter_value(j);
+            if (value.dispatch_id != record.dispatch.dispatch_id) {
+                break;
+            }
+            auto column = columns.index.find(value.name_id);
+            if (column == columns.index.end()) {
+                continue;
+            }
+            row.agent_id = value.agent_id;
+            row.values[column->second] += value.value;
+            // Only computable values are written, so a record is a value;
+            // metrics carry no instances
+            row.instances[column->second] += std::max(value.instances, 1u);
+            counted = true;
+        }
+        return counted;
+    }
+}
+
+void write_counter_csv(const Reader& reader, FILE* out) {
+    const CounterColumns columns(reader);
+    fputs(counter_csv_header(columns.names).c_str(), out);
+
+    KernelNames kernel_name(reader);
+    RecordBuffer buffer;
+    CounterRow row;
+    std::vector<double> values;
+    for (uint64_t i = 0; i < reader.record_count(); i++) {
+        Record record = reader.record(i);
+        if (record.kind != kRecordDispatch || !collect_counters(reader, i, columns, row)) {
+            continue;  // Traced without counters
+        }
+        counter_values(row, values);
+        buffer.clear();
+        format_counter_csv_row(buffer, kernel_name(record.string_id), row, values);
+        fwrite(buffer.data(), 1, buffer.size(), out);
+    }
+}
+
+void write_joined_csv(const Reader& reader, FILE* out) {
+    const bool blas_columns = (reader.flags() & kFlagBlasColumns) != 0;
+    const CounterColumns columns(reader);
+    fputs(joined_csv_header(blas_columns, columns.names).c_str(), out);
+
+    const uint64_t tracer_start = reader.tracer_start_ns();
+    KernelNames kernel_name(reader);
+    RecordBuffer buffer;
+    CounterRow row;
+    std::vector<double> values;
+    for (uint64_t i = 0; i < reader.record_count(); i++) {
+        Record record = reader.record(i);
+        if (record.kind == kRecordAnnotation) {
+            std::string_view text = reader.string(record.string_id);
+            fprintf(out, "# %.*s\n", (int)text.size(), text.data());
+            continue;
+        }
+        if (record.kind != kRecordDispatch) {
+            continue;
+        }
+
+        buffer.clear();
+        format_csv_fields(buffer, kernel_name(record.string_id), record.dispatch, tracer_start);
+        if (blas_columns) {
+            BlasRecord blas;
+            const bool found = find_blas_call(reader, i, blas);
+            const BlasWork work = found && blas_one_kernel(blas.call) ? blas_work(blas.call) : BlasWork();
+            const uint64_t duration_ns = record.dispatch.duration_ns();
+            format_csv_blas_fields(buffer, found ? &blas.call : nullptr,
+                                   achieved_tflops(work, duration_ns), achieved_gbps(work, duration_ns));
+        }
+        if (collect_counters(reader, i, columns, row)) {
+            counter_values(row, values);
+        } else {
+            values.assign(columns.names.size(), NAN);
+        }
+        format_counter_fields(buffer, values);
+        buffer.append('\n');
+        fwrite(buffer.data(), 1, buffer.size(), out);
+    }
+}
+
+} // namespace binary
+} // namespace rpv3
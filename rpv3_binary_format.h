@@ -0,0 +1,204 @@
+// MIT License
+// RPV3 Binary Format - Compact .rpv3 trace files (--format binary)
+//
+// File layout (all integers little-endian):
+//
+//   FileHeader    64 bytes   magic "RPV3BIN\0", version, record size,
+//                            tracer start timestamp, counts (patched at close)
+//   Records       N * 96     fixed-size, one per dispatch, annotation,
+//                            parsed rocBLAS call or counter value
+//   String table  variable   u32 length + bytes, ids assigned in order from 0
+//   FileFooter    32 bytes   magic "RPV3END\0", string table offset and counts
+//
+// Fixed-size records make a trace mmap-able and randomly addressable:
+// record i lives at kHeaderSize + i * kRecordSize. Kernel names and rocBLAS
+// log lines are interned once and referenced by id. The footer is appended
+// at close, so traces written to non-seekable outputs remain readable even
+// though the header counts cannot be patched.
+
+#ifndef RPV3_BINARY_FORMAT_H
+#define RPV3_BINARY_FORMAT_H
+
+#include "rpv3_blas_parser.h"
+#include "rpv3_record.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace rpv3 {
+namespace binary {
+
+constexpr char kFileMagic[8] = {'R', 'P', 'V', '3', 'B', 'I', 'N', '\0'};
+constexpr char kFooterMagic[8] = {'R', 'P', 'V', '3', 'E', 'N', 'D', '\0'};
+constexpr uint16_t kVersion = 1;
+constexpr size_t kHeaderSize = 64;
+constexpr size_t kRecordSize = 96;
+constexpr size_t kFooterSize = 32;
+
+// String id 0 is always "<unknown>"
+constexpr uint32_t kUnknownStringId = 0;
+
+// Header flags
+constexpr uint32_t kFlagMangledNames = 1u << 0;  // Dispatch names are stored mangled
+                                                 // and demangled by the reader
+constexpr uint32_t kFlagBlasColumns = 1u << 1;   // Written with --rocblas; CSV expansion
+                                                 // adds the BLAS columns
+
+enum RecordKind : uint16_t {
+    kRecordDispatch = 1,    // One kernel dispatch (every CSV column)
+    kRecordAnnotation = 2,  // rocBLAS log line attached to the preceding dispatch
+    kRecordBlasCall = 3,    // Typed fields of that line (BlasRecord)
+    kRecordCounter = 4,     // One counter of the preceding dispatch (CounterValue)
+    kRecordCounterColumn = 5,  // Counter column declared at setup, in output
+                               // order (CounterValue with name and flags only)
+};
+
+// CounterValue flags
+constexpr uint32_t kCounterMetric = 1u << 0;  // Computed from counters, not summed
+                                              // from instances (instances is 0)
+
+// Decoded view of one fixed-size record
+struct Record {
+    uint16_t kind = 0;
+    uint32_t string_id = 0;  // Kernel name (dispatch) or log line (annotation)
+    DispatchRecord dispatch;
+};
+
+// Parsed rocBLAS call behind a dispatch. On disk the strings are table ids
+// and dimensions are 32-bit (rocblas_int), saturated if larger.
+struct BlasRecord {
+    uint64_t dispatch_id = 0;
+    BlasCall call;
+};
+
+// Hardware counter collected for a dispatch (--counter), summed across
+// instances. The counter name is a string table id.
+struct CounterValue {
+    uint64_t dispatch_id = 0;
+    uint32_t name_id = 0;
+    uint32_t instances = 0;  // Counter instances summed into value
+    uint32_t flags = 0;      // kCounterMetric
+    uint64_t agent_id = 0;
+    double value = 0.0;
+};
+
+// Encode/decode a record into exactly kRecordSize bytes
+void encode_record(const Record& record, unsigned char* out);
+Record decode_record(const unsigned char* in);
+
+// Producer side used by the tracer. Records are encoded by the caller and
+// handed to whatever sink is active (direct fwrite or the async TraceWriter);
+// this class owns the header, the string table and the footer.
+class Writer {
+public:
+    Writer() = default;
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // Write the file header. Call before any record reaches the stream.
+    bool begin(FILE* out, uint64_t tracer_start_ns, uint32_t flags = 0);
+
+    // Return the id for a string, adding it to the table on first use. Thread-safe.
+    uint32_t intern(std::string_view text);
+
+    // Encode a record and count it
+    void encode(const Record& record, unsigned char* out);
+
+    // Encode a kRecordBlasCall record, interning its strings, and count it
+    void encode(const BlasRecord& record, unsigned char* out);
+
+    // Encode a kRecordCounter record and count it
+    void encode(const CounterValue& record, unsigned char* out);
+
+    // Encode a kRecordCounterColumn record and count it
+    void encode_column(uint32_t name_id, uint32_t flags, unsigned char* out);
+
+    // Append the string table and footer, then patch the header counts if the
+    // stream is seekable. All records must already be written to the stream.
+    bool finish(FILE* out);
+
+    uint64_t record_count() const;
+    size_t string_count() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::vector<const std::string*> strings_;  // Indexed by id, points into ids_
+    uint64_t records_ = 0;
+};
+
+// Read-only view of a .rpv3 file, mmap-backed
+class Reader {
+public:
+    Reader() = default;
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    // Map and validate a file. On failure returns false and sets error().
+    bool open(const char* path);
+    void close();
+
+    const std::string& error() const { return error_; }
+
+    uint16_t version() const { return version_; }
+    uint32_t flags() const { return flags_; }
+    uint64_t tracer_start_ns() const { return tracer_start_ns_; }
+    uint64_t record_count() const { return record_count_; }
+    size_t string_count() const { return strings_.size(); }
+
+    Record record(uint64_t index) const;
+
+    // Record at index, which must be of kind kRecordBlasCall
+    BlasRecord blas_record(uint64_t index) const;
+
+    // Record at index, which must be of kind kRecordCounter or
+    // kRecordCounterColumn
+    CounterValue counter_value(uint64_t index) const;
+    std::string_view string(uint32_t id) const;
+
+private:
+    bool fail(const std::string& message);
+
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+    std::string error_;
+    uint16_t version_ = 0;
+    uint32_t flags_ = 0;
+    uint64_t tracer_start_ns_ = 0;
+    uint64_t record_count_ = 0;
+    std::vector<std::string_view> strings_;
+};
+
+// Expand a binary trace to the CSV schema written by --csv, byte for byte.
+// Kernel names of kFlagMangledNames traces are demangled once per string.
+// kFlagBlasColumns traces get the BLAS columns, filled from the
+// kRecordBlasCall record that follows each rocBLAS dispatch.
+void write_csv(const Reader& reader, FILE* out);
+
+// Counter column names of a trace: the declared kRecordCounterColumn list,
+// or, for traces written without one, names in order of first appearance
+std::vector<uint32_t> counter_columns(const Reader& reader);
+
+// Expand the counter rows of a --counter trace to the CSV written by
+// --csv --counter: one row per dispatch, one column per counter name.
+void write_counter_csv(const Reader& reader, FILE* out);
+
+// Expand a --timeline trace with counters to the CSV written by --timeline
+// --csv with counters: each dispatch row (with the BLAS columns for
+// kFlagBlasColumns traces) followed by its counter columns, empty when the
+// dispatch was not counted, and rocBLAS lines as "# " lines.
+void write_joined_csv(const Reader& reader, FILE* out);
+
+} // namespace binary
+} // namespace rpv3
+
+#endif // RPV3_BINARY_FORMAT_H
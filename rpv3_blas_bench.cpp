@@ -0,0 +1,182 @@
+// MIT License
+// RPV3 BLAS Bench - Implementation
+// See rpv3_blas_bench.h for the output format
+
+#include "rpv3_blas_bench.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace rpv3 {
+
+namespace {
+
+// One argument, spelled as a rocblas-bench flag and as a YAML key
+struct BenchArg {
+    const char* flag;
+    const char* key;
+    std::string value;
+    bool text;  // Quoted in YAML
+};
+
+std::string number(int64_t value) {
+    return std::to_string(value);
+}
+
+std::string number(double value) {
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    return std::string(digits, result.ptr - digits);
+}
+
+bool is_typed(const BlasCall& call) {
+    return call.function.size() > 3 && call.function.compare(call.function.size() - 3, 3, "_ex") == 0;
+}
+
+// Precision prefix of the non-_ex routine name ("f32_r" -> 's')
+char precision_prefix(const std::string& precision) {
+    for (char prefix : {'h', 's', 'd', 'c', 'z'}) {
+        if (blas_precision_name(prefix) == precision) {
+            return prefix;
+        }
+    }
+    return 0;
+}
+
+std::vector<BenchArg> bench_args(const BlasCall& call) {
+    std::vector<BenchArg> args;
+    const bool typed = is_typed(call);
+    const bool gemv = call.family == BlasFamily::Gemv;
+    auto add = [&](const char* flag, const char* key, std::string value) {
+        args.push_back({flag, key, std::move(value), true});
+    };
+    auto add_flag = [&](const char* flag, const char* key, char value) {
+        if (value) {
+            add(flag, key, std::string(1, value));
+        }
+    };
+    auto add_int = [&](const char* flag, const char* key, int64_t value) {
+        if (value != kBlasNone) {
+            args.push_back({flag, key, number(value), false});
+        }
+    };
+    auto add_scalar = [&](const char* flag, const char* key, double value) {
+        if (!std::isnan(value)) {
+            args.push_back({flag, key, number(value), false});
+        }
+    };
+
+    if (typed) {
+        add("--a_type", "a_type", call.precision);
+        add("--b_type", "b_type", call.b_type);
+        add("--c_type", "c_type", call.c_type);
+        add("--d_type", "d_type", call.d_type);
+        add("--compute_type", "compute_type", call.compute_type);
+    } else {
+        add("-r", "a_type", call.precision);
+    }
+    add_flag("--side", "side", call.side);
+    add_flag("--uplo", "uplo", call.uplo);
+    add_flag("--transposeA", "transA", call.trans_a);
+    add_flag("--transposeB", "transB", call.trans_b);
+    add_flag("--diag", "diag", call.diag);
+    add_int("-m", "M", call.m);
+    add_int("-n", "N", call.n);
+    add_int("-k", "K", call.k);
+    add_scalar("--alpha", "alpha", call.alpha);
+    add_int("--lda", "lda", call.lda);
+    add_int("--stride_a", "stride_a", call.stride_a);
+    add_int(gemv ? "--incx" : "--ldb", gemv ? "incx" : "ldb", call.ldb);
+    add_int("--stride_b", "stride_b", call.stride_b);
+    add_scalar("--beta", "beta", call.beta);
+    add_int(gemv ? "--incy" : "--ldc", gemv ? "incy" : "ldc", call.ldc);
+    add_int("--stride_c", "stride_c", call.stride_c);
+    if (typed) {
+        // rocBLAS does not log D separately; rocblas-bench needs it
+        add_int("--ldd", "ldd", call.ldc);
+        add_int("--stride_d", "stride_d", call.stride_c);
+    }
+    if (call.function.find("batched") != std::string::npos) {
+        add_int("--batch_count", "batch_count", call.batch_count);
+    }
+    return args;
+}
+
+} // namespace
+
+std::string bench_command(const BlasCall& call) {
+    std::string command = "rocblas-bench -f " + call.function;
+    for (const BenchArg& arg : bench_args(call)) {
+        command.append(" ").append(arg.flag).append(" ").append(arg.value);
+    }
+    return command;
+}
+
+std::string bench_yaml(const BlasCall& call) {
+    std::string function = "rocblas_";
+    const char prefix = is_typed(call) ? 0 : precision_prefix(call.precision);
+    if (prefix) {
+        function += prefix;
+    }
+    function += call.function;
+
+    std::string yaml = "{ rocblas_function: \"" + function + "\"";
+    for (const BenchArg& arg : bench_args(call)) {
+        yaml.append(", ").append(arg.key).append(": ");
+        if (arg.text) {
+            yaml.append("\"").append(arg.value).append("\"");
+        } else {
+            yaml.append(arg.value);
+        }
+    }
+    yaml += " }";
+    return yaml;
+}
+
+void BlasBenchTable::record(const BlasCall& call, uint64_t duration_ns) {
+    if (!blas_one_kernel(call)) {
+        return;
+    }
+    std::string command = bench_command(call);
+    auto it = index_.find(command);
+    if (it == index_.end()) {
+        it = index_.emplace(command, rows_.size()).first;
+        BenchRow row;
+        row.command = std::move(command);
+        row.call = call;
+        rows_.push_back(std::move(row));
+    }
+    BenchRow& row = rows_[it->second];
+    row.count++;
+    row.total_ns += duration_ns;
+}
+
+std::vector<BenchRow> BlasBenchTable::rows() const {
+    std::vector<BenchRow> rows = rows_;
+    std::stable_sort(rows.begin(), rows.end(), [](const BenchRow& a, const BenchRow& b) {
+        return a.total_ns > b.total_ns;
+    });
+    return rows;
+}
+
+bool write_bench_yaml(FILE* out, const std::vector<BenchRow>& rows) {
+    uint64_t total_ns = 0;
+    for (const BenchRow& row : rows) {
+        total_ns += row.total_ns;
+    }
+    fprintf(out, "# rocblas-bench reproducers written by RPV3: %zu distinct calls, most GPU time first\n", rows.size());
+    fprintf(out, "# Run all with: rocblas-bench --yaml <this file>\n");
+    size_t rank = 0;
+    for (const BenchRow& row : rows) {
+        const double share = total_ns ? 100.0 * row.total_ns / total_ns : 0.0;
+        fprintf(out, "\n# %zu. %lu calls, %.3f ms GPU time (%.1f%%), %.3f us mean\n", ++rank,
+                (unsigned long)row.count, row.total_ns / 1e6, share,
+                row.count ? row.total_ns / 1e3 / row.count : 0.0);
+        fprintf(out, "#    %s\n", row.command.c_str());
+        fprintf(out, "- %s\n", bench_yaml(row.call).c_str());
+    }
+    return ferror(out) == 0;
+}
+
+} // namespace rpv3
@@ -0,0 +1,63 @@
+// MIT License
+// RPV3 BLAS Bench - rocblas-bench reproducers for the hottest rocBLAS calls
+//
+// Correlated rocBLAS calls are deduplicated by their full rocblas-bench
+// argument list and ranked by total GPU time. The result is a YAML file that
+// `rocblas-bench --yaml <file>` runs as is; a comment above each entry gives
+// the call count, the GPU time and the equivalent command line, so single
+// calls can be pasted into a shell.
+//
+// _ex routines reproduce the logged a_type, b_type, c_type and d_type, so
+// mixed-precision calls run as traced. Scalars logged as device pointers are
+// left out and rocblas-bench falls back to its defaults (alpha 1, beta 0).
+
+#ifndef RPV3_BLAS_BENCH_H
+#define RPV3_BLAS_BENCH_H
+
+#include "rpv3_blas_parser.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rpv3 {
+
+// rocblas-bench command line for a call, e.g.
+// "rocblas-bench -f gemm -r f32_r --transposeA N --transposeB T -m 1024 ..."
+std::string bench_command(const BlasCall& call);
+
+// One rocblas-bench YAML entry (without the leading "- ")
+std::string bench_yaml(const BlasCall& call);
+
+struct BenchRow {
+    std::string command;
+    BlasCall call;
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+};
+
+// Not thread-safe; fed from the correlator sink like BlasEfficiencyTable
+class BlasBenchTable {
+public:
+    // Calls that run several kernels (blas_one_kernel) are ignored; their
+    // dispatches would each count as a call
+    void record(const BlasCall& call, uint64_t duration_ns);
+
+    // Distinct calls, most total GPU time first
+    std::vector<BenchRow> rows() const;
+
+    size_t size() const { return rows_.size(); }
+
+private:
+    std::unordered_map<std::string, size_t> index_;  // Command -> rows_ slot
+    std::vector<BenchRow> rows_;
+};
+
+// Write the reproducer YAML. Returns false on a write error.
+bool write_bench_yaml(FILE* out, const std::vector<BenchRow>& rows);
+
+} // namespace rpv3
+
+#endif // RPV3_BLAS_BENCH_H
@@ -0,0 +1,271 @@
+// MIT License
+// RPV3 BLAS Parser - Implementation
+// See rpv3_blas_parser.h for the supported log formats
+
+#include "rpv3_blas_parser.h"
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+namespace rpv3 {
+
+namespace {
+
+constexpr size_t kMaxFields = 32;
+
+// Field positions in the trace layer, from rocBLAS' log_trace() calls. -1 marks
+// a field the routine does not log.
+struct TraceLayout {
+    const char* function;  // Without prefix or precision
+    bool typed;            // _ex routines log explicit datatypes instead of a precision prefix
+    BlasFamily family;
+    int trans_a, trans_b, side, uplo, diag;
+    int m, n, k, alpha, lda, stride_a, ldb, stride_b, beta, ldc, stride_c, batch_count;
+    int a_type, b_type, c_type, d_type, compute_type;
+};
+
+constexpr TraceLayout kTraceLayouts[] = {
+    // function                 typed  family             tA tB  sd  up  dg   m  n  k  al lda sA ldb sB  be ldc sC  bc  aT  bT  cT  dT  ct
+    {"gemm",                    false, BlasFamily::Gemm,   1, 2, -1, -1, -1,  3, 4, 5, 6,  8, -1, 10, -1, 11, 13, -1, -1, -1, -1, -1, -1, -1},
+    {"gemm_batched",            false, BlasFamily::Gemm,   1, 2, -1, -1, -1,  3, 4, 5, 6,  8, -1, 10, -1, 11, 13, -1, 14, -1, -1, -1, -1, -1},
+    {"gemm_strided_batched",    false, BlasFamily::Gemm,   1, 2, -1, -1, -1,  3, 4, 5, 6,  8,  9, 11, 12, 13, 15, 16, 17, -1, -1, -1, -1, -1},
+    {"gemm_ex",                 true,  BlasFamily::Gemm,   1, 2, -1, -1, -1,  3, 4, 5, 6,  9, -1, 12, -1, 13, 16, -1, -1,  8, 11, 15, 18, 20},
+    {"gemm_batched_ex",         true,  BlasFamily::Gemm,   1, 2, -1, -1, -1,  3, 4, 5, 6,  9, -1, 12, -1, 13, 16, -1, 20,  8, 11, 15, 18, 21},
+    {"gemm_strided_batched_ex", true,  BlasFamily::Gemm,   1, 2, -1, -1, -1,  3, 4, 5, 6,  9, 10, 13, 14, 15, 18, 19, 24,  8, 12, 17, 21, 25},
+    {"trsm",                    false, BlasFamily::Trsm,   3, -1, 1,  2,  4,  5, 6, -1, 7, 9, -1, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {"gemv",                    false, BlasFamily::Gemv,   1, -1, -1, -1, -1, 2, 3, -1, 4, 6, -1,  8, -1,  9, 11, -1, -1, -1, -1, -1, -1, -1},
+};
+
+const TraceLayout* find_layout(std::string_view function) {
+    for (const TraceLayout& layout : kTraceLayouts) {
+        if (function == layout.function) {
+            return &layout;
+        }
+    }
+    return nullptr;
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool parse_int(std::string_view text, int64_t& value) {
+    text = trim(text);
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Scalars are logged as plain numbers in host pointer mode and as
+// addresses in device pointer mode; only the former have a value
+bool parse_scalar(std::string_view text, double& value) {
+    text = trim(text);
+    if (text.empty() || text.size() > 63 || text.substr(0, 2) == "0x") {
+        return false;
+    }
+    char buffer[64];
+    memcpy(buffer, text.data(), text.size());
+    buffer[text.size()] = '\0';
+    char* end = nullptr;
+    double parsed = strtod(buffer, &end);
+    if (end != buffer + text.size()) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+char parse_flag(std::string_view text) {
+    text = trim(text);
+    return text.size() == 1 ? text[0] : 0;
+}
+
+std::string precision_from(std::string_view text) {
+    text = trim(text);
+    if (text.size() == 1) {
+        std::string_view name = blas_precision_name(text[0]);
+        if (!name.empty()) {
+            return std::string(name);
+        }
+    }
+    return std::string(text);
+}
+
+bool parse_trace(std::string_view line, BlasCall& call) {
+    std::string_view fields[kMaxFields];
+    size_t count = 0;
+    while (count < kMaxFields) {
+        size_t comma = line.find(',');
+        fields[count++] = line.substr(0, comma);
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        line.remove_prefix(comma + 1);
+    }
+
+    std::string_view routine = trim(fields[0]).substr(strlen("rocblas_"));
+    const TraceLayout* layout = find_layout(routine);
+    char prefix = 0;
+    if (!layout && routine.size() > 1) {
+        prefix = routine[0];
+        layout = find_layout(routine.substr(1));
+        if (layout && (layout->typed || blas_precision_name(prefix).empty())) {
+            layout = nullptr;
+        }
+    }
+    if (!layout) {
+        return false;
+    }
+
+    auto field = [&](int index) -> std::string_view {
+        return (index >= 0 && (size_t)index < count) ? fields[index] : std::string_view();
+    };
+    auto int_field = [&](int index, int64_t& value) {
+        return index < 0 || parse_int(field(index), value);
+    };
+
+    BlasCall parsed;
+    parsed.family = layout->family;
+    parsed.function = layout->function;
+    parsed.precision = layout->typed ? precision_from(field(layout->a_type)) : std::string(blas_precision_name(prefix));
+    parsed.b_type = layout->typed ? precision_from(field(layout->b_type)) : parsed.precision;
+    parsed.c_type = layout->typed ? precision_from(field(layout->c_type)) : parsed.precision;
+    parsed.d_type = layout->typed ? precision_from(field(layout->d_type)) : parsed.precision;
+    parsed.compute_type = layout->typed ? precision_from(field(layout->compute_type)) : parsed.precision;
+    parsed.trans_a = layout->trans_a >= 0 ? parse_flag(field(layout->trans_a)) : 0;
+    parsed.trans_b = layout->trans_b >= 0 ? parse_flag(field(layout->trans_b)) : 0;
+    parsed.side = layout->side >= 0 ? parse_flag(field(layout->side)) : 0;
+    parsed.uplo = layout->uplo >= 0 ? parse_flag(field(layout->uplo)) : 0;
+    parsed.diag = layout->diag >= 0 ? parse_flag(field(layout->diag)) : 0;
+
+    // Dimensions and leading dimensions are required; a line that does not
+    // have them where the layout says is some other format
+    if (!int_field(layout->m, parsed.m) || !int_field(layout->n, parsed.n) ||
+        !int_field(layout->k, parsed.k) || !int_field(layout->lda, parsed.lda) ||
+        !int_field(layout->ldb, parsed.ldb) || !int_field(layout->ldc, parsed.ldc) ||
+        !int_field(layout->stride_a, parsed.stride_a) || !int_field(layout->stride_b, parsed.stride_b) ||
+        !int_field(layout->stride_c, parsed.stride_c) || !int_field(layout->batch_count, parsed.batch_count)) {
+        return false;
+    }
+    if (layout->alpha >= 0) {
+        parse_scalar(field(layout->alpha), parsed.alpha);
+    }
+    if (layout->beta >= 0) {
+        parse_scalar(field(layout->beta), parsed.beta);
+    }
+    call = std::move(parsed);
+    return true;
+}
+
+bool parse_bench(std::string_view line, BlasCall& call) {
+    std::string_view tokens[2 * kMaxFields];
+    size_t count = 0;
+    while (count < 2 * kMaxFields) {
+        line = trim(line);
+        if (line.empty()) {
+            break;
+        }
+        size_t space = line.find_first_of(" \t");
+        tokens[count++] = line.substr(0, space);
+        if (space == std::string_view::npos) {
+            break;
+        }
+        line.remove_prefix(space);
+    }
+
+    BlasCall parsed;
+    std::string_view function;
+    std::string_view precision;
+    std::string_view a_type;
+    std::string_view b_type;
+    std::string_view c_type;
+    std::string_view d_type;
+    std::string_view compute_type;
+    for (size_t i = 1; i + 1 < count; i++) {
+        std::string_view key = tokens[i];
+        std::string_view value = tokens[i + 1];
+        if (key.empty() || key[0] != '-') {
+            continue;
+        }
+        i++;  // Every argument we read takes a value
+        bool ok = true;
+        if (key == "-f" || key == "--function") function = value;
+        else if (key == "-r" || key == "--precision") precision = value;
+        else if (key == "--a_type") a_type = value;
+        else if (key == "--b_type") b_type = value;
+        else if (key == "--c_type") c_type = value;
+        else if (key == "--d_type") d_type = value;
+        else if (key == "--compute_type") compute_type = value;
+        else if (key == "--transposeA") parsed.trans_a = parse_flag(value);
+        else if (key == "--transposeB") parsed.trans_b = parse_flag(value);
+        else if (key == "--side") parsed.side = parse_flag(value);
+        else if (key == "--uplo") parsed.uplo = parse_flag(value);
+        else if (key == "--diag") parsed.diag = parse_flag(value);
+        else if (key == "-m") ok = parse_int(value, parsed.m);
+        else if (key == "-n") ok = parse_int(value, parsed.n);
+        else if (key == "-k") ok = parse_int(value, parsed.k);
+        else if (key == "--lda") ok = parse_int(value, parsed.lda);
+        else if (key == "--ldb" || key == "--incx") ok = parse_int(value, parsed.ldb);
+        else if (key == "--ldc" || key == "--incy") ok = parse_int(value, parsed.ldc);
+        else if (key == "--stride_a") ok = parse_int(value, parsed.stride_a);
+        else if (key == "--stride_b") ok = parse_int(value, parsed.stride_b);
+        else if (key == "--stride_c") ok = parse_int(value, parsed.stride_c);
+        else if (key == "--batch_count") ok = parse_int(value, parsed.batch_count);
+        else if (key == "--alpha") parse_scalar(value, parsed.alpha);
+        else if (key == "--beta") parse_scalar(value, parsed.beta);
+        else i--;  // Unknown flag; it may not take a value
+        if (!ok) {
+            return false;
+        }
+    }
+
+    const TraceLayout* layout = find_layout(function);
+    if (!layout || parsed.m < 0 || parsed.n < 0 || (layout->family == BlasFamily::Gemm && parsed.k < 0)) {
+        return false;
+    }
+    parsed.family = layout->family;
+    parsed.function = layout->function;
+    parsed.precision = precision_from(a_type.empty() ? precision : a_type);
+    parsed.b_type = b_type.empty() ? parsed.precision : precision_from(b_type);
+    parsed.c_type = c_type.empty() ? parsed.precision : precision_from(c_type);
+    parsed.d_type = d_type.empty() ? parsed.c_type : precision_from(d_type);
+    parsed.compute_type = compute_type.empty() ? parsed.precision : precision_from(compute_type);
+    call = std::move(parsed);
+    return true;
+}
+
+} // namespace
+
+std::string_view blas_precision_name(char prefix) {
+    switch (prefix) {
+        case 'h': return "f16_r";
+        case 's': return "f32_r";
+        case 'd': return "f64_r";
+        case 'c': return "f32_c";
+        case 'z': return "f64_c";
+        default: return {};
+    }
+}
+
+bool parse_blas_call(std::string_view line, BlasCall& call) {
+    line = trim(line);
+    if (!line.empty() && line[0] == '#') {
+        line = trim(line.substr(1));
+    }
+    if (line.substr(0, strlen("rocblas_")) == "rocblas_") {
+        return parse_trace(line, call);
+    }
+    size_t bench = line.find("rocblas-bench");
+    if (bench != std::string_view::npos) {
+        return parse_bench(line.substr(bench), call);
+    }
+    return false;
+}
+
+} // namespace rpv3
@@ -0,0 +1,81 @@
+// MIT License
+// RPV3 BLAS Parser - Typed fields from rocBLAS log lines (--rocblas)
+//
+// Understands both rocBLAS log layers:
+//
+//   trace (ROCBLAS_LAYER=1)  rocblas_sgemm,N,T,1024,512,256,1,0x7f..,1024,...
+//                            positional, pointers included; the layout
+//                            depends on the routine
+//   bench (ROCBLAS_LAYER=2)  ./rocblas-bench -f gemm -r f32_r --transposeA N
+//                            -m 1024 ...; named arguments in any order
+//
+// for the gemm family (plain, batched, strided_batched and their _ex
+// variants), trsm and gemv. Both spellings normalize to the same BlasCall,
+// so a trace can be grouped by shape without looking at the text again.
+// Parsing allocates only for the string fields and never throws.
+
+#ifndef RPV3_BLAS_PARSER_H
+#define RPV3_BLAS_PARSER_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace rpv3 {
+
+enum class BlasFamily : uint8_t {
+    Unknown = 0,
+    Gemm,  // Every gemm variant; batched ones set batch_count
+    Trsm,
+    Gemv,
+};
+
+// Field value for dimensions a routine does not have (e.g. K for gemv)
+constexpr int64_t kBlasNone = -1;
+
+struct BlasCall {
+    BlasFamily family = BlasFamily::Unknown;
+    std::string function;      // Routine without prefix or precision: "gemm_strided_batched_ex"
+    std::string precision;     // rocBLAS datatype of A: "f32_r", "f16_r", "f64_c", ...
+    std::string b_type;        // Datatypes of B, C and D for _ex routines, which may
+    std::string c_type;        // differ from A's (i8_r inputs with i32_r output);
+    std::string d_type;        // the precision otherwise
+    std::string compute_type;  // _ex routines; the precision otherwise
+    char trans_a = 0;          // 'N', 'T' or 'C'; 0 when the routine has none
+    char trans_b = 0;
+    char side = 0;             // trsm only: 'L' or 'R'
+    char uplo = 0;             // trsm only: 'U' or 'L'
+    char diag = 0;             // trsm only: 'N' or 'U'
+    int64_t m = kBlasNone;
+    int64_t n = kBlasNone;
+    int64_t k = kBlasNone;
+    int64_t lda = kBlasNone;
+    int64_t ldb = kBlasNone;   // incx for gemv
+    int64_t ldc = kBlasNone;   // incy for gemv
+    int64_t stride_a = kBlasNone;
+    int64_t stride_b = kBlasNone;
+    int64_t stride_c = kBlasNone;
+    int64_t batch_count = 1;
+    // NaN when logged as a device pointer
+    double alpha = std::numeric_limits<double>::quiet_NaN();
+    double beta = std::numeric_limits<double>::quiet_NaN();
+};
+
+// True for routines that run one kernel per call, the gemm family. A trsm
+// runs several Tensile gemms, so a dispatch does an unknown part of its
+// work and per-dispatch rates and call counts do not apply.
+inline bool blas_one_kernel(const BlasCall& call) {
+    return call.family == BlasFamily::Gemm;
+}
+
+// Parse one log line (with or without a leading "# "). Returns false for
+// routines outside the supported set and for malformed lines.
+bool parse_blas_call(std::string_view line, BlasCall& call);
+
+// rocBLAS datatype for a precision prefix: 's' -> "f32_r", 'z' -> "f64_c"
+std::string_view blas_precision_name(char prefix);
+
+} // namespace rpv3
+
+#endif // RPV3_BLAS_PARSER_H
@@ -0,0 +1,232 @@
+// MIT License
+// RPV3 BLAS Perf - Implementation
+// See rpv3_blas_perf.h for what is counted
+
+#include "rpv3_blas_perf.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rpv3 {
+
+namespace {
+
+struct Datatype {
+    const char* name;
+    size_t bytes;
+};
+
+constexpr Datatype kDatatypes[] = {
+    {"f16_r", 2}, {"bf16_r", 2}, {"f32_r", 4}, {"f64_r", 8},
+    {"f16_c", 4}, {"bf16_c", 4}, {"f32_c", 8}, {"f64_c", 16},
+    {"i8_r", 1},  {"u8_r", 1},   {"i32_r", 4}, {"u32_r", 4},
+    {"f8_r", 1},  {"bf8_r", 1},
+};
+
+bool is_complex(std::string_view datatype) {
+    return datatype.size() > 2 && datatype.substr(datatype.size() - 2) == "_c";
+}
+
+// Dense FLOPs (integer ops for i8) per CU per clock, from the CDNA ISA
+// guides' matrix-core rates; FP64 on gfx908 has vector units only
+struct TargetRates {
+    const char* target;
+    double f64, f32, f16, bf16, i8, f8;
+};
+
+constexpr TargetRates kTargetRates[] = {
+    //          f64   f32    f16   bf16    i8    f8
+    {"gfx908",   64, 256, 1024,  512, 1024,    0},
+    {"gfx90a",  256, 256, 1024, 1024, 1024,    0},
+    {"gfx940",  256, 256, 2048, 2048, 4096, 4096},
+    {"gfx941",  256, 256, 2048, 2048, 4096, 4096},
+    {"gfx942",  256, 256, 2048, 2048, 4096, 4096},
+    {"gfx950",  128, 256, 4096, 4096, 8192, 8192},
+};
+
+double flops_per_cu_clock(const TargetRates& rates, std::string_view datatype) {
+    // Complex types run on the units of their real part
+    const std::string_view base = datatype.substr(0, datatype.find('_'));
+    if (base == "f64") return rates.f64;
+    if (base == "f32") return rates.f32;
+    if (base == "f16") return rates.f16;
+    if (base == "bf16") return rates.bf16;
+    if (base == "i8") return rates.i8;
+    if (base == "f8" || base == "bf8") return rates.f8;
+    return 0.0;
+}
+
+// A scaled C (or y) has to be read as well as written
+bool reads_output(double beta) {
+    return !std::isnan(beta) && beta != 0.0;
+}
+
+} // namespace
+
+size_t blas_element_bytes(std::string_view datatype) {
+    for (const Datatype& type : kDatatypes) {
+        if (datatype == type.name) {
+            return type.bytes;
+        }
+    }
+    return 0;
+}
+
+BlasWork blas_work(const BlasCall& call) {
+    BlasWork work;
+    const double element = (double)blas_element_bytes(call.precision);
+    if (element == 0.0 || call.m < 0 || call.n < 0) {
+        return work;
+    }
+    // One complex multiply-add is four real ones
+    const double ops = is_complex(call.precision) ? 8.0 : 2.0;
+    const double m = (double)call.m;
+    const double n = (double)call.n;
+
+    switch (call.family) {
+        case BlasFamily::Gemm: {
+            if (call.k < 0) {
+                return work;
+            }
+            // _ex routines may use a wider C; the estimate stays with A's type
+            const double k = (double)call.k;
+            const double batch = (double)std::max<int64_t>(call.batch_count, 1);
+            work.flops = ops * m * n * k * batch;
+            work.bytes = (m * k + k * n + m * n * (reads_output(call.beta) ? 2.0 : 1.0)) * element * batch;
+            break;
+        }
+        case BlasFamily::Trsm: {
+            // Triangular A is M x M on the left, N x N on the right; B is overwritten
+            const double order = (call.side == 'R' || call.side == 'r') ? n : m;
+            work.flops = ops / 2.0 * order * m * n;
+            work.bytes = (order * (order + 1.0) / 2.0 + 2.0 * m * n) * element;
+            break;
+        }
+        case BlasFamily::Gemv: {
+            const bool transposed = call.trans_a != 'N' && call.trans_a != 'n';
+            const double x = transposed ? m : n;
+            const double y = transposed ? n : m;
+            work.flops = ops * m * n;
+            work.bytes = (m * n + x + y * (reads_output(call.beta) ? 2.0 : 1.0)) * element;
+            break;
+        }
+        default:
+            break;
+    }
+    return work;
+}
+
+double estimate_peak_tflops(std::string_view target, std::string_view datatype, uint32_t cu_count,
+                            uint32_t clock_mhz) {
+    // Agents may report feature suffixes: "gfx90a:sramecc+:xnack-"
+    target = target.substr(0, target.find(':'));
+    for (const TargetRates& rates : kTargetRates) {
+        if (target == rates.target) {
+            return flops_per_cu_clock(rates, datatype) * cu_count * clock_mhz / 1e6;
+        }
+    }
+    return 0.0;
+}
+
+double BlasPeak::tflops_for(std::string_view datatype) const {
+    return tflops > 0.0 ? tflops : estimate_peak_tflops(target, datatype, cu_count, clock_mhz);
+}
+
+void BlasEfficiencyTable::record(const BlasCall& call, uint64_t duration_ns) {
+    if (!blas_one_kernel(call)) {
+        return;
+    }
+    const BlasWork work = blas_work(call);
+    if (work.flops <= 0.0 || duration_ns == 0) {
+        return;
+    }
+    const double tflops = achieved_tflops(work, duration_ns);
+
+    Shape& shape = shapes_[Key(call.function, call.precision, call.m, call.n, call.k)];
+    if (shape.count == 0 || tflops < shape.min_tflops) {
+        shape.min_tflops = tflops;
+    }
+    shape.max_tflops = std::max(shape.max_tflops, tflops);
+    shape.count++;
+    shape.total_ns += duration_ns;
+    shape.total_flops += work.flops;
+    shape.total_bytes += work.bytes;
+    shape.mflops->record((uint64_t)std::llround(tflops * 1e6));
+}
+
+std::vector<BlasShapeRow> BlasEfficiencyTable::rows() const {
+    std::vector<BlasShapeRow> rows;
+    rows.reserve(shapes_.size());
+    for (const auto& [key, shape] : shapes_) {
+        BlasShapeRow row;
+        std::tie(row.function, row.precision, row.m, row.n, row.k) = key;
+        row.count = shape.count;
+        row.total_ns = shape.total_ns;
+        row.total_flops = shape.total_flops;
+        row.total_bytes = shape.total_bytes;
+        row.min_tflops = shape.min_tflops;
+        row.max_tflops = shape.max_tflops;
+        // The bucket bound can overshoot the exact range by a bucket width
+        row.median_tflops = std::clamp(shape.mflops->percentile(0.5) / 1e6, row.min_tflops, row.max_tflops);
+        rows.push_back(std::move(row));
+    }
+    std::sort(rows.begin(), rows.end(), [](const BlasShapeRow& a, const BlasShapeRow& b) {
+        return a.total_ns > b.total_ns;
+    });
+    return rows;
+}
+
+void print_blas_efficiency(FILE* out, const std::vector<BlasShapeRow>& rows, const BlasPeak& peak) {
+    const bool estimated = peak.tflops <= 0.0 && !peak.target.empty();
+    const bool percent = peak.tflops > 0.0 || estimated;
+    fprintf(out, "\n[BLAS Efficiency] %zu shapes", rows.size());
+    if (peak.tflops > 0.0) {
+        fprintf(out, ", %% of %.1f TFLOP/s peak", peak.tflops);
+    } else if (estimated) {
+        fprintf(out, ", %% of the %s dense peak of each type", peak.target.c_str());
+    } else {
+        fprintf(out, ", achieved TFLOP/s (peak unknown)");
+    }
+    if (peak.gbps > 0.0) {
+        fprintf(out, ", GB/s %% of %.0f GB/s", peak.gbps);
+    }
+    fprintf(out, "\n%-24s %-7s %8s %8s %8s %10s %12s %9s %9s %9s %9s %9s\n",
+            "Routine", "Type", "M", "N", "K", "Count", "Total (ms)", "TFLOP/s", "GB/s",
+            percent ? "Min %" : "Min", percent ? "Median %" : "Median", percent ? "Max %" : "Max");
+
+    for (const BlasShapeRow& row : rows) {
+        const double total_ns = (double)row.total_ns;
+        const double row_peak = percent ? peak.tflops_for(row.precision) : 0.0;
+        char k[24];
+        char gbps[32];
+        char spread[3][16];
+        if (row.k == kBlasNone) {
+            snprintf(k, sizeof(k), "-");
+        } else {
+            snprintf(k, sizeof(k), "%ld", (long)row.k);
+        }
+        if (peak.gbps > 0.0) {
+            snprintf(gbps, sizeof(gbps), "%.1f%%", row.total_bytes / total_ns / peak.gbps * 100.0);
+        } else {
+            snprintf(gbps, sizeof(gbps), "%.1f", row.total_bytes / total_ns);
+        }
+        // A type without a known peak gets no percentages rather than ones
+        // against another type's peak
+        const double values[3] = {row.min_tflops, row.median_tflops, row.max_tflops};
+        for (int i = 0; i < 3; i++) {
+            if (!percent) {
+                snprintf(spread[i], sizeof(spread[i]), "%.2f", values[i]);
+            } else if (row_peak > 0.0) {
+                snprintf(spread[i], sizeof(spread[i]), "%.2f", values[i] * 100.0 / row_peak);
+            } else {
+                snprintf(spread[i], sizeof(spread[i]), "-");
+            }
+        }
+        fprintf(out, "%-24s %-7s %8ld %8ld %8s %10lu %12.3f %9.2f %9s %9s %9s %9s\n",
+                row.function.c_str(), row.precision.c_str(), (long)row.m, (long)row.n, k,
+                (unsigned long)row.count, row.total_ns / 1e6, row.total_flops / total_ns / 1000.0, gbps,
+                spread[0], spread[1], spread[2]);
+    }
+}
+
+} // namespace rpv3
@@ -0,0 +1,126 @@
+// MIT License
+// RPV3 BLAS Perf - Achieved FLOP/s and bytes/s of correlated rocBLAS dispatches
+//
+// A Tensile dispatch whose rocBLAS call has been parsed has a known shape
+// and a GPU duration. From the shape follow the floating point operations
+// and the least memory traffic the call can need (every operand read once,
+// the result written once), and from the duration the achieved TFLOP/s and
+// GB/s. Those go into the --csv --rocblas rows and, aggregated per
+// (routine, precision, M, N, K), into an efficiency table printed at exit.
+//
+// Per shape the table keeps a count, totals and a log-bucketed histogram of
+// achieved throughput (the latency histogram, fed MFLOP/s instead of ns), so
+// memory is fixed per shape however many dispatches it has and the median
+// is accurate to ~3%. Min and max are exact.
+
+#ifndef RPV3_BLAS_PERF_H
+#define RPV3_BLAS_PERF_H
+
+#include "rpv3_blas_parser.h"
+#include "rpv3_histogram.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace rpv3 {
+
+// Work implied by one call; zero when the shape or datatype is unknown.
+// Only a one-kernel call's work is its dispatch's work (blas_one_kernel).
+struct BlasWork {
+    double flops = 0.0;
+    double bytes = 0.0;  // Minimum traffic: operands read once, result written once
+};
+
+// Bytes per element of a rocBLAS datatype ("f32_r" -> 4, "f64_c" -> 16); 0 if unknown
+size_t blas_element_bytes(std::string_view datatype);
+
+BlasWork blas_work(const BlasCall& call);
+
+// Achieved rates over a GPU duration; 0 when the duration or work is unknown
+inline double achieved_tflops(const BlasWork& work, uint64_t duration_ns) {
+    return duration_ns ? work.flops / (double)duration_ns / 1000.0 : 0.0;
+}
+
+inline double achieved_gbps(const BlasWork& work, uint64_t duration_ns) {
+    return duration_ns ? work.bytes / (double)duration_ns : 0.0;
+}
+
+// Device peaks used for efficiency. --peak-tflops applies to every row;
+// otherwise each row's peak is estimated for its datatype on the GPU below.
+// A zero peak means unknown, and rows without one show only the achieved
+// TFLOP/s.
+struct BlasPeak {
+    double tflops = 0.0;  // --peak-tflops
+    double gbps = 0.0;
+    std::string target;   // gfx target of the first GPU agent, e.g. "gfx942"
+    uint32_t cu_count = 0;
+    uint32_t clock_mhz = 0;
+
+    // Peak for rows of a datatype (A's, which sets the matrix-core rate)
+    double tflops_for(std::string_view datatype) const;
+};
+
+// Dense peak of a datatype from the gfx target's FLOPs per CU per clock,
+// matrix cores where the target has them for that type, x CUs x clock.
+// 0 when the target or the datatype is not in the table.
+double estimate_peak_tflops(std::string_view target, std::string_view datatype, uint32_t cu_count,
+                            uint32_t clock_mhz);
+
+struct BlasShapeRow {
+    std::string function;
+    std::string precision;
+    int64_t m = kBlasNone;
+    int64_t n = kBlasNone;
+    int64_t k = kBlasNone;
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    double total_flops = 0.0;
+    double total_bytes = 0.0;
+    double min_tflops = 0.0;
+    double median_tflops = 0.0;
+    double max_tflops = 0.0;
+};
+
+// Not thread-safe; the tracer records from the correlator sink, which runs
+// under the correlator's matcher lock.
+class BlasEfficiencyTable {
+public:
+    // Calls with no FLOP count or no duration, and calls that run several
+    // kernels (blas_one_kernel), are ignored
+    void record(const BlasCall& call, uint64_t duration_ns);
+
+    // One row per shape, most total GPU time first
+    std::vector<BlasShapeRow> rows() const;
+
+    size_t size() const { return shapes_.size(); }
+
+private:
+    using Key = std::tuple<std::string, std::string, int64_t, int64_t, int64_t>;
+
+    struct Shape {
+        uint64_t count = 0;
+        uint64_t total_ns = 0;
+        double total_flops = 0.0;
+        double total_bytes = 0.0;
+        double min_tflops = 0.0;
+        double max_tflops = 0.0;
+        std::unique_ptr<LatencyHistogram> mflops = std::make_unique<LatencyHistogram>();
+    };
+
+    std::map<Key, Shape> shapes_;
+};
+
+// Text table: routine, precision, M, N, K, count, total time, aggregate
+// TFLOP/s and GB/s, and min/median/max efficiency against peak (or achieved
+// TFLOP/s when the peak is unknown)
+void print_blas_efficiency(FILE* out, const std::vector<BlasShapeRow>& rows, const BlasPeak& peak);
+
+} // namespace rpv3
+
+#endif // RPV3_BLAS_PERF_H
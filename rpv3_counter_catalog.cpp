@@ -0,0 +1,296 @@
+// MIT License
+// RPV3 Counter Catalog - Implementation
+// See rpv3_counter_catalog.h for what is cached and when it is trusted
+//
+// File format, one record per line:
+//
+//   rpv3-counter-catalog 1
+//   agent <key>
+//   counter <id> <name>        (entry's catalog, sorted by name)
+//   plan <name,name,...>
+//   pass <index> <index> ...   (indices into the plan's names)
+//   rejected <index> ...
+
+#include "rpv3_counter_catalog.h"
+#include "rpv3_counter_passes.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rpv3 {
+
+namespace {
+    constexpr std::string_view kMagic = "rpv3-counter-catalog";
+
+    bool fail(std::string* error, std::string message) {
+        if (error) {
+            *error = std::move(message);
+        }
+        return false;
+    }
+
+    std::string join_names(const std::vector<std::string>& names) {
+        std::string joined;
+        for (const std::string& name : names) {
+            if (!joined.empty()) {
+                joined += ',';
+            }
+            joined += name;
+        }
+        return joined;
+    }
+
+    size_t count_names(const std::string& joined) {
+        return joined.empty() ? 0 : (size_t)std::count(joined.begin(), joined.end(), ',') + 1;
+    }
+
+    // Space-separated indices, each below limit
+    bool parse_indices(std::string_view text, size_t limit, std::vector<size_t>& out) {
+        std::string copy(text);
+        const char* p = copy.c_str();
+        while (*p) {
+            if (*p == ' ') {
+                p++;
+                continue;
+            }
+            char* end = nullptr;
+            errno = 0;
+            const unsigned long long value = strtoull(p, &end, 10);
+            if (end == p || errno != 0 || value >= limit || (*end && *end != ' ')) {
+                return false;
+            }
+            out.push_back((size_t)value);
+            p = end;
+        }
+        return true;
+    }
+
+    // mkdir -p of the directory holding path
+    bool make_parent_dirs(const std::string& path) {
+        for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+            const std::string dir = path.substr(0, slash);
+            if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+std::string counter_catalog_key(std::string_view product, std::string_view target, std::string_view version) {
+    std::string key;
+    key.append(product).append("|").append(target).append("|").append(version);
+    // A key is one line of the file
+    std::replace(key.begin(), key.end(), '\n', ' ');
+    return key;
+}
+
+std::string default_counter_catalog_path() {
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    if (xdg && *xdg) {
+        return std::string(xdg) + "/rpv3/counter-catalog";
+    }
+    const char* home = getenv("HOME");
+    if (home && *home) {
+        return std::string(home) + "/.cache/rpv3/counter-catalog";
+    }
+    return std::string();
+}
+
+const std::vector<CatalogCounter>& CounterCatalog::counters(const std::string& key, const Query& query,
+                                                            bool* queried) {
+    Entry& entry = entries_[key];
+    if (queried) {
+        *queried = !entry.has_counters;
+    }
+    if (!entry.has_counters) {
+        entry.counters = query();
+        std::sort(entry.counters.begin(), entry.counters.end(),
+                  [](const CatalogCounter& a, const CatalogCounter& b) { return a.name < b.name; });
+        entry.has_counters = true;
+        entry.loaded = false;
+        dirty_ = true;
+    }
+    return entry.counters;
+}
+
+bool CounterCatalog::find(const std::string& key, std::string_view name, uint64_t& id) const {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return false;
+    }
+    const std::vector<CatalogCounter>& counters = it->second.counters;
+    auto counter = std::lower_bound(counters.begin(), counters.end(), name,
+                                    [](const CatalogCounter& c, std::string_view n) { return c.name < n; });
+    if (counter == counters.end() || counter->name != name) {
+        return false;
+    }
+    id = counter->id;
+    return true;
+}
+
+const CounterPlan& CounterCatalog::plan(const std::string& key, const std::vector<std::string>& names,
+                                        const Fits& fits, bool* planned) {
+    Entry& entry = entries_[key];
+    const std::string joined = join_names(names);
+    auto it = entry.plans.find(joined);
+    if (planned) {
+        *planned = (it == entry.plans.end());
+    }
+    if (it != entry.plans.end()) {
+        return it->second;
+    }
+    CounterPlan plan;
+    plan.passes = plan_counter_passes(names.size(), fits, &plan.rejected);
+    dirty_ = true;
+    return entry.plans.emplace(joined, std::move(plan)).first->second;
+}
+
+bool CounterCatalog::loaded(const std::string& key) const {
+    auto it = entries_.find(key);
+    return it != entries_.end() && it->second.loaded;
+}
+
+void CounterCatalog::forget(const std::string& key) {
+    if (entries_.erase(key) > 0) {
+        dirty_ = true;
+    }
+}
+
+bool CounterCatalog::load(const std::string& path, std::string* error) {
+    entries_.clear();
+    dirty_ = false;
+    if (error) {
+        error->clear();
+    }
+
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+        return errno == ENOENT ? false : fail(error, path + ": " + strerror(errno));
+    }
+
+    std::map<std::string, Entry> entries;
+    Entry* entry = nullptr;
+    CounterPlan* plan = nullptr;
+    size_t plan_names = 0;
+    bool header = false;
+    bool ok = true;
+    size_t line_number = 0;
+    char* buffer = nullptr;
+    size_t capacity = 0;
+    ssize_t length;
+    while (ok && (length = getline(&buffer, &capacity, file)) >= 0) {
+        line_number++;
+        std::string_view line(buffer, (size_t)length);
+        if (!line.empty() && line.back() == '\n') {
+            line.remove_suffix(1);
+        }
+        const size_t space = line.find(' ');
+        const std::string_view tag = line.substr(0, space);
+        const std::string_view rest = (space == std::string_view::npos) ? std::string_view() : line.substr(space + 1);
+
+        if (!header) {
+            if (tag != kMagic) {
+                ok = fail(error, path + ": not a counter catalog");
+            } else if (rest != std::to_string(kFormatVersion)) {
+                // Another version of the tracer wrote it; it is rebuilt
+                ok = false;
+            }
+            header = true;
+        } else if (tag == "agent" && !rest.empty()) {
+            // An agent may support no counters at all; that is cached too
+            entry = &entries[std::string(rest)];
+            entry->has_counters = true;
+            entry->loaded = true;
+            plan = nullptr;
+        } else if (tag == "counter" && entry) {
+            const std::string text(rest);
+            char* end = nullptr;
+            errno = 0;
+            const unsigned long long id = strtoull(text.c_str(), &end, 10);
+            if (end == text.c_str() || errno != 0 || *end != ' ' || end[1] == '\0') {
+                ok = fail(error, path + ":" + std::to_string(line_number) + ": bad counter");
+            } else {
+                entry->counters.push_back(CatalogCounter{std::string(end + 1), (uint64_t)id});
+            }
+        } else if (tag == "plan" && entry) {
+            plan = &entry->plans[std::string(rest)];
+            plan_names = count_names(std::string(rest));
+        } else if ((tag == "pass" || tag == "rejected") && plan) {
+            std::vector<size_t> indices;
+            if (!parse_indices(rest, plan_names, indices) || indices.empty()) {
+                ok = fail(error, path + ":" + std::to_string(line_number) + ": bad " + std::string(tag));
+            } else if (tag == "pass") {
+                plan->passes.push_back(std::move(indices));
+            } else {
+                plan->rejected.insert(plan->rejected.end(), indices.begin(), indices.end());
+            }
+        } else {
+            ok = fail(error, path + ":" + std::to_string(line_number) + ": unexpected '" + std::string(tag) + "'");
+        }
+    }
+    free(buffer);
+    fclose(file);
+    if (!ok || !header) {
+        return false;
+    }
+
+    // Lookups binary-search the catalog; never trust the file's order
+    for (auto& [key, loaded] : entries) {
+        std::sort(loaded.counters.begin(), loaded.counters.end(),
+                  [](const CatalogCounter& a, const CatalogCounter& b) { return a.name < b.name; });
+    }
+    entries_ = std::move(entries);
+    return true;
+}
+
+bool CounterCatalog::save(const std::string& path, std::string* error) {
+    if (!make_parent_dirs(path)) {
+        return fail(error, path + ": cannot create directory: " + strerror(errno));
+    }
+    // Written aside and renamed over the old file in one step
+    const std::string temp = path + "." + std::to_string((long)getpid()) + ".tmp";
+    FILE* file = fopen(temp.c_str(), "w");
+    if (!file) {
+        return fail(error, temp + ": " + strerror(errno));
+    }
+    fprintf(file, "%s %d\n", kMagic.data(), kFormatVersion);
+    for (const auto& [key, entry] : entries_) {
+        fprintf(file, "agent %s\n", key.c_str());
+        for (const CatalogCounter& counter : entry.counters) {
+            fprintf(file, "counter %llu %s\n", (unsigned long long)counter.id, counter.name.c_str());
+        }
+        for (const auto& [names, plan] : entry.plans) {
+            fprintf(file, "plan %s\n", names.c_str());
+            for (const std::vector<size_t>& pass : plan.passes) {
+                fputs("pass", file);
+                for (size_t i : pass) {
+                    fprintf(file, " %zu", i);
+                }
+                fputc('\n', file);
+            }
+            if (!plan.rejected.empty()) {
+                fputs("rejected", file);
+                for (size_t i : plan.rejected) {
+                    fprintf(file, " %zu", i);
+                }
+                fputc('\n', file);
+            }
+        }
+    }
+    const bool written = !ferror(file);
+    if (fclose(file) != 0 || !written || rename(temp.c_str(), path.c_str()) != 0) {
+        const std::string reason = strerror(errno);
+        unlink(temp.c_str());
+        return fail(error, path + ": " + reason);
+    }
+    dirty_ = false;
+    return true;
+}
+
+} // namespace rpv3
@@ -0,0 +1,112 @@
+// MIT License
+// RPV3 Counter Catalog - On-disk cache of counter ids and pass plans
+//
+// Setting up counter collection used to cost, per agent, one
+// rocprofiler_query_counter_info call for every counter the agent supports
+// (hundreds) to map names to ids, then a trial profile config for every
+// step of the pass plan (rpv3_counter_passes.h). Both answers depend only
+// on the kind of agent and the ROCm release, so they are kept in a small
+// text file and reused:
+//
+// - An entry is keyed by product name, gfx target and rocprofiler version
+//   (counter_catalog_key). Identical GPUs share one entry, so a node with
+//   eight of them queries once, and a new ROCm release starts a new entry.
+// - An entry holds the name -> id catalog, sorted by name, and the pass
+//   plan of every counter list planned on that agent kind.
+// - On a miss the caller's query or fits function provides the answer,
+//   which is cached. The file is rewritten at setup only when something
+//   was added, through a temporary file and rename(), so processes
+//   starting together never read a partial file. Entries of other agent
+//   kinds in the file are kept.
+//
+// Cached ids are only as good as the key. While a key's catalog came from
+// disk (loaded), the tracer treats a profile config that fails to create,
+// or a new plan that rejects counters, as a sign of a stale entry: it
+// forgets the entry and queries again.
+
+#ifndef RPV3_COUNTER_CATALOG_H
+#define RPV3_COUNTER_CATALOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rpv3 {
+
+struct CatalogCounter {
+    std::string name;
+    uint64_t id = 0;
+};
+
+struct CounterPlan {
+    std::vector<std::vector<size_t>> passes;  // Indices into the planned names
+    std::vector<size_t> rejected;             // Counters no profile accepts
+};
+
+// "<product>|<gfx target>|<rocprofiler version>"
+std::string counter_catalog_key(std::string_view product, std::string_view target, std::string_view version);
+
+// $XDG_CACHE_HOME/rpv3/counter-catalog, else ~/.cache/rpv3/counter-catalog;
+// empty when neither variable is set
+std::string default_counter_catalog_path();
+
+class CounterCatalog {
+public:
+    static constexpr int kFormatVersion = 1;
+
+    using Query = std::function<std::vector<CatalogCounter>()>;
+    using Fits = std::function<bool(const std::vector<size_t>&)>;
+
+    // Counters supported by agents of this key, sorted by name. On a miss
+    // they come from query() and are cached. queried, if given, tells which.
+    const std::vector<CatalogCounter>& counters(const std::string& key, const Query& query,
+                                                bool* queried = nullptr);
+
+    // Id of a counter in a key's catalog; false if the agent lacks it or
+    // the key has no catalog yet
+    bool find(const std::string& key, std::string_view name, uint64_t& id) const;
+
+    // Passes for names (in order) on agents of this key. On a miss they are
+    // planned with plan_counter_passes(fits) and cached.
+    const CounterPlan& plan(const std::string& key, const std::vector<std::string>& names, const Fits& fits,
+                            bool* planned = nullptr);
+
+    // True while the key's catalog is the one read from disk rather than
+    // queried by this process
+    bool loaded(const std::string& key) const;
+
+    // Drop a key's entry, so the next lookup queries again
+    void forget(const std::string& key);
+
+    size_t size() const { return entries_.size(); }
+
+    // Something changed since load() or save()
+    bool dirty() const { return dirty_; }
+
+    // Replace the contents with the file at path. Returns false, leaving the
+    // catalog empty, when the file cannot be used; error is set unless the
+    // file is simply missing or from another format version.
+    bool load(const std::string& path, std::string* error = nullptr);
+
+    // Write every entry to path, creating its directory
+    bool save(const std::string& path, std::string* error = nullptr);
+
+private:
+    struct Entry {
+        std::vector<CatalogCounter> counters;
+        std::map<std::string, CounterPlan> plans;  // Keyed by the names, comma-joined
+        bool has_counters = false;
+        bool loaded = false;
+    };
+
+    std::map<std::string, Entry> entries_;
+    bool dirty_ = false;
+};
+
+} // namespace rpv3
+
+#endif // RPV3_COUNTER_CATALOG_H
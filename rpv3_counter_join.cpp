@@ -0,0 +1,107 @@
+// MIT License
+// RPV3 Counter Join - Implementation
+// See rpv3_counter_join.h for how the two halves of a dispatch meet
+
+#include "rpv3_counter_join.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rpv3 {
+
+void CounterJoin::expect(uint64_t dispatch_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[dispatch_id] = Entry();
+}
+
+CounterJoin::Match CounterJoin::add_dispatch(const TimedDispatch& timed, CounterRow& row) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(timed.dispatch.dispatch_id);
+    if (it == entries_.end()) {
+        return Match::Uncounted;
+    }
+    if (it->second.state == State::HasRow) {
+        row = std::move(it->second.row);
+        entries_.erase(it);
+        return Match::Joined;
+    }
+    it->second.state = State::HasDispatch;
+    it->second.timed = timed;
+    return Match::Held;
+}
+
+void CounterJoin::discard(uint64_t dispatch_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(dispatch_id);
+    if (it == entries_.end()) {
+        return;
+    }
+    if (it->second.state == State::HasRow) {
+        entries_.erase(it);
+    } else {
+        it->second.state = State::Discarded;
+    }
+}
+
+void CounterJoin::defer(uint64_t dispatch_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(dispatch_id);
+    if (it != entries_.end()) {
+        it->second.deferred = true;
+    }
+}
+
+CounterJoin::Match CounterJoin::add_row(CounterRow& row, TimedDispatch& timed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t dispatch_id = row.dispatch.dispatch_id;
+    Entry& entry = entries_[dispatch_id];
+    switch (entry.state) {
+        case State::HasDispatch:
+            timed = entry.timed;
+            entries_.erase(dispatch_id);
+            return Match::Joined;
+        case State::Discarded:
+            entries_.erase(dispatch_id);
+            return Match::Uncounted;
+        default:
+            entry.state = State::HasRow;
+            entry.row = std::move(row);
+            return Match::Held;
+    }
+}
+
+void CounterJoin::drain(std::vector<TimedDispatch>& dispatches, std::vector<CounterRow>& rows) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [dispatch_id, entry] : entries_) {
+        if (entry.state == State::HasDispatch) {
+            dispatches.push_back(std::move(entry.timed));
+        } else if (entry.state == State::HasRow && !entry.deferred) {
+            rows.push_back(std::move(entry.row));
+        }
+    }
+    entries_.clear();
+    std::sort(dispatches.begin(), dispatches.end(), [](const TimedDispatch& a, const TimedDispatch& b) {
+        return a.dispatch.dispatch_id < b.dispatch.dispatch_id;
+    });
+    std::sort(rows.begin(), rows.end(), [](const CounterRow& a, const CounterRow& b) {
+        return a.dispatch.dispatch_id < b.dispatch.dispatch_id;
+    });
+}
+
+size_t CounterJoin::held() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void format_counter_line(RecordBuffer& out, const std::vector<std::string>& columns,
+                         const std::vector<double>& values) {
+    out.append("  Counters:");
+    for (size_t i = 0; i < values.size() && i < columns.size(); i++) {
+        if (!std::isnan(values[i])) {
+            out.append(' ').append(columns[i]).append('=').append_double(values[i]);
+        }
+    }
+    out.append('\n');
+}
+
+} // namespace rpv3
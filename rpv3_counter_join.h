@@ -0,0 +1,105 @@
+// MIT License
+// RPV3 Counter Join - Timeline records and counter rows of the same dispatch
+//
+// With --timeline and counter collection together, one dispatch produces
+// two results on two buffers: a kernel-dispatch record with its GPU start
+// and end timestamps, and a counter row. Neither buffer waits for the other,
+// so whichever arrives first is held here, keyed by dispatch id, until its
+// partner arrives and one combined record is written:
+//
+// - dispatch_counting_callback runs before the kernel launches, so every
+//   counted dispatch is expected (expect) before either result exists.
+// - A timeline record of a dispatch that was not expected is written at
+//   once, with empty counter columns.
+// - Dispatches the timeline does not write (filtered out, sampled away) are
+//   discarded, and so is their counter row when it arrives.
+// - Dispatches whose timeline record is written later (a library kernel
+//   waiting for its log line, a reservoir sample written at exit) are
+//   deferred: their counter row is held until the record is handed over.
+//   Rows of reservoir dispatches that were never handed over were sampled
+//   away, and are dropped by drain().
+//
+// Whatever else is still held at exit lost its partner (dropped records) and
+// is handed back by drain().
+
+#ifndef RPV3_COUNTER_JOIN_H
+#define RPV3_COUNTER_JOIN_H
+
+#include "rpv3_counter_table.h"
+#include "rpv3_record.h"
+#include "rpv3_record_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rpv3 {
+
+// A timeline record with its output sequence number. A library record is
+// handed over already formatted up to its counter columns (record), with
+// the log line that follows it (annotation); both are empty otherwise.
+struct TimedDispatch {
+    DispatchRecord dispatch;
+    uint64_t sequence = 0;
+    std::string record;
+    std::string annotation;
+};
+
+class CounterJoin {
+public:
+    enum class Match {
+        Uncounted,  // Not counted: write the record alone
+        Held,       // Waiting for the partner
+        Joined      // Partner returned: write the combined record
+    };
+
+    // The dispatch will be counted. Thread-safe, as are all members.
+    void expect(uint64_t dispatch_id);
+
+    // Timeline side. On Joined, row holds the dispatch's counter row.
+    Match add_dispatch(const TimedDispatch& timed, CounterRow& row);
+
+    // The timeline side skipped this dispatch; its counter row is dropped
+    void discard(uint64_t dispatch_id);
+
+    // The timeline side hands this dispatch over later, if at all; its
+    // counter row is held until then
+    void defer(uint64_t dispatch_id);
+
+    // Counter side. On Joined, timed holds the dispatch's timeline record;
+    // on Held the row is moved in. Rows of discarded dispatches are dropped
+    // (Uncounted).
+    Match add_row(CounterRow& row, TimedDispatch& timed);
+
+    // Everything still held: timeline records without a counter row, and
+    // counter rows without a timeline record, each in dispatch id order.
+    // Rows of deferred dispatches are dropped, not handed back.
+    void drain(std::vector<TimedDispatch>& dispatches, std::vector<CounterRow>& rows);
+
+    size_t held() const;
+
+private:
+    enum class State : uint8_t { Expected, HasDispatch, HasRow, Discarded };
+
+    struct Entry {
+        State state = State::Expected;
+        bool deferred = false;
+        TimedDispatch timed;
+        CounterRow row;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, Entry> entries_;
+};
+
+// "  Counters: NAME=value ..." line completing a text record; NaN values
+// are left out
+void format_counter_line(RecordBuffer& out, const std::vector<std::string>& columns,
+                         const std::vector<double>& values);
+
+} // namespace rpv3
+
+#endif // RPV3_COUNTER_JOIN_H
@@ -0,0 +1,332 @@
+// MIT License
+// RPV3 Counter Metrics - Implementation
+// See rpv3_counter_metrics.h for the expression syntax
+
+#include "rpv3_counter_metrics.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace rpv3 {
+
+namespace {
+    using Instr = CounterMetrics::Instr;
+    using Op = CounterMetrics::Op;
+
+    constexpr std::string_view kDuration = "DurationNs";
+
+    bool fail(std::string* error, std::string message) {
+        if (error) {
+            *error = std::move(message);
+        }
+        return false;
+    }
+
+    bool is_name_start(char c) {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+    }
+
+    bool is_name_char(char c) {
+        return is_name_start(c) || (c >= '0' && c <= '9');
+    }
+
+    bool is_name(std::string_view text) {
+        if (text.empty() || !is_name_start(text[0])) {
+            return false;
+        }
+        for (char c : text) {
+            if (!is_name_char(c)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int find(const std::vector<std::string>& names, std::string_view name) {
+        for (size_t i = 0; i < names.size(); i++) {
+            if (names[i] == name) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
+
+    // Recursive descent over one expression, emitting postfix code:
+    //   expr   := term (('+' | '-') term)*
+    //   term   := unary (('*' | '/') unary)*
+    //   unary  := '-' unary | primary
+    //   primary:= number | name | '(' expr ')'
+    class Compiler {
+    public:
+        Compiler(std::string_view self, std::string_view text, std::vector<std::string>& counters,
+                 const std::vector<std::string>& columns, const std::vector<bool>& metric_columns)
+            : self_(self), text_(text), counters_(counters), columns_(columns), metric_columns_(metric_columns) {}
+
+        bool compile(std::vector<Instr>& code, bool& uses_duration, std::string* error) {
+            code_ = &code;
+            if (!expr(error)) {
+                return false;
+            }
+            skip_space();
+            if (pos_ != text_.size()) {
+                return fail(error, "unexpected '" + std::string(text_.substr(pos_)) + "'");
+            }
+            uses_duration = uses_duration || uses_duration_;
+            return true;
+        }
+
+    private:
+        void skip_space() {
+            while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t')) {
+                pos_++;
+            }
+        }
+
+        bool accept(char c) {
+            skip_space();
+            if (pos_ < text_.size() && text_[pos_] == c) {
+                pos_++;
+                return true;
+            }
+            return false;
+        }
+
+        bool emit(Op op, std::string* error, uint32_t index = 0, double value = 0.0) {
+            code_->push_back(Instr{op, index, value});
+            if (op == Op::Add || op == Op::Sub || op == Op::Mul || op == Op::Div) {
+                depth_--;
+            } else if (op != Op::Neg) {
+                depth_++;
+                if (depth_ > CounterMetrics::kMaxStack) {
+                    return fail(error, "expression too deeply nested");
+                }
+            }
+            return true;
+        }
+
+        bool expr(std::string* error) {
+            if (!term(error)) {
+                return false;
+            }
+            for (;;) {
+                Op op;
+                if (accept('+')) {
+                    op = Op::Add;
+                } else if (accept('-')) {
+                    op = Op::Sub;
+                } else {
+                    return true;
+                }
+                if (!term(error) || !emit(op, error)) {
+                    return false;
+                }
+            }
+        }
+
+        bool term(std::string* error) {
+            if (!unary(error)) {
+                return false;
+            }
+            for (;;) {
+                Op op;
+                if (accept('*')) {
+                    op = Op::Mul;
+                } else if (accept('/')) {
+                    op = Op::Div;
+                } else {
+                    return true;
+                }
+                if (!unary(error) || !emit(op, error)) {
+                    return false;
+                }
+            }
+        }
+
+        bool unary(std::string* error) {
+            if (accept('-')) {
+                return unary(error) && emit(Op::Neg, error);
+            }
+            return primary(error);
+        }
+
+        bool primary(std::string* error) {
+            skip_space();
+            if (pos_ >= text_.size()) {
+                return fail(error, "expression ends early");
+            }
+            const char c = text_[pos_];
+            if (c == '(') {
+                pos_++;
+                if (!expr(error)) {
+                    return false;
+                }
+                if (!accept(')')) {
+                    return fail(error, "missing ')'");
+                }
+                return true;
+            }
+            if ((c >= '0' && c <= '9') || c == '.') {
+                // strtod needs a terminated string
+                const std::string rest(text_.substr(pos_));
+                char* end = nullptr;
+                const double value = strtod(rest.c_str(), &end);
+                if (end == rest.c_str()) {
+                    return fail(error, "bad number '" + rest + "'");
+                }
+                pos_ += (size_t)(end - rest.c_str());
+                return emit(Op::Const, error, 0, value);
+            }
+            if (is_name_start(c)) {
+                size_t start = pos_;
+                while (pos_ < text_.size() && is_name_char(text_[pos_])) {
+                    pos_++;
+                }
+                return name(text_.substr(start, pos_ - start), error);
+            }
+            return fail(error, std::string("unexpected '") + c + "'");
+        }
+
+        // Earlier metric, the duration, or a counter (added on first use)
+        bool name(std::string_view name, std::string* error) {
+            if (name == self_) {
+                return fail(error, "refers to itself");
+            }
+            const int column = find(columns_, name);
+            if (column >= 0 && metric_columns_[column]) {
+                return emit(Op::Column, error, (uint32_t)column);
+            }
+            if (name == kDuration) {
+                uses_duration_ = true;
+                return emit(Op::Duration, error);
+            }
+            int counter = find(counters_, name);
+            if (counter < 0) {
+                counter = (int)counters_.size();
+                counters_.emplace_back(name);
+            }
+            return emit(Op::Counter, error, (uint32_t)counter);
+        }
+
+        std::string_view self_;  // Metric being defined
+        std::string_view text_;
+        size_t pos_ = 0;
+        size_t depth_ = 0;
+        bool uses_duration_ = false;
+        std::vector<Instr>* code_ = nullptr;
+        std::vector<std::string>& counters_;
+        const std::vector<std::string>& columns_;
+        const std::vector<bool>& metric_columns_;
+    };
+
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+}
+
+bool CounterMetrics::compile(std::string_view spec, std::string* error) {
+    // Work on copies so a failed item leaves the set unchanged
+    std::vector<std::string> counters = counters_;
+    std::vector<std::string> columns = columns_;
+    std::vector<Instr> code = code_;
+    std::vector<uint32_t> code_end = code_end_;
+    std::vector<bool> metric_columns = metric_columns_;
+    bool has_derived = has_derived_;
+    bool uses_duration = uses_duration_;
+
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t end = spec.find(',', start);
+        if (end == std::string_view::npos) {
+            end = spec.size();
+        }
+        std::string_view item = trim(spec.substr(start, end - start));
+        start = end + 1;
+        if (item.empty()) {
+            return fail(error, "empty counter name");
+        }
+
+        const size_t eq = item.find('=');
+        std::string_view name = trim(item.substr(0, eq));
+        if (!is_name(name)) {
+            return fail(error, "bad name '" + std::string(name) + "'");
+        }
+        if (find(columns, name) >= 0) {
+            return fail(error, "'" + std::string(name) + "' listed twice");
+        }
+        if (eq == std::string_view::npos) {
+            if (name == kDuration) {
+                return fail(error, "DurationNs is not a counter");
+            }
+            int counter = find(counters, name);
+            if (counter < 0) {
+                counter = (int)counters.size();
+                counters.emplace_back(name);
+            }
+            code.push_back(Instr{Op::Counter, (uint32_t)counter, 0.0});
+            metric_columns.push_back(false);
+        } else {
+            std::string message;
+            Compiler compiler(name, item.substr(eq + 1), counters, columns, metric_columns);
+            if (!compiler.compile(code, uses_duration, &message)) {
+                return fail(error, std::string(name) + ": " + message);
+            }
+            metric_columns.push_back(true);
+            has_derived = true;
+        }
+        columns.emplace_back(name);
+        code_end.push_back((uint32_t)code.size());
+    }
+
+    counters_ = std::move(counters);
+    columns_ = std::move(columns);
+    code_ = std::move(code);
+    code_end_ = std::move(code_end);
+    metric_columns_ = std::move(metric_columns);
+    has_derived_ = has_derived;
+    uses_duration_ = uses_duration;
+    return true;
+}
+
+int CounterMetrics::counter_of(size_t column) const {
+    if (column >= columns_.size() || metric_columns_[column]) {
+        return -1;
+    }
+    // A plain counter column is a single load
+    const uint32_t begin = column ? code_end_[column - 1] : 0;
+    return (int)code_[begin].index;
+}
+
+void CounterMetrics::evaluate(const double* counters, double duration_ns, double* out) const {
+    double stack[kMaxStack];
+    size_t ip = 0;
+    for (size_t column = 0; column < columns_.size(); column++) {
+        size_t top = 0;
+        for (const size_t end = code_end_[column]; ip < end; ip++) {
+            const Instr& instr = code_[ip];
+            switch (instr.op) {
+                case Op::Const:    stack[top++] = instr.value; break;
+                case Op::Counter:  stack[top++] = counters[instr.index]; break;
+                case Op::Column:   stack[top++] = out[instr.index]; break;
+                case Op::Duration: stack[top++] = duration_ns; break;
+                case Op::Neg:      stack[top - 1] = -stack[top - 1]; break;
+                case Op::Add:      top--; stack[top - 1] += stack[top]; break;
+                case Op::Sub:      top--; stack[top - 1] -= stack[top]; break;
+                case Op::Mul:      top--; stack[top - 1] *= stack[top]; break;
+                case Op::Div:
+                    top--;
+                    // No infinities in the output: x/0 is not computable
+                    stack[top - 1] = (stack[top] != 0.0) ? stack[top - 1] / stack[top] : NAN;
+                    break;
+            }
+        }
+        out[column] = stack[0];
+    }
+}
+
+} // namespace rpv3
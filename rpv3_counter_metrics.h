@@ -0,0 +1,80 @@
+// MIT License
+// RPV3 Counter Metrics - Counter sets and derived metrics for --counters
+//
+// "--counters SQ_WAVES,VALU_UTIL=SQ_INSTS_VALU/SQ_WAVES" names the columns
+// written per dispatch: hardware counters as they are, and metrics computed
+// from them. Each item is compiled once, at tool_init, into a short postfix
+// program over a flat instruction array; a dispatch's row is then one pass
+// over those instructions with a small fixed stack, no parsing and no
+// allocation. Counters only referenced by a metric are collected but not
+// written, so the output holds the derived values alone.
+//
+// Expressions take + - * /, unary minus, parentheses, numbers, counter
+// names, metrics defined earlier in the list and DurationNs. A counter that
+// was not collected, an unknown duration or a division by zero makes the
+// value NaN, which is written as an empty field.
+
+#ifndef RPV3_COUNTER_METRICS_H
+#define RPV3_COUNTER_METRICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rpv3 {
+
+class CounterMetrics {
+public:
+    // Deepest operand stack an expression may need
+    static constexpr size_t kMaxStack = 32;
+
+    // Add comma-separated items, each a counter name or NAME=expression.
+    // Returns false and leaves the set unchanged on a syntax error.
+    bool compile(std::string_view spec, std::string* error = nullptr);
+
+    bool empty() const { return columns_.empty(); }
+
+    // Hardware counters to collect: listed ones first, then those only
+    // referenced by metrics, in order of appearance
+    const std::vector<std::string>& counters() const { return counters_; }
+
+    // Columns written per dispatch, in list order
+    const std::vector<std::string>& columns() const { return columns_; }
+
+    // True when some column is computed rather than a plain counter
+    bool has_derived() const { return has_derived_; }
+
+    // Index into counters() of a plain counter column, -1 for a metric
+    int counter_of(size_t column) const;
+
+    // True when some metric needs the dispatch duration
+    bool uses_duration() const { return uses_duration_; }
+
+    // Compute every column. counters holds one value per counters() entry,
+    // NaN where not collected; duration_ns is NaN when unknown. out receives
+    // one value per columns() entry.
+    void evaluate(const double* counters, double duration_ns, double* out) const;
+
+    enum class Op : uint8_t { Const, Counter, Column, Duration, Add, Sub, Mul, Div, Neg };
+
+    struct Instr {
+        Op op;
+        uint32_t index;  // Counter or column index
+        double value;    // Const
+    };
+
+private:
+    std::vector<std::string> counters_;
+    std::vector<std::string> columns_;
+    std::vector<bool> metric_columns_;   // Per column: computed, not a plain counter
+    std::vector<Instr> code_;            // Every column's program, back to back
+    std::vector<uint32_t> code_end_;     // Per column: end of its program in code_
+    bool has_derived_ = false;
+    bool uses_duration_ = false;
+};
+
+} // namespace rpv3
+
+#endif // RPV3_COUNTER_METRICS_H
@@ -0,0 +1,124 @@
+// MIT License
+// RPV3 Counter Passes - Implementation
+// See rpv3_counter_passes.h for how passes are planned, rotated and merged
+
+#include "rpv3_counter_passes.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rpv3 {
+
+std::vector<std::vector<size_t>> plan_counter_passes(size_t count,
+                                                     const std::function<bool(const std::vector<size_t>&)>& fits,
+                                                     std::vector<size_t>* rejected) {
+    std::vector<std::vector<size_t>> passes;
+    for (size_t counter = 0; counter < count; counter++) {
+        bool placed = false;
+        for (auto& pass : passes) {
+            pass.push_back(counter);
+            if (fits(pass)) {
+                placed = true;
+                break;
+            }
+            pass.pop_back();
+        }
+        if (placed) {
+            continue;
+        }
+        std::vector<size_t> pass{counter};
+        if (fits(pass)) {
+            passes.push_back(std::move(pass));
+        } else if (rejected) {
+            rejected->push_back(counter);
+        }
+    }
+    return passes;
+}
+
+void CounterEstimates::add(const CounterRow& row) {
+    Sums& kernel = kernels_[row.dispatch.kernel_id];
+    if (kernel.sums.size() < row.values.size()) {
+        kernel.sums.resize(row.values.size(), 0.0);
+        kernel.samples.resize(row.values.size(), 0);
+    }
+    kernel.dispatches++;
+    for (size_t i = 0; i < row.values.size(); i++) {
+        if (row.has(i)) {
+            kernel.sums[i] += row.values[i];
+            kernel.samples[i]++;
+        }
+    }
+}
+
+std::vector<CounterEstimateRow> CounterEstimates::rows() const {
+    std::vector<CounterEstimateRow> rows;
+    rows.reserve(kernels_.size());
+    for (const auto& [kernel_id, kernel] : kernels_) {
+        CounterEstimateRow row;
+        row.kernel_id = kernel_id;
+        row.dispatches = kernel.dispatches;
+        row.samples = kernel.samples;
+        row.means.resize(kernel.sums.size());
+        for (size_t i = 0; i < kernel.sums.size(); i++) {
+            row.means[i] = kernel.samples[i] ? kernel.sums[i] / (double)kernel.samples[i] : NAN;
+        }
+        rows.push_back(std::move(row));
+    }
+    std::sort(rows.begin(), rows.end(), [](const CounterEstimateRow& a, const CounterEstimateRow& b) {
+        return a.dispatches != b.dispatches ? a.dispatches > b.dispatches : a.kernel_id < b.kernel_id;
+    });
+    return rows;
+}
+
+void format_estimates_text(RecordBuffer& out, const std::vector<CounterEstimateRow>& rows,
+                           const std::vector<std::string>& columns, const std::vector<std::vector<double>>& values,
+                           const std::vector<std::string>& counters) {
+    out.append("\n[Counter Estimates] ").append_u64(rows.size())
+       .append(" kernels, means over the dispatches that collected each counter\n");
+    for (size_t r = 0; r < rows.size(); r++) {
+        const CounterEstimateRow& row = rows[r];
+        out.append(row.name).append(" (").append_u64(row.dispatches).append(" dispatches):");
+        for (size_t i = 0; i < columns.size() && i < values[r].size(); i++) {
+            if (!std::isnan(values[r][i])) {
+                out.append(' ').append(columns[i]).append('=').append_double(values[r][i]);
+            }
+        }
+        out.append(" samples");
+        for (size_t i = 0; i < counters.size(); i++) {
+            out.append(i ? ',' : ' ').append(counters[i]).append('=')
+               .append_u64(i < row.samples.size() ? row.samples[i] : 0);
+        }
+        out.append('\n');
+    }
+}
+
+void format_estimates_csv(RecordBuffer& out, const std::vector<CounterEstimateRow>& rows,
+                          const std::vector<std::string>& columns, const std::vector<std::vector<double>>& values,
+                          const std::vector<std::string>& counters) {
+    out.append("KernelName,KernelID,Dispatches");
+    for (const std::string& name : columns) {
+        out.append(',').append(name);
+    }
+    for (const std::string& name : counters) {
+        out.append(',').append(name).append("Samples");
+    }
+    out.append('\n');
+    for (size_t r = 0; r < rows.size(); r++) {
+        const CounterEstimateRow& row = rows[r];
+        out.append('"').append(row.name).append("\",");
+        out.append_u64(row.kernel_id).append(',').append_u64(row.dispatches);
+        for (size_t i = 0; i < columns.size(); i++) {
+            out.append(',');
+            if (i < values[r].size() && !std::isnan(values[r][i])) {
+                out.append_double(values[r][i]);
+            }
+        }
+        for (size_t i = 0; i < counters.size(); i++) {
+            out.append(',').append_u64(i < row.samples.size() ? row.samples[i] : 0);
+        }
+        out.append('\n');
+    }
+}
+
+} // namespace rpv3
@@ -0,0 +1,79 @@
+// MIT License
+// RPV3 Counter Passes - Multiplexing counter sets across repeated dispatches
+//
+// A profile config holds only as many counters as the hardware can count
+// at once, and rocprofiler rejects configs that do not fit. Rather than
+// dropping the counters that do not fit, the tracer splits the requested
+// set into several passes per agent (plan_counter_passes) and counts one
+// pass per dispatch, rotating through them across successive dispatches of
+// the same kernel (rpv3_counter_select.h). A dispatch's row then holds only its
+// pass's counters, so rows are also merged per kernel (CounterEstimates):
+// each counter's mean over the dispatches that collected it, with that
+// sample count, is the kernel's estimate. Metrics are computed from the
+// means, which combines counters no single dispatch collected together.
+
+#ifndef RPV3_COUNTER_PASSES_H
+#define RPV3_COUNTER_PASSES_H
+
+#include "rpv3_counter_table.h"
+#include "rpv3_record_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rpv3 {
+
+// Pack counters 0..count-1 into passes, first fit in list order. fits()
+// answers whether one profile can hold a set of counters. Counters no
+// profile accepts, even alone, go to rejected.
+std::vector<std::vector<size_t>> plan_counter_passes(size_t count,
+                                                     const std::function<bool(const std::vector<size_t>&)>& fits,
+                                                     std::vector<size_t>* rejected = nullptr);
+
+struct CounterEstimateRow {
+    uint64_t kernel_id = 0;
+    std::string name;
+    uint64_t dispatches = 0;
+    std::vector<double> means;     // Per counter column, NaN without samples
+    std::vector<uint64_t> samples; // Per counter column: dispatches that collected it
+};
+
+// Per-kernel merge of counter rows. Single consumer (the buffer callback).
+class CounterEstimates {
+public:
+    void add(const CounterRow& row);
+
+    size_t size() const { return kernels_.size(); }
+
+    // Every kernel, most dispatches first. Names are left empty for the
+    // caller to fill in.
+    std::vector<CounterEstimateRow> rows() const;
+
+private:
+    struct Sums {
+        uint64_t dispatches = 0;
+        std::vector<double> sums;
+        std::vector<uint64_t> samples;
+    };
+
+    std::unordered_map<uint64_t, Sums> kernels_;
+};
+
+// "[Counter Estimates]" block, one line per kernel: the columns (counter
+// means and metrics computed from them) followed by each counter's samples
+void format_estimates_text(RecordBuffer& out, const std::vector<CounterEstimateRow>& rows,
+                           const std::vector<std::string>& columns, const std::vector<std::vector<double>>& values,
+                           const std::vector<std::string>& counters);
+
+// CSV table: KernelName,KernelID,Dispatches,<columns>,<counter>Samples...
+void format_estimates_csv(RecordBuffer& out, const std::vector<CounterEstimateRow>& rows,
+                          const std::vector<std::string>& columns, const std::vector<std::vector<double>>& values,
+                          const std::vector<std::string>& counters);
+
+} // namespace rpv3
+
+#endif // RPV3_COUNTER_PASSES_H
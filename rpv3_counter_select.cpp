@@ -0,0 +1,116 @@
+// MIT License
+// RPV3 Counter Select - Implementation
+// See rpv3_counter_select.h for the selection policies
+
+#include "rpv3_counter_select.h"
+
+namespace rpv3 {
+
+CounterSelector::CounterSelector(size_t initial_capacity) {
+    size_t capacity = 16;
+    while (capacity < initial_capacity * 2) {
+        capacity <<= 1;
+    }
+    tables_.push_back(std::make_unique<Table>(capacity));
+    table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+CounterSelector::~CounterSelector() = default;
+
+void CounterSelector::configure(uint64_t first, uint64_t every) {
+    first_ = first;
+    every_ = every ? every : 1;
+}
+
+CounterSelector::Counts* CounterSelector::find(uint64_t kernel_id) const {
+    const Table* table = table_.load(std::memory_order_acquire);
+    size_t mask = table->capacity - 1;
+    for (size_t i = hash(kernel_id) & mask, probes = 0; probes < table->capacity;
+         i = (i + 1) & mask, probes++) {
+        uint64_t key = table->slots[i].key.load(std::memory_order_acquire);
+        if (key == kernel_id) {
+            return table->slots[i].counts.load(std::memory_order_acquire);
+        }
+        if (key == kEmptyKey) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+CounterSelector::Slot& CounterSelector::slot_for(Table* table, uint64_t kernel_id) {
+    size_t mask = table->capacity - 1;
+    size_t i = hash(kernel_id) & mask;
+    while (true) {
+        uint64_t key = table->slots[i].key.load(std::memory_order_relaxed);
+        if (key == kernel_id || key == kEmptyKey) {
+            return table->slots[i];
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+void CounterSelector::grow() {
+    Table* old_table = table_.load(std::memory_order_relaxed);
+    auto bigger = std::make_unique<Table>(old_table->capacity * 2);
+    for (size_t i = 0; i < old_table->capacity; i++) {
+        uint64_t key = old_table->slots[i].key.load(std::memory_order_relaxed);
+        if (key == kEmptyKey) {
+            continue;
+        }
+        // The copy shares the kernel's counters with the old slot
+        Slot& slot = slot_for(bigger.get(), key);
+        slot.counts.store(old_table->slots[i].counts.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        slot.key.store(key, std::memory_order_relaxed);
+    }
+    // Readers that already loaded the old table keep probing it safely
+    table_.store(bigger.get(), std::memory_order_release);
+    tables_.push_back(std::move(bigger));
+}
+
+CounterSelector::Counts* CounterSelector::insert(uint64_t kernel_id) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    // Another thread may have inserted the kernel since find() missed
+    Table* table = table_.load(std::memory_order_relaxed);
+    Slot& existing = slot_for(table, kernel_id);
+    if (existing.key.load(std::memory_order_relaxed) == kernel_id) {
+        return existing.counts.load(std::memory_order_relaxed);
+    }
+
+    if ((counts_.size() + 1) * 2 > table->capacity) {
+        grow();
+        table = table_.load(std::memory_order_relaxed);
+    }
+    counts_.emplace_back();
+    Counts* counts = &counts_.back();
+
+    // Publish the counters before the key so a reader that sees the key sees them
+    Slot& slot = slot_for(table, kernel_id);
+    slot.counts.store(counts, std::memory_order_release);
+    slot.key.store(kernel_id, std::memory_order_release);
+    return counts;
+}
+
+size_t CounterSelector::kernels() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return counts_.size();
+}
+
+bool CounterSelector::select(uint64_t kernel_id, uint32_t passes, uint32_t& pass) {
+    Counts* counts = find(kernel_id);
+    if (!counts) {
+        counts = insert(kernel_id);
+    }
+    const uint64_t dispatch = counts->dispatches.fetch_add(1, std::memory_order_relaxed);
+    if ((first_ && dispatch >= first_) || dispatch % every_ != 0) {
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const uint64_t counted = counts->counted.fetch_add(1, std::memory_order_relaxed);
+    pass = passes > 1 ? (uint32_t)(counted % passes) : 0;
+    counted_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace rpv3
@@ -0,0 +1,99 @@
+// MIT License
+// RPV3 Counter Select - Which dispatches of a kernel are counted
+//
+// A counted dispatch is serialized and read out by the counter hardware, so
+// counting every dispatch slows the whole job. The tracer leaves the profile
+// of a dispatch empty unless its kernel was selected:
+//
+// - by name (--counter-kernels), decided once when the kernel symbol
+//   registers and cached in the symbol's flags, like --include/--exclude
+// - by the first K dispatches of the kernel (--counter-first)
+// - by one dispatch in N of the kernel (--counter-every)
+//
+// The per-kernel dispatch numbers live in an open-addressed table that is
+// looked up without a lock. A kernel's first dispatch inserts it under a
+// mutex; when the table fills, a larger copy is published RCU-style like
+// KernelRegistry's and the old one is kept alive, so no kernel is ever
+// turned away. Slots point at per-kernel counters that never move, so an
+// increment made through a retired table is not lost. The pass of a
+// multiplexed counter set (rpv3_counter_passes.h) rotates over the counted
+// dispatches only; rotating over all dispatches would count the same pass
+// every time when N is a multiple of the number of passes.
+
+#ifndef RPV3_COUNTER_SELECT_H
+#define RPV3_COUNTER_SELECT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rpv3 {
+
+class CounterSelector {
+public:
+    explicit CounterSelector(size_t initial_capacity = 1024);
+    ~CounterSelector();
+
+    CounterSelector(const CounterSelector&) = delete;
+    CounterSelector& operator=(const CounterSelector&) = delete;
+
+    // Count the first `first` dispatches of each kernel (0 = no limit) and,
+    // among those, one in `every`. Not thread-safe; call before any dispatch.
+    void configure(uint64_t first, uint64_t every);
+
+    // Decide for the next dispatch of kernel_id. Returns true with the pass
+    // to count in [0, passes) when the dispatch is counted. Thread-safe.
+    bool select(uint64_t kernel_id, uint32_t passes, uint32_t& pass);
+
+    // Dispatches counted and skipped so far
+    uint64_t counted() const { return counted_.load(std::memory_order_relaxed); }
+    uint64_t skipped() const { return skipped_.load(std::memory_order_relaxed); }
+
+    // Kernels seen so far
+    size_t kernels() const;
+
+private:
+    static constexpr uint64_t kEmptyKey = ~0ULL;
+
+    struct Counts {
+        std::atomic<uint64_t> dispatches{0};
+        std::atomic<uint64_t> counted{0};
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> key{kEmptyKey};
+        std::atomic<Counts*> counts{nullptr};
+    };
+
+    struct Table {
+        explicit Table(size_t capacity_) : capacity(capacity_), slots(new Slot[capacity_]) {}
+        size_t capacity;  // Power of two
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    static size_t hash(uint64_t kernel_id) {
+        return (size_t)((kernel_id * 0x9e3779b97f4a7c15ULL) >> 17);
+    }
+
+    Counts* find(uint64_t kernel_id) const;
+    Counts* insert(uint64_t kernel_id);
+    Slot& slot_for(Table* table, uint64_t kernel_id);
+    void grow();
+
+    uint64_t first_ = 0;
+    uint64_t every_ = 1;
+    mutable std::mutex write_mutex_;
+    std::atomic<Table*> table_;
+    std::vector<std::unique_ptr<Table>> tables_;  // Live table last, retired before it
+    std::deque<Counts> counts_;                   // Stable addresses for published entries
+    std::atomic<uint64_t> counted_{0};
+    std::atomic<uint64_t> skipped_{0};
+};
+
+} // namespace rpv3
+
+#endif // RPV3_COUNTER_SELECT_H
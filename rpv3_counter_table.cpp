@@ -0,0 +1,161 @@
+// MIT License
+// RPV3 Counter Table - Implementation
+// See rpv3_counter_table.h for how records become rows
+
+#include "rpv3_counter_table.h"
+
+#include <cmath>
+
+namespace rpv3 {
+
+size_t CounterTable::add_column(std::string_view name) {
+    for (size_t i = 0; i < columns_.size(); i++) {
+        if (columns_[i] == name) {
+            return i;
+        }
+    }
+    columns_.emplace_back(name);
+    return columns_.size() - 1;
+}
+
+size_t CounterTable::add_counter(uint64_t counter_id, std::string_view name) {
+    auto it = column_by_id_.find(counter_id);
+    if (it != column_by_id_.end()) {
+        return it->second;
+    }
+    const size_t column = add_column(name);
+    column_by_id_.emplace(counter_id, column);
+    return column;
+}
+
+int CounterTable::column(uint64_t counter_id) const {
+    auto it = column_by_id_.find(counter_id);
+    return it != column_by_id_.end() ? (int)it->second : -1;
+}
+
+void CounterTable::begin_dispatch(const DispatchRecord& dispatch, uint64_t agent_id) {
+    CounterRow row;
+    row.dispatch = dispatch;
+    row.agent_id = agent_id;
+    std::lock_guard<std::mutex> lock(dispatches_mutex_);
+    dispatches_[dispatch.dispatch_id] = std::move(row);
+}
+
+void CounterTable::open_row(uint64_t dispatch_id) {
+    row_ = CounterRow();
+    {
+        std::lock_guard<std::mutex> lock(dispatches_mutex_);
+        auto it = dispatches_.find(dispatch_id);
+        if (it != dispatches_.end()) {
+            row_ = std::move(it->second);
+            dispatches_.erase(it);
+        }
+    }
+    row_.dispatch.dispatch_id = dispatch_id;
+    row_.values.assign(columns_.size(), 0.0);
+    row_.instances.assign(columns_.size(), 0);
+    row_open_ = true;
+}
+
+bool CounterTable::add(uint64_t dispatch_id, uint64_t counter_id, double value, CounterRow& completed) {
+    const int column = this->column(counter_id);
+    if (column < 0) {
+        return false;
+    }
+    bool done = false;
+    if (row_open_ && row_.dispatch.dispatch_id != dispatch_id) {
+        completed = std::move(row_);
+        done = true;
+        row_open_ = false;
+    }
+    if (!row_open_) {
+        open_row(dispatch_id);
+    }
+    row_.values[column] += value;
+    row_.instances[column]++;
+    return done;
+}
+
+bool CounterTable::finish(CounterRow& completed) {
+    if (!row_open_) {
+        return false;
+    }
+    completed = std::move(row_);
+    row_open_ = false;
+    return true;
+}
+
+size_t CounterTable::pending_dispatches() const {
+    std::lock_guard<std::mutex> lock(dispatches_mutex_);
+    return dispatches_.size();
+}
+
+void counter_values(const CounterRow& row, std::vector<double>& values) {
+    values.resize(row.values.size());
+    for (size_t i = 0; i < row.values.size(); i++) {
+        values[i] = row.has(i) ? row.values[i] : NAN;
+    }
+}
+
+std::string counter_csv_header(const std::vector<std::string>& columns) {
+    std::string header = "KernelName,DispatchID,CorrelationID,KernelID,AgentID,"
+                         "GridX,GridY,GridZ,WorkgroupX,WorkgroupY,WorkgroupZ";
+    for (const std::string& name : columns) {
+        header.append(",").append(name);
+    }
+    return header.append("\n");
+}
+
+std::string joined_csv_header(bool blas_columns, const std::vector<std::string>& columns) {
+    std::string header = csv_header(blas_columns);
+    header.pop_back();
+    for (const std::string& name : columns) {
+        header.append(",").append(name);
+    }
+    return header.append("\n");
+}
+
+void format_counter_fields(RecordBuffer& out, const std::vector<double>& values) {
+    for (double value : values) {
+        out.append(',');
+        if (!std::isnan(value)) {
+            out.append_double(value);
+        }
+    }
+}
+
+void format_counter_csv_row(RecordBuffer& out, std::string_view kernel_name, const CounterRow& row,
+                            const std::vector<double>& values) {
+    const DispatchRecord& d = row.dispatch;
+    out.append('"').append(kernel_name).append("\",");
+    out.append_u64(d.dispatch_id).append(',');
+    out.append_u64(d.correlation_id).append(',');
+    out.append_u64(d.kernel_id).append(',');
+    out.append_u64(row.agent_id);
+    for (uint32_t v : d.grid) {
+        out.append(',').append_u64(v);
+    }
+    for (uint32_t v : d.workgroup) {
+        out.append(',').append_u64(v);
+    }
+    format_counter_fields(out, values);
+    out.append('\n');
+}
+
+void format_counter_text(RecordBuffer& out, std::string_view kernel_name, const CounterRow& row,
+                         const std::vector<std::string>& columns, const std::vector<double>& values) {
+    const DispatchRecord& d = row.dispatch;
+    out.append("[Counters] ").append(kernel_name)
+       .append(" dispatch ").append_u64(d.dispatch_id)
+       .append(" agent ").append_u64(row.agent_id)
+       .append(" grid [").append_u64(d.grid[0]).append(", ").append_u64(d.grid[1])
+       .append(", ").append_u64(d.grid[2]).append("]:");
+    for (size_t i = 0; i < values.size() && i < columns.size(); i++) {
+        if (!std::isnan(values[i])) {
+            out.append(' ').append(columns[i]).append('=').append_double(values[i]);
+        }
+    }
+    out.append('\n');
+}
+
+} // namespace rpv3
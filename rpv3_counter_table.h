@@ -0,0 +1,126 @@
+// MIT License
+// RPV3 Counter Table - One row per dispatch from counter collection records
+//
+// rocprofiler delivers counter collection results as one record per counter
+// instance (the value of one counter on one shader engine, XCC or other
+// hardware dimension), tagged with a dispatch id and an instance id that
+// resolves to a counter id. The tracer reduces them to one row per dispatch:
+//
+// - Columns come from the profile configs. add_counter() maps a counter id
+//   to a named column when the profile is created; agents that report the
+//   same counter name share its column.
+// - dispatch_counting_callback is the only place the kernel, launch shape
+//   and agent of a counted dispatch are known, so it records them here
+//   (begin_dispatch).
+// - The buffer callback feeds instance values in (add) and instances of a
+//   counter are summed into its column. The records of one dispatch are
+//   written to the buffer together, so a row is complete once a record of
+//   another dispatch arrives, or when the buffer is flushed at exit (finish).
+//
+// Rows are written as a text line, as a CSV row with one column per
+// counter, or as binary kRecordDispatch + kRecordCounter records. The
+// columns written need not be the collected counters: with --counters
+// metrics (rpv3_counter_metrics.h) they are computed from the row first.
+// With --timeline, rows complete the timeline record of their dispatch
+// instead (rpv3_counter_join.h).
+
+#ifndef RPV3_COUNTER_TABLE_H
+#define RPV3_COUNTER_TABLE_H
+
+#include "rpv3_record.h"
+#include "rpv3_record_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace rpv3 {
+
+struct CounterRow {
+    DispatchRecord dispatch;          // Counted dispatches carry no timestamps
+    uint64_t agent_id = 0;
+    std::vector<double> values;       // Per column, summed across instances
+    std::vector<uint32_t> instances;  // Records summed per column; 0 = not collected
+
+    bool has(size_t column) const { return column < instances.size() && instances[column] > 0; }
+};
+
+class CounterTable {
+public:
+    CounterTable() = default;
+
+    CounterTable(const CounterTable&) = delete;
+    CounterTable& operator=(const CounterTable&) = delete;
+
+    // Column for a counter name, added on first use. Declaring the columns
+    // up front fixes their order regardless of what each agent supports.
+    size_t add_column(std::string_view name);
+
+    // Column of a counter, added under name on first use. Setup only: call
+    // before any dispatch is counted.
+    size_t add_counter(uint64_t counter_id, std::string_view name);
+
+    // Column of a counter id, or -1 if no profile selected it
+    int column(uint64_t counter_id) const;
+
+    const std::vector<std::string>& columns() const { return columns_; }
+
+    // Remember the dispatch about to be counted. Thread-safe.
+    void begin_dispatch(const DispatchRecord& dispatch, uint64_t agent_id);
+
+    // Add one counter instance. Returns true with the previous row in
+    // completed when the record belongs to a new dispatch. Records of
+    // counters without a column are ignored. Single consumer only (the
+    // buffer callback).
+    bool add(uint64_t dispatch_id, uint64_t counter_id, double value, CounterRow& completed);
+
+    // The row still open after the last record, if any
+    bool finish(CounterRow& completed);
+
+    // Dispatches begun whose records have not arrived (dropped or pending)
+    size_t pending_dispatches() const;
+
+private:
+    void open_row(uint64_t dispatch_id);
+
+    std::vector<std::string> columns_;
+    std::unordered_map<uint64_t, size_t> column_by_id_;
+
+    mutable std::mutex dispatches_mutex_;
+    std::unordered_map<uint64_t, CounterRow> dispatches_;  // Begun, keyed by dispatch id
+
+    CounterRow row_;  // Row being accumulated
+    bool row_open_ = false;
+};
+
+// Summed values of a row, NaN where a counter was not collected
+void counter_values(const CounterRow& row, std::vector<double>& values);
+
+// CSV header for counter rows: dispatch fields, then one column per name
+std::string counter_csv_header(const std::vector<std::string>& columns);
+
+// Timeline CSV header, with or without the BLAS columns, followed by one
+// column per counter column (--timeline --csv with counters)
+std::string joined_csv_header(bool blas_columns, const std::vector<std::string>& columns);
+
+// ",value" per column; NaN values (not collected or not computable) are
+// left empty
+void format_counter_fields(RecordBuffer& out, const std::vector<double>& values);
+
+// One CSV row matching counter_csv_header(), values in column order. NaN
+// values (not collected or not computable) are left empty.
+void format_counter_csv_row(RecordBuffer& out, std::string_view kernel_name, const CounterRow& row,
+                            const std::vector<double>& values);
+
+// "[Counters] <kernel> dispatch N agent A grid [x, y, z]: NAME=value ..."
+// line; NaN values are left out
+void format_counter_text(RecordBuffer& out, std::string_view kernel_name, const CounterRow& row,
+                         const std::vector<std::string>& columns, const std::vector<double>& values);
+
+} // namespace rpv3
+
+#endif // RPV3_COUNTER_TABLE_H
@@ -0,0 +1,40 @@
+// MIT License
+// RPV3 Demangle - Implementation
+// See rpv3_demangle.h for when names are demangled
+
+#include "rpv3_demangle.h"
+
+#include <cstdlib>
+#include <cxxabi.h>
+
+namespace rpv3 {
+
+std::string_view strip_kd_suffix(std::string_view symbol) {
+    constexpr std::string_view kSuffix = ".kd";
+    if (symbol.size() >= kSuffix.size() &&
+        symbol.compare(symbol.size() - kSuffix.size(), kSuffix.size(), kSuffix) == 0) {
+        symbol.remove_suffix(kSuffix.size());
+    }
+    return symbol;
+}
+
+std::string demangle_symbol(std::string_view symbol) {
+    std::string name(strip_kd_suffix(symbol));
+
+    // Only Itanium-mangled names start with _Z; skip the demangler for the rest
+    if (name.size() < 2 || name[0] != '_' || name[1] != 'Z') {
+        return name;
+    }
+
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        std::string result(demangled);
+        free(demangled);
+        return result;
+    }
+    free(demangled);
+    return name;
+}
+
+} // namespace rpv3
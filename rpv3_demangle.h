@@ -0,0 +1,27 @@
+// MIT License
+// RPV3 Demangle - Kernel symbol name demangling
+//
+// Code object symbols arrive mangled and usually carry the ".kd" suffix of
+// the kernel descriptor. Demangling is comparatively expensive and libraries
+// such as rocBLAS register thousands of symbols at startup, so the tracer
+// stores mangled names and demangles on first use (see rpv3_kernel_registry.h).
+// Binary traces keep mangled names and leave demangling to the converter.
+
+#ifndef RPV3_DEMANGLE_H
+#define RPV3_DEMANGLE_H
+
+#include <string>
+#include <string_view>
+
+namespace rpv3 {
+
+// Drop a trailing ".kd" (kernel descriptor symbol) if present
+std::string_view strip_kd_suffix(std::string_view symbol);
+
+// Demangled form of a symbol, or the symbol itself (minus ".kd") when it is
+// not a mangled C++ name
+std::string demangle_symbol(std::string_view symbol);
+
+} // namespace rpv3
+
+#endif // RPV3_DEMANGLE_H
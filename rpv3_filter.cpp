@@ -0,0 +1,212 @@
+// MIT License
+// RPV3 Filter - Implementation
+// See rpv3_filter.h for the filter syntax
+
+#include "rpv3_filter.h"
+
+#include <fnmatch.h>
+
+#include <charconv>
+
+namespace rpv3 {
+
+std::string NameFilter::compile(std::string_view pattern) {
+    if (pattern.find_first_of("*?[") == std::string_view::npos) {
+        std::string glob;
+        glob.reserve(pattern.size() + 2);
+        glob.append("*").append(pattern).append("*");
+        return glob;
+    }
+    return std::string(pattern);
+}
+
+void NameFilter::add_include(std::string_view pattern) {
+    includes_.push_back(compile(pattern));
+}
+
+void NameFilter::add_exclude(std::string_view pattern) {
+    excludes_.push_back(compile(pattern));
+}
+
+bool NameFilter::matches(std::string_view kernel_name) const {
+    // fnmatch needs a terminated string
+    const std::string name(kernel_name);
+    if (!includes_.empty()) {
+        bool included = false;
+        for (const std::string& pattern : includes_) {
+            if (fnmatch(pattern.c_str(), name.c_str(), 0) == 0) {
+                included = true;
+                break;
+            }
+        }
+        if (!included) {
+            return false;
+        }
+    }
+    for (const std::string& pattern : excludes_) {
+        if (fnmatch(pattern.c_str(), name.c_str(), 0) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace {
+    struct FieldName {
+        const char* name;
+        DispatchFilter::Field field;
+    };
+
+    const FieldName kFields[] = {
+        {"duration", DispatchFilter::Field::Duration},
+        {"grid", DispatchFilter::Field::Grid},
+        {"workgroup", DispatchFilter::Field::Workgroup},
+        {"wg", DispatchFilter::Field::Workgroup},
+        {"lds", DispatchFilter::Field::Lds},
+        {"scratch", DispatchFilter::Field::Scratch},
+    };
+
+    bool fail(std::string* error, std::string message) {
+        if (error) {
+            *error = std::move(message);
+        }
+        return false;
+    }
+
+    // Multiplier for a value suffix, 0 if the suffix is not valid for the field
+    uint64_t unit_scale(DispatchFilter::Field field, std::string_view unit) {
+        if (unit.empty()) {
+            return 1;
+        }
+        if (field == DispatchFilter::Field::Duration) {
+            if (unit == "ns") return 1;
+            if (unit == "us") return 1000;
+            if (unit == "ms") return 1000000;
+            if (unit == "s") return 1000000000;
+            return 0;
+        }
+        if (field == DispatchFilter::Field::Lds || field == DispatchFilter::Field::Scratch) {
+            if (unit == "K" || unit == "k") return 1024;
+            if (unit == "M" || unit == "m") return 1024 * 1024;
+        }
+        return 0;
+    }
+
+    bool parse_predicate(std::string_view text, DispatchFilter::Predicate& out, std::string* error) {
+        size_t op_pos = text.find_first_of("<>=!");
+        if (op_pos == std::string_view::npos) {
+            return fail(error, "missing comparison in '" + std::string(text) + "'");
+        }
+
+        std::string_view name = text.substr(0, op_pos);
+        bool known = false;
+        for (const FieldName& f : kFields) {
+            if (name == f.name) {
+                out.field = f.field;
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            return fail(error, "unknown field '" + std::string(name) +
+                               "' (duration, grid, workgroup, lds, scratch)");
+        }
+
+        std::string_view rest = text.substr(op_pos);
+        size_t op_len = 1;
+        if (rest.compare(0, 2, "<=") == 0) { out.op = DispatchFilter::Op::LessEqual; op_len = 2; }
+        else if (rest.compare(0, 2, ">=") == 0) { out.op = DispatchFilter::Op::GreaterEqual; op_len = 2; }
+        else if (rest.compare(0, 2, "==") == 0) { out.op = DispatchFilter::Op::Equal; op_len = 2; }
+        else if (rest.compare(0, 2, "!=") == 0) { out.op = DispatchFilter::Op::NotEqual; op_len = 2; }
+        else if (rest[0] == '<') { out.op = DispatchFilter::Op::Less; }
+        else if (rest[0] == '>') { out.op = DispatchFilter::Op::Greater; }
+        else if (rest[0] == '=') { out.op = DispatchFilter::Op::Equal; }
+        else {
+            return fail(error, "invalid comparison in '" + std::string(text) + "'");
+        }
+
+        std::string_view value = rest.substr(op_len);
+        uint64_t number = 0;
+        auto result = std::from_chars(value.data(), value.data() + value.size(), number);
+        if (result.ec != std::errc() || result.ptr == value.data()) {
+            return fail(error, "invalid number in '" + std::string(text) + "'");
+        }
+        std::string_view unit = value.substr(result.ptr - value.data());
+        uint64_t scale = unit_scale(out.field, unit);
+        if (scale == 0) {
+            return fail(error, "invalid unit '" + std::string(unit) + "' in '" + std::string(text) + "'");
+        }
+        out.value = number * scale;
+        return true;
+    }
+}
+
+bool DispatchFilter::compile(std::string_view expression, std::string* error) {
+    std::vector<Predicate> compiled;
+    size_t start = 0;
+    while (start <= expression.size()) {
+        size_t end = expression.find(',', start);
+        if (end == std::string_view::npos) {
+            end = expression.size();
+        }
+        std::string_view term = expression.substr(start, end - start);
+        if (term.empty()) {
+            return fail(error, "empty predicate");
+        }
+        Predicate predicate{};
+        if (!parse_predicate(term, predicate, error)) {
+            return false;
+        }
+        compiled.push_back(predicate);
+        start = end + 1;
+    }
+
+    for (const Predicate& p : compiled) {
+        predicates_.push_back(p);
+        uses_duration_ = uses_duration_ || p.field == Field::Duration;
+    }
+    return true;
+}
+
+bool DispatchFilter::matches_launch(const DispatchRecord& record) const {
+    for (const Predicate& p : predicates_) {
+        if (p.field != Field::Duration && !test(p, record)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DispatchFilter::test(const Predicate& p, const DispatchRecord& record) {
+    uint64_t value;
+    switch (p.field) {
+        case Field::Duration:
+            if (record.end_ns == 0) {
+                return false;
+            }
+            value = record.duration_ns();
+            break;
+        case Field::Grid:
+            value = (uint64_t)record.grid[0] * record.grid[1] * record.grid[2];
+            break;
+        case Field::Workgroup:
+            value = (uint64_t)record.workgroup[0] * record.workgroup[1] * record.workgroup[2];
+            break;
+        case Field::Lds:
+            value = record.group_segment_size;
+            break;
+        default:
+            value = record.private_segment_size;
+            break;
+    }
+    switch (p.op) {
+        case Op::Less:         return value < p.value;
+        case Op::LessEqual:    return value <= p.value;
+        case Op::Greater:      return value > p.value;
+        case Op::GreaterEqual: return value >= p.value;
+        case Op::Equal:        return value == p.value;
+        default:               return value != p.value;
+    }
+}
+
+} // namespace rpv3
@@ -0,0 +1,87 @@
+// MIT License
+// RPV3 Filter - Kernel name patterns and numeric dispatch predicates
+//
+// Name patterns (--include/--exclude) are matched once per kernel symbol and
+// the verdict is cached by the tracer, so dispatches never touch a pattern.
+// Numeric predicates (--filter) are compiled once into a flat list of
+// (field, operator, constant) triples that is evaluated per dispatch.
+
+#ifndef RPV3_FILTER_H
+#define RPV3_FILTER_H
+
+#include "rpv3_record.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rpv3 {
+
+class NameFilter {
+public:
+    // Shell-style glob (fnmatch). A pattern without *, ? or [ matches any
+    // name containing it.
+    void add_include(std::string_view pattern);
+    void add_exclude(std::string_view pattern);
+
+    bool empty() const { return includes_.empty() && excludes_.empty(); }
+
+    // A name passes when it matches some include pattern (or there are none)
+    // and no exclude pattern
+    bool matches(std::string_view kernel_name) const;
+
+private:
+    static std::string compile(std::string_view pattern);
+
+    std::vector<std::string> includes_;
+    std::vector<std::string> excludes_;
+};
+
+class DispatchFilter {
+public:
+    enum class Field { Duration, Grid, Workgroup, Lds, Scratch };
+    enum class Op { Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual };
+
+    struct Predicate {
+        Field field;
+        Op op;
+        uint64_t value;
+    };
+
+    // Add comma-separated predicates such as "duration>=10us,lds>0".
+    // Fields: duration (ns/us/ms/s), grid and workgroup (total work-items),
+    // lds and scratch (bytes, K/M suffix). All predicates must hold.
+    // Returns false and leaves the filter unchanged on a syntax error.
+    bool compile(std::string_view expression, std::string* error = nullptr);
+
+    bool empty() const { return predicates_.empty(); }
+
+    // True when some predicate needs the kernel's completion timestamp
+    bool uses_duration() const { return uses_duration_; }
+
+    // Duration predicates fail for records without an end timestamp
+    bool matches(const DispatchRecord& record) const {
+        for (const Predicate& p : predicates_) {
+            if (!test(p, record)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // As matches(), but ignores duration predicates (dispatch-time decisions)
+    bool matches_launch(const DispatchRecord& record) const;
+
+    const std::vector<Predicate>& predicates() const { return predicates_; }
+
+private:
+    static bool test(const Predicate& p, const DispatchRecord& record);
+
+    std::vector<Predicate> predicates_;
+    bool uses_duration_ = false;
+};
+
+} // namespace rpv3
+
+#endif // RPV3_FILTER_H
@@ -0,0 +1,171 @@
+// MIT License
+// RPV3 Histogram - Implementation
+// See rpv3_histogram.h for the bucket layout
+
+#include "rpv3_histogram.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace rpv3 {
+
+LatencyHistogram::LatencyHistogram() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::bucket_low(size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    uint64_t shift = index / kSubBuckets - 1;
+    uint64_t sub = index % kSubBuckets;
+    return (kSubBuckets + sub) << shift;
+}
+
+uint64_t LatencyHistogram::bucket_high(size_t index) {
+    if (index == kBucketCount - 1) {
+        return ~0ULL;
+    }
+    return bucket_low(index + 1) - 1;
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (const auto& bucket : buckets_) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::percentile(double quantile) const {
+    const uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    // Rank of the value at this quantile, 1-based
+    uint64_t rank = (uint64_t)(quantile * (double)total + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, total));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucket_high(i), max());
+        }
+    }
+    return max();
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < kBucketCount; i++) {
+        uint64_t n = other.buckets_[i].load(std::memory_order_relaxed);
+        if (n) {
+            buckets_[i].fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+    uint64_t other_max = other.max();
+    uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (other_max > seen && !max_.compare_exchange_weak(seen, other_max, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramTable::HistogramTable(size_t capacity)
+    : capacity_(capacity ? capacity : 1), slots_(new Slot[capacity_]) {
+}
+
+HistogramTable::~HistogramTable() {
+    for (size_t i = 0; i < capacity_; i++) {
+        delete slots_[i].histogram.load();
+    }
+    delete[] slots_;
+}
+
+LatencyHistogram* HistogramTable::find_or_insert(uint64_t kernel_id) {
+    // Fibonacci hashing spreads the small sequential kernel ids
+    size_t start = (size_t)((kernel_id * 0x9e3779b97f4a7c15ULL) % capacity_);
+    for (size_t probe = 0; probe < capacity_; probe++) {
+        Slot& slot = slots_[(start + probe) % capacity_];
+        uint64_t key = slot.key.load(std::memory_order_acquire);
+
+        if (key == kEmptyKey) {
+            uint64_t expected = kEmptyKey;
+            if (slot.key.compare_exchange_strong(expected, kernel_id, std::memory_order_acq_rel)) {
+                LatencyHistogram* histogram = new LatencyHistogram();
+                slot.histogram.store(histogram, std::memory_order_release);
+                return histogram;
+            }
+            key = expected;  // Another thread claimed the slot first
+        }
+
+        if (key == kernel_id) {
+            // The claiming thread publishes the histogram right after the key
+            LatencyHistogram* histogram;
+            while ((histogram = slot.histogram.load(std::memory_order_acquire)) == nullptr) {
+                std::this_thread::yield();
+            }
+            return histogram;
+        }
+    }
+    return nullptr;
+}
+
+void HistogramTable::record(uint64_t kernel_id, uint64_t duration_ns) {
+    LatencyHistogram* histogram = find_or_insert(kernel_id);
+    if (!histogram) {
+        overflow_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    histogram->record(duration_ns);
+}
+
+std::vector<HistogramEntry> HistogramTable::entries() const {
+    std::vector<HistogramEntry> result;
+    for (size_t i = 0; i < capacity_; i++) {
+        LatencyHistogram* histogram = slots_[i].histogram.load(std::memory_order_acquire);
+        if (histogram) {
+            result.push_back({slots_[i].key.load(std::memory_order_relaxed), histogram});
+        }
+    }
+    return result;
+}
+
+void print_percentiles(FILE* out, const std::vector<NamedHistogram>& kernels) {
+    fprintf(out, "\n[Kernel Latency Percentiles] %zu kernels (us, log buckets within ~3%%)\n", kernels.size());
+    fprintf(out, "%-60s %10s %12s %12s %12s %12s %12s\n",
+            "Kernel Name", "Count", "p50", "p90", "p99", "p99.9", "Max");
+    for (const NamedHistogram& k : kernels) {
+        const LatencyHistogram& h = *k.histogram;
+        std::string name = k.name;
+        if (name.size() > 60) {
+            name = name.substr(0, 57) + "...";
+        }
+        fprintf(out, "%-60s %10lu %12.3f %12.3f %12.3f %12.3f %12.3f\n",
+                name.c_str(), (unsigned long)h.count(),
+                h.percentile(0.50) / 1000.0, h.percentile(0.90) / 1000.0,
+                h.percentile(0.99) / 1000.0, h.percentile(0.999) / 1000.0,
+                h.max() / 1000.0);
+    }
+}
+
+bool write_histogram_csv(FILE* out, const std::vector<NamedHistogram>& kernels) {
+    fprintf(out, "# rpv3-histogram v1 sub_bucket_bits=%u\n", LatencyHistogram::kSubBucketBits);
+    fprintf(out, "KernelName,BucketLowNs,BucketHighNs,Count\n");
+    for (const NamedHistogram& k : kernels) {
+        for (size_t i = 0; i < LatencyHistogram::kBucketCount; i++) {
+            uint64_t n = k.histogram->bucket_count(i);
+            if (n == 0) {
+                continue;
+            }
+            // The last bucket is open-ended; its recorded maximum is the useful bound
+            uint64_t high = (i == LatencyHistogram::kBucketCount - 1) ? k.histogram->max()
+                                                                       : LatencyHistogram::bucket_high(i);
+            fprintf(out, "\"%s\",%lu,%lu,%lu\n", k.name.c_str(),
+                    (unsigned long)LatencyHistogram::bucket_low(i), (unsigned long)high, (unsigned long)n);
+        }
+    }
+    return ferror(out) == 0;
+}
+
+} // namespace rpv3
@@ -0,0 +1,135 @@
+// MIT License
+// RPV3 Histogram - Fixed-memory per-kernel latency histograms for --histogram
+//
+// Buckets are log-linear (HDR-style): values below 2^kSubBucketBits ns get
+// one bucket each, every higher power-of-two range is split into
+// 2^kSubBucketBits equal buckets, so a bucket is at most ~3% wide relative to
+// its value. Values at or above 2^(kMaxExponent + 1) ns (~36 minutes) land in
+// the last bucket. Every histogram has the same fixed size (kHistogramBytes),
+// and the table holds at most a fixed number of kernels, so memory is known
+// up front. Recording is lock-free: one relaxed atomic add per dispatch.
+
+#ifndef RPV3_HISTOGRAM_H
+#define RPV3_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace rpv3 {
+
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 5;
+    static constexpr unsigned kMaxExponent = 40;
+    static constexpr uint64_t kSubBuckets = 1ULL << kSubBucketBits;
+    static constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    LatencyHistogram();
+
+    void record(uint64_t value_ns) {
+        buckets_[bucket_index(value_ns)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t seen = max_.load(std::memory_order_relaxed);
+        while (value_ns > seen &&
+               !max_.compare_exchange_weak(seen, value_ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    static size_t bucket_index(uint64_t value_ns) {
+        if (value_ns < kSubBuckets) {
+            return (size_t)value_ns;
+        }
+        unsigned exponent = 63u - (unsigned)__builtin_clzll(value_ns);
+        if (exponent > kMaxExponent) {
+            return kBucketCount - 1;
+        }
+        unsigned shift = exponent - kSubBucketBits;
+        return (size_t)(shift + 1) * kSubBuckets + (size_t)((value_ns >> shift) - kSubBuckets);
+    }
+
+    // Inclusive value range covered by a bucket
+    static uint64_t bucket_low(size_t index);
+    static uint64_t bucket_high(size_t index);
+
+    uint64_t count() const;
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t bucket_count(size_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
+
+    // Smallest bucket upper bound at or below which `quantile` (0..1] of the
+    // recorded values fall, capped at the recorded maximum. 0 when empty.
+    uint64_t percentile(double quantile) const;
+
+    // Add another histogram's counts (used to merge kernels or processes)
+    void merge(const LatencyHistogram& other);
+
+private:
+    std::atomic<uint64_t> buckets_[kBucketCount];
+    std::atomic<uint64_t> max_{0};
+};
+
+// Fixed memory per kernel, known at compile time
+constexpr size_t kHistogramBytes = sizeof(LatencyHistogram);
+
+struct HistogramEntry {
+    uint64_t kernel_id = 0;
+    const LatencyHistogram* histogram = nullptr;
+};
+
+// Kernel id -> histogram, open addressing over a fixed number of slots.
+// Lookups and inserts are lock-free; a histogram is allocated the first
+// time its kernel completes and lives as long as the table.
+class HistogramTable {
+public:
+    static constexpr size_t kDefaultCapacity = 4096;
+
+    explicit HistogramTable(size_t capacity = kDefaultCapacity);
+    ~HistogramTable();
+
+    HistogramTable(const HistogramTable&) = delete;
+    HistogramTable& operator=(const HistogramTable&) = delete;
+
+    void record(uint64_t kernel_id, uint64_t duration_ns);
+
+    // Histograms in slot order. Safe to call while recording continues.
+    std::vector<HistogramEntry> entries() const;
+
+    // Dispatches not recorded because every slot was taken
+    uint64_t overflow() const { return overflow_.load(std::memory_order_relaxed); }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    static constexpr uint64_t kEmptyKey = ~0ULL;
+
+    struct Slot {
+        std::atomic<uint64_t> key{kEmptyKey};
+        std::atomic<LatencyHistogram*> histogram{nullptr};
+    };
+
+    LatencyHistogram* find_or_insert(uint64_t kernel_id);
+
+    size_t capacity_;
+    Slot* slots_;
+    std::atomic<uint64_t> overflow_{0};
+};
+
+struct NamedHistogram {
+    std::string name;
+    uint64_t kernel_id = 0;
+    const LatencyHistogram* histogram = nullptr;
+};
+
+// Text table of count, p50, p90, p99, p99.9 and max per kernel (microseconds)
+void print_percentiles(FILE* out, const std::vector<NamedHistogram>& kernels);
+
+// Machine-readable dump: one "KernelName,BucketLowNs,BucketHighNs,Count" row
+// per non-empty bucket. Dumps from several processes merge by summing Count
+// per (KernelName, BucketLowNs); see utils/merge_histograms.py.
+bool write_histogram_csv(FILE* out, const std::vector<NamedHistogram>& kernels);
+
+} // namespace rpv3
+
+#endif // RPV3_HISTOGRAM_H
@@ -0,0 +1,172 @@
+// MIT License
+// RPV3 Kernel Registry - Implementation
+// See rpv3_kernel_registry.h for the concurrency design
+
+#include "rpv3_kernel_registry.h"
+#include "rpv3_demangle.h"
+
+#include <cstring>
+
+namespace rpv3 {
+
+std::string_view StringArena::copy(std::string_view text) {
+    const size_t needed = text.size() + 1;
+    char* dest;
+    if (needed > kChunkSize) {
+        // Oversized names get a chunk of their own; the current chunk stays open
+        chunks_.emplace_back(new char[needed]);
+        dest = chunks_.back().get();
+    } else {
+        if (chunk_used_ + needed > kChunkSize) {
+            chunks_.emplace_back(new char[kChunkSize]);
+            current_ = chunks_.back().get();
+            chunk_used_ = 0;
+        }
+        dest = current_ + chunk_used_;
+        chunk_used_ += needed;
+    }
+    memcpy(dest, text.data(), text.size());
+    dest[text.size()] = '\0';
+    bytes_used_ += needed;
+    return std::string_view(dest, text.size());
+}
+
+std::string_view StringArena::intern(std::string_view text) {
+    auto it = strings_.find(text);
+    if (it != strings_.end()) {
+        return *it;
+    }
+    std::string_view stored = copy(text);
+    strings_.insert(stored);
+    return stored;
+}
+
+KernelRegistry::KernelRegistry(size_t initial_capacity) {
+    size_t capacity = 16;
+    while (capacity < initial_capacity * 2) {
+        capacity <<= 1;
+    }
+    tables_.push_back(std::make_unique<Table>(capacity));
+    table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+KernelRegistry::~KernelRegistry() = default;
+
+KernelRegistry::Slot& KernelRegistry::slot_for(Table* table, uint64_t kernel_id) {
+    size_t mask = table->capacity - 1;
+    size_t i = hash(kernel_id) & mask;
+    while (true) {
+        uint64_t key = table->slots[i].key.load(std::memory_order_relaxed);
+        if (key == kernel_id || key == kEmptyKey) {
+            return table->slots[i];
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+void KernelRegistry::grow() {
+    Table* old_table = table_.load(std::memory_order_relaxed);
+    auto bigger = std::make_unique<Table>(old_table->capacity * 2);
+    used_slots_ = 0;
+    for (size_t i = 0; i < old_table->capacity; i++) {
+        uint64_t key = old_table->slots[i].key.load(std::memory_order_relaxed);
+        const KernelSymbol* symbol = old_table->slots[i].symbol.load(std::memory_order_relaxed);
+        if (key == kEmptyKey || symbol == nullptr) {
+            continue;  // Erased kernels are dropped on copy
+        }
+        Slot& slot = slot_for(bigger.get(), key);
+        slot.symbol.store(symbol, std::memory_order_relaxed);
+        slot.key.store(key, std::memory_order_relaxed);
+        used_slots_++;
+    }
+    // Readers that already loaded the old table keep probing it safely
+    table_.store(bigger.get(), std::memory_order_release);
+    tables_.push_back(std::move(bigger));
+}
+
+const KernelSymbol* KernelRegistry::insert(uint64_t kernel_id, std::string_view mangled, uint32_t flags) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    Table* table = table_.load(std::memory_order_relaxed);
+    if ((used_slots_ + 1) * 2 > table->capacity) {
+        grow();
+        table = table_.load(std::memory_order_relaxed);
+    }
+
+    symbols_.emplace_back(kernel_id, arena_.intern(mangled), flags);
+    const KernelSymbol* symbol = &symbols_.back();
+
+    Slot& slot = slot_for(table, kernel_id);
+    const bool new_key = slot.key.load(std::memory_order_relaxed) == kEmptyKey;
+    const bool was_registered = !new_key && slot.symbol.load(std::memory_order_relaxed) != nullptr;
+
+    // Publish the entry before the key so a reader that sees the key sees the entry
+    slot.symbol.store(symbol, std::memory_order_release);
+    if (new_key) {
+        slot.key.store(kernel_id, std::memory_order_release);
+        used_slots_++;
+    }
+    if (!was_registered) {
+        size_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return symbol;
+}
+
+void KernelRegistry::erase(uint64_t kernel_id) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Table* table = table_.load(std::memory_order_relaxed);
+    Slot& slot = slot_for(table, kernel_id);
+    if (slot.key.load(std::memory_order_relaxed) != kernel_id) {
+        return;
+    }
+    // The key stays as a tombstone so probe chains through it are not broken
+    if (slot.symbol.exchange(nullptr, std::memory_order_acq_rel) != nullptr) {
+        size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+const std::string_view* KernelRegistry::demangled_view(std::string_view mangled) const {
+    const char* key;
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        key = arena_.intern(mangled).data();
+        auto it = demangled_.find(key);
+        if (it != demangled_.end()) {
+            return it->second;
+        }
+    }
+
+    // The demangler runs unlocked; two threads racing on one name both do the
+    // work and the first result is kept
+    std::string text = demangle_symbol(mangled);
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    auto inserted = demangled_.emplace(key, nullptr);
+    if (inserted.second) {
+        demangled_views_.push_back(arena_.intern(text));
+        inserted.first->second = &demangled_views_.back();
+    }
+    return inserted.first->second;
+}
+
+std::string_view KernelRegistry::demangled(std::string_view mangled) const {
+    return *demangled_view(mangled);
+}
+
+std::string_view KernelRegistry::resolve(const KernelSymbol& symbol) const {
+    const std::string_view* view = demangled_view(symbol.mangled);
+    symbol.demangled.store(view, std::memory_order_release);
+    return *view;
+}
+
+size_t KernelRegistry::demangled_count() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return demangled_.size();
+}
+
+size_t KernelRegistry::arena_bytes() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return arena_.bytes_used();
+}
+
+} // namespace rpv3
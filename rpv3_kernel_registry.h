@@ -0,0 +1,163 @@
+// MIT License
+// RPV3 Kernel Registry - Concurrent kernel_id -> name table
+//
+// Symbols are registered from the code object callback while dispatch and
+// buffer callbacks look them up on other threads. Writers are serialized by
+// a mutex; readers take no lock:
+//
+// - Names are interned into an append-only arena, so each distinct name is
+//   stored once and a returned string_view stays valid for the registry's
+//   lifetime, even after the symbol is unregistered.
+// - Symbols are registered with their mangled name. The demangled name is
+//   produced on first use and cached twice: by mangled name, so a code object
+//   loaded on several agents is demangled once, and in the entry itself, so
+//   later lookups are a single atomic load.
+// - Entries are immutable once published apart from that cached name.
+//   Re-registering or unregistering a kernel swaps the slot's entry pointer
+//   atomically.
+// - The open-addressing table is replaced RCU-style when it fills: the writer
+//   publishes a larger copy and keeps the old one alive until destruction, so
+//   a reader still probing it never touches freed memory. Retired tables sum
+//   to less than the live one.
+
+#ifndef RPV3_KERNEL_REGISTRY_H
+#define RPV3_KERNEL_REGISTRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rpv3 {
+
+// Append-only string storage. Interned strings are NUL-terminated and never move.
+class StringArena {
+public:
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    // Not thread-safe; KernelRegistry serializes callers
+    std::string_view intern(std::string_view text);
+
+    size_t bytes_used() const { return bytes_used_; }
+
+private:
+    std::string_view copy(std::string_view text);
+
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char* current_ = nullptr;  // Chunk receiving small strings
+    size_t chunk_used_ = kChunkSize;
+    size_t bytes_used_ = 0;
+    std::unordered_set<std::string_view> strings_;
+};
+
+struct KernelSymbol {
+    KernelSymbol(uint64_t kernel_id_, std::string_view mangled_, uint32_t flags_)
+        : kernel_id(kernel_id_), mangled(mangled_), flags(flags_) {}
+
+    uint64_t kernel_id;
+    std::string_view mangled;  // Name as registered, owned by the registry's arena
+    uint32_t flags;            // Caller-defined per-kernel bits (e.g. filter verdicts)
+
+    // Set by KernelRegistry::name() on first use
+    mutable std::atomic<const std::string_view*> demangled{nullptr};
+};
+
+class KernelRegistry {
+public:
+    explicit KernelRegistry(size_t initial_capacity = 1024);
+    ~KernelRegistry();
+
+    KernelRegistry(const KernelRegistry&) = delete;
+    KernelRegistry& operator=(const KernelRegistry&) = delete;
+
+    // Register or replace a symbol under its mangled name. Returns the registered entry.
+    const KernelSymbol* insert(uint64_t kernel_id, std::string_view mangled, uint32_t flags = 0);
+
+    // Unregister a symbol; views returned earlier stay valid
+    void erase(uint64_t kernel_id);
+
+    // Lock-free lookup, nullptr if the kernel is not registered
+    const KernelSymbol* find(uint64_t kernel_id) const {
+        const Table* table = table_.load(std::memory_order_acquire);
+        size_t mask = table->capacity - 1;
+        for (size_t i = hash(kernel_id) & mask, probes = 0; probes < table->capacity;
+             i = (i + 1) & mask, probes++) {
+            uint64_t key = table->slots[i].key.load(std::memory_order_acquire);
+            if (key == kernel_id) {
+                return table->slots[i].symbol.load(std::memory_order_acquire);
+            }
+            if (key == kEmptyKey) {
+                return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    // Demangled name of a symbol, demangling on first use
+    std::string_view name(const KernelSymbol& symbol) const {
+        const std::string_view* cached = symbol.demangled.load(std::memory_order_acquire);
+        return cached ? *cached : resolve(symbol);
+    }
+
+    // Demangled name, or `fallback` for unknown kernels
+    std::string_view name(uint64_t kernel_id, std::string_view fallback = "<unknown>") const {
+        const KernelSymbol* symbol = find(kernel_id);
+        return symbol ? name(*symbol) : fallback;
+    }
+
+    // Demangle through the shared cache, e.g. to filter a symbol before it is registered
+    std::string_view demangled(std::string_view mangled) const;
+
+    // Currently registered symbols
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    // Bytes held by distinct interned names
+    size_t arena_bytes() const;
+
+    // Distinct mangled names demangled so far
+    size_t demangled_count() const;
+
+private:
+    static constexpr uint64_t kEmptyKey = ~0ULL;
+
+    struct Slot {
+        std::atomic<uint64_t> key{kEmptyKey};
+        std::atomic<const KernelSymbol*> symbol{nullptr};
+    };
+
+    struct Table {
+        explicit Table(size_t capacity_) : capacity(capacity_), slots(new Slot[capacity_]) {}
+        size_t capacity;  // Power of two
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    static size_t hash(uint64_t kernel_id) {
+        return (size_t)((kernel_id * 0x9e3779b97f4a7c15ULL) >> 17);
+    }
+
+    Slot& slot_for(Table* table, uint64_t kernel_id);
+    void grow();
+    std::string_view resolve(const KernelSymbol& symbol) const;
+    const std::string_view* demangled_view(std::string_view mangled) const;
+
+    mutable std::mutex write_mutex_;
+    std::atomic<Table*> table_;
+    std::vector<std::unique_ptr<Table>> tables_;  // Live table last, retired before it
+    size_t used_slots_ = 0;                       // Keys ever placed in the live table
+    std::atomic<size_t> size_{0};
+    mutable StringArena arena_;
+    std::deque<KernelSymbol> symbols_;  // Stable addresses for published entries
+    // Mangled name (arena pointer) -> demangled view, both arena-owned
+    mutable std::unordered_map<const char*, const std::string_view*> demangled_;
+    mutable std::deque<std::string_view> demangled_views_;
+};
+
+} // namespace rpv3
+
+#endif // RPV3_KERNEL_REGISTRY_H
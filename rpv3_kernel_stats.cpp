@@ -0,0 +1,236 @@
+// MIT License
+// RPV3 Kernel Stats - Implementation
+// See rpv3_kernel_stats.h for the design overview
+
+#include "rpv3_kernel_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace rpv3 {
+
+namespace {
+    // Distinguishes table instances so a recycled address never matches a stale cache
+    std::atomic<uint64_t> next_generation{1};
+
+    struct ShardCache {
+        uint64_t generation = 0;
+        void* shard = nullptr;
+    };
+    thread_local ShardCache shard_cache;
+
+    // Longest kernel name printed in the text table before truncation
+    constexpr size_t kMaxNameWidth = 80;
+}
+
+void KernelStats::add(uint64_t duration_ns) {
+    if (count == 0) {
+        min_ns = duration_ns;
+        max_ns = duration_ns;
+    } else {
+        min_ns = std::min(min_ns, duration_ns);
+        max_ns = std::max(max_ns, duration_ns);
+    }
+    count++;
+    total_ns += duration_ns;
+
+    const double delta = (double)duration_ns - mean_ns;
+    mean_ns += delta / (double)count;
+    m2 += delta * ((double)duration_ns - mean_ns);
+}
+
+void KernelStats::merge(const KernelStats& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    const double n_a = (double)count;
+    const double n_b = (double)other.count;
+    const double n = n_a + n_b;
+    const double delta = other.mean_ns - mean_ns;
+
+    mean_ns += delta * n_b / n;
+    m2 += other.m2 + delta * delta * n_a * n_b / n;
+    count += other.count;
+    total_ns += other.total_ns;
+    min_ns = std::min(min_ns, other.min_ns);
+    max_ns = std::max(max_ns, other.max_ns);
+}
+
+double KernelStats::stddev_ns() const {
+    if (count < 2) {
+        return 0.0;
+    }
+    return std::sqrt(m2 / (double)(count - 1));
+}
+
+struct KernelStatsTable::Shard {
+    std::mutex mutex;  // Only contended while rows() merges
+    std::unordered_map<uint64_t, KernelStats> stats;
+};
+
+KernelStatsTable::KernelStatsTable()
+    : generation_(next_generation.fetch_add(1)) {
+}
+
+KernelStatsTable::~KernelStatsTable() = default;
+
+KernelStatsTable::Shard* KernelStatsTable::shard_for_current_thread() {
+    if (shard_cache.generation == generation_) {
+        return static_cast<Shard*>(shard_cache.shard);
+    }
+
+    auto shard = std::make_unique<Shard>();
+    Shard* raw = shard.get();
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex_);
+        shards_.push_back(std::move(shard));
+    }
+    shard_cache.generation = generation_;
+    shard_cache.shard = raw;
+    return raw;
+}
+
+void KernelStatsTable::record(uint64_t kernel_id, uint64_t duration_ns) {
+    Shard* shard = shard_for_current_thread();
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->stats[kernel_id].add(duration_ns);
+}
+
+std::vector<KernelSummaryRow> KernelStatsTable::rows() const {
+    std::unordered_map<uint64_t, KernelStats> merged;
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex_);
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> shard_lock(shard->mutex);
+            for (const auto& entry : shard->stats) {
+                merged[entry.first].merge(entry.second);
+            }
+        }
+    }
+
+    std::vector<KernelSummaryRow> rows;
+    rows.reserve(merged.size());
+    for (const auto& entry : merged) {
+        KernelSummaryRow row;
+        row.kernel_id = entry.first;
+        row.stats = entry.second;
+        rows.push_back(std::move(row));
+    }
+    std::sort(rows.begin(), rows.end(), [](const KernelSummaryRow& a, const KernelSummaryRow& b) {
+        if (a.stats.total_ns != b.stats.total_ns) {
+            return a.stats.total_ns > b.stats.total_ns;
+        }
+        return a.kernel_id < b.kernel_id;
+    });
+    return rows;
+}
+
+namespace {
+    uint64_t grand_total_ns(const std::vector<KernelSummaryRow>& rows) {
+        uint64_t total = 0;
+        for (const auto& row : rows) {
+            total += row.stats.total_ns;
+        }
+        return total;
+    }
+
+    double percent_of(uint64_t part, uint64_t total) {
+        return total ? (100.0 * (double)part / (double)total) : 0.0;
+    }
+
+    // Append `scratch` right-aligned to `width` columns, then reset it
+    void pad_left(RecordBuffer& out, RecordBuffer& scratch, size_t width) {
+        if (scratch.size() < width) {
+            out.append(std::string(width - scratch.size(), ' '));
+        }
+        out.append(std::string_view(scratch.data(), scratch.size()));
+        scratch.clear();
+    }
+}
+
+void format_summary_text(RecordBuffer& out, const std::vector<KernelSummaryRow>& rows) {
+    const uint64_t total_ns = grand_total_ns(rows);
+    uint64_t dispatches = 0;
+    size_t name_width = 11;  // strlen("Kernel Name")
+    for (const auto& row : rows) {
+        dispatches += row.stats.count;
+        name_width = std::max(name_width, std::min(row.name.size(), kMaxNameWidth));
+    }
+
+    out.append("\n[Kernel Summary] ").append_u64(rows.size()).append(" unique kernels, ")
+       .append_u64(dispatches).append(" dispatches, ")
+       .append_fixed3(total_ns / 1000000.0).append(" ms total GPU time\n");
+
+    static const char* headers[] = {"Count", "Total (ms)", "Mean (us)", "Min (us)",
+                                    "Max (us)", "Stddev (us)", "% Total"};
+    static const size_t widths[] = {10, 14, 12, 12, 12, 12, 8};
+
+    RecordBuffer scratch;
+    out.append("Kernel Name").append(std::string(name_width - 11, ' '));
+    for (size_t i = 0; i < 7; i++) {
+        out.append(" |");
+        scratch.append(headers[i]);
+        pad_left(out, scratch, widths[i]);
+    }
+    out.append('\n');
+    out.append(std::string(name_width, '-'));
+    for (size_t i = 0; i < 7; i++) {
+        out.append("-+").append(std::string(widths[i], '-'));
+    }
+    out.append('\n');
+
+    for (const auto& row : rows) {
+        const KernelStats& s = row.stats;
+        if (row.name.size() > name_width) {
+            out.append(std::string_view(row.name).substr(0, name_width - 3)).append("...");
+        } else {
+            out.append(row.name).append(std::string(name_width - row.name.size(), ' '));
+        }
+        out.append(" |");
+        scratch.append_u64(s.count);
+        pad_left(out, scratch, widths[0]);
+        out.append(" |");
+        scratch.append_fixed3(s.total_ns / 1000000.0);
+        pad_left(out, scratch, widths[1]);
+        out.append(" |");
+        scratch.append_fixed3(s.mean_ns / 1000.0);
+        pad_left(out, scratch, widths[2]);
+        out.append(" |");
+        scratch.append_fixed3(s.min_ns / 1000.0);
+        pad_left(out, scratch, widths[3]);
+        out.append(" |");
+        scratch.append_fixed3(s.max_ns / 1000.0);
+        pad_left(out, scratch, widths[4]);
+        out.append(" |");
+        scratch.append_fixed3(s.stddev_ns() / 1000.0);
+        pad_left(out, scratch, widths[5]);
+        out.append(" |");
+        scratch.append_fixed3(percent_of(s.total_ns, total_ns)).append('%');
+        pad_left(out, scratch, widths[6]);
+        out.append('\n');
+    }
+}
+
+void format_summary_csv(RecordBuffer& out, const std::vector<KernelSummaryRow>& rows) {
+    const uint64_t total_ns = grand_total_ns(rows);
+    out.append("KernelName,KernelID,Count,TotalNs,MeanNs,MinNs,MaxNs,StddevNs,PercentTotal\n");
+    for (const auto& row : rows) {
+        const KernelStats& s = row.stats;
+        out.append('"').append(row.name).append("\",");
+        out.append_u64(row.kernel_id).append(',');
+        out.append_u64(s.count).append(',');
+        out.append_u64(s.total_ns).append(',');
+        out.append_fixed3(s.mean_ns).append(',');
+        out.append_u64(s.min_ns).append(',');
+        out.append_u64(s.max_ns).append(',');
+        out.append_fixed3(s.stddev_ns()).append(',');
+        out.append_fixed3(percent_of(s.total_ns, total_ns)).append('\n');
+    }
+}
+
+} // namespace rpv3
@@ -0,0 +1,78 @@
+// MIT License
+// RPV3 Kernel Stats - Per-kernel duration statistics for --summary mode
+//
+// Each dispatching thread updates its own shard (kernel_id -> running
+// statistics) under an uncontended per-shard lock. Shards are merged only
+// when the summary is produced, so the hot path never shares a cache line
+// with other threads. Mean and variance use Welford's online algorithm and
+// are combined across shards with Chan's parallel update.
+
+#ifndef RPV3_KERNEL_STATS_H
+#define RPV3_KERNEL_STATS_H
+
+#include "rpv3_record_format.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rpv3 {
+
+struct KernelStats {
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t min_ns = 0;
+    uint64_t max_ns = 0;
+    double mean_ns = 0.0;
+    double m2 = 0.0;  // Sum of squared deviations from the mean
+
+    void add(uint64_t duration_ns);
+    void merge(const KernelStats& other);
+
+    // Sample standard deviation (0 for fewer than two dispatches)
+    double stddev_ns() const;
+};
+
+struct KernelSummaryRow {
+    uint64_t kernel_id = 0;
+    std::string name;
+    KernelStats stats;
+};
+
+class KernelStatsTable {
+public:
+    KernelStatsTable();
+    ~KernelStatsTable();
+
+    KernelStatsTable(const KernelStatsTable&) = delete;
+    KernelStatsTable& operator=(const KernelStatsTable&) = delete;
+
+    // Record one completed dispatch. Thread-safe; threads never share a lock.
+    void record(uint64_t kernel_id, uint64_t duration_ns);
+
+    // Merged statistics for every kernel, sorted by total time descending.
+    // Names are left empty for the caller to fill in.
+    std::vector<KernelSummaryRow> rows() const;
+
+private:
+    struct Shard;
+
+    Shard* shard_for_current_thread();
+
+    uint64_t generation_;
+    mutable std::mutex shards_mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+// Aligned text table, one line per kernel, with a totals header
+void format_summary_text(RecordBuffer& out, const std::vector<KernelSummaryRow>& rows);
+
+// CSV table: KernelName,KernelID,Count,TotalNs,MeanNs,MinNs,MaxNs,StddevNs,PercentTotal
+void format_summary_csv(RecordBuffer& out, const std::vector<KernelSummaryRow>& rows);
+
+} // namespace rpv3
+
+#endif // RPV3_KERNEL_STATS_H
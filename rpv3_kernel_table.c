@@ -0,0 +1,201 @@
+/* MIT License
+ * RPV3 Kernel Table - Implementation
+ * See rpv3_kernel_table.h for the concurrency design
+ */
+
+#include "rpv3_kernel_table.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RPV3_EMPTY_KEY UINT64_MAX
+#define RPV3_ARENA_CHUNK_SIZE (64 * 1024)
+
+typedef struct {
+    _Atomic uint64_t key;
+    const char* _Atomic name;
+} rpv3_kernel_slot_t;
+
+struct rpv3_kernel_slots {
+    size_t capacity;            /* Power of two */
+    rpv3_kernel_slots_t* next;  /* Retired list link */
+    rpv3_kernel_slot_t slots[];
+};
+
+struct rpv3_arena_chunk {
+    rpv3_arena_chunk_t* next;
+    size_t size;
+    size_t used;
+    char data[];
+};
+
+/* Fibonacci hashing spreads the small sequential kernel ids */
+static size_t hash_kernel_id(uint64_t kernel_id) {
+    return (size_t)((kernel_id * 0x9e3779b97f4a7c15ULL) >> 17);
+}
+
+static rpv3_kernel_slots_t* alloc_slots(size_t capacity) {
+    rpv3_kernel_slots_t* slots = malloc(sizeof(rpv3_kernel_slots_t) + capacity * sizeof(rpv3_kernel_slot_t));
+    if (!slots) {
+        return NULL;
+    }
+    slots->capacity = capacity;
+    slots->next = NULL;
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&slots->slots[i].key, RPV3_EMPTY_KEY);
+        atomic_init(&slots->slots[i].name, NULL);
+    }
+    return slots;
+}
+
+/* Slot holding kernel_id, or the empty slot where it belongs (writer side) */
+static rpv3_kernel_slot_t* slot_for(rpv3_kernel_slots_t* slots, uint64_t kernel_id) {
+    size_t mask = slots->capacity - 1;
+    size_t i = hash_kernel_id(kernel_id) & mask;
+    for (;;) {
+        uint64_t key = atomic_load_explicit(&slots->slots[i].key, memory_order_relaxed);
+        if (key == kernel_id || key == RPV3_EMPTY_KEY) {
+            return &slots->slots[i];
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+static const char* arena_copy(rpv3_kernel_table_t* table, const char* name) {
+    size_t needed = strlen(name) + 1;
+    rpv3_arena_chunk_t* chunk = table->chunks;
+    if (!chunk || chunk->size - chunk->used < needed) {
+        size_t size = needed > RPV3_ARENA_CHUNK_SIZE ? needed : RPV3_ARENA_CHUNK_SIZE;
+        chunk = malloc(sizeof(rpv3_arena_chunk_t) + size);
+        if (!chunk) {
+            return NULL;
+        }
+        chunk->size = size;
+        chunk->used = 0;
+        chunk->next = table->chunks;
+        table->chunks = chunk;
+    }
+    char* copy = chunk->data + chunk->used;
+    memcpy(copy, name, needed);
+    chunk->used += needed;
+    return copy;
+}
+
+static int grow(rpv3_kernel_table_t* table) {
+    rpv3_kernel_slots_t* old_slots = atomic_load_explicit(&table->slots, memory_order_relaxed);
+    rpv3_kernel_slots_t* new_slots = alloc_slots(old_slots->capacity * 2);
+    if (!new_slots) {
+        return -1;
+    }
+    for (size_t i = 0; i < old_slots->capacity; i++) {
+        uint64_t key = atomic_load_explicit(&old_slots->slots[i].key, memory_order_relaxed);
+        if (key == RPV3_EMPTY_KEY) {
+            continue;
+        }
+        rpv3_kernel_slot_t* slot = slot_for(new_slots, key);
+        atomic_store_explicit(&slot->name, atomic_load_explicit(&old_slots->slots[i].name, memory_order_relaxed),
+                              memory_order_relaxed);
+        atomic_store_explicit(&slot->key, key, memory_order_relaxed);
+    }
+    /* Readers that loaded the old table keep probing it safely */
+    atomic_store_explicit(&table->slots, new_slots, memory_order_release);
+    old_slots->next = table->retired;
+    table->retired = old_slots;
+    return 0;
+}
+
+int rpv3_kernel_table_init(rpv3_kernel_table_t* table, size_t initial_capacity) {
+    size_t capacity = 16;
+    while (capacity < initial_capacity * 2) {
+        capacity <<= 1;
+    }
+    rpv3_kernel_slots_t* slots = alloc_slots(capacity);
+    if (!slots) {
+        return -1;
+    }
+    atomic_init(&table->slots, slots);
+    table->retired = NULL;
+    table->chunks = NULL;
+    table->used_slots = 0;
+    atomic_init(&table->count, 0);
+    pthread_mutex_init(&table->write_lock, NULL);
+    return 0;
+}
+
+void rpv3_kernel_table_destroy(rpv3_kernel_table_t* table) {
+    free(atomic_load(&table->slots));
+    atomic_store(&table->slots, NULL);
+    while (table->retired) {
+        rpv3_kernel_slots_t* next = table->retired->next;
+        free(table->retired);
+        table->retired = next;
+    }
+    while (table->chunks) {
+        rpv3_arena_chunk_t* next = table->chunks->next;
+        free(table->chunks);
+        table->chunks = next;
+    }
+    atomic_store(&table->count, 0);
+    pthread_mutex_destroy(&table->write_lock);
+}
+
+int rpv3_kernel_table_insert(rpv3_kernel_table_t* table, uint64_t kernel_id, const char* name) {
+    if (!name || kernel_id == RPV3_EMPTY_KEY) {
+        return -1;
+    }
+    pthread_mutex_lock(&table->write_lock);
+
+    /* The first name registered for a kernel id is kept */
+    rpv3_kernel_slots_t* slots = atomic_load_explicit(&table->slots, memory_order_relaxed);
+    if (atomic_load_explicit(&slot_for(slots, kernel_id)->key, memory_order_relaxed) == kernel_id) {
+        pthread_mutex_unlock(&table->write_lock);
+        return 0;
+    }
+    if ((table->used_slots + 1) * 2 > slots->capacity) {
+        if (grow(table) != 0) {
+            pthread_mutex_unlock(&table->write_lock);
+            return -1;
+        }
+        slots = atomic_load_explicit(&table->slots, memory_order_relaxed);
+    }
+
+    const char* copy = arena_copy(table, name);
+    if (!copy) {
+        pthread_mutex_unlock(&table->write_lock);
+        return -1;
+    }
+
+    rpv3_kernel_slot_t* slot = slot_for(slots, kernel_id);
+    /* Publish the name before the key */
+    atomic_store_explicit(&slot->name, copy, memory_order_release);
+    atomic_store_explicit(&slot->key, kernel_id, memory_order_release);
+    table->used_slots++;
+    atomic_fetch_add_explicit(&table->count, 1, memory_order_relaxed);
+
+    pthread_mutex_unlock(&table->write_lock);
+    return 0;
+}
+
+const char* rpv3_kernel_table_lookup(const rpv3_kernel_table_t* table, uint64_t kernel_id) {
+    rpv3_kernel_slots_t* slots = atomic_load_explicit(&((rpv3_kernel_table_t*)table)->slots, memory_order_acquire);
+    if (!slots) {
+        return NULL;
+    }
+    size_t mask = slots->capacity - 1;
+    size_t i = hash_kernel_id(kernel_id) & mask;
+    for (size_t probes = 0; probes < slots->capacity; probes++, i = (i + 1) & mask) {
+        uint64_t key = atomic_load_explicit(&slots->slots[i].key, memory_order_acquire);
+        if (key == kernel_id) {
+            return atomic_load_explicit(&slots->slots[i].name, memory_order_acquire);
+        }
+        if (key == RPV3_EMPTY_KEY) {
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+size_t rpv3_kernel_table_size(const rpv3_kernel_table_t* table) {
+    return atomic_load_explicit(&((rpv3_kernel_table_t*)table)->count, memory_order_relaxed);
+}
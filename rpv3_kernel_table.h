@@ -0,0 +1,53 @@
+/* MIT License
+ * RPV3 Kernel Table - kernel_id -> name map for the C tracer (C11 only)
+ *
+ * Symbols are registered from the code object callback while dispatch and
+ * buffer callbacks look them up on other threads. Writers take a mutex;
+ * lookups take no lock:
+ *
+ * - Names are copied into an append-only arena of 64 KB chunks, so a
+ *   returned name stays valid until the table is destroyed.
+ * - Slots are open-addressed (linear probing) with atomic keys and name
+ *   pointers. A writer stores the name before the key, so a reader that
+ *   sees the key sees the name.
+ * - When the table is half full the writer publishes a copy of twice the
+ *   size. The old copy is kept until destruction because a reader may
+ *   still be probing it.
+ */
+
+#ifndef RPV3_KERNEL_TABLE_H
+#define RPV3_KERNEL_TABLE_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct rpv3_kernel_slots rpv3_kernel_slots_t;
+typedef struct rpv3_arena_chunk rpv3_arena_chunk_t;
+
+typedef struct {
+    rpv3_kernel_slots_t* _Atomic slots;  /* Live table */
+    rpv3_kernel_slots_t* retired;        /* Older tables, freed by destroy */
+    rpv3_arena_chunk_t* chunks;          /* Arena, newest chunk first */
+    size_t used_slots;                   /* Keys placed in the live table */
+    size_t _Atomic count;                /* Distinct kernel ids registered */
+    pthread_mutex_t write_lock;
+} rpv3_kernel_table_t;
+
+/* Initialize an empty table. Returns 0 on success, -1 if out of memory. */
+int rpv3_kernel_table_init(rpv3_kernel_table_t* table, size_t initial_capacity);
+
+/* Free every slot table and the name arena */
+void rpv3_kernel_table_destroy(rpv3_kernel_table_t* table);
+
+/* Register a kernel; an id already registered keeps its first name.
+ * Returns 0 on success, -1 if out of memory. */
+int rpv3_kernel_table_insert(rpv3_kernel_table_t* table, uint64_t kernel_id, const char* name);
+
+/* Lock-free lookup; NULL if the kernel was never registered */
+const char* rpv3_kernel_table_lookup(const rpv3_kernel_table_t* table, uint64_t kernel_id);
+
+/* Number of distinct kernel ids registered */
+size_t rpv3_kernel_table_size(const rpv3_kernel_table_t* table);
+
+#endif /* RPV3_KERNEL_TABLE_H */
@@ -0,0 +1,280 @@
+// MIT License
+// RPV3 Library Log - Implementation
+// See rpv3_library_log.h for what each library contributes
+
+#include "rpv3_library_log.h"
+#include "rpv3_line_reader.h"
+#include "rpv3_tensile.h"
+
+namespace rpv3 {
+
+namespace {
+
+bool contains(std::string_view text, std::string_view part) {
+    return text.find(part) != std::string_view::npos;
+}
+
+bool starts_with(std::string_view text, std::string_view prefix) {
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+// Argument of "-f" in a *-bench command line: "./rocblas-bench -f gemm ..." -> "gemm"
+std::string_view bench_function(std::string_view line) {
+    size_t pos = line.find(" -f ");
+    if (pos == std::string_view::npos) {
+        return {};
+    }
+    line.remove_prefix(pos + 4);
+    return line.substr(0, line.find(' '));
+}
+
+// Leading identifier of a trace line, up to a separator
+std::string_view leading_name(std::string_view line, std::string_view separators) {
+    return line.substr(0, line.find_first_of(separators));
+}
+
+// rocBLAS routines that run the Tensile kernels rocBLAS claims. A gemm runs
+// one; the others run a number of gemms inside that depends on the size.
+// Batched variants run the same kernels.
+struct TensileRoutine {
+    std::string_view name;
+    bool spans;
+};
+
+constexpr TensileRoutine kTensileRoutines[] = {
+    {"gemm", false}, {"gemm_ex", false},
+    {"trsm", true},  {"trsm_ex", true}, {"trmm", true},  {"trtri", true},
+    {"syrk", true},  {"herk", true},    {"syrkx", true}, {"herkx", true},
+    {"syr2k", true}, {"her2k", true},
+};
+
+// name == head + tail
+bool joins(std::string_view name, std::string_view head, std::string_view tail) {
+    return name.size() == head.size() + tail.size() && starts_with(name, head) &&
+           name.substr(head.size()) == tail;
+}
+
+const TensileRoutine* find_tensile_routine(std::string_view routine) {
+    std::string_view head = routine;
+    std::string_view tail;
+    for (std::string_view batched : {std::string_view("_strided_batched"), std::string_view("_batched")}) {
+        size_t pos = routine.find(batched);
+        if (pos != std::string_view::npos) {
+            head = routine.substr(0, pos);
+            tail = routine.substr(pos + batched.size());
+            break;
+        }
+    }
+    for (const TensileRoutine& known : kTensileRoutines) {
+        if (joins(known.name, head, tail)) {
+            return &known;
+        }
+    }
+    return nullptr;
+}
+
+// Routine of a call key: "rocblas_sgemm_batched" (trace) or "gemm_batched"
+// (bench, precision given by -r), with or without the precision prefix
+const TensileRoutine* tensile_routine(std::string_view key) {
+    if (starts_with(key, "rocblas_")) {
+        key.remove_prefix(8);
+    }
+    const TensileRoutine* routine = find_tensile_routine(key);
+    if (!routine && key.size() > 1 && !blas_precision_name(key[0]).empty()) {
+        routine = find_tensile_routine(key.substr(1));
+    }
+    return routine;
+}
+
+// rocBLAS: Tensile GEMMs, ROCBLAS_LAYER trace (1) or bench (2) lines
+class RocblasLog : public LibraryLog {
+public:
+    const char* id() const override { return "rocblas"; }
+    const char* name() const override { return "RocBLAS"; }
+
+    const char* const* log_env() const override {
+        static const char* const env[] = {"ROCBLAS_LOG_TRACE", "ROCBLAS_LOG_TRACE_PATH",
+                                          "ROCBLAS_LOG_BENCH_PATH", "ROCBLAS_LOG_PROFILE_PATH", nullptr};
+        return env;
+    }
+
+    int claim_kernel(std::string_view mangled) const override {
+        return is_tensile_kernel(mangled) ? kClaimGeneric : kClaimNone;
+    }
+
+    // Only routines that run the Tensile kernels claimed above are paired.
+    // A line of any other routine (gemv, axpy, ...) has no dispatch to pair
+    // with and would shift every later line onto the wrong one.
+    bool is_call_line(std::string_view line) const override {
+        return !line.empty() && !is_rocblas_bookkeeping(line) && tensile_routine(call_key(line));
+    }
+
+    bool spans_kernels(std::string_view line) const override {
+        const TensileRoutine* routine = tensile_routine(call_key(line));
+        return routine && routine->spans;
+    }
+
+    std::string_view call_key(std::string_view line) const override {
+        if (contains(line, "rocblas-bench")) {
+            return bench_function(line);
+        }
+        return leading_name(line, ",");
+    }
+
+    bool parse_call(std::string_view line, BlasCall& call) const override {
+        return parse_blas_call(line, call);
+    }
+};
+
+// hipBLASLt: also Tensile kernels; names built for its user-argument ABI
+// are its own. HIPBLASLT_LOG_MASK=32 bench lines or trace-level API lines.
+class HipblasltLog : public LibraryLog {
+public:
+    const char* id() const override { return "hipblaslt"; }
+    const char* name() const override { return "hipBLASLt"; }
+
+    const char* const* log_env() const override {
+        static const char* const env[] = {"HIPBLASLT_LOG_FILE", nullptr};
+        return env;
+    }
+
+    int claim_kernel(std::string_view mangled) const override {
+        if (contains(mangled, "Cijk_") && contains(mangled, "UserArgs")) {
+            return kClaimSpecific;
+        }
+        return is_tensile_kernel(mangled) ? kClaimGeneric : kClaimNone;
+    }
+
+    bool is_call_line(std::string_view line) const override {
+        return contains(line, "hipblaslt-bench ") || contains(line, "[hipblasLtMatmul]");
+    }
+
+    std::string_view call_key(std::string_view line) const override {
+        return is_call_line(line) ? std::string_view("hipblasLtMatmul") : std::string_view();
+    }
+};
+
+// MIOpen: convolution solver kernels, MIOPEN_ENABLE_LOGGING_CMD=1 driver
+// command lines. MIOpen logs to stderr only, so the source is a redirect.
+class MiopenLog : public LibraryLog {
+public:
+    const char* id() const override { return "miopen"; }
+    const char* name() const override { return "MIOpen"; }
+
+    const char* const* log_env() const override {
+        static const char* const env[] = {nullptr};
+        return env;
+    }
+
+    int claim_kernel(std::string_view mangled) const override {
+        // Transposes, casts and other helpers around a convolution are not
+        // claimed, so each logged command pairs with its one solver kernel
+        static const std::string_view kSolvers[] = {
+            "MIOpenConv", "MIOpenCvD", "MIOpenGroupConv", "miopenSp3AsmConv", "naive_conv_",
+            "igemm_fwd", "igemm_bwd", "igemm_wrw", "gridwise_convolution", "grouped_conv",
+        };
+        for (std::string_view solver : kSolvers) {
+            if (contains(mangled, solver)) {
+                return kClaimSpecific;
+            }
+        }
+        return kClaimNone;
+    }
+
+    bool is_call_line(std::string_view line) const override {
+        return contains(line, "MIOpenDriver conv");
+    }
+
+    std::string_view call_key(std::string_view line) const override {
+        size_t pos = line.find("MIOpenDriver ");
+        if (pos == std::string_view::npos) {
+            return {};
+        }
+        return leading_name(line.substr(pos + 13), " ");
+    }
+};
+
+// rocSOLVER: its own kernels (namespace rocsolver), ROCSOLVER_LAYER trace
+// or bench lines. One call runs many kernels, hence span pairing; nested
+// internal calls are indented in the trace and skipped.
+class RocsolverLog : public LibraryLog {
+public:
+    const char* id() const override { return "rocsolver"; }
+    const char* name() const override { return "rocSOLVER"; }
+
+    const char* const* log_env() const override {
+        static const char* const env[] = {"ROCSOLVER_LOG_TRACE_PATH", "ROCSOLVER_LOG_BENCH_PATH",
+                                          "ROCSOLVER_LOG_PROFILE_PATH", nullptr};
+        return env;
+    }
+
+    int claim_kernel(std::string_view mangled) const override {
+        return contains(mangled, "rocsolver") ? kClaimSpecific : kClaimNone;
+    }
+
+    bool is_call_line(std::string_view line) const override {
+        return starts_with(line, "rocsolver_") || contains(line, "rocsolver-bench ");
+    }
+
+    std::string_view call_key(std::string_view line) const override {
+        if (contains(line, "rocsolver-bench ")) {
+            return bench_function(line);
+        }
+        return starts_with(line, "rocsolver_") ? leading_name(line, "(, ") : std::string_view();
+    }
+
+    LogPairing pairing() const override { return LogPairing::Span; }
+};
+
+} // namespace
+
+const LibraryLog& rocblas_log() {
+    static const RocblasLog log;
+    return log;
+}
+
+const LibraryLog& hipblaslt_log() {
+    static const HipblasltLog log;
+    return log;
+}
+
+const LibraryLog& miopen_log() {
+    static const MiopenLog log;
+    return log;
+}
+
+const LibraryLog& rocsolver_log() {
+    static const RocsolverLog log;
+    return log;
+}
+
+const std::vector<const LibraryLog*>& library_logs() {
+    static const std::vector<const LibraryLog*> logs = {
+        &rocblas_log(), &hipblaslt_log(), &miopen_log(), &rocsolver_log(),
+    };
+    return logs;
+}
+
+const LibraryLog* find_library_log(std::string_view id) {
+    for (const LibraryLog* log : library_logs()) {
+        if (id == log->id()) {
+            return log;
+        }
+    }
+    return nullptr;
+}
+
+int route_kernel(const std::vector<const LibraryLog*>& libraries, std::string_view mangled) {
+    int best = -1;
+    int best_claim = kClaimNone;
+    for (size_t i = 0; i < libraries.size(); i++) {
+        int claim = libraries[i]->claim_kernel(mangled);
+        if (claim > best_claim) {
+            best = (int)i;
+            best_claim = claim;
+        }
+    }
+    return best;
+}
+
+} // namespace rpv3
@@ -0,0 +1,97 @@
+// MIT License
+// RPV3 Library Log - Per-library rules for pairing call logs with kernels
+//
+// rocBLAS, hipBLASLt, MIOpen and rocSOLVER can each log their API calls to
+// a file or pipe. The tracer reads every configured log on one background
+// thread through the same buffered LineReader and LogCorrelator, and only
+// the library specific parts live behind LibraryLog:
+//
+// - which kernels the library launches for a logged call (claim_kernel,
+//   decided once per symbol at registration),
+// - where the library writes its log (log_env, for the pipe check and the
+//   stdio interposers),
+// - which log lines are calls that launch such a kernel (is_call_line),
+//   the routine a line names (call_key) and, for rocBLAS, its typed fields
+//   (parse_call),
+// - how lines map onto dispatches (pairing).
+//
+// Several libraries may claim the same kernel: hipBLASLt and rocBLAS both
+// launch Tensile Cijk_ kernels. claim_kernel() returns how specific the
+// claim is and route_kernel() picks the strongest among the enabled
+// libraries, the first one on a tie.
+
+#ifndef RPV3_LIBRARY_LOG_H
+#define RPV3_LIBRARY_LOG_H
+
+#include "rpv3_blas_parser.h"
+#include "rpv3_log_correlator.h"
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace rpv3 {
+
+// claim_kernel() results
+constexpr int kClaimNone = 0;
+constexpr int kClaimGeneric = 1;   // Kernel family shared with other libraries
+constexpr int kClaimSpecific = 2;  // Only this library launches it
+
+class LibraryLog {
+public:
+    virtual ~LibraryLog() = default;
+
+    // Option name without dashes ("rocblas") and the name used in messages
+    virtual const char* id() const = 0;
+    virtual const char* name() const = 0;
+
+    // Environment variables that name the library's log files, nullptr
+    // terminated; empty for libraries that only log to stderr
+    virtual const char* const* log_env() const = 0;
+
+    // kClaim* for a kernel symbol (mangled name)
+    virtual int claim_kernel(std::string_view mangled) const = 0;
+
+    // True for a line describing a call that launches a claimed kernel;
+    // every other line is skipped before it reaches the correlator
+    virtual bool is_call_line(std::string_view line) const = 0;
+
+    // True for a call line whose routine may run several claimed kernels,
+    // or none; see LogLine::span
+    virtual bool spans_kernels(std::string_view line) const {
+        (void)line;
+        return false;
+    }
+
+    // Routine named by a call line, e.g. "rocblas_sgemm", "hipblasLtMatmul";
+    // empty if the line has none
+    virtual std::string_view call_key(std::string_view line) const = 0;
+
+    // Typed BLAS fields of a call line, for the efficiency table, CSV
+    // columns and reproducers. Only rocBLAS lines are parsed.
+    virtual bool parse_call(std::string_view line, BlasCall& call) const {
+        (void)line;
+        (void)call;
+        return false;
+    }
+
+    virtual LogPairing pairing() const { return LogPairing::OnePerCall; }
+};
+
+const LibraryLog& rocblas_log();
+const LibraryLog& hipblaslt_log();
+const LibraryLog& miopen_log();
+const LibraryLog& rocsolver_log();
+
+// Every supported library, in the order the tracer sets them up
+const std::vector<const LibraryLog*>& library_logs();
+
+// Library with the given id, or nullptr
+const LibraryLog* find_library_log(std::string_view id);
+
+// Index into libraries of the one whose kernel this is, or -1
+int route_kernel(const std::vector<const LibraryLog*>& libraries, std::string_view mangled);
+
+} // namespace rpv3
+
+#endif // RPV3_LIBRARY_LOG_H
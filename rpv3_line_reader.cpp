@@ -0,0 +1,221 @@
+// MIT License
+// RPV3 Line Reader - Implementation
+// See rpv3_line_reader.h for the buffering scheme
+
+#include "rpv3_line_reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rpv3 {
+
+LineReader::LineReader(size_t capacity)
+    : buffer_(new char[capacity < 2 ? 2 : capacity]), capacity_(capacity < 2 ? 2 : capacity) {
+}
+
+LineReader::~LineReader() {
+    close_mirror();
+}
+
+void LineReader::set_tee(FILE* tee) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tee_ = tee;
+    close_mirror();
+    checked_fd_ = -1;  // Decide the kernel path again on the next read
+}
+
+void LineReader::close_mirror() {
+    for (int& fd : mirror_) {
+        if (fd != -1) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    kernel_tee_ = false;
+}
+
+// Decided once per input fd: a pipe input and a tee with a descriptor
+bool LineReader::kernel_tee_ready(int fd) {
+    if (fd == checked_fd_) {
+        return kernel_tee_;
+    }
+    close_mirror();
+    checked_fd_ = fd;
+    struct stat st;
+    if (fileno(tee_) < 0 || fstat(fd, &st) != 0 || !S_ISFIFO(st.st_mode)) {
+        return false;
+    }
+    if (pipe2(mirror_, O_CLOEXEC) != 0) {
+        mirror_[0] = mirror_[1] = -1;
+        return false;
+    }
+    fflush(tee_);  // Bytes written through the stream go first
+    kernel_tee_ = true;
+    return true;
+}
+
+// Duplicate up to length bytes of the input pipe into the tee without
+// consuming them. Returns the count duplicated, 0 at EOF or -1 with errno
+// set; the caller then reads exactly that many bytes.
+ssize_t LineReader::kernel_tee(int fd, size_t length) {
+    ssize_t duplicated;
+    do {
+        duplicated = tee(fd, mirror_[1], length, SPLICE_F_NONBLOCK);
+    } while (duplicated < 0 && errno == EINTR);
+    if (duplicated <= 0) {
+        return duplicated;
+    }
+
+    size_t left = (size_t)duplicated;
+    while (left > 0) {
+        ssize_t moved = splice(mirror_[0], nullptr, fileno(tee_), nullptr, left, SPLICE_F_MOVE);
+        if (moved < 0 && errno == EINTR) {
+            continue;
+        }
+        if (moved <= 0) {
+            // The log refuses splice (e.g. O_APPEND): copy the rest through
+            // userspace and stay there
+            char chunk[4096];
+            while (left > 0) {
+                ssize_t n = read(mirror_[0], chunk, std::min(left, sizeof(chunk)));
+                if (n <= 0) {
+                    break;
+                }
+                fwrite(chunk, 1, (size_t)n, tee_);
+                left -= (size_t)n;
+            }
+            fflush(tee_);
+            close_mirror();
+            break;
+        }
+        left -= (size_t)moved;
+        spliced_bytes_ += (uint64_t)moved;
+    }
+    return duplicated;
+}
+
+// Take the next complete line out of the buffer, if there is one
+bool LineReader::extract_line(std::string& line) {
+    while (true) {
+        const char* start = buffer_.get() + begin_;
+        const char* newline = static_cast<const char*>(
+            memchr(buffer_.get() + scanned_, '\n', end_ - scanned_));
+        if (!newline) {
+            scanned_ = end_;
+            return false;
+        }
+
+        size_t length = (size_t)(newline - start);
+        const bool dropped = discarding_;
+        begin_ += length + 1;
+        scanned_ = begin_;
+        discarding_ = false;
+        if (dropped) {
+            continue;  // Tail of a line already returned truncated
+        }
+
+        if (length > 0 && start[length - 1] == '\r') {
+            length--;
+        }
+        line.assign(start, length);
+        return true;
+    }
+}
+
+// Read as much as fits. Returns false if nothing new arrived.
+bool LineReader::fill(int fd) {
+    if (begin_ > 0) {
+        // Move the partial line to the front to make room
+        memmove(buffer_.get(), buffer_.get() + begin_, end_ - begin_);
+        end_ -= begin_;
+        scanned_ -= begin_;
+        begin_ = 0;
+    }
+    if (end_ == capacity_) {
+        // No newline in a full buffer: return what we have as a truncated line
+        return false;
+    }
+
+    size_t length = capacity_ - end_;
+    bool mirrored = false;
+    if (tee_ && kernel_tee_ready(fd)) {
+        ssize_t duplicated = kernel_tee(fd, length);
+        if (duplicated > 0) {
+            length = (size_t)duplicated;
+            mirrored = true;
+        } else if (duplicated == 0 || errno == EAGAIN) {
+            read_calls_++;
+            return false;  // EOF, or nothing buffered in the pipe
+        } else {
+            close_mirror();  // tee(2) unsupported: userspace copy from now on
+        }
+    }
+
+    // After tee(2) the pipe holds at least `length` bytes and only this
+    // reader consumes it, so they must all be read before the next tee(2)
+    size_t n = 0;
+    while (true) {
+        ssize_t got = read(fd, buffer_.get() + end_ + n, length - n);
+        read_calls_++;
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;  // EAGAIN on an empty pipe, EOF or error
+        }
+        n += (size_t)got;
+        if (!mirrored || n == length) {
+            break;
+        }
+    }
+    if (n == 0) {
+        return false;
+    }
+
+    if (tee_ && !mirrored) {
+        fwrite(buffer_.get() + end_, 1, n, tee_);
+        fflush(tee_);
+    }
+    end_ += n;
+    bytes_read_ += (uint64_t)n;
+    return true;
+}
+
+bool LineReader::next_line(int fd, std::string& line) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (true) {
+        if (extract_line(line)) {
+            return true;
+        }
+        if (fill(fd)) {
+            continue;
+        }
+        if (end_ == capacity_ && begin_ == 0) {
+            // Overlong line: keep the first capacity - 1 bytes, drop the rest
+            const bool first_chunk = !discarding_;
+            if (first_chunk) {
+                line.assign(buffer_.get(), capacity_ - 1);
+                truncated_lines_++;
+            }
+            begin_ = end_ = scanned_ = 0;
+            discarding_ = true;
+            if (first_chunk) {
+                return true;
+            }
+            continue;
+        }
+        return false;
+    }
+}
+
+bool is_rocblas_bookkeeping(std::string_view line) {
+    return line.find("rocblas_create_handle") != std::string_view::npos ||
+           line.find("rocblas_destroy_handle") != std::string_view::npos ||
+           line.find("rocblas_set_stream") != std::string_view::npos;
+}
+
+} // namespace rpv3
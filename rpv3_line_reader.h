@@ -0,0 +1,88 @@
+// MIT License
+// RPV3 Line Reader - Buffered line reader for library log pipes (--rocblas, ...)
+//
+// The dispatch callbacks used to read the rocBLAS log one byte per read()
+// call, so a single gemm line cost hundreds of syscalls inside a profiler
+// callback. LineReader reads up to the free space of its buffer per call,
+// finds line ends with memchr over bytes not yet scanned, and keeps any
+// partial line and any further complete lines for the next call.
+//
+// The tee stream (--rocblas-log) receives the log unfiltered and in order.
+// When the input is a pipe and the tee has a file descriptor, the bytes are
+// mirrored in the kernel: tee(2) duplicates what is about to be read into a
+// private pipe, splice(2) moves that into the log file, and only then are
+// the same bytes read for parsing, so the log copy never passes through
+// userspace. Other inputs (a regular file with --rocblas), and tee streams
+// without a descriptor, fall back to one buffered fwrite per read.
+//
+// Callbacks from several threads may share one reader; next_line() holds a
+// mutex while it reads and scans.
+
+#ifndef RPV3_LINE_READER_H
+#define RPV3_LINE_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace rpv3 {
+
+class LineReader {
+public:
+    static constexpr size_t kDefaultCapacity = 64 * 1024;
+
+    // Lines longer than capacity - 1 bytes are truncated
+    explicit LineReader(size_t capacity = kDefaultCapacity);
+    ~LineReader();
+
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    // Copy every byte read to this stream (nullptr disables the tee)
+    void set_tee(FILE* tee);
+
+    // Next complete line from fd, without "\n" or "\r\n". Returns false when
+    // no complete line is available without blocking (EAGAIN) or at EOF; a
+    // partial line stays buffered for the next call.
+    bool next_line(int fd, std::string& line);
+
+    // Statistics
+    uint64_t read_calls() const { return read_calls_; }
+    uint64_t bytes_read() const { return bytes_read_; }
+    uint64_t truncated_lines() const { return truncated_lines_; }
+    uint64_t spliced_bytes() const { return spliced_bytes_; }  // Tee bytes mirrored in the kernel
+
+private:
+    bool extract_line(std::string& line);
+    bool fill(int fd);
+    bool kernel_tee_ready(int fd);
+    ssize_t kernel_tee(int fd, size_t length);
+    void close_mirror();
+
+    std::mutex mutex_;
+    std::unique_ptr<char[]> buffer_;
+    size_t capacity_;
+    size_t begin_ = 0;        // First unconsumed byte
+    size_t end_ = 0;          // One past the last buffered byte
+    size_t scanned_ = 0;      // Bytes in [begin_, scanned_) hold no newline
+    bool discarding_ = false; // Dropping the tail of a truncated line
+    FILE* tee_ = nullptr;
+    int mirror_[2] = {-1, -1};  // Private pipe between tee(2) and splice(2)
+    int checked_fd_ = -1;       // Input fd the kernel path was last decided for
+    bool kernel_tee_ = false;
+    uint64_t read_calls_ = 0;
+    uint64_t bytes_read_ = 0;
+    uint64_t truncated_lines_ = 0;
+    uint64_t spliced_bytes_ = 0;
+};
+
+// rocBLAS handle and stream bookkeeping lines that never belong to a kernel
+bool is_rocblas_bookkeeping(std::string_view line);
+
+} // namespace rpv3
+
+#endif // RPV3_LINE_READER_H
@@ -0,0 +1,123 @@
+// MIT License
+// RPV3 Log Correlator - Implementation
+// See rpv3_log_correlator.h for the matching rules
+
+#include "rpv3_log_correlator.h"
+
+namespace rpv3 {
+
+void LogCorrelator::push_line(uint64_t timestamp_ns, std::string text, bool span) {
+    incoming_lines_.push(LogLine{timestamp_ns, std::move(text), span});
+}
+
+void LogCorrelator::push_dispatch(PendingDispatch dispatch) {
+    incoming_dispatches_.push(std::move(dispatch));
+}
+
+void LogCorrelator::resolve(uint64_t now_ns, const Sink& sink) {
+    incoming_lines_.drain(lines_);
+    incoming_dispatches_.drain(dispatches_);
+    if (pairing_ == LogPairing::Span) {
+        resolve_spans(now_ns, sink);
+        return;
+    }
+
+    while (!dispatches_.empty()) {
+        const PendingDispatch& dispatch = dispatches_.front();
+        const uint64_t deadline = dispatch.timestamp_ns + window_ns_;
+
+        // A span line whose successor was in before this dispatch started
+        // ran none of the claimed kernels
+        while (lines_.size() > 1 && lines_.front().span && lines_[1].timestamp_ns <= dispatch.timestamp_ns) {
+            lines_.pop_front();
+            unmatched_lines_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const bool next_call = !lines_.empty() && lines_.front().timestamp_ns <= dispatch.timestamp_ns;
+        if (have_current_ && !next_call) {
+            // Another kernel of the multi-kernel call, unless a line that
+            // arrived before it started may still be in flight
+            if (lines_.empty() && now_ns <= deadline) {
+                break;
+            }
+            sink(dispatch, &current_);
+            matched_.fetch_add(1, std::memory_order_relaxed);
+        } else if (!lines_.empty() && lines_.front().timestamp_ns <= deadline) {
+            have_current_ = lines_.front().span;
+            if (have_current_) {
+                current_ = std::move(lines_.front());
+                sink(dispatch, &current_);
+            } else {
+                sink(dispatch, &lines_.front());
+            }
+            lines_.pop_front();
+            matched_.fetch_add(1, std::memory_order_relaxed);
+        } else if (!lines_.empty() || now_ns > deadline) {
+            // The next line is too late for this dispatch, or none came in time
+            sink(dispatch, nullptr);
+            unmatched_dispatches_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            break;  // Its line may still be in flight
+        }
+        dispatches_.pop_front();
+    }
+}
+
+void LogCorrelator::resolve_spans(uint64_t now_ns, const Sink& sink) {
+    while (!dispatches_.empty()) {
+        const PendingDispatch& dispatch = dispatches_.front();
+        const uint64_t deadline = dispatch.timestamp_ns + window_ns_;
+
+        // Lines are stamped in arrival order, so the dispatch is settled once
+        // a line past its deadline is in or the deadline itself has passed
+        const bool later_line = !lines_.empty() && lines_.back().timestamp_ns > deadline;
+        if (!later_line && now_ns <= deadline) {
+            break;
+        }
+        // Calls that started before this dispatch; only the last one runs it
+        bool claimed = false;
+        while (!lines_.empty() && lines_.front().timestamp_ns <= deadline) {
+            if (claimed) {
+                unmatched_lines_.fetch_add(1, std::memory_order_relaxed);
+            }
+            current_ = std::move(lines_.front());
+            lines_.pop_front();
+            have_current_ = true;
+            claimed = true;
+        }
+        if (have_current_) {
+            sink(dispatch, &current_);
+            matched_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            sink(dispatch, nullptr);
+            unmatched_dispatches_.fetch_add(1, std::memory_order_relaxed);
+        }
+        dispatches_.pop_front();
+    }
+}
+
+bool LogCorrelator::try_match(uint64_t now_ns, const Sink& sink) {
+    std::unique_lock<std::mutex> lock(match_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return false;
+    }
+    resolve(flushed_.load(std::memory_order_acquire) ? UINT64_MAX : now_ns, sink);
+    return true;
+}
+
+void LogCorrelator::match(uint64_t now_ns, const Sink& sink) {
+    std::lock_guard<std::mutex> lock(match_mutex_);
+    resolve(flushed_.load(std::memory_order_acquire) ? UINT64_MAX : now_ns, sink);
+}
+
+void LogCorrelator::flush(const Sink& sink) {
+    std::lock_guard<std::mutex> lock(match_mutex_);
+    flushed_.store(true, std::memory_order_release);
+
+    // Remaining lines still pair in order; only a missing line ends the wait
+    resolve(UINT64_MAX, sink);
+    unmatched_lines_.fetch_add(lines_.size(), std::memory_order_relaxed);
+    lines_.clear();
+}
+
+} // namespace rpv3
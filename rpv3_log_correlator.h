@@ -0,0 +1,182 @@
+// MIT License
+// RPV3 Log Correlator - Pairs library log lines with the dispatches they launched
+//
+// A background thread reads a library's call log (rocBLAS, hipBLASLt, ...;
+// see rpv3_library_log.h) and stamps each call line with the time it
+// arrived. Dispatch callbacks hand over each dispatch of a kernel the
+// library claimed together with its already formatted trace record. Neither side waits for
+// the other:
+//
+// - Both hand-offs go through lock-free multi-producer queues (one atomic
+//   exchange per push). Matching runs on whichever thread gets the matcher
+//   lock with try_lock; callbacks skip it when it is busy.
+// - Lines and dispatches are paired in arrival order, which keeps each host
+//   thread's launch order. rocBLAS writes a line before launching its
+//   kernel, so a line that arrived more than the window after a dispatch
+//   started belongs to a later dispatch; the earlier one is resolved
+//   without a line and pairing stays in step.
+// - A dispatch is held until its line arrives or the window has passed, and
+//   its record is released together with the line so the annotation still
+//   directly follows the record it describes.
+// - flush() resolves everything still queued at exit. After a flush,
+//   dispatches that arrive late are resolved without waiting.
+//
+// Some calls of a one-per-call library run a varying number of claimed
+// kernels (a rocBLAS trsm runs Tensile gemms inside, or none when small).
+// Their lines are marked as spans: such a line takes the next dispatch like
+// any other and then keeps every following one until a later line arrived
+// no later than a dispatch started, which hands that dispatch to the later
+// line. A span line still queued when a later line was in before the next
+// dispatch started ran no claimed kernel and is dropped. A line read after
+// its first kernel started can leave that kernel in the span before it.
+//
+// Libraries whose calls launch several kernels (rocSOLVER) use span pairing
+// instead: each dispatch gets the latest line that arrived no later than
+// the window after it started, so one line covers every kernel of its call.
+// Nothing in the log marks where a call's kernels end, so when the host
+// runs ahead of the GPU by less than the window a boundary can shift.
+
+#ifndef RPV3_LOG_CORRELATOR_H
+#define RPV3_LOG_CORRELATOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace rpv3 {
+
+// How call lines map onto claimed dispatches
+enum class LogPairing : uint8_t {
+    OnePerCall,  // Each line belongs to exactly one dispatch, in order
+    Span,        // A line covers every dispatch until the next line
+};
+
+// One library call line, stamped when it was taken off the log
+struct LogLine {
+    uint64_t timestamp_ns = 0;
+    std::string text;
+    bool span = false;  // One-per-call pairing: the call may run several claimed kernels
+};
+
+// A claimed dispatch waiting for its log line
+struct PendingDispatch {
+    uint64_t dispatch_id = 0;
+    uint64_t timestamp_ns = 0;  // Dispatch start
+    uint64_t duration_ns = 0;   // GPU time, 0 when not known yet
+    bool recorded = false;      // False for filtered or sampled-out dispatches
+    std::string record;         // Formatted trace record, written before the line
+};
+
+// Unbounded lock-free multi-producer, single-consumer queue. Producers push
+// onto an intrusive stack; the consumer takes the whole stack at once, so
+// there is no ABA problem, and restores push order.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() = default;
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        Node* node = head_.load(std::memory_order_acquire);
+        while (node) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    void push(T value) {
+        Node* node = new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+    }
+
+    // Move everything pushed so far to the back of out, oldest first
+    void drain(std::deque<T>& out) {
+        Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+        Node* reversed = nullptr;
+        while (node) {
+            Node* next = node->next;
+            node->next = reversed;
+            reversed = node;
+            node = next;
+        }
+        while (reversed) {
+            Node* next = reversed->next;
+            out.push_back(std::move(reversed->value));
+            delete reversed;
+            reversed = next;
+        }
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+    std::atomic<Node*> head_{nullptr};
+};
+
+class LogCorrelator {
+public:
+    // Longest a line may trail the start of its dispatch
+    static constexpr uint64_t kDefaultWindowNs = 50'000'000;
+
+    // Receives each resolved dispatch, with its line or nullptr
+    using Sink = std::function<void(const PendingDispatch& dispatch, const LogLine* line)>;
+
+    explicit LogCorrelator(uint64_t window_ns = kDefaultWindowNs, LogPairing pairing = LogPairing::OnePerCall)
+        : window_ns_(window_ns), pairing_(pairing) {}
+
+    LogCorrelator(const LogCorrelator&) = delete;
+    LogCorrelator& operator=(const LogCorrelator&) = delete;
+
+    // Lock-free; called by the log reader thread
+    void push_line(uint64_t timestamp_ns, std::string text, bool span = false);
+
+    // Lock-free; called by dispatch and buffer callbacks
+    void push_dispatch(PendingDispatch dispatch);
+
+    // Resolve what can be resolved at now_ns. Returns false at once if another
+    // thread is matching.
+    bool try_match(uint64_t now_ns, const Sink& sink);
+
+    // Same, waiting for the matcher (the reader thread's periodic pass)
+    void match(uint64_t now_ns, const Sink& sink);
+
+    // Resolve every queued dispatch and drop lines no dispatch claimed
+    void flush(const Sink& sink);
+
+    uint64_t matched() const { return matched_.load(std::memory_order_relaxed); }
+    uint64_t unmatched_dispatches() const { return unmatched_dispatches_.load(std::memory_order_relaxed); }
+    uint64_t unmatched_lines() const { return unmatched_lines_.load(std::memory_order_relaxed); }
+
+private:
+    void resolve(uint64_t now_ns, const Sink& sink);
+    void resolve_spans(uint64_t now_ns, const Sink& sink);
+
+    const uint64_t window_ns_;
+    const LogPairing pairing_;
+    MpscQueue<LogLine> incoming_lines_;
+    MpscQueue<PendingDispatch> incoming_dispatches_;
+
+    std::mutex match_mutex_;  // Guards the two deques
+    std::deque<LogLine> lines_;
+    std::deque<PendingDispatch> dispatches_;
+    LogLine current_;             // Span pairing or a span line: the call now running
+    bool have_current_ = false;
+
+    std::atomic<bool> flushed_{false};
+    std::atomic<uint64_t> matched_{0};
+    std::atomic<uint64_t> unmatched_dispatches_{0};
+    std::atomic<uint64_t> unmatched_lines_{0};
+};
+
+} // namespace rpv3
+
+#endif // RPV3_LOG_CORRELATOR_H
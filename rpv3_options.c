@@ -19,9 +19,15 @@ int rpv3_timeline_enabled = 0;
 /* Global flag for CSV output mode */
 int rpv3_csv_enabled = 0;
 
+/* Global output format */
+rpv3_output_format_t rpv3_output_format = RPV3_FORMAT_TEXT;
+
 /* Global counter mode */
 rpv3_counter_mode_t rpv3_counter_mode = RPV3_COUNTER_MODE_NONE;
 
+/* Counters and derived metrics for --counters */
+char* rpv3_counters_spec = NULL;
+
 /* Global output file path */
 char* rpv3_output_file = NULL;
 
@@ -34,9 +40,133 @@ char* rpv3_rocblas_pipe = NULL;
 /* Global rocBLAS log file path */
 char* rpv3_rocblas_log_file = NULL;
 
+/* hipBLASLt, MIOpen and rocSOLVER log pipe paths */
+char* rpv3_hipblaslt_pipe = NULL;
+char* rpv3_miopen_pipe = NULL;
+char* rpv3_rocsolver_pipe = NULL;
+
 /* Global flag for backtrace mode */
 int rpv3_backtrace_enabled = 0;
 
+/* Global flag for aggregate-only mode */
+int rpv3_summary_enabled = 0;
+
+/* Latency histogram settings */
+int rpv3_histogram_enabled = 0;
+char* rpv3_histogram_file = NULL;
+
+/* Dispatch sampling settings */
+rpv3_sample_mode_t rpv3_sample_mode = RPV3_SAMPLE_NONE;
+unsigned long rpv3_sample_every = 0;
+unsigned long rpv3_sample_window_on_ms = 0;
+unsigned long rpv3_sample_window_off_ms = 0;
+unsigned long rpv3_sample_reservoir = 0;
+
+/* Kernel filter settings */
+char* rpv3_counter_kernel_patterns[RPV3_MAX_NAME_PATTERNS];
+int rpv3_counter_kernel_count = 0;
+unsigned long rpv3_counter_first = 0;
+unsigned long rpv3_counter_every = 0;
+char* rpv3_counter_cache = NULL;
+char* rpv3_include_patterns[RPV3_MAX_NAME_PATTERNS];
+int rpv3_include_count = 0;
+char* rpv3_exclude_patterns[RPV3_MAX_NAME_PATTERNS];
+int rpv3_exclude_count = 0;
+char* rpv3_filter_expr = NULL;
+
+/* Async output engine settings */
+int rpv3_async_enabled = 0;
+unsigned long rpv3_ring_size = RPV3_DEFAULT_RING_SIZE;
+rpv3_ring_policy_t rpv3_ring_policy = RPV3_RING_POLICY_BLOCK;
+
+/* rocblas-bench reproducer file */
+char* rpv3_rocblas_bench_file = NULL;
+
+/* rocBLAS efficiency table peaks */
+double rpv3_peak_tflops = 0.0;
+double rpv3_peak_gbps = 0.0;
+
+/* Parse a size such as "65536", "256K" or "4M". Returns 0 on error. */
+static unsigned long parse_size(const char* text) {
+    char* end = NULL;
+    unsigned long value = strtoul(text, &end, 10);
+    if (end == text) {
+        return 0;
+    }
+    if (*end == 'k' || *end == 'K') {
+        value *= 1024UL;
+        end++;
+    } else if (*end == 'm' || *end == 'M') {
+        value *= 1024UL * 1024UL;
+        end++;
+    }
+    return (*end == '\0') ? value : 0;
+}
+
+/* Parse a positive number such as "1307.4". Returns 0 on error. */
+static double parse_positive(const char* text) {
+    char* end = NULL;
+    double value = strtod(text, &end);
+    return (end != text && *end == '\0' && value > 0.0) ? value : 0.0;
+}
+
+/* Parse a positive decimal number that must be followed by `terminator`.
+ * Stores the position after the terminator in *next. Returns 0 on error. */
+static unsigned long parse_count(const char* text, char terminator, const char** next) {
+    char* end = NULL;
+    if (*text < '0' || *text > '9') {
+        return 0;
+    }
+    unsigned long value = strtoul(text, &end, 10);
+    if (*end != terminator) {
+        return 0;
+    }
+    *next = (terminator == '\0') ? end : end + 1;
+    return value;
+}
+
+/* Parse a --sample policy: every:N, window:ON_MS:OFF_MS or reservoir:K. Returns 0 on error. */
+static int parse_sample(const char* spec) {
+    const char* next = NULL;
+    if (strncmp(spec, "every:", 6) == 0) {
+        unsigned long n = parse_count(spec + 6, '\0', &next);
+        if (n == 0) {
+            return 0;
+        }
+        rpv3_sample_mode = RPV3_SAMPLE_EVERY;
+        rpv3_sample_every = n;
+        printf("[RPV3] Sampling: every %lu dispatches\n", n);
+        return 1;
+    }
+    if (strncmp(spec, "window:", 7) == 0) {
+        unsigned long on = parse_count(spec + 7, ':', &next);
+        if (on == 0) {
+            return 0;
+        }
+        const char* off_text = next;
+        unsigned long off = parse_count(off_text, '\0', &next);
+        if (off == 0 && strcmp(off_text, "0") != 0) {
+            return 0;
+        }
+        rpv3_sample_mode = RPV3_SAMPLE_WINDOW;
+        rpv3_sample_window_on_ms = on;
+        rpv3_sample_window_off_ms = off;
+        printf("[RPV3] Sampling: %lu ms on, %lu ms off\n", on, off);
+        return 1;
+    }
+    if (strncmp(spec, "reservoir:", 10) == 0) {
+        unsigned long k = parse_count(spec + 10, '\0', &next);
+        if (k == 0) {
+            return 0;
+        }
+        rpv3_sample_mode = RPV3_SAMPLE_RESERVOIR;
+        rpv3_sample_reservoir = k;
+        printf("[RPV3] Sampling: reservoir of %lu dispatches per kernel\n", k);
+        return 1;
+    }
+    return 0;
+}
+
 /* Parse options from the RPV3_OPTIONS environment variable */
 int rpv3_parse_options(void) {
     const char* options_env = getenv("RPV3_OPTIONS");
@@ -72,12 +202,36 @@ int rpv3_parse_options(void) {
             printf("  --help, -h   Print this help message and exit\n");
             printf("  --timeline   Enable timeline mode with GPU timestamps\n");
             printf("  --csv        Enable CSV output mode\n");
+            printf("  --format <f> Trace output format (text, csv, binary; binary needs --output/--outputdir)\n");
             printf("  --counter <group> Enable counter collection (compute, memory, mixed)\n");
+            printf("  --counters <list> Collect these counters and derived metrics (comma-separated, no spaces)\n");
+            printf("                    e.g. SQ_WAVES,VALU_UTIL=SQ_INSTS_VALU/SQ_WAVES\n");
+            printf("  --counter-kernels <pattern> Count only kernels whose name matches (glob, repeatable)\n");
+            printf("  --counter-first <K> Count only the first K dispatches of each kernel\n");
+            printf("  --counter-every <N> Count one dispatch in N of each kernel\n");
+            printf("  --counter-cache <file> Counter catalog cache (default ~/.cache/rpv3/counter-catalog, off to disable)\n");
             printf("  --output <file>   Redirect output to specified file\n");
             printf("  --outputdir <dir> Redirect output to directory with PID-based filename\n");
             printf("  --rocblas <pipe>  Read rocBLAS logs from named pipe\n");
             printf("  --rocblas-log <file> Redirect rocBLAS logs to file (requires --rocblas)\n");
-            printf("  --backtrace  Enable function backtrace (incompatible with --timeline, --csv)\n");
+            printf("  --rocblas-bench <file> Write rocblas-bench YAML for the hottest rocBLAS calls (requires --rocblas)\n");
+            printf("  --hipblaslt <pipe> Read hipBLASLt logs (HIPBLASLT_LOG_FILE) from named pipe\n");
+            printf("  --miopen <pipe>    Read MIOpen command logs (MIOPEN_ENABLE_LOGGING_CMD) from named pipe\n");
+            printf("  --rocsolver <pipe> Read rocSOLVER logs (ROCSOLVER_LOG_*_PATH) from named pipe\n");
+            printf("  --backtrace  Enable function backtrace (incompatible with --timeline, --csv, binary)\n");
+            printf("  --summary    Print a per-kernel statistics table at exit instead of every dispatch\n");
+            printf("  --histogram  Print per-kernel latency percentiles (p50/p90/p99/p99.9) at exit\n");
+            printf("  --histogram-dump <file> Also write the histograms as mergeable CSV\n");
+            printf("  --sample <policy>   Record a sample of dispatches (every:N, window:ON_MS:OFF_MS, reservoir:K)\n");
+            printf("  --include <pattern> Trace only kernels whose name matches (glob, repeatable)\n");
+            printf("  --exclude <pattern> Skip kernels whose name matches (glob, repeatable)\n");
+            printf("  --filter <expr>     Numeric predicates on duration, grid, workgroup, lds, scratch\n");
+            printf("                      e.g. duration>=10us,lds>0\n");
+            printf("  --async      Queue trace output in per-thread rings drained by a writer thread\n");
+            printf("  --ring-size <bytes> Per-thread ring size for --async (K/M suffix, default 256K)\n");
+            printf("  --ring-policy <p>   Full ring policy for --async (block, drop, spill)\n");
+            printf("  --peak-tflops <x>   Device peak TFLOP/s for the rocBLAS efficiency table\n");
+            printf("  --peak-gbps <x>     Device peak memory bandwidth (GB/s) for the same table\n");
             printf("\nExample:\n");
             printf("  RPV3_OPTIONS=\"--version\" LD_PRELOAD=./libkernel_tracer.so ./app\n");
             printf("  RPV3_OPTIONS=\"--timeline\" LD_PRELOAD=./libkernel_tracer.so ./app\n");
@@ -91,8 +245,29 @@ int rpv3_parse_options(void) {
         }
         else if (strcmp(token, "--csv") == 0) {
             rpv3_csv_enabled = 1;
+            rpv3_output_format = RPV3_FORMAT_CSV;
             printf("[RPV3] CSV output mode enabled\n");
         }
+        else if (strcmp(token, "--format") == 0) {
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: --format requires an argument (text, csv, binary)\n");
+            } else if (strcmp(token, "text") == 0) {
+                rpv3_output_format = RPV3_FORMAT_TEXT;
+                rpv3_csv_enabled = 0;
+                printf("[RPV3] Output format: text\n");
+            } else if (strcmp(token, "csv") == 0) {
+                rpv3_output_format = RPV3_FORMAT_CSV;
+                rpv3_csv_enabled = 1;
+                printf("[RPV3] Output format: csv\n");
+            } else if (strcmp(token, "binary") == 0) {
+                rpv3_output_format = RPV3_FORMAT_BINARY;
+                rpv3_csv_enabled = 0;
+                printf("[RPV3] Output format: binary\n");
+            } else {
+                fprintf(stderr, "[RPV3] Error: Unknown output format '%s'. Supported: text, csv, binary\n", token);
+            }
+        }
         else if (strcmp(token, "--output") == 0) {
             token = strtok(NULL, " \t\n");
             if (token == NULL) {
@@ -120,6 +295,21 @@ int rpv3_parse_options(void) {
                 printf("[RPV3] RocBLAS log pipe: %s\n", rpv3_rocblas_pipe);
             }
         }
+        else if (strcmp(token, "--hipblaslt") == 0 || strcmp(token, "--miopen") == 0 ||
+                 strcmp(token, "--rocsolver") == 0) {
+            char** pipe = (token[2] == 'h') ? &rpv3_hipblaslt_pipe :
+                          (token[2] == 'm') ? &rpv3_miopen_pipe : &rpv3_rocsolver_pipe;
+            const char* library = (token[2] == 'h') ? "hipBLASLt" : (token[2] == 'm') ? "MIOpen" : "rocSOLVER";
+            const char* option = token;
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: %s requires a pipe name argument\n", option);
+            } else {
+                free(*pipe);
+                *pipe = strdup(token);
+                printf("[RPV3] %s log pipe: %s\n", library, *pipe);
+            }
+        }
         else if (strcmp(token, "--rocblas-log") == 0) {
             token = strtok(NULL, " \t\n");
             if (token == NULL) {
@@ -148,10 +338,198 @@ int rpv3_parse_options(void) {
                 }
             }
         }
+        else if (strcmp(token, "--counters") == 0) {
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: --counters requires a list (e.g. SQ_WAVES,VALU_UTIL=SQ_INSTS_VALU/SQ_WAVES)\n");
+            } else {
+                /* Repeated lists are collected together */
+                size_t old_len = rpv3_counters_spec ? strlen(rpv3_counters_spec) : 0;
+                char* joined = (char*)realloc(rpv3_counters_spec, old_len + strlen(token) + 2);
+                if (joined) {
+                    if (old_len > 0) {
+                        joined[old_len++] = ',';
+                    }
+                    strcpy(joined + old_len, token);
+                    rpv3_counters_spec = joined;
+                    rpv3_counter_mode = RPV3_COUNTER_MODE_CUSTOM;
+                    printf("[RPV3] Counter collection enabled: %s\n", token);
+                }
+            }
+        }
+        else if (strcmp(token, "--counter-kernels") == 0) {
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: --counter-kernels requires a kernel name pattern\n");
+            } else if (rpv3_counter_kernel_count >= RPV3_MAX_NAME_PATTERNS) {
+                fprintf(stderr, "[RPV3] Error: Too many --counter-kernels patterns (max %d), ignoring '%s'\n",
+                        RPV3_MAX_NAME_PATTERNS, token);
+            } else {
+                rpv3_counter_kernel_patterns[rpv3_counter_kernel_count++] = strdup(token);
+                printf("[RPV3] Counting kernels matching: %s\n", token);
+            }
+        }
+        else if (strcmp(token, "--counter-first") == 0 || strcmp(token, "--counter-every") == 0) {
+            int first = (token[10] == 'f');
+            const char* option = first ? "--counter-first" : "--counter-every";
+            token = strtok(NULL, " \t\n");
+            const char* next = NULL;
+            unsigned long n = token ? parse_count(token, '\0', &next) : 0;
+            if (n == 0) {
+                fprintf(stderr, "[RPV3] Error: %s requires a positive dispatch count\n", option);
+            } else if (first) {
+                rpv3_counter_first = n;
+                printf("[RPV3] Counting the first %lu dispatches of each kernel\n", n);
+            } else {
+                rpv3_counter_every = n;
+                printf("[RPV3] Counting one dispatch in %lu of each kernel\n", n);
+            }
+        }
+        else if (strcmp(token, "--counter-cache") == 0) {
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: --counter-cache requires a filename argument (or off)\n");
+            } else {
+                free(rpv3_counter_cache);
+                rpv3_counter_cache = strdup(token);
+                if (strcmp(token, "off") == 0) {
+                    printf("[RPV3] Counter catalog cache disabled\n");
+                } else {
+                    printf("[RPV3] Counter catalog cache: %s\n", rpv3_counter_cache);
+                }
+            }
+        }
         else if (strcmp(token, "--backtrace") == 0) {
             rpv3_backtrace_enabled = 1;
             printf("[RPV3] Backtrace mode enabled\n");
         }
+        else if (strcmp(token, "--summary") == 0) {
+            rpv3_summary_enabled = 1;
+            printf("[RPV3] Summary mode enabled\n");
+        }
+        else if (strcmp(token, "--histogram") == 0) {
+            rpv3_histogram_enabled = 1;
+            printf("[RPV3] Latency histograms enabled\n");
+        }
+        else if (strcmp(token, "--histogram-dump") == 0) {
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: --histogram-dump requires a filename argument\n");
+            } else {
+                free(rpv3_histogram_file);
+                rpv3_histogram_file = strdup(token);
+                rpv3_histogram_enabled = 1;
+                printf("[RPV3] Latency histograms will be written to: %s\n", rpv3_histogram_file);
+            }
+        }
+        else if (strcmp(token, "--sample") == 0) {
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: --sample requires a policy (every:N, window:ON:OFF, reservoir:K)\n");
+            } else if (!parse_sample(token)) {
+                fprintf(stderr, "[RPV3] Error: Invalid sampling policy '%s'. Supported: every:N, window:ON:OFF, reservoir:K\n", token);
+            }
+        }
+        else if (strcmp(token, "--include") == 0 || strcmp(token, "--exclude") == 0) {
+            int include = (token[2] == 'i');
+            const char* option = include ? "--include" : "--exclude";
+            char** patterns = include ? rpv3_include_patterns : rpv3_exclude_patterns;
+            int* count = include ? &rpv3_include_count : &rpv3_exclude_count;
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: %s requires a kernel name pattern\n", option);
+            } else if (*count >= RPV3_MAX_NAME_PATTERNS) {
+                fprintf(stderr, "[RPV3] Error: Too many %s patterns (max %d), ignoring '%s'\n",
+                        option, RPV3_MAX_NAME_PATTERNS, token);
+            } else {
+                patterns[(*count)++] = strdup(token);
+                printf("[RPV3] Kernel filter: %s %s\n", option + 2, token);
+            }
+        }
+        else if (strcmp(token, "--filter") == 0) {
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: --filter requires an expression (e.g. duration>=10us)\n");
+            } else {
+                /* Repeated filters must all hold: join them into one list */
+                size_t old_len = rpv3_filter_expr ? strlen(rpv3_filter_expr) : 0;
+                char* joined = (char*)realloc(rpv3_filter_expr, old_len + strlen(token) + 2);
+                if (joined) {
+                    if (old_len > 0) {
+                        joined[old_len++] = ',';
+                    }
+                    strcpy(joined + old_len, token);
+                    rpv3_filter_expr = joined;
+                    printf("[RPV3] Dispatch filter: %s\n", token);
+                }
+            }
+        }
+        else if (strcmp(token, "--async") == 0) {
+            rpv3_async_enabled = 1;
+            printf("[RPV3] Async output enabled\n");
+        }
+        else if (strcmp(token, "--ring-size") == 0) {
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: --ring-size requires a size argument\n");
+            } else {
+                unsigned long size = parse_size(token);
+                if (size == 0) {
+                    fprintf(stderr, "[RPV3] Error: Invalid ring size '%s'\n", token);
+                } else {
+                    rpv3_ring_size = size;
+                    rpv3_async_enabled = 1;
+                    printf("[RPV3] Async output ring size: %lu bytes\n", rpv3_ring_size);
+                }
+            }
+        }
+        else if (strcmp(token, "--ring-policy") == 0) {
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: --ring-policy requires an argument (block, drop, spill)\n");
+            } else if (strcmp(token, "block") == 0) {
+                rpv3_ring_policy = RPV3_RING_POLICY_BLOCK;
+                rpv3_async_enabled = 1;
+                printf("[RPV3] Async output ring policy: block\n");
+            } else if (strcmp(token, "drop") == 0) {
+                rpv3_ring_policy = RPV3_RING_POLICY_DROP;
+                rpv3_async_enabled = 1;
+                printf("[RPV3] Async output ring policy: drop\n");
+            } else if (strcmp(token, "spill") == 0) {
+                rpv3_ring_policy = RPV3_RING_POLICY_SPILL;
+                rpv3_async_enabled = 1;
+                printf("[RPV3] Async output ring policy: spill\n");
+            } else {
+                fprintf(stderr, "[RPV3] Error: Unknown ring policy '%s'. Supported: block, drop, spill\n", token);
+            }
+        }
+        else if (strcmp(token, "--rocblas-bench") == 0) {
+            token = strtok(NULL, " \t\n");
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: --rocblas-bench requires a filename argument\n");
+            } else {
+                free(rpv3_rocblas_bench_file);
+                rpv3_rocblas_bench_file = strdup(token);
+                printf("[RPV3] rocblas-bench reproducers will be written to: %s\n", rpv3_rocblas_bench_file);
+            }
+        }
+        else if (strcmp(token, "--peak-tflops") == 0 || strcmp(token, "--peak-gbps") == 0) {
+            int tflops = (token[7] == 't');
+            const char* option = tflops ? "--peak-tflops" : "--peak-gbps";
+            token = strtok(NULL, " \t\n");
+            double value = token ? parse_positive(token) : 0.0;
+            if (token == NULL) {
+                fprintf(stderr, "[RPV3] Error: %s requires a value\n", option);
+            } else if (value == 0.0) {
+                fprintf(stderr, "[RPV3] Error: Invalid %s value '%s'\n", option, token);
+            } else if (tflops) {
+                rpv3_peak_tflops = value;
+                printf("[RPV3] Peak for BLAS efficiency: %g TFLOP/s\n", value);
+            } else {
+                rpv3_peak_gbps = value;
+                printf("[RPV3] Peak for BLAS efficiency: %g GB/s\n", value);
+            }
+        }
         else {
             fprintf(stderr, "[RPV3] Warning: Unknown option '%s' (ignored)\n", token);
         }
@@ -173,6 +551,26 @@ int rpv3_parse_options(void) {
             fprintf(stderr, "[RPV3]        Variable-length backtraces don't fit CSV schema\n");
             return RPV3_OPTIONS_EXIT;
         }
+        if (rpv3_output_format == RPV3_FORMAT_BINARY) {
+            fprintf(stderr, "[RPV3] Error: --backtrace is incompatible with --format binary\n");
+            fprintf(stderr, "[RPV3]        Variable-length backtraces don't fit fixed-size records\n");
+            return RPV3_OPTIONS_EXIT;
+        }
+        if (rpv3_summary_enabled) {
+            fprintf(stderr, "[RPV3] Error: --backtrace is incompatible with --summary\n");
+            fprintf(stderr, "[RPV3]        Summary mode does not emit per-dispatch records\n");
+            return RPV3_OPTIONS_EXIT;
+        }
+        if (rpv3_sample_mode == RPV3_SAMPLE_RESERVOIR) {
+            fprintf(stderr, "[RPV3] Error: --backtrace is incompatible with --sample reservoir\n");
+            fprintf(stderr, "[RPV3]        Reservoir samples are chosen after the call stack is gone\n");
+            return RPV3_OPTIONS_EXIT;
+        }
+    }
+    if (rpv3_summary_enabled && rpv3_output_format == RPV3_FORMAT_BINARY) {
+        fprintf(stderr, "[RPV3] Error: --summary is incompatible with --format binary\n");
+        fprintf(stderr, "[RPV3]        The summary table is written as text or CSV\n");
+        return RPV3_OPTIONS_EXIT;
     }
     
     return should_exit ? RPV3_OPTIONS_EXIT : RPV3_OPTIONS_CONTINUE;
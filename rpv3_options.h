@@ -28,17 +28,32 @@ extern int rpv3_timeline_enabled;
 /* Global flag for CSV output mode (set by --csv option) */
 extern int rpv3_csv_enabled;
 
+/* Trace output formats */
+typedef enum {
+    RPV3_FORMAT_TEXT = 0,  /* Human-readable records (default) */
+    RPV3_FORMAT_CSV,       /* One CSV line per dispatch */
+    RPV3_FORMAT_BINARY     /* Compact .rpv3 records, expanded with rpv3-convert */
+} rpv3_output_format_t;
+
+/* Global output format (set by --format, --csv implies RPV3_FORMAT_CSV) */
+extern rpv3_output_format_t rpv3_output_format;
+
 /* Counter collection modes */
 typedef enum {
     RPV3_COUNTER_MODE_NONE = 0,
     RPV3_COUNTER_MODE_COMPUTE,
     RPV3_COUNTER_MODE_MEMORY,
-    RPV3_COUNTER_MODE_MIXED
+    RPV3_COUNTER_MODE_MIXED,
+    RPV3_COUNTER_MODE_CUSTOM  /* Counters and metrics listed with --counters */
 } rpv3_counter_mode_t;
 
-/* Global counter mode (set by --counter option) */
+/* Global counter mode (set by --counter and --counters options) */
 extern rpv3_counter_mode_t rpv3_counter_mode;
 
+/* Counter names and NAME=expression metrics (set by --counters, repeated
+ * lists are joined with ',', C++ library only) */
+extern char* rpv3_counters_spec;
+
 /* Global output file path (set by --output option) */
 extern char* rpv3_output_file;
 
@@ -51,9 +66,94 @@ extern char* rpv3_rocblas_pipe;
 /* Global rocBLAS log file path (set by --rocblas-log option) */
 extern char* rpv3_rocblas_log_file;
 
+/* Log pipes of the other libraries whose calls are paired with their
+ * kernels (set by --hipblaslt, --miopen and --rocsolver, C++ library only) */
+extern char* rpv3_hipblaslt_pipe;
+extern char* rpv3_miopen_pipe;
+extern char* rpv3_rocsolver_pipe;
+
 /* Global flag for backtrace mode (set by --backtrace option) */
 extern int rpv3_backtrace_enabled;
 
+/* Global flag for aggregate-only mode (set by --summary option) */
+extern int rpv3_summary_enabled;
+
+/* Global flag for per-kernel latency histograms (set by --histogram option) */
+extern int rpv3_histogram_enabled;
+
+/* Histogram dump file path (set by --histogram-dump option, implies --histogram) */
+extern char* rpv3_histogram_file;
+
+/* Dispatch sampling policies */
+typedef enum {
+    RPV3_SAMPLE_NONE = 0,   /* Record every dispatch */
+    RPV3_SAMPLE_EVERY,      /* Record every Nth dispatch */
+    RPV3_SAMPLE_WINDOW,     /* Record during periodic on/off time windows */
+    RPV3_SAMPLE_RESERVOIR   /* Keep a uniform sample of K dispatches per kernel */
+} rpv3_sample_mode_t;
+
+/* Global sampling policy (set by --sample option) */
+extern rpv3_sample_mode_t rpv3_sample_mode;
+
+/* Sampling parameters: N for every:N, ON/OFF milliseconds for window:ON:OFF, K for reservoir:K */
+extern unsigned long rpv3_sample_every;
+extern unsigned long rpv3_sample_window_on_ms;
+extern unsigned long rpv3_sample_window_off_ms;
+extern unsigned long rpv3_sample_reservoir;
+
+/* Maximum number of --include / --exclude patterns */
+#define RPV3_MAX_NAME_PATTERNS 32
+
+/* Kernel name patterns (set by --include and --exclude, may be repeated) */
+extern char* rpv3_include_patterns[RPV3_MAX_NAME_PATTERNS];
+extern int rpv3_include_count;
+extern char* rpv3_exclude_patterns[RPV3_MAX_NAME_PATTERNS];
+extern int rpv3_exclude_count;
+
+/* Counter collection selection (C++ library only): kernels counted by name
+ * (--counter-kernels, repeatable), the first K dispatches of each kernel
+ * (--counter-first, 0 = all) and one dispatch in N of each kernel
+ * (--counter-every, 0 or 1 = all) */
+extern char* rpv3_counter_kernel_patterns[RPV3_MAX_NAME_PATTERNS];
+extern int rpv3_counter_kernel_count;
+extern unsigned long rpv3_counter_first;
+extern unsigned long rpv3_counter_every;
+
+/* Counter catalog cache file (set by --counter-cache, "off" disables it;
+ * NULL = ~/.cache/rpv3/counter-catalog, C++ library only) */
+extern char* rpv3_counter_cache;
+
+/* Numeric dispatch predicates (set by --filter, repeated filters are joined with ',') */
+extern char* rpv3_filter_expr;
+
+/* Behaviour of the async output engine when a thread's ring is full */
+typedef enum {
+    RPV3_RING_POLICY_BLOCK = 0,  /* Wait for the writer thread (lossless) */
+    RPV3_RING_POLICY_DROP,       /* Drop the record and count it */
+    RPV3_RING_POLICY_SPILL       /* Queue in an unbounded overflow buffer (lossless) */
+} rpv3_ring_policy_t;
+
+/* Default per-thread ring size for the async output engine */
+#define RPV3_DEFAULT_RING_SIZE (256UL * 1024UL)
+
+/* Global flag for the async output engine (set by --async option) */
+extern int rpv3_async_enabled;
+
+/* Per-thread ring size in bytes (set by --ring-size option) */
+extern unsigned long rpv3_ring_size;
+
+/* Ring full policy (set by --ring-policy option) */
+extern rpv3_ring_policy_t rpv3_ring_policy;
+
+/* rocblas-bench YAML for the correlated rocBLAS calls (set by --rocblas-bench) */
+extern char* rpv3_rocblas_bench_file;
+
+/* Device peaks for the rocBLAS efficiency table (set by --peak-tflops and
+ * --peak-gbps, 0 = unknown; the TFLOP/s peak is then estimated per datatype
+ * from the agent) */
+extern double rpv3_peak_tflops;
+extern double rpv3_peak_gbps;
+
 /**
  * Parse options from the RPV3_OPTIONS environment variable
  * 
@@ -63,10 +163,26 @@ extern int rpv3_backtrace_enabled;
  *   --help, -h : Print help message and return RPV3_OPTIONS_EXIT
  *   --timeline : Enable timeline mode with GPU timestamps (sets rpv3_timeline_enabled)
  *   --csv : Enable CSV output mode (sets rpv3_csv_enabled)
+ *   --format <text|csv|binary> : Select the trace output format (sets rpv3_output_format)
  *   --counter <group> : Enable counter collection (compute, memory, mixed)
+ *   --counter-kernels <pattern> : Count only kernels whose name matches, repeatable (sets rpv3_counter_kernel_patterns)
+ *   --counter-first <K> / --counter-every <N> : Count the first K / one in N dispatches per kernel (sets rpv3_counter_first/every)
+ *   --counters <list> : Collect listed counters and derived metrics such as VALU_UTIL=SQ_INSTS_VALU/SQ_WAVES (sets rpv3_counters_spec)
  *   --output <filename> : Redirect output to specified file (sets rpv3_output_file)
  *   --outputdir <directory> : Redirect output to directory with PID-based filename (sets rpv3_output_dir)
- *   --backtrace : Enable function backtrace at kernel dispatch (incompatible with --timeline and --csv)
+ *   --backtrace : Enable function backtrace at kernel dispatch (incompatible with --timeline, --csv and binary)
+ *   --summary : Print per-kernel statistics at exit instead of per-dispatch records (sets rpv3_summary_enabled)
+ *   --histogram : Keep per-kernel latency histograms and print percentiles at exit (sets rpv3_histogram_enabled)
+ *   --histogram-dump <file> : Also write the histograms as mergeable CSV (sets rpv3_histogram_file)
+ *   --sample <every:N|window:ON:OFF|reservoir:K> : Record only a sample of dispatches (sets rpv3_sample_*)
+ *   --include <pattern> / --exclude <pattern> : Kernel name globs, repeatable (sets rpv3_include/exclude_patterns)
+ *   --filter <predicates> : Numeric predicates such as duration>=10us,lds>0 (sets rpv3_filter_expr)
+ *   --async : Write trace records through per-thread rings and a background writer (sets rpv3_async_enabled)
+ *   --ring-size <bytes> : Per-thread ring size, accepts K/M suffixes (implies --async)
+ *   --ring-policy <block|drop|spill> : What to do when a ring is full (implies --async)
+ *   --peak-tflops <value> / --peak-gbps <value> : Device peaks for the rocBLAS efficiency table
+ *   --rocblas-bench <file> : Write deduplicated rocblas-bench reproducers at exit (sets rpv3_rocblas_bench_file)
+ *   --hipblaslt <pipe> / --miopen <pipe> / --rocsolver <pipe> : Pair library call logs with kernels (sets rpv3_*_pipe)
  * 
  * @return RPV3_OPTIONS_CONTINUE (0) to continue normal operation
  *         RPV3_OPTIONS_EXIT (1) to exit early without initializing profiler
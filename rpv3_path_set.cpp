@@ -0,0 +1,79 @@
+// MIT License
+// RPV3 Path Set - Implementation
+// See rpv3_path_set.h for where the sets are used
+
+#include "rpv3_path_set.h"
+
+namespace rpv3 {
+
+// FNV-1a; paths are short and this runs once per open
+uint64_t PathSet::hash(std::string_view path) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : path) {
+        h = (h ^ c) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+bool PathSet::add(std::string_view path) {
+    if (path.empty()) {
+        return false;
+    }
+    const uint64_t h = hash(path);
+    for (size_t i = h & (kCapacity - 1), probes = 0; probes < kCapacity; i = (i + 1) & (kCapacity - 1), probes++) {
+        Slot& slot = slots_[i];
+        if (!slot.used) {
+            slot.hash = h;
+            slot.path = std::string(path);
+            slot.used = true;
+            size_++;
+            return true;
+        }
+        if (slot.hash == h && slot.path == path) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PathSet::contains(const char* path) const {
+    if (!path || size_ == 0) {
+        return false;
+    }
+    const std::string_view text(path);
+    const uint64_t h = hash(text);
+    for (size_t i = h & (kCapacity - 1), probes = 0; probes < kCapacity; i = (i + 1) & (kCapacity - 1), probes++) {
+        const Slot& slot = slots_[i];
+        if (!slot.used) {
+            return false;
+        }
+        if (slot.hash == h && slot.path == text) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FdSet::set(int fd, bool target) {
+    if (!tracked(fd)) {
+        return false;
+    }
+    const uint64_t bit = 1ULL << (fd % 64);
+    std::atomic<uint64_t>& word = bits_[fd / 64];
+    // Skip the read-modify-write in the common case of an untracked fd
+    const uint64_t current = word.load(std::memory_order_relaxed);
+    if (((current & bit) != 0) != target) {
+        if (target) {
+            word.fetch_or(bit, std::memory_order_relaxed);
+        } else {
+            word.fetch_and(~bit, std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+bool FdSet::contains(int fd) const {
+    return tracked(fd) && (bits_[fd / 64].load(std::memory_order_relaxed) & (1ULL << (fd % 64))) != 0;
+}
+
+} // namespace rpv3
@@ -0,0 +1,76 @@
+// MIT License
+// RPV3 Path Set - Library log targets for the stdio interposers
+//
+// The tracer interposes fopen, fopen64, fdopen and open/openat to unbuffer
+// the streams rocBLAS and the other math libraries log through. Those
+// wrappers run for every file the host process opens, so the targets (the
+// libraries' log path variables and the --rocblas style pipes) are
+// resolved once into a PathSet: a small open-addressing table keyed by a
+// hash of the path, compared in full only on a hash hit. When no library
+// logging is configured no set is published and a wrapper costs one atomic
+// load on top of the real call.
+//
+// fdopen() has only a descriptor. Instead of a readlink() on /proc/self/fd
+// per call, the open/openat wrappers record which descriptors were opened
+// on a target in an FdSet. A descriptor number that is reused through
+// dup(), pipe() or socket() may keep a stale bit; the only effect is an
+// unbuffered stream. Descriptors beyond FdSet::kMaxFd are not tracked and
+// the caller resolves them by path.
+
+#ifndef RPV3_PATH_SET_H
+#define RPV3_PATH_SET_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace rpv3 {
+
+class PathSet {
+public:
+    static constexpr size_t kCapacity = 16;  // Power of two; a handful of paths
+
+    // Not thread-safe: build the set, then publish it. Returns false for an
+    // empty path or a full set; adding a path twice is a no-op.
+    bool add(std::string_view path);
+
+    bool contains(const char* path) const;
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+private:
+    struct Slot {
+        uint64_t hash = 0;
+        std::string path;
+        bool used = false;
+    };
+
+    static uint64_t hash(std::string_view path);
+
+    Slot slots_[kCapacity];
+    size_t size_ = 0;
+};
+
+// Descriptors opened on a PathSet target. Lock-free; bits are relaxed
+// atomics because a stale answer only changes stream buffering.
+class FdSet {
+public:
+    static constexpr int kMaxFd = 4096;
+
+    // Record whether fd refers to a target. False if fd is out of range.
+    bool set(int fd, bool target);
+
+    bool contains(int fd) const;
+
+    static bool tracked(int fd) { return fd >= 0 && fd < kMaxFd; }
+
+private:
+    std::atomic<uint64_t> bits_[kMaxFd / 64] = {};
+};
+
+} // namespace rpv3
+
+#endif // RPV3_PATH_SET_H
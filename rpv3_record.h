@@ -0,0 +1,43 @@
+// MIT License
+// RPV3 Record - Normalized kernel dispatch record shared by all output formats
+//
+// Both the callback-tracing and the buffer-tracing (timeline) paths fill a
+// DispatchRecord, so CSV, human-readable and binary output see the same fields.
+
+#ifndef RPV3_RECORD_H
+#define RPV3_RECORD_H
+
+#include <cstdint>
+
+namespace rpv3 {
+
+// CSV schema written by --csv and reproduced by rpv3-convert
+constexpr const char* kCsvHeader =
+    "KernelName,ThreadID,CorrelationID,KernelID,DispatchID,GridX,GridY,GridZ,"
+    "WorkgroupX,WorkgroupY,WorkgroupZ,PrivateSeg,GroupSeg,StartTimestamp,EndTimestamp,"
+    "DurationNs,DurationUs,TimeSinceStartMs\n";
+
+struct DispatchRecord {
+    uint64_t thread_id = 0;
+    uint64_t correlation_id = 0;
+    uint64_t kernel_id = 0;
+    uint64_t dispatch_id = 0;
+    uint32_t grid[3] = {0, 0, 0};
+    uint32_t workgroup[3] = {0, 0, 0};
+    uint32_t private_segment_size = 0;  // Scratch memory per work-item
+    uint32_t group_segment_size = 0;    // LDS memory per work-group
+    uint64_t start_ns = 0;
+    uint64_t end_ns = 0;
+
+    uint64_t duration_ns() const {
+        return (end_ns > start_ns) ? (end_ns - start_ns) : 0;
+    }
+
+    double time_since_start_ms(uint64_t tracer_start_ns) const {
+        return (start_ns > tracer_start_ns) ? ((start_ns - tracer_start_ns) / 1000000.0) : 0.0;
+    }
+};
+
+} // namespace rpv3
+
+#endif // RPV3_RECORD_H
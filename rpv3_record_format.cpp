@@ -0,0 +1,221 @@
+// MIT License
+// RPV3 Record Format - Implementation
+// Output is byte-identical to the printf formats used before, see the unit tests
+
+#include "rpv3_record_format.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace rpv3 {
+
+RecordBuffer& RecordBuffer::append_u64(uint64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buf_.append(digits, result.ptr - digits);
+    return *this;
+}
+
+RecordBuffer& RecordBuffer::append_i64(int64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buf_.append(digits, result.ptr - digits);
+    return *this;
+}
+
+RecordBuffer& RecordBuffer::append_fixed3(double value) {
+    // to_chars is exactly rounded, like glibc printf, so "%.3f" output is reproduced
+    char digits[352];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, 3);
+    buf_.append(digits, result.ptr - digits);
+    return *this;
+}
+
+RecordBuffer& RecordBuffer::append_double(double value) {
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buf_.append(digits, result.ptr - digits);
+    return *this;
+}
+
+RecordBuffer& RecordBuffer::append_left(int64_t value, size_t width) {
+    size_t start = buf_.size();
+    append_i64(value);
+    size_t written = buf_.size() - start;
+    if (written < width) {
+        buf_.append(width - written, ' ');
+    }
+    return *this;
+}
+
+RecordBuffer& RecordBuffer::append_pointer(uintptr_t value) {
+    if (value == 0) {
+        return append("(nil)");
+    }
+    return append_hex(value);
+}
+
+RecordBuffer& RecordBuffer::append_hex(uint64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, 16);
+    buf_.append("0x", 2);
+    buf_.append(digits, result.ptr - digits);
+    return *this;
+}
+
+std::string csv_header(bool blas_columns) {
+    std::string header(kCsvHeader);
+    if (blas_columns) {
+        header.pop_back();
+        header.append(",").append(kCsvBlasColumns).append("\n");
+    }
+    return header;
+}
+
+void format_csv_row(RecordBuffer& out, std::string_view kernel_name,
+                    const DispatchRecord& record, uint64_t tracer_start_ns) {
+    format_csv_fields(out, kernel_name, record, tracer_start_ns);
+    out.append('\n');
+}
+
+void format_csv_fields(RecordBuffer& out, std::string_view kernel_name,
+                       const DispatchRecord& record, uint64_t tracer_start_ns) {
+    const uint64_t duration_ns = record.duration_ns();
+    out.append('"').append(kernel_name).append("\",");
+    out.append_u64(record.thread_id).append(',');
+    out.append_u64(record.correlation_id).append(',');
+    out.append_u64(record.kernel_id).append(',');
+    out.append_u64(record.dispatch_id).append(',');
+    for (uint32_t v : record.grid) {
+        out.append_u64(v).append(',');
+    }
+    for (uint32_t v : record.workgroup) {
+        out.append_u64(v).append(',');
+    }
+    out.append_u64(record.private_segment_size).append(',');
+    out.append_u64(record.group_segment_size).append(',');
+    out.append_u64(record.start_ns).append(',');
+    out.append_u64(record.end_ns).append(',');
+    out.append_u64(duration_ns).append(',');
+    out.append_fixed3(duration_ns / 1000.0).append(',');
+    out.append_fixed3(record.time_since_start_ms(tracer_start_ns));
+}
+
+namespace {
+    // Dimensions a routine does not have (kBlasNone) and device-mode scalars stay empty
+    void append_blas_int(RecordBuffer& out, int64_t value) {
+        out.append(',');
+        if (value != kBlasNone) {
+            out.append_i64(value);
+        }
+    }
+
+    void append_blas_flag(RecordBuffer& out, char flag) {
+        out.append(',');
+        if (flag) {
+            out.append(flag);
+        }
+    }
+
+    void append_blas_scalar(RecordBuffer& out, double value) {
+        out.append(',');
+        if (!std::isnan(value)) {
+            out.append_double(value);
+        }
+    }
+
+    void append_blas_rate(RecordBuffer& out, double value) {
+        out.append(',');
+        if (value > 0.0) {
+            out.append_fixed3(value);
+        }
+    }
+}
+
+void format_csv_blas_columns(RecordBuffer& out, const BlasCall* call, double tflops, double gbps) {
+    format_csv_blas_fields(out, call, tflops, gbps);
+    out.append('\n');
+}
+
+void format_csv_blas_fields(RecordBuffer& out, const BlasCall* call, double tflops, double gbps) {
+    if (!call) {
+        // One comma per column
+        out.append(",,,,,,,,,,,,,,,,,,,");
+        return;
+    }
+    out.append(',').append(call->function);
+    out.append(',').append(call->precision);
+    out.append(',').append(call->compute_type);
+    append_blas_flag(out, call->trans_a);
+    append_blas_flag(out, call->trans_b);
+    append_blas_int(out, call->m);
+    append_blas_int(out, call->n);
+    append_blas_int(out, call->k);
+    append_blas_int(out, call->lda);
+    append_blas_int(out, call->ldb);
+    append_blas_int(out, call->ldc);
+    append_blas_int(out, call->stride_a);
+    append_blas_int(out, call->stride_b);
+    append_blas_int(out, call->stride_c);
+    append_blas_int(out, call->batch_count);
+    append_blas_scalar(out, call->alpha);
+    append_blas_scalar(out, call->beta);
+    append_blas_rate(out, tflops);
+    append_blas_rate(out, gbps);
+}
+
+namespace {
+    void append_dim3(RecordBuffer& out, const uint32_t (&dims)[3]) {
+        out.append('[').append_u64(dims[0]).append(", ")
+           .append_u64(dims[1]).append(", ")
+           .append_u64(dims[2]).append("]\n");
+    }
+
+    void append_title(RecordBuffer& out, uint64_t sequence, std::string_view kernel_name) {
+        out.append("\n[Kernel Trace #").append_u64(sequence).append("]\n");
+        out.append("  Kernel Name: ").append(kernel_name).append('\n');
+    }
+}
+
+void format_text_record(RecordBuffer& out, uint64_t sequence, std::string_view kernel_name,
+                        const DispatchRecord& record, TextTimestamps timestamps,
+                        uint64_t tracer_start_ns) {
+    append_title(out, sequence, kernel_name);
+    out.append("  Thread ID: ").append_u64(record.thread_id).append('\n');
+    out.append("  Correlation ID: ").append_u64(record.correlation_id).append('\n');
+    out.append("  Kernel ID: ").append_u64(record.kernel_id).append('\n');
+    out.append("  Dispatch ID: ").append_u64(record.dispatch_id).append('\n');
+    out.append("  Grid Size: ");
+    append_dim3(out, record.grid);
+    out.append("  Workgroup Size: ");
+    append_dim3(out, record.workgroup);
+    out.append("  Private Segment Size: ").append_u64(record.private_segment_size)
+       .append(" bytes (scratch memory per work-item)\n");
+    out.append("  Group Segment Size: ").append_u64(record.group_segment_size)
+       .append(" bytes (LDS memory per work-group)\n");
+
+    if (timestamps == TextTimestamps::None) {
+        return;
+    }
+    format_text_timestamps(out, record);
+    if (timestamps == TextTimestamps::Timeline) {
+        out.append("  Time Since Start: ").append_fixed3(record.time_since_start_ms(tracer_start_ns))
+           .append(" ms\n");
+    }
+}
+
+void format_text_timestamps(RecordBuffer& out, const DispatchRecord& record) {
+    out.append("  Start Timestamp: ").append_u64(record.start_ns).append(" ns\n");
+    out.append("  End Timestamp: ").append_u64(record.end_ns).append(" ns\n");
+    out.append("  Duration: ").append_fixed3(record.duration_ns() / 1000.0).append(" \xce\xbcs\n");
+}
+
+void format_backtrace_header(RecordBuffer& out, uint64_t sequence, std::string_view kernel_name,
+                             const DispatchRecord& record) {
+    append_title(out, sequence, kernel_name);
+    out.append("  Dispatch ID: ").append_u64(record.dispatch_id).append('\n');
+    out.append("  Grid Size: ");
+    append_dim3(out, record.grid);
+}
+
+} // namespace rpv3
@@ -0,0 +1,99 @@
+// MIT License
+// RPV3 Record Format - Single-pass formatting of trace records
+//
+// Each record (CSV row, human-readable block, backtrace) is built into one
+// buffer with std::to_chars and handed to the output sink in a single write,
+// so records from different threads never interleave and printf's format
+// parsing is paid zero times per dispatch.
+
+#ifndef RPV3_RECORD_FORMAT_H
+#define RPV3_RECORD_FORMAT_H
+
+#include "rpv3_blas_parser.h"
+#include "rpv3_record.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace rpv3 {
+
+// Growable append-only text buffer. Reuse one per thread and clear() it
+// between records; the capacity is kept so steady state never allocates.
+class RecordBuffer {
+public:
+    RecordBuffer() { buf_.reserve(4096); }
+
+    void clear() { buf_.clear(); }
+    const char* data() const { return buf_.data(); }
+    size_t size() const { return buf_.size(); }
+
+    RecordBuffer& append(std::string_view text) {
+        buf_.append(text.data(), text.size());
+        return *this;
+    }
+    RecordBuffer& append(char c) {
+        buf_.push_back(c);
+        return *this;
+    }
+
+    RecordBuffer& append_u64(uint64_t value);
+    RecordBuffer& append_i64(int64_t value);
+    RecordBuffer& append_fixed3(double value);               // printf "%.3f"
+    RecordBuffer& append_double(double value);               // Shortest round-trip form
+    RecordBuffer& append_left(int64_t value, size_t width);  // printf "%-<width>d"
+    RecordBuffer& append_pointer(uintptr_t value);           // printf "%p"
+    RecordBuffer& append_hex(uint64_t value);                // printf "0x%lx"
+
+private:
+    std::string buf_;
+};
+
+// Which timestamp lines a human-readable record carries
+enum class TextTimestamps {
+    None,      // Dispatch had no timing information
+    Duration,  // Start, end and duration (callback tracing)
+    Timeline   // Start, end, duration and time since tracer start (buffer tracing)
+};
+
+// Typed rocBLAS call columns appended to kCsvHeader when --rocblas is active
+constexpr const char* kCsvBlasColumns =
+    "BlasFunction,Precision,ComputeType,TransA,TransB,M,N,K,Lda,Ldb,Ldc,"
+    "StrideA,StrideB,StrideC,BatchCount,Alpha,Beta,AchievedTFLOPS,AchievedGBps";
+
+// CSV header line, with or without the BLAS columns
+std::string csv_header(bool blas_columns);
+
+// One CSV row matching kCsvHeader
+void format_csv_row(RecordBuffer& out, std::string_view kernel_name,
+                    const DispatchRecord& record, uint64_t tracer_start_ns);
+
+// The same row without its line end, for rows that take the BLAS columns
+void format_csv_fields(RecordBuffer& out, std::string_view kernel_name,
+                       const DispatchRecord& record, uint64_t tracer_start_ns);
+
+// BLAS columns and the line end that complete a format_csv_fields row.
+// Without a call (not a BLAS kernel, or an unparsed line) the columns are
+// empty, as are rates of zero (work or duration unknown).
+void format_csv_blas_columns(RecordBuffer& out, const BlasCall* call, double tflops, double gbps);
+
+// The same columns without the line end, for rows that continue with
+// counter columns
+void format_csv_blas_fields(RecordBuffer& out, const BlasCall* call, double tflops, double gbps);
+
+// "[Kernel Trace #N]" block with every dispatch field
+void format_text_record(RecordBuffer& out, uint64_t sequence, std::string_view kernel_name,
+                        const DispatchRecord& record, TextTimestamps timestamps,
+                        uint64_t tracer_start_ns);
+
+// Start, end and duration lines only (appended after a --backtrace record)
+void format_text_timestamps(RecordBuffer& out, const DispatchRecord& record);
+
+// Short kernel summary printed above a call stack in --backtrace mode
+void format_backtrace_header(RecordBuffer& out, uint64_t sequence, std::string_view kernel_name,
+                             const DispatchRecord& record);
+
+} // namespace rpv3
+
+#endif // RPV3_RECORD_FORMAT_H
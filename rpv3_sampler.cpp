@@ -0,0 +1,108 @@
+// MIT License
+// RPV3 Sampler - Implementation
+// See rpv3_sampler.h for the sampling policies
+
+#include "rpv3_sampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace rpv3 {
+
+namespace {
+    // Per-thread splitmix64 generator for reservoir replacement
+    uint64_t next_random() {
+        thread_local uint64_t state =
+            (uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+            (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+}
+
+DispatchSampler::DispatchSampler() : stripes_(kStripes) {
+}
+
+void DispatchSampler::configure(const SamplerConfig& config) {
+    config_ = config;
+    if (config_.every == 0) {
+        config_.every = 1;
+    }
+    window_period_ns_ = config_.window_on_ns + config_.window_off_ns;
+    if (window_period_ns_ == 0) {
+        window_period_ns_ = 1;
+    }
+    kept_.store(0);
+    population_.store(0);
+}
+
+void DispatchSampler::offer(uint64_t sequence, const DispatchRecord& record) {
+    const size_t capacity = config_.reservoir_size;
+    if (capacity == 0) {
+        return;
+    }
+    Stripe& stripe = stripes_[record.kernel_id % kStripes];
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    Reservoir& reservoir = stripe.reservoirs[record.kernel_id];
+    reservoir.seen++;
+    population_.fetch_add(1, std::memory_order_relaxed);
+
+    // Algorithm R: the i-th dispatch replaces a random slot with probability K/i
+    if (reservoir.samples.size() < capacity) {
+        reservoir.samples.push_back({sequence, record});
+        return;
+    }
+    uint64_t slot = next_random() % reservoir.seen;
+    if (slot < capacity) {
+        reservoir.samples[slot] = {sequence, record};
+    }
+}
+
+std::vector<SampledDispatch> DispatchSampler::drain(std::vector<ReservoirCount>* counts) {
+    std::vector<SampledDispatch> kept;
+    for (Stripe& stripe : stripes_) {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        for (auto& entry : stripe.reservoirs) {
+            for (auto& sample : entry.second.samples) {
+                kept.push_back(sample);
+            }
+            if (counts) {
+                counts->push_back({entry.first, entry.second.seen, entry.second.samples.size()});
+            }
+        }
+        stripe.reservoirs.clear();
+    }
+    if (counts) {
+        std::sort(counts->begin(), counts->end(), [](const ReservoirCount& a, const ReservoirCount& b) {
+            return a.kernel_id < b.kernel_id;
+        });
+    }
+    std::sort(kept.begin(), kept.end(), [](const SampledDispatch& a, const SampledDispatch& b) {
+        if (a.record.start_ns != b.record.start_ns) {
+            return a.record.start_ns < b.record.start_ns;
+        }
+        return a.sequence < b.sequence;
+    });
+    kept_.fetch_add(kept.size());
+    return kept;
+}
+
+std::string DispatchSampler::describe() const {
+    switch (config_.mode) {
+        case SampleMode::Every:
+            return "every:" + std::to_string(config_.every);
+        case SampleMode::Window:
+            return "window:" + std::to_string(config_.window_on_ns / 1000000) + ":" +
+                   std::to_string(config_.window_off_ns / 1000000);
+        case SampleMode::Reservoir:
+            return "reservoir:" + std::to_string(config_.reservoir_size);
+        default:
+            return "all";
+    }
+}
+
+} // namespace rpv3
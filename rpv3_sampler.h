@@ -0,0 +1,143 @@
+// MIT License
+// RPV3 Sampler - Dispatch sampling policies for --sample
+//
+// every:N and window:ON:OFF are stateless decisions on the dispatch sequence
+// number or timestamp, cheap enough to run before a record is even built.
+// reservoir:K keeps a uniform sample of K dispatches per kernel (Algorithm R),
+// so rare kernels are always present; the kept records are emitted at exit.
+//
+// Scale factors are taken over the dispatches that pass --include, --exclude
+// and --filter (the population): one kept/population ratio for every and
+// window, and one per kernel (seen/kept) for reservoir, since each kernel's
+// reservoir fills at its own rate.
+
+#ifndef RPV3_SAMPLER_H
+#define RPV3_SAMPLER_H
+
+#include "rpv3_record.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rpv3 {
+
+enum class SampleMode {
+    All,        // Record every dispatch
+    Every,      // Record dispatches 1, N+1, 2N+1, ...
+    Window,     // Record while (t - origin) mod (on + off) < on
+    Reservoir   // Keep a uniform sample of K dispatches per kernel
+};
+
+struct SamplerConfig {
+    SampleMode mode = SampleMode::All;
+    uint64_t every = 1;
+    uint64_t window_on_ns = 0;
+    uint64_t window_off_ns = 0;
+    size_t reservoir_size = 0;
+    uint64_t origin_ns = 0;  // Start of the first window (tracer start)
+};
+
+struct SampledDispatch {
+    uint64_t sequence = 0;  // Dispatch number as counted by the tracer
+    DispatchRecord record;
+};
+
+// One kernel's reservoir at drain(): scale its counts and totals by seen/kept
+struct ReservoirCount {
+    uint64_t kernel_id = 0;
+    uint64_t seen = 0;
+    uint64_t kept = 0;
+};
+
+class DispatchSampler {
+public:
+    DispatchSampler();
+
+    DispatchSampler(const DispatchSampler&) = delete;
+    DispatchSampler& operator=(const DispatchSampler&) = delete;
+
+    // Not thread-safe; call before any dispatch is seen
+    void configure(const SamplerConfig& config);
+
+    bool enabled() const { return config_.mode != SampleMode::All; }
+
+    // Reservoir records are buffered and only emitted by drain()
+    bool buffered() const { return config_.mode == SampleMode::Reservoir; }
+
+    // keep() needs a timestamp only in window mode
+    bool needs_timestamp() const { return config_.mode == SampleMode::Window; }
+
+    // Streaming decision for dispatch number `sequence` (1-based). Always true
+    // in All and Reservoir modes; reservoir selection happens in offer().
+    bool keep(uint64_t sequence, uint64_t timestamp_ns) const {
+        switch (config_.mode) {
+            case SampleMode::Every:
+                return (sequence - 1) % config_.every == 0;
+            case SampleMode::Window: {
+                uint64_t elapsed = timestamp_ns > config_.origin_ns ? timestamp_ns - config_.origin_ns : 0;
+                return elapsed % window_period_ns_ < config_.window_on_ns;
+            }
+            default:
+                return true;
+        }
+    }
+
+    // Every and window modes count their population with tally(); reservoir
+    // mode counts it in offer()
+    bool tallies() const { return config_.mode == SampleMode::Every || config_.mode == SampleMode::Window; }
+
+    // Count one dispatch that passed the filters, and whether it was recorded
+    void tally(bool kept) {
+        population_.fetch_add(1, std::memory_order_relaxed);
+        if (kept) {
+            kept_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Reservoir mode: consider one completed dispatch (that passed the
+    // filters) for its kernel's sample
+    void offer(uint64_t sequence, const DispatchRecord& record);
+
+    // Reservoir mode: every kept dispatch, ordered by start time. Empties the
+    // reservoirs. counts, if given, receives each kernel's seen and kept
+    // dispatches in kernel id order.
+    std::vector<SampledDispatch> drain(std::vector<ReservoirCount>* counts = nullptr);
+
+    // Dispatches recorded so far (reservoir mode: counted by drain())
+    uint64_t kept() const { return kept_.load(std::memory_order_relaxed); }
+
+    // Dispatches that passed the filters, recorded or not
+    uint64_t population() const { return population_.load(std::memory_order_relaxed); }
+
+    // Policy as written on the command line, e.g. "every:100"
+    std::string describe() const;
+
+private:
+    struct Reservoir {
+        uint64_t seen = 0;
+        std::vector<SampledDispatch> samples;
+    };
+
+    // Reservoirs are striped by kernel id so threads launching different
+    // kernels rarely share a lock
+    static constexpr size_t kStripes = 64;
+    struct Stripe {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, Reservoir> reservoirs;
+    };
+
+    SamplerConfig config_;
+    uint64_t window_period_ns_ = 1;
+    std::atomic<uint64_t> kept_{0};
+    std::atomic<uint64_t> population_{0};
+    std::vector<Stripe> stripes_;
+};
+
+} // namespace rpv3
+
+#endif // RPV3_SAMPLER_H
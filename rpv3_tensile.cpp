@@ -0,0 +1,248 @@
+// MIT License
+// RPV3 Tensile - Implementation
+// See rpv3_tensile.h for the name layout
+
+#include "rpv3_tensile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <tuple>
+
+namespace rpv3 {
+
+namespace {
+
+bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Parameter token such as "GSU4": the prefix followed by a number. Tensile
+// writes negative values with an 'n' ("WGMn8").
+bool parse_param(std::string_view token, std::string_view prefix, int32_t& value) {
+    if (token.size() <= prefix.size() || token.substr(0, prefix.size()) != prefix) {
+        return false;
+    }
+    std::string_view digits = token.substr(prefix.size());
+    const bool negative = digits[0] == 'n';
+    if (negative) {
+        digits.remove_prefix(1);
+    }
+    if (digits.empty()) {
+        return false;
+    }
+    int64_t parsed = 0;
+    for (char c : digits) {
+        if (!is_digit(c) || parsed > INT32_MAX) {
+            return false;
+        }
+        parsed = parsed * 10 + (c - '0');
+    }
+    value = (int32_t)(negative ? -parsed : parsed);
+    return true;
+}
+
+// "128x128x32" -> {128, 128, 32}; returns the number of fields read
+size_t parse_dims(std::string_view text, uint32_t* dims, size_t max_dims) {
+    size_t count = 0;
+    while (count < max_dims && !text.empty() && is_digit(text[0])) {
+        uint32_t value = 0;
+        size_t i = 0;
+        for (; i < text.size() && is_digit(text[i]); i++) {
+            value = value * 10 + (uint32_t)(text[i] - '0');
+        }
+        dims[count++] = value;
+        text.remove_prefix(i);
+        if (text.empty() || text[0] != 'x') {
+            break;
+        }
+        text.remove_prefix(1);
+    }
+    return text.empty() ? count : 0;
+}
+
+// Operand index string: free index first means not transposed
+char transpose_of(std::string_view token, char free_index) {
+    if (token.size() < 3) {
+        return 0;
+    }
+    if (token.back() == 'C') {
+        return 'C';
+    }
+    return token[1] == free_index ? 'N' : 'T';
+}
+
+std::string macro_tile_text(const TensileSolution& s) {
+    std::string text = std::to_string(s.macro_tile0) + "x" + std::to_string(s.macro_tile1);
+    if (s.depth_u) {
+        text += "x" + std::to_string(s.depth_u);
+    }
+    return text;
+}
+
+} // namespace
+
+bool is_tensile_kernel(std::string_view name) {
+    return (name.find("Cijk") != std::string_view::npos ||
+            name.find("assembly") != std::string_view::npos ||
+            name.find("Tensile") != std::string_view::npos);
+}
+
+bool decode_tensile_name(std::string_view name, TensileSolution& solution) {
+    size_t start = name.find("Cijk_");
+    if (start == std::string_view::npos) {
+        return false;
+    }
+    name.remove_prefix(start);
+
+    TensileSolution s;
+    bool have_tile = false;
+    size_t index = 0;
+    while (!name.empty()) {
+        size_t end = name.find('_');
+        std::string_view token = name.substr(0, end);
+        name.remove_prefix(end == std::string_view::npos ? name.size() : end + 1);
+
+        // Cijk, A..., B..., then the data types
+        if (index == 1) {
+            if (token.empty() || token[0] != 'A' || !(s.trans_a = transpose_of(token, 'i'))) {
+                return false;
+            }
+        } else if (index == 2) {
+            if (token.empty() || token[0] != 'B' || !(s.trans_b = transpose_of(token, 'l'))) {
+                return false;
+            }
+        } else if (index == 3) {
+            s.types = std::string(token);
+        } else if (index > 3) {
+            int32_t value = 0;
+            uint32_t dims[3] = {0, 0, 0};
+            if (token.size() > 2 && token.substr(0, 2) == "MT" && !have_tile) {
+                size_t count = parse_dims(token.substr(2), dims, 3);
+                if (count >= 2) {
+                    s.macro_tile0 = dims[0];
+                    s.macro_tile1 = dims[1];
+                    if (count == 3) {
+                        s.depth_u = dims[2];
+                    }
+                    have_tile = true;
+                }
+            } else if (token.size() > 2 && token.substr(0, 2) == "MI" && is_digit(token[2])) {
+                s.matrix_instruction = std::string(token.substr(2));
+            } else if (parse_param(token, "DU", value)) {
+                s.depth_u = (uint32_t)value;
+            } else if (parse_param(token, "GSU", value)) {
+                s.global_split_u = value;
+            } else if (parse_param(token, "WGM", value)) {
+                s.workgroup_mapping = value;
+            } else if (token.size() > 3 && token.substr(0, 3) == "ISA" && is_digit(token[3])) {
+                s.isa = std::string(token.substr(3));
+            }
+        }
+        index++;
+    }
+    if (!have_tile) {
+        return false;
+    }
+    solution = std::move(s);
+    return true;
+}
+
+void TensileSolutionTable::insert(uint64_t kernel_id, std::string_view name) {
+    TensileSolution solution;
+    if (!decode_tensile_name(name, solution)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    solutions_[kernel_id] = std::move(solution);
+}
+
+bool TensileSolutionTable::find(uint64_t kernel_id, TensileSolution& solution) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = solutions_.find(kernel_id);
+    if (it == solutions_.end()) {
+        return false;
+    }
+    solution = it->second;
+    return true;
+}
+
+size_t TensileSolutionTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return solutions_.size();
+}
+
+std::vector<TensileGroupRow> group_tensile_solutions(const std::vector<KernelSummaryRow>& rows,
+                                                     const TensileSolutionTable& table) {
+    using Key = std::tuple<char, char, std::string, uint32_t, uint32_t, uint32_t, std::string, int32_t, int32_t>;
+    std::map<Key, TensileGroupRow> groups;
+    TensileSolution solution;
+    for (const KernelSummaryRow& row : rows) {
+        if (!table.find(row.kernel_id, solution)) {
+            continue;
+        }
+        Key key(solution.trans_a, solution.trans_b, solution.types, solution.macro_tile0, solution.macro_tile1,
+                solution.depth_u, solution.matrix_instruction, solution.global_split_u, solution.workgroup_mapping);
+        TensileGroupRow& group = groups[key];
+        if (group.kernels == 0) {
+            group.solution = solution;
+        }
+        group.kernels++;
+        group.count += row.stats.count;
+        group.total_ns += row.stats.total_ns;
+    }
+
+    std::vector<TensileGroupRow> result;
+    result.reserve(groups.size());
+    for (auto& entry : groups) {
+        result.push_back(std::move(entry.second));
+    }
+    std::stable_sort(result.begin(), result.end(), [](const TensileGroupRow& a, const TensileGroupRow& b) {
+        return a.total_ns > b.total_ns;
+    });
+    return result;
+}
+
+void format_tensile_summary_text(RecordBuffer& out, const std::vector<TensileGroupRow>& rows, uint64_t total_ns) {
+    uint64_t tensile_ns = 0;
+    uint64_t kernels = 0;
+    for (const TensileGroupRow& row : rows) {
+        tensile_ns += row.total_ns;
+        kernels += row.kernels;
+    }
+    char line[256];
+    snprintf(line, sizeof(line), "\n[Tensile Solutions] %zu groups of %lu kernels, %.3f%% of GPU time\n",
+             rows.size(), (unsigned long)kernels, total_ns ? 100.0 * tensile_ns / total_ns : 0.0);
+    out.append(line);
+    snprintf(line, sizeof(line), "%-5s %-6s %-14s %-12s %5s %5s %8s %10s %14s %8s\n", "Trans", "Types",
+             "Macro tile", "MI", "GSU", "WGM", "Kernels", "Count", "Total (ms)", "% Total");
+    out.append(line);
+    for (const TensileGroupRow& row : rows) {
+        const TensileSolution& s = row.solution;
+        const char trans[3] = {s.trans_a, s.trans_b, '\0'};
+        snprintf(line, sizeof(line), "%-5s %-6s %-14s %-12s %5d %5d %8lu %10lu %14.3f %7.3f%%\n", trans,
+                 s.types.c_str(), macro_tile_text(s).c_str(),
+                 s.matrix_instruction.empty() ? "-" : s.matrix_instruction.c_str(), s.global_split_u,
+                 s.workgroup_mapping, (unsigned long)row.kernels, (unsigned long)row.count, row.total_ns / 1e6,
+                 total_ns ? 100.0 * row.total_ns / total_ns : 0.0);
+        out.append(line);
+    }
+}
+
+void format_tensile_summary_csv(RecordBuffer& out, const std::vector<TensileGroupRow>& rows, uint64_t total_ns) {
+    out.append("TransA,TransB,Types,MT0,MT1,DepthU,MatrixInstruction,GSU,WGM,Kernels,Count,TotalNs,PercentTotal\n");
+    for (const TensileGroupRow& row : rows) {
+        const TensileSolution& s = row.solution;
+        out.append(s.trans_a).append(',').append(s.trans_b).append(',');
+        out.append(s.types).append(',');
+        out.append_u64(s.macro_tile0).append(',').append_u64(s.macro_tile1).append(',');
+        out.append_u64(s.depth_u).append(',');
+        out.append(s.matrix_instruction).append(',');
+        out.append_i64(s.global_split_u).append(',').append_i64(s.workgroup_mapping).append(',');
+        out.append_u64(row.kernels).append(',').append_u64(row.count).append(',');
+        out.append_u64(row.total_ns).append(',');
+        out.append_fixed3(total_ns ? 100.0 * row.total_ns / total_ns : 0.0).append('\n');
+    }
+}
+
+} // namespace rpv3
@@ -0,0 +1,92 @@
+// MIT License
+// RPV3 Tensile - Solution parameters decoded from Tensile kernel names
+//
+// Tensile names its GEMM kernels after the problem and the solution, e.g.
+//
+//   Cijk_Ailk_Bjlk_HHS_BH_MT128x128x32_MI32x32x8x1_SN_..._GSU1_..._WGM8
+//
+// The index strings give the transposes (Ailk is A not transposed, Alik is
+// A transposed, a trailing C conjugates), the next token the data types
+// (A/B, C/D, compute; one letter when they agree), MT the macro tile and
+// depth-U, MI the matrix instruction, GSU the global split-U and WGM the
+// workgroup mapping. Names are decoded once per kernel_id when the symbol
+// registers, so --summary can group GPU time by solution without rocBLAS
+// logging, which has a cost of its own.
+//
+// Unknown tokens are skipped, so names from newer Tensile versions still
+// decode as far as the parameters above go.
+
+#ifndef RPV3_TENSILE_H
+#define RPV3_TENSILE_H
+
+#include "rpv3_kernel_stats.h"
+#include "rpv3_record_format.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace rpv3 {
+
+// Substring check used to route dispatches to the rocBLAS correlator
+bool is_tensile_kernel(std::string_view name);
+
+struct TensileSolution {
+    char trans_a = 'N';          // 'N', 'T' or 'C'
+    char trans_b = 'N';
+    std::string types;           // Tensile type letters: "S", "HHS", "BBS", ...
+    uint32_t macro_tile0 = 0;    // MT0 x MT1
+    uint32_t macro_tile1 = 0;
+    uint32_t depth_u = 0;
+    std::string matrix_instruction;  // "32x32x8x1"; empty for non-MFMA kernels
+    int32_t global_split_u = 1;
+    int32_t workgroup_mapping = 0;
+    std::string isa;             // "90a", "942"; empty if not in the name
+};
+
+// Decode a Cijk_ kernel name. Returns false if the name is not a Tensile
+// GEMM or has no macro tile.
+bool decode_tensile_name(std::string_view name, TensileSolution& solution);
+
+// kernel_id -> decoded solution. Written at symbol registration, read when
+// the summary is produced; both are rare, so one mutex covers it.
+class TensileSolutionTable {
+public:
+    // Decode and store; names that are not Tensile GEMMs are ignored
+    void insert(uint64_t kernel_id, std::string_view name);
+
+    // Copy of the solution, false if the kernel was not decoded
+    bool find(uint64_t kernel_id, TensileSolution& solution) const;
+
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, TensileSolution> solutions_;
+};
+
+// Summary kernels grouped by (transposes, types, macro tile, depth-U,
+// matrix instruction, GSU, WGM)
+struct TensileGroupRow {
+    TensileSolution solution;  // Fields outside the key are from the first kernel
+    uint64_t kernels = 0;
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+};
+
+// Group the Tensile kernels among the summary rows, most total time first
+std::vector<TensileGroupRow> group_tensile_solutions(const std::vector<KernelSummaryRow>& rows,
+                                                     const TensileSolutionTable& table);
+
+// Aligned text table; percentages are of total_ns (all kernels, not just Tensile)
+void format_tensile_summary_text(RecordBuffer& out, const std::vector<TensileGroupRow>& rows, uint64_t total_ns);
+
+// CSV table: TransA,TransB,Types,MT0,MT1,DepthU,MatrixInstruction,GSU,WGM,Kernels,Count,TotalNs,PercentTotal
+void format_tensile_summary_csv(RecordBuffer& out, const std::vector<TensileGroupRow>& rows, uint64_t total_ns);
+
+} // namespace rpv3
+
+#endif // RPV3_TENSILE_H
@@ -0,0 +1,326 @@
+// MIT License
+// RPV3 Trace Writer - Implementation
+// See rpv3_trace_writer.h for the design overview
+
+#include "rpv3_trace_writer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace rpv3 {
+
+namespace {
+    // Distinguishes writer instances so a recycled address never matches a stale cache
+    std::atomic<uint64_t> next_generation{1};
+
+    struct RingCache {
+        uint64_t generation = 0;
+        void* ring = nullptr;
+    };
+    thread_local RingCache ring_cache;
+
+    size_t round_up_pow2(size_t value) {
+        size_t result = 1024;  // Never smaller than 1 KB
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+// One ring per producer thread. head is only written by the producer,
+// tail only by the writer thread, so no lock is needed on the fast path.
+struct TraceWriter::ThreadRing {
+    explicit ThreadRing(size_t size)
+        : data(new char[size]), capacity(size), mask(size - 1) {}
+
+    std::unique_ptr<char[]> data;
+    const size_t capacity;
+    const size_t mask;
+
+    alignas(64) std::atomic<size_t> head{0};
+    std::atomic<bool> busy{false};          // Producer is inside write()
+    alignas(64) std::atomic<size_t> tail{0};
+
+    // Overflow storage for RingFullPolicy::Spill. While spill_pending is set
+    // the producer appends here instead of the ring to keep its records in order.
+    std::mutex spill_mutex;
+    std::string spill_data;
+    std::atomic<bool> spill_pending{false};
+};
+
+TraceWriter::TraceWriter(FILE* out, const TraceWriterConfig& config)
+    : out_(out ? out : stdout),
+      config_(config),
+      ring_size_(round_up_pow2(config.ring_size)),
+      generation_(next_generation.fetch_add(1)),
+      staging_(std::max<size_t>(config.batch_size, 64 * 1024)) {
+}
+
+TraceWriter::~TraceWriter() {
+    stop();
+}
+
+void TraceWriter::start() {
+    if (writer_thread_.joinable()) {
+        return;
+    }
+    stop_requested_.store(false);
+    accepting_.store(true);
+    writer_thread_ = std::thread(&TraceWriter::writer_loop, this);
+}
+
+TraceWriter::ThreadRing* TraceWriter::ring_for_current_thread() {
+    if (ring_cache.generation == generation_) {
+        return static_cast<ThreadRing*>(ring_cache.ring);
+    }
+
+    auto ring = std::make_unique<ThreadRing>(ring_size_);
+    ThreadRing* raw = ring.get();
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(std::move(ring));
+    }
+    ring_cache.generation = generation_;
+    ring_cache.ring = raw;
+    return raw;
+}
+
+bool TraceWriter::write(const char* data, size_t len) {
+    if (len == 0) {
+        return true;
+    }
+    if (!accepting_.load(std::memory_order_acquire)) {
+        write_direct(data, len);
+        return true;
+    }
+
+    ThreadRing* ring = ring_for_current_thread();
+
+    // Dekker-style handshake with stop(): either stop() sees busy and waits
+    // for this record, or we see accepting == false and write synchronously.
+    ring->busy.store(true, std::memory_order_seq_cst);
+    if (!accepting_.load(std::memory_order_seq_cst)) {
+        ring->busy.store(false, std::memory_order_release);
+        write_direct(data, len);
+        return true;
+    }
+
+    bool queued = push(ring, data, len);
+    ring->busy.store(false, std::memory_order_release);
+    return queued;
+}
+
+bool TraceWriter::push(ThreadRing* ring, const char* data, size_t len) {
+    if (ring->spill_pending.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(ring->spill_mutex);
+        if (ring->spill_pending.load(std::memory_order_relaxed)) {
+            ring->spill_data.append(data, len);
+            spilled_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    const size_t head = ring->head.load(std::memory_order_relaxed);
+
+    // A record larger than the whole ring can never be queued
+    if (len > ring->capacity) {
+        switch (config_.policy) {
+            case RingFullPolicy::Drop:
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            case RingFullPolicy::Spill:
+                spill(ring, data, len);
+                return true;
+            case RingFullPolicy::Block:
+                // Let the writer empty our ring first so ordering is preserved
+                while (ring->tail.load(std::memory_order_acquire) != head) {
+                    wake_requested_.store(true, std::memory_order_release);
+                    wake_cv_.notify_one();
+                    std::this_thread::yield();
+                }
+                write_direct(data, len);
+                return true;
+        }
+    }
+
+    size_t used = 0;
+    unsigned spins = 0;
+    for (;;) {
+        used = head - ring->tail.load(std::memory_order_acquire);
+        if (ring->capacity - used >= len) {
+            break;
+        }
+        switch (config_.policy) {
+            case RingFullPolicy::Drop:
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                wake_requested_.store(true, std::memory_order_release);
+                wake_cv_.notify_one();
+                return false;
+            case RingFullPolicy::Spill:
+                spill(ring, data, len);
+                wake_requested_.store(true, std::memory_order_release);
+                wake_cv_.notify_one();
+                return true;
+            case RingFullPolicy::Block:
+                wake_requested_.store(true, std::memory_order_release);
+                wake_cv_.notify_one();
+                if (++spins < 64) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+                break;
+        }
+    }
+
+    const size_t offset = head & ring->mask;
+    const size_t first = std::min(len, ring->capacity - offset);
+    memcpy(ring->data.get() + offset, data, first);
+    if (first < len) {
+        memcpy(ring->data.get(), data + first, len - first);
+    }
+    ring->head.store(head + len, std::memory_order_release);
+
+    // Nudge the writer once a ring is half full instead of on every record
+    if (used + len > ring->capacity / 2 &&
+        !wake_requested_.exchange(true, std::memory_order_acq_rel)) {
+        wake_cv_.notify_one();
+    }
+    return true;
+}
+
+void TraceWriter::spill(ThreadRing* ring, const char* data, size_t len) {
+    std::lock_guard<std::mutex> lock(ring->spill_mutex);
+    ring->spill_data.append(data, len);
+    ring->spill_pending.store(true, std::memory_order_release);
+    spilled_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TraceWriter::writer_loop() {
+    const auto interval = std::chrono::milliseconds(config_.flush_interval_ms ? config_.flush_interval_ms : 1);
+
+    while (!stop_requested_.load(std::memory_order_acquire)) {
+        wake_requested_.store(false, std::memory_order_release);
+        drain_all();
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_cv_.wait_for(lock, interval, [this] {
+            return wake_requested_.load(std::memory_order_acquire) ||
+                   stop_requested_.load(std::memory_order_acquire);
+        });
+    }
+}
+
+void TraceWriter::drain_all() {
+    std::vector<ThreadRing*> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        snapshot.reserve(rings_.size());
+        for (const auto& ring : rings_) {
+            snapshot.push_back(ring.get());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+
+    auto drain_ring = [this](ThreadRing* ring) {
+        const size_t tail = ring->tail.load(std::memory_order_relaxed);
+        const size_t head = ring->head.load(std::memory_order_acquire);
+        if (head == tail) {
+            return;
+        }
+        const size_t len = head - tail;
+        const size_t offset = tail & ring->mask;
+        const size_t first = std::min(len, ring->capacity - offset);
+        stage(ring->data.get() + offset, first);
+        if (first < len) {
+            stage(ring->data.get(), len - first);
+        }
+        ring->tail.store(head, std::memory_order_release);
+    };
+
+    for (ThreadRing* ring : snapshot) {
+        drain_ring(ring);
+
+        if (ring->spill_pending.load(std::memory_order_acquire)) {
+            std::string spilled;
+            {
+                // Everything still in the ring was queued before the spill started
+                std::lock_guard<std::mutex> spill_lock(ring->spill_mutex);
+                drain_ring(ring);
+                spilled.swap(ring->spill_data);
+                ring->spill_pending.store(false, std::memory_order_release);
+            }
+            stage(spilled.data(), spilled.size());
+        }
+    }
+
+    if (staged_ > 0) {
+        flush_staging();
+        fflush(out_);
+    }
+}
+
+void TraceWriter::stage(const char* data, size_t len) {
+    if (staged_ + len > staging_.size()) {
+        flush_staging();
+    }
+    if (len > staging_.size()) {
+        fwrite(data, 1, len, out_);
+        bytes_written_.fetch_add(len, std::memory_order_relaxed);
+        return;
+    }
+    memcpy(staging_.data() + staged_, data, len);
+    staged_ += len;
+}
+
+void TraceWriter::flush_staging() {
+    if (staged_ == 0) {
+        return;
+    }
+    fwrite(staging_.data(), 1, staged_, out_);
+    bytes_written_.fetch_add(staged_, std::memory_order_relaxed);
+    staged_ = 0;
+}
+
+void TraceWriter::write_direct(const char* data, size_t len) {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    flush_staging();
+    fwrite(data, 1, len, out_);
+    bytes_written_.fetch_add(len, std::memory_order_relaxed);
+}
+
+void TraceWriter::stop() {
+    accepting_.store(false, std::memory_order_seq_cst);
+
+    // Wait for producers that were already past the accepting_ check.
+    // The writer thread keeps draining meanwhile so blocked producers finish.
+    std::vector<ThreadRing*> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        for (const auto& ring : rings_) {
+            snapshot.push_back(ring.get());
+        }
+    }
+    for (ThreadRing* ring : snapshot) {
+        while (ring->busy.load(std::memory_order_seq_cst)) {
+            std::this_thread::yield();
+        }
+    }
+
+    if (writer_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stop_requested_.store(true, std::memory_order_release);
+        }
+        wake_cv_.notify_all();
+        writer_thread_.join();
+    }
+
+    drain_all();
+    fflush(out_);
+}
+
+} // namespace rpv3
@@ -0,0 +1,103 @@
+// MIT License
+// RPV3 Trace Writer - Asynchronous output engine for the C++ kernel tracer
+//
+// Each producer thread owns a lock-free single-producer/single-consumer byte
+// ring. Profiler callbacks append complete records to their own ring without
+// taking a lock; a single background writer thread drains all rings into the
+// output stream using large batched fwrite() calls.
+
+#ifndef RPV3_TRACE_WRITER_H
+#define RPV3_TRACE_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rpv3 {
+
+// What a producer does when its ring has no room for a record
+enum class RingFullPolicy {
+    Block,  // Wake the writer and wait until space is available (lossless)
+    Drop,   // Discard the record and count it
+    Spill   // Append to an unbounded per-thread overflow buffer (lossless)
+};
+
+struct TraceWriterConfig {
+    size_t ring_size = 256 * 1024;        // Bytes per thread, rounded up to a power of two
+    RingFullPolicy policy = RingFullPolicy::Block;
+    unsigned flush_interval_ms = 20;      // Maximum time records wait in a ring
+    size_t batch_size = 1024 * 1024;      // Staging buffer handed to fwrite()
+};
+
+class TraceWriter {
+public:
+    TraceWriter(FILE* out, const TraceWriterConfig& config);
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Start the background writer thread
+    void start();
+
+    // Queue one complete record. Records are never split or interleaved.
+    // Returns false if the record was dropped (RingFullPolicy::Drop only).
+    // After stop() the record is written synchronously.
+    bool write(const char* data, size_t len);
+
+    // Drain every ring, join the writer thread and fflush() the stream.
+    // Safe to call more than once.
+    void stop();
+
+    uint64_t dropped_records() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t spilled_records() const { return spilled_.load(std::memory_order_relaxed); }
+    uint64_t bytes_written() const { return bytes_written_.load(std::memory_order_relaxed); }
+    size_t ring_size() const { return ring_size_; }
+
+private:
+    struct ThreadRing;
+
+    ThreadRing* ring_for_current_thread();
+    bool push(ThreadRing* ring, const char* data, size_t len);
+    void spill(ThreadRing* ring, const char* data, size_t len);
+    void writer_loop();
+    void drain_all();
+    void stage(const char* data, size_t len);
+    void flush_staging();
+    void write_direct(const char* data, size_t len);
+
+    FILE* out_;
+    TraceWriterConfig config_;
+    size_t ring_size_;
+    uint64_t generation_;
+
+    std::atomic<bool> accepting_{false};
+    std::atomic<bool> stop_requested_{false};
+    std::atomic<bool> wake_requested_{false};
+
+    std::mutex rings_mutex_;
+    std::vector<std::unique_ptr<ThreadRing>> rings_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::thread writer_thread_;
+
+    std::mutex drain_mutex_;     // Serializes drain_all() and direct writes
+    std::vector<char> staging_;
+    size_t staged_ = 0;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> spilled_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+};
+
+} // namespace rpv3
+
+#endif // RPV3_TRACE_WRITER_H
@@ -0,0 +1,108 @@
+/* MIT License
+ * Microbenchmark for the tracer's stdio interposers
+ *
+ * The tracer wraps fopen, fopen64, fdopen and open/openat to unbuffer the
+ * rocBLAS log streams, so every file the host process opens goes through
+ * them. This measures the per-call cost of opening and closing a temporary
+ * file. Run it twice to see the interposer overhead:
+ *
+ *   tests/bench_fopen
+ *   LD_PRELOAD=./libkernel_tracer.so tests/bench_fopen
+ *
+ * and with ROCBLAS_LOG_TRACE_PATH set to see the cost once a path set is
+ * published. It also times the matching step on its own: the old check
+ * (three getenv() calls and strcmp() per open) against rpv3::PathSet.
+ *
+ * Usage: bench_fopen [iterations]
+ */
+
+#include "../rpv3_path_set.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+template <typename F>
+double ns_per_call(size_t iterations, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        body();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (double)iterations;
+}
+
+// The check the interposers made before the path set
+bool legacy_match(const char* path, const char* pipe) {
+    const char* trace_path = getenv("ROCBLAS_LOG_TRACE_PATH");
+    const char* bench_path = getenv("ROCBLAS_LOG_BENCH_PATH");
+    const char* profile_path = getenv("ROCBLAS_LOG_PROFILE_PATH");
+    if (!path) return false;
+    if (trace_path && strcmp(path, trace_path) == 0) return true;
+    if (bench_path && strcmp(path, bench_path) == 0) return true;
+    if (profile_path && strcmp(path, profile_path) == 0) return true;
+    return pipe && strcmp(path, pipe) == 0;
+}
+
+volatile size_t sink = 0;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 200000;
+    if (iterations == 0) iterations = 1;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/rpv3_bench_fopen_%d", (int)getpid());
+    FILE* create = fopen(path, "w");
+    if (!create) {
+        perror("fopen");
+        return 1;
+    }
+    fclose(create);
+
+    const char* preload = getenv("LD_PRELOAD");
+    printf("stdio interposer benchmark: %zu iterations, LD_PRELOAD=%s\n\n", iterations, preload ? preload : "(unset)");
+    printf("%-24s %12s\n", "Call", "ns/call");
+
+    double fopen_ns = ns_per_call(iterations, [&] {
+        FILE* fp = fopen(path, "r");
+        if (fp) fclose(fp);
+    });
+    double open_ns = ns_per_call(iterations, [&] {
+        int fd = open(path, O_RDONLY);
+        if (fd >= 0) close(fd);
+    });
+    double fdopen_ns = ns_per_call(iterations, [&] {
+        int fd = open(path, O_RDONLY);
+        FILE* fp = fd >= 0 ? fdopen(fd, "r") : nullptr;
+        if (fp) fclose(fp);
+        else if (fd >= 0) close(fd);
+    });
+    printf("%-24s %12.1f\n", "fopen+fclose", fopen_ns);
+    printf("%-24s %12.1f\n", "open+close", open_ns);
+    printf("%-24s %12.1f\n", "open+fdopen+fclose", fdopen_ns);
+
+    // Matching alone, for a path that is not a target
+    const char* pipe = "/tmp/rocblas_pipe";
+    rpv3::PathSet none;
+    rpv3::PathSet paths;
+    paths.add(pipe);
+    paths.add("/tmp/rocblas_bench.log");
+    size_t match_iterations = iterations * 50;
+    double legacy_ns = ns_per_call(match_iterations, [&] { sink = sink + legacy_match(path, pipe); });
+    double empty_ns = ns_per_call(match_iterations, [&] { sink = sink + none.contains(path); });
+    double set_ns = ns_per_call(match_iterations, [&] { sink = sink + paths.contains(path); });
+    printf("\n%-24s %12s\n", "Path match", "ns/call");
+    printf("%-24s %12.1f\n", "getenv+strcmp", legacy_ns);
+    printf("%-24s %12.1f\n", "PathSet (empty)", empty_ns);
+    printf("%-24s %12.1f\n", "PathSet (2 paths)", set_ns);
+
+    unlink(path);
+    return 0;
+}
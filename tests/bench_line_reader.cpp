@@ -0,0 +1,140 @@
+/* MIT License
+ * Microbenchmark for reading the rocBLAS log pipe
+ *
+ * Feeds a synthetic rocBLAS trace log through a local FIFO and consumes it
+ * the way the tracer does for each Tensile dispatch: take the next line,
+ * skipping handle/stream bookkeeping, and tee the raw bytes to a log file.
+ * Compares the old path (one read() and one fputc() per byte) with
+ * rpv3::LineReader. The tee goes to /dev/null.
+ *
+ * Usage: bench_line_reader [megabytes]
+ */
+
+#include "../rpv3_line_reader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+const char* kLines[] = {
+    "rocblas_create_handle,atomics_allowed",
+    "rocblas_set_stream,0x5581b2c0",
+    "rocblas_gemm_ex,N,T,4096,4096,4096,1,f16_r,4096,f16_r,4096,0,f32_r,4096,f32_r,4096,f32_r,standard,0,none",
+    "rocblas_sgemm_strided_batched,N,N,512,512,64,1,512,262144,512,32768,0,512,262144,16",
+    "rocblas_dgemv,T,2048,2048,1,2048,1,0,1",
+};
+
+std::string make_log(size_t bytes) {
+    std::string log;
+    log.reserve(bytes + 256);
+    for (size_t i = 0; log.size() < bytes; i++) {
+        log += kLines[i % (sizeof(kLines) / sizeof(kLines[0]))];
+        log += '\n';
+    }
+    return log;
+}
+
+// Old path: byte-at-a-time read() with a per-byte fputc tee
+size_t consume_bytewise(int fd, FILE* tee, uint64_t& read_calls) {
+    char line[4096];
+    size_t lines = 0;
+    int pos = 0;
+    while (true) {
+        char c;
+        ssize_t n = read(fd, &c, 1);
+        read_calls++;
+        if (n == 0) break;
+        if (n < 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        fputc(c, tee);
+        if (c == '\n') {
+            line[pos] = '\0';
+            if (pos > 0 && !rpv3::is_rocblas_bookkeeping(line)) {
+                lines++;
+            }
+            pos = 0;
+        } else if (pos < (int)sizeof(line) - 1) {
+            line[pos++] = c;
+        }
+    }
+    return lines;
+}
+
+size_t consume_buffered(int fd, FILE* tee, uint64_t& read_calls) {
+    rpv3::LineReader reader;
+    reader.set_tee(tee);
+    std::string line;
+    size_t lines = 0;
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);  // Block so EOF ends the loop
+    while (reader.next_line(fd, line)) {
+        if (!line.empty() && !rpv3::is_rocblas_bookkeeping(line)) {
+            lines++;
+        }
+    }
+    read_calls = reader.read_calls();
+    return lines;
+}
+
+double run(const char* fifo, const std::string& log, bool buffered, size_t& lines, uint64_t& read_calls) {
+    std::thread writer([&] {
+        int fd = open(fifo, O_WRONLY);
+        size_t off = 0;
+        while (off < log.size()) {
+            ssize_t n = write(fd, log.data() + off, log.size() - off);
+            if (n <= 0) break;
+            off += (size_t)n;
+        }
+        close(fd);
+    });
+
+    int fd = open(fifo, O_RDONLY);
+    FILE* tee = fopen("/dev/null", "w");
+    read_calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    lines = buffered ? consume_buffered(fd, tee, read_calls) : consume_bytewise(fd, tee, read_calls);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    writer.join();
+    fclose(tee);
+    close(fd);
+    return (double)log.size() / (1024.0 * 1024.0) / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t megabytes = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 16;
+    if (megabytes == 0) megabytes = 1;
+
+    char fifo[64];
+    snprintf(fifo, sizeof(fifo), "/tmp/rpv3_bench_fifo_%d", (int)getpid());
+    if (mkfifo(fifo, 0600) != 0) {
+        perror("mkfifo");
+        return 1;
+    }
+
+    std::string log = make_log(megabytes * 1024 * 1024);
+    printf("rocBLAS log reader benchmark: %zu MB through a FIFO\n\n", megabytes);
+    printf("%-10s %12s %14s %12s\n", "Reader", "MB/s", "read() calls", "Lines");
+
+    size_t lines_old = 0, lines_new = 0;
+    uint64_t calls_old = 0, calls_new = 0;
+    double before = run(fifo, log, false, lines_old, calls_old);
+    double after = run(fifo, log, true, lines_new, calls_new);
+    printf("%-10s %12.1f %14lu %12zu\n", "bytewise", before, (unsigned long)calls_old, lines_old);
+    printf("%-10s %12.1f %14lu %12zu\n", "buffered", after, (unsigned long)calls_new, lines_new);
+    printf("\nSpeedup: %.1fx%s\n", after / before, lines_old == lines_new ? "" : " (line counts differ!)");
+
+    unlink(fifo);
+    return lines_old == lines_new ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+/* MIT License
+ * Microbenchmark for trace record output
+ *
+ * Compares the old output path (one locked fprintf per line, ~15 per
+ * human-readable record) with the single-pass formatter (record built in a
+ * thread-local RecordBuffer, one locked fwrite per record). Output goes to
+ * /dev/null so the numbers reflect formatting and locking, not disk speed.
+ *
+ * Usage: bench_record_format [threads] [records_per_thread]
+ */
+
+#include "../rpv3_record_format.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::mutex output_mutex;
+FILE* sink = nullptr;
+
+const char* kKernelName =
+    "void at::native::elementwise_kernel<128, 2, at::native::gpu_kernel_impl<"
+    "at::native::BinaryFunctor<float, float, float, at::native::MulFunctor<float> > >"
+    "(at::TensorIteratorBase&, at::native::BinaryFunctor<float, float, float, "
+    "at::native::MulFunctor<float> > const&)::{lambda(int)#1}>(int, "
+    "at::native::gpu_kernel_impl<...>::{lambda(int)#1})";
+
+rpv3::DispatchRecord make_record(uint64_t i) {
+    rpv3::DispatchRecord r;
+    r.thread_id = 140234;
+    r.correlation_id = i;
+    r.kernel_id = 12;
+    r.dispatch_id = i;
+    r.grid[0] = 1048576; r.grid[1] = 1; r.grid[2] = 1;
+    r.workgroup[0] = 256; r.workgroup[1] = 1; r.workgroup[2] = 1;
+    r.group_segment_size = 4096;
+    r.start_ns = 1700000000000000ULL + i * 5000;
+    r.end_ns = r.start_ns + 1234 + (i % 977);
+    return r;
+}
+
+// Old path: every line is a separate locked fprintf, as TRACE_PRINTF did
+#define LOCKED_PRINTF(...) do { \
+        std::lock_guard<std::mutex> lock(output_mutex); \
+        fprintf(sink, __VA_ARGS__); \
+    } while (0)
+
+void printf_text(uint64_t count, const rpv3::DispatchRecord& r, uint64_t tracer_start) {
+    LOCKED_PRINTF("\n[Kernel Trace #%lu]\n", (unsigned long)count);
+    LOCKED_PRINTF("  Kernel Name: %s\n", kKernelName);
+    LOCKED_PRINTF("  Thread ID: %lu\n", (unsigned long)r.thread_id);
+    LOCKED_PRINTF("  Correlation ID: %lu\n", (unsigned long)r.correlation_id);
+    LOCKED_PRINTF("  Kernel ID: %lu\n", (unsigned long)r.kernel_id);
+    LOCKED_PRINTF("  Dispatch ID: %lu\n", (unsigned long)r.dispatch_id);
+    LOCKED_PRINTF("  Grid Size: [%u, %u, %u]\n", r.grid[0], r.grid[1], r.grid[2]);
+    LOCKED_PRINTF("  Workgroup Size: [%u, %u, %u]\n", r.workgroup[0], r.workgroup[1], r.workgroup[2]);
+    LOCKED_PRINTF("  Private Segment Size: %u bytes (scratch memory per work-item)\n", r.private_segment_size);
+    LOCKED_PRINTF("  Group Segment Size: %u bytes (LDS memory per work-group)\n", r.group_segment_size);
+    LOCKED_PRINTF("  Start Timestamp: %lu ns\n", (unsigned long)r.start_ns);
+    LOCKED_PRINTF("  End Timestamp: %lu ns\n", (unsigned long)r.end_ns);
+    LOCKED_PRINTF("  Duration: %.3f μs\n", (r.end_ns - r.start_ns) / 1000.0);
+    LOCKED_PRINTF("  Time Since Start: %.3f ms\n", (r.start_ns - tracer_start) / 1000000.0);
+}
+
+void printf_csv(const rpv3::DispatchRecord& r, uint64_t tracer_start) {
+    LOCKED_PRINTF("\"%s\",%lu,%lu,%lu,%lu,%u,%u,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu,%.3f,%.3f\n",
+                  kKernelName, (unsigned long)r.thread_id, (unsigned long)r.correlation_id,
+                  (unsigned long)r.kernel_id, (unsigned long)r.dispatch_id,
+                  r.grid[0], r.grid[1], r.grid[2], r.workgroup[0], r.workgroup[1], r.workgroup[2],
+                  r.private_segment_size, r.group_segment_size,
+                  (unsigned long)r.start_ns, (unsigned long)r.end_ns,
+                  (unsigned long)(r.end_ns - r.start_ns), (r.end_ns - r.start_ns) / 1000.0,
+                  (r.start_ns - tracer_start) / 1000000.0);
+}
+
+void buffered_write(const rpv3::RecordBuffer& buffer) {
+    std::lock_guard<std::mutex> lock(output_mutex);
+    fwrite(buffer.data(), 1, buffer.size(), sink);
+}
+
+enum class Mode { PrintfText, FormatText, PrintfCsv, FormatCsv };
+
+void worker(Mode mode, uint64_t records) {
+    const uint64_t tracer_start = 1700000000000000ULL - 1000000;
+    thread_local rpv3::RecordBuffer buffer;
+    for (uint64_t i = 0; i < records; i++) {
+        rpv3::DispatchRecord r = make_record(i);
+        switch (mode) {
+            case Mode::PrintfText:
+                printf_text(i + 1, r, tracer_start);
+                break;
+            case Mode::PrintfCsv:
+                printf_csv(r, tracer_start);
+                break;
+            case Mode::FormatText:
+                buffer.clear();
+                rpv3::format_text_record(buffer, i + 1, kKernelName, r,
+                                         rpv3::TextTimestamps::Timeline, tracer_start);
+                buffered_write(buffer);
+                break;
+            case Mode::FormatCsv:
+                buffer.clear();
+                rpv3::format_csv_row(buffer, kKernelName, r, tracer_start);
+                buffered_write(buffer);
+                break;
+        }
+    }
+}
+
+double run(Mode mode, int threads, uint64_t records) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back(worker, mode, records);
+    }
+    for (auto& w : workers) w.join();
+    fflush(sink);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return (double)(threads * records) / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int threads = (argc > 1) ? atoi(argv[1]) : 4;
+    uint64_t records = (argc > 2) ? strtoull(argv[2], nullptr, 10) : 200000;
+    if (threads < 1) threads = 1;
+
+    sink = fopen("/dev/null", "w");
+    if (!sink) {
+        perror("/dev/null");
+        return 1;
+    }
+
+    printf("Record formatting benchmark: %d thread(s), %lu records per thread\n\n",
+           threads, (unsigned long)records);
+    printf("%-10s %18s %18s %9s\n", "Format", "printf (rec/s)", "formatter (rec/s)", "Speedup");
+
+    double before = run(Mode::PrintfText, threads, records);
+    double after = run(Mode::FormatText, threads, records);
+    printf("%-10s %18.0f %18.0f %8.2fx\n", "text", before, after, after / before);
+
+    before = run(Mode::PrintfCsv, threads, records);
+    after = run(Mode::FormatCsv, threads, records);
+    printf("%-10s %18.0f %18.0f %8.2fx\n", "csv", before, after, after / before);
+
+    fclose(sink);
+    return 0;
+}
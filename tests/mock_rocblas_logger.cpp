@@ -1,18 +1,38 @@
 #include <hip/hip_runtime.h>
 #include <iostream>
+#include <string>
 #include <unistd.h>
 #include <fcntl.h>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 __global__ void dummy_kernel() {}
 
+// Write all of text, retrying short writes
+static bool write_all(int fd, const char* text, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, text, length);
+        if (n <= 0) {
+            return false;
+        }
+        text += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <pipe_path>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <pipe_path> [line_count [copy_path]]" << std::endl;
+        std::cerr << "  line_count: also write that many synthetic rocBLAS trace lines" << std::endl;
+        std::cerr << "  copy_path:  write the same bytes to this file for comparison" << std::endl;
         return 1;
     }
 
     const char* pipe_path = argv[1];
+    const long line_count = (argc > 2) ? strtol(argv[2], nullptr, 10) : 0;
+    const char* copy_path = (argc > 3) ? argv[3] : nullptr;
     
     std::cout << "Mock Logger: Opening pipe " << pipe_path << std::endl;
     // Open pipe for writing
@@ -23,11 +43,34 @@ int main(int argc, char* argv[]) {
     }
 
     // Write log
-    const char* msg = "Mock RocBLAS Log Entry\n";
-    std::cout << "Mock Logger: Writing to pipe" << std::endl;
-    write(fd, msg, strlen(msg));
+    std::string log = "Mock RocBLAS Log Entry\n";
+    for (long i = 0; i < line_count; i++) {
+        log += "rocblas_sgemm,N,T," + std::to_string(64 + i % 4096) +
+               ",512,256,1,0x7f00,1024,0x7f01,512,0,0x7f02,1024\n";
+        if (i % 97 == 0) {
+            log += "rocblas_set_stream,0x1\r\n";
+        }
+    }
+    std::cout << "Mock Logger: Writing " << log.size() << " bytes to pipe" << std::endl;
+    // Odd-sized chunks so lines straddle the tracer's reads
+    for (size_t offset = 0, chunk = 1; offset < log.size(); offset += chunk, chunk = chunk * 7 % 9001 + 1) {
+        size_t length = chunk < log.size() - offset ? chunk : log.size() - offset;
+        if (!write_all(fd, log.data() + offset, length)) {
+            perror("write pipe");
+            return 1;
+        }
+    }
     close(fd);
 
+    if (copy_path) {
+        FILE* copy = fopen(copy_path, "wb");
+        if (!copy || fwrite(log.data(), 1, log.size(), copy) != log.size()) {
+            perror("write copy");
+            return 1;
+        }
+        fclose(copy);
+    }
+
     // Launch kernel
     std::cout << "Mock Logger: Launching kernel" << std::endl;
     dummy_kernel<<<1, 1>>>();
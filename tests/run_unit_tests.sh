@@ -1,5 +1,5 @@
 #!/bin/bash
-# Unit test runner for RPV3 options parser
+# Unit test runner for RPV3 options parser and C++ support modules
 
 set -e
 
@@ -10,6 +10,32 @@ PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
 # Source test utilities
 source "$SCRIPT_DIR/test_utils.sh"
 
+# C++ module tests: "<test source>:<module sources...>" (sources relative to project root)
+CXX_TESTS=(
+    "test_rpv3_trace_writer.cpp:rpv3_trace_writer.cpp"
+    "test_rpv3_binary_format.cpp:rpv3_binary_format.cpp rpv3_record_format.cpp rpv3_demangle.cpp rpv3_blas_perf.cpp rpv3_histogram.cpp rpv3_counter_table.cpp"
+    "test_rpv3_record_format.cpp:rpv3_record_format.cpp"
+    "test_rpv3_kernel_stats.cpp:rpv3_kernel_stats.cpp rpv3_record_format.cpp"
+    "test_rpv3_sampler.cpp:rpv3_sampler.cpp"
+    "test_rpv3_filter.cpp:rpv3_filter.cpp"
+    "test_rpv3_histogram.cpp:rpv3_histogram.cpp"
+    "test_rpv3_kernel_registry.cpp:rpv3_kernel_registry.cpp rpv3_demangle.cpp"
+    "test_rpv3_line_reader.cpp:rpv3_line_reader.cpp"
+    "test_rpv3_log_correlator.cpp:rpv3_log_correlator.cpp"
+    "test_rpv3_blas_parser.cpp:rpv3_blas_parser.cpp"
+    "test_rpv3_blas_perf.cpp:rpv3_blas_perf.cpp rpv3_histogram.cpp"
+    "test_rpv3_blas_bench.cpp:rpv3_blas_bench.cpp rpv3_blas_parser.cpp"
+    "test_rpv3_tensile.cpp:rpv3_tensile.cpp rpv3_kernel_stats.cpp rpv3_record_format.cpp"
+    "test_rpv3_path_set.cpp:rpv3_path_set.cpp"
+    "test_rpv3_library_log.cpp:rpv3_library_log.cpp rpv3_log_correlator.cpp rpv3_blas_parser.cpp rpv3_line_reader.cpp rpv3_tensile.cpp rpv3_kernel_stats.cpp rpv3_record_format.cpp"
+    "test_rpv3_counter_table.cpp:rpv3_counter_table.cpp rpv3_record_format.cpp"
+    "test_rpv3_counter_metrics.cpp:rpv3_counter_metrics.cpp"
+    "test_rpv3_counter_passes.cpp:rpv3_counter_passes.cpp rpv3_counter_table.cpp rpv3_record_format.cpp"
+    "test_rpv3_counter_select.cpp:rpv3_counter_select.cpp"
+    "test_rpv3_counter_join.cpp:rpv3_counter_join.cpp rpv3_counter_table.cpp rpv3_record_format.cpp"
+    "test_rpv3_counter_catalog.cpp:rpv3_counter_catalog.cpp rpv3_counter_passes.cpp rpv3_counter_table.cpp rpv3_record_format.cpp"
+)
+
 print_info "Compiling unit tests..."
 
 # Compile the unit test executable
@@ -18,14 +44,37 @@ gcc -std=c11 -I"$PROJECT_DIR" \
     "$SCRIPT_DIR/test_rpv3_options.c" \
     "$PROJECT_DIR/rpv3_options.c"
 
+gcc -std=c11 -O2 -pthread -I"$PROJECT_DIR" \
+    -o "$SCRIPT_DIR/test_rpv3_kernel_table" \
+    "$SCRIPT_DIR/test_rpv3_kernel_table.c" \
+    "$PROJECT_DIR/rpv3_kernel_table.c"
+
+TEST_BINS=("$SCRIPT_DIR/test_rpv3_options" "$SCRIPT_DIR/test_rpv3_kernel_table")
+
+for entry in "${CXX_TESTS[@]}"; do
+    test_src="${entry%%:*}"
+    module_srcs=()
+    for src in ${entry#*:}; do
+        module_srcs+=("$PROJECT_DIR/$src")
+    done
+    test_bin="$SCRIPT_DIR/${test_src%.cpp}"
+    g++ -std=c++17 -O2 -pthread -I"$PROJECT_DIR" \
+        -o "$test_bin" \
+        "$SCRIPT_DIR/$test_src" \
+        "${module_srcs[@]}"
+    TEST_BINS+=("$test_bin")
+done
+
 print_info "Running unit tests..."
 echo ""
 
 # Run the tests
-"$SCRIPT_DIR/test_rpv3_options"
-exit_code=$?
+exit_code=0
+for test_bin in "${TEST_BINS[@]}"; do
+    "$test_bin" || exit_code=1
+done
 
 # Cleanup
-rm -f "$SCRIPT_DIR/test_rpv3_options"
+rm -f "${TEST_BINS[@]}"
 
 exit $exit_code
@@ -85,5 +85,21 @@ else
     exit 1
 fi
 
-rm -f $FIFO_PATH output.csv rocblas_test.log
+# Test 3: a large log is mirrored byte for byte (tee/splice from the FIFO)
+echo "Testing --rocblas-log byte-for-byte copy..."
+rm -f $FIFO_PATH output.csv rocblas_test.log rocblas_expected.log
+mkfifo $FIFO_PATH
+
+./mock_rocblas_logger $FIFO_PATH 20000 rocblas_expected.log > output.csv 2>&1 &
+APP_PID=$!
+wait $APP_PID
+
+if cmp -s rocblas_expected.log rocblas_test.log; then
+    echo "SUCCESS: Redirected log is byte-for-byte identical ($(wc -c < rocblas_test.log) bytes)"
+else
+    echo "FAILURE: Redirected log differs from what was written to the pipe"
+    exit 1
+fi
+
+rm -f $FIFO_PATH output.csv rocblas_test.log rocblas_expected.log
 exit 0
@@ -0,0 +1,517 @@
+/* MIT License
+ * Unit tests for rpv3_binary_format.cpp
+ * Round-trips records through a .rpv3 file and checks the CSV expansion
+ */
+
+#include "../rpv3_binary_format.h"
+#include "../rpv3_blas_perf.h"
+#include "../rpv3_counter_table.h"
+#include "../rpv3_record_format.h"
+#include "test_utils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+using rpv3::binary::Record;
+
+std::string temp_path(const char* tag) {
+    char path[256];
+    snprintf(path, sizeof(path), "/tmp/rpv3_test_%s_%d.rpv3", tag, (int)getpid());
+    return path;
+}
+
+std::string read_file(FILE* fp) {
+    fflush(fp);
+    rewind(fp);
+    std::string contents;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        contents.append(chunk, n);
+    }
+    return contents;
+}
+
+Record make_dispatch(uint32_t name_id, uint64_t dispatch_id, uint64_t start_ns, uint64_t end_ns) {
+    Record record;
+    record.kind = rpv3::binary::kRecordDispatch;
+    record.string_id = name_id;
+    record.dispatch.thread_id = 4242;
+    record.dispatch.correlation_id = dispatch_id + 100;
+    record.dispatch.kernel_id = 7;
+    record.dispatch.dispatch_id = dispatch_id;
+    record.dispatch.grid[0] = 1048576;
+    record.dispatch.grid[1] = 2;
+    record.dispatch.grid[2] = 1;
+    record.dispatch.workgroup[0] = 256;
+    record.dispatch.workgroup[1] = 1;
+    record.dispatch.workgroup[2] = 1;
+    record.dispatch.private_segment_size = 16;
+    record.dispatch.group_segment_size = 32768;
+    record.dispatch.start_ns = start_ns;
+    record.dispatch.end_ns = end_ns;
+    return record;
+}
+
+/* Write a small trace the same way the tracer does */
+void write_trace(FILE* fp, uint64_t tracer_start) {
+    rpv3::binary::Writer writer;
+    writer.begin(fp, tracer_start);
+
+    uint32_t gemm = writer.intern("Cijk_Ailk_Bljk_SB_MT64x64x16");
+    uint32_t add = writer.intern("vector_add(float const*, float const*, float*, int)");
+
+    unsigned char buffer[rpv3::binary::kRecordSize];
+    writer.encode(make_dispatch(add, 1, 1000500000, 1000512345), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    writer.encode(make_dispatch(gemm, 2, 1002000000, 1002100001), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+
+    Record note;
+    note.kind = rpv3::binary::kRecordAnnotation;
+    note.string_id = writer.intern("rocblas_sgemm,N,N,128,128,128,1,0x1,128,0x2,128,0,0x3,128");
+    note.dispatch.dispatch_id = 2;
+    writer.encode(note, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+
+    /* Unknown kernel name and a record with end < start */
+    writer.encode(make_dispatch(rpv3::binary::kUnknownStringId, 3, 900, 800), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+
+    writer.finish(fp);
+}
+
+} // namespace
+
+TEST(encode_decode) {
+    Record in = make_dispatch(5, 99, 123456789012345ULL, 123456789999999ULL);
+    unsigned char buffer[rpv3::binary::kRecordSize];
+    rpv3::binary::encode_record(in, buffer);
+    Record out = rpv3::binary::decode_record(buffer);
+
+    ASSERT_EQUALS(in.kind, out.kind, "Kind survives encoding");
+    ASSERT_EQUALS(in.string_id, out.string_id, "String id survives encoding");
+    ASSERT_EQUALS(in.dispatch.dispatch_id, out.dispatch.dispatch_id, "Dispatch id survives encoding");
+    ASSERT_EQUALS(in.dispatch.end_ns, out.dispatch.end_ns, "64-bit timestamp survives encoding");
+    ASSERT_EQUALS(in.dispatch.grid[0], out.dispatch.grid[0], "Grid survives encoding");
+    ASSERT_EQUALS(in.dispatch.group_segment_size, out.dispatch.group_segment_size, "LDS size survives encoding");
+    ASSERT_EQUALS(0x01, buffer[0], "Record kind is little-endian");
+}
+
+TEST(intern_deduplicates) {
+    rpv3::binary::Writer writer;
+    FILE* fp = tmpfile();
+    writer.begin(fp, 0);
+    uint32_t a = writer.intern("kernel_a");
+    uint32_t b = writer.intern("kernel_b");
+    ASSERT_TRUE(a != b, "Distinct strings get distinct ids");
+    ASSERT_EQUALS(a, writer.intern("kernel_a"), "Repeated string reuses its id");
+    ASSERT_EQUALS(3, writer.string_count(), "Table holds <unknown> plus two names");
+    fclose(fp);
+}
+
+TEST(csv_roundtrip) {
+    const uint64_t tracer_start = 1000000000;
+    std::string path = temp_path("roundtrip");
+    FILE* fp = fopen(path.c_str(), "w+");
+    write_trace(fp, tracer_start);
+    fclose(fp);
+
+    rpv3::binary::Reader reader;
+    ASSERT_TRUE(reader.open(path.c_str()), "Reader accepts the trace");
+    ASSERT_EQUALS(4, reader.record_count(), "Record count read from footer");
+    ASSERT_EQUALS(tracer_start, reader.tracer_start_ns(), "Tracer start timestamp preserved");
+
+    FILE* csv = tmpfile();
+    rpv3::binary::write_csv(reader, csv);
+    std::string actual = read_file(csv);
+    fclose(csv);
+
+    /* Expected output, formatted exactly as kernel_tracer.cpp does in --csv mode */
+    std::string expected = rpv3::kCsvHeader;
+    char line[1024];
+    snprintf(line, sizeof(line), "\"%s\",%lu,%lu,%lu,%lu,%u,%u,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu,%.3f,%.3f\n",
+             "vector_add(float const*, float const*, float*, int)", 4242UL, 101UL, 7UL, 1UL,
+             1048576u, 2u, 1u, 256u, 1u, 1u, 16u, 32768u,
+             1000500000UL, 1000512345UL, 12345UL, 12345 / 1000.0, 500000 / 1000000.0);
+    expected += line;
+    snprintf(line, sizeof(line), "\"%s\",%lu,%lu,%lu,%lu,%u,%u,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu,%.3f,%.3f\n",
+             "Cijk_Ailk_Bljk_SB_MT64x64x16", 4242UL, 102UL, 7UL, 2UL,
+             1048576u, 2u, 1u, 256u, 1u, 1u, 16u, 32768u,
+             1002000000UL, 1002100001UL, 100001UL, 100001 / 1000.0, 2000000 / 1000000.0);
+    expected += line;
+    expected += "# rocblas_sgemm,N,N,128,128,128,1,0x1,128,0x2,128,0,0x3,128\n";
+    snprintf(line, sizeof(line), "\"%s\",%lu,%lu,%lu,%lu,%u,%u,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu,%.3f,%.3f\n",
+             "<unknown>", 4242UL, 103UL, 7UL, 3UL,
+             1048576u, 2u, 1u, 256u, 1u, 1u, 16u, 32768u,
+             900UL, 800UL, 0UL, 0.0, 0.0);
+    expected += line;
+
+    ASSERT_TRUE(actual == expected, "CSV expansion matches --csv output byte for byte");
+    unlink(path.c_str());
+}
+
+TEST(header_patched) {
+    std::string path = temp_path("header");
+    FILE* fp = fopen(path.c_str(), "w+");
+    write_trace(fp, 0);
+    std::string contents = read_file(fp);
+    fclose(fp);
+    unlink(path.c_str());
+
+    ASSERT_TRUE(contents.compare(0, 8, std::string("RPV3BIN\0", 8)) == 0, "File starts with magic");
+    ASSERT_EQUALS(4, (unsigned char)contents[32], "Header record count patched at finish");
+    ASSERT_EQUALS(rpv3::binary::kHeaderSize + 4 * rpv3::binary::kRecordSize,
+                  (size_t)(unsigned char)contents[40] | ((size_t)(unsigned char)contents[41] << 8),
+                  "Header string table offset patched at finish");
+}
+
+TEST(mangled_names) {
+    std::string path = temp_path("mangled");
+    FILE* fp = fopen(path.c_str(), "w+");
+    rpv3::binary::Writer writer;
+    writer.begin(fp, 0, rpv3::binary::kFlagMangledNames);
+    uint32_t add = writer.intern("_Z10vector_addPKfS0_Pfi.kd");
+    uint32_t gemm = writer.intern("Cijk_Ailk_Bljk_SB_MT64x64x16.kd");
+    unsigned char buffer[rpv3::binary::kRecordSize];
+    writer.encode(make_dispatch(add, 1, 500, 600), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    writer.encode(make_dispatch(add, 2, 700, 800), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    writer.encode(make_dispatch(gemm, 3, 900, 1000), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    writer.finish(fp);
+    fclose(fp);
+
+    rpv3::binary::Reader reader;
+    ASSERT_TRUE(reader.open(path.c_str()), "Reader accepts the trace");
+    ASSERT_TRUE(reader.flags() & rpv3::binary::kFlagMangledNames, "Header records mangled names");
+    ASSERT_TRUE(reader.string(add) == "_Z10vector_addPKfS0_Pfi.kd", "String table keeps the mangled name");
+
+    FILE* csv = tmpfile();
+    rpv3::binary::write_csv(reader, csv);
+    std::string actual = read_file(csv);
+    fclose(csv);
+    unlink(path.c_str());
+
+    size_t first = actual.find("\"vector_add(float const*, float const*, float*, int)\"");
+    ASSERT_TRUE(first != std::string::npos, "Converter demangles kernel names");
+    ASSERT_TRUE(actual.find("vector_add(float const*", first + 1) != std::string::npos, "Cached name is reused");
+    ASSERT_TRUE(actual.find("\"Cijk_Ailk_Bljk_SB_MT64x64x16\"") != std::string::npos,
+                "Unmangled names only lose the .kd suffix");
+    ASSERT_TRUE(actual.find("_Z10") == std::string::npos, "No mangled name reaches the CSV");
+}
+
+TEST(blas_columns) {
+    std::string path = temp_path("blas");
+    FILE* fp = fopen(path.c_str(), "w+");
+    rpv3::binary::Writer writer;
+    writer.begin(fp, 0, rpv3::binary::kFlagBlasColumns);
+    uint32_t gemm = writer.intern("Cijk_Ailk_Bljk_SB_MT64x64x16");
+    uint32_t add = writer.intern("vector_add");
+    unsigned char buffer[rpv3::binary::kRecordSize];
+
+    rpv3::binary::BlasRecord blas;
+    blas.dispatch_id = 1;
+    blas.call.family = rpv3::BlasFamily::Gemm;
+    blas.call.function = "gemm_strided_batched_ex";
+    blas.call.precision = "f16_r";
+    blas.call.b_type = "f16_r";
+    blas.call.c_type = "f32_r";
+    blas.call.d_type = "f32_r";
+    blas.call.compute_type = "f32_r";
+    blas.call.trans_a = 'T';
+    blas.call.trans_b = 'N';
+    blas.call.m = 128;
+    blas.call.n = 256;
+    blas.call.k = 64;
+    blas.call.lda = 64;
+    blas.call.ldb = 64;
+    blas.call.ldc = 128;
+    blas.call.stride_a = 8589934592LL;
+    blas.call.batch_count = 8;
+    blas.call.alpha = 0.5;
+
+    writer.encode(make_dispatch(gemm, 1, 100, 200), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    Record note;
+    note.kind = rpv3::binary::kRecordAnnotation;
+    note.string_id = writer.intern("rocblas_gemm_strided_batched_ex,T,N,128,256,64");
+    note.dispatch.dispatch_id = 1;
+    writer.encode(note, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    writer.encode(blas, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    writer.encode(make_dispatch(add, 2, 300, 400), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    writer.finish(fp);
+    fclose(fp);
+
+    rpv3::binary::Reader reader;
+    ASSERT_TRUE(reader.open(path.c_str()), "Reader accepts the trace");
+    ASSERT_EQUALS(4, reader.record_count(), "BLAS record counted");
+    rpv3::binary::BlasRecord back = reader.blas_record(2);
+    ASSERT_TRUE(back.dispatch_id == 1 && back.call.function == "gemm_strided_batched_ex", "Dispatch id and routine");
+    ASSERT_TRUE(back.call.precision == "f16_r" && back.call.compute_type == "f32_r", "Datatypes");
+    ASSERT_TRUE(back.call.b_type == "f16_r" && back.call.c_type == "f32_r" && back.call.d_type == "f32_r",
+                "B, C and D datatypes");
+    ASSERT_TRUE(back.call.trans_a == 'T' && back.call.m == 128 && back.call.k == 64, "Shape");
+    ASSERT_TRUE(back.call.stride_a == 8589934592LL && back.call.stride_b == rpv3::kBlasNone, "64-bit and unset strides");
+    ASSERT_TRUE(back.call.alpha == 0.5 && back.call.beta != back.call.beta, "Scalars, NaN included");
+
+    FILE* csv = tmpfile();
+    rpv3::binary::write_csv(reader, csv);
+    std::string actual = read_file(csv);
+    fclose(csv);
+    unlink(path.c_str());
+
+    ASSERT_TRUE(actual.compare(0, rpv3::csv_header(true).size(), rpv3::csv_header(true)) == 0, "Header has BLAS columns");
+    ASSERT_TRUE(actual.find(",gemm_strided_batched_ex,f16_r,f32_r,T,N,128,256,64,64,64,128,8589934592,,,8,0.5,,335.544,9175.040\n"
+                            "# rocblas_gemm_strided_batched_ex") != std::string::npos,
+                "BLAS call and achieved rates complete the row, annotation follows");
+    ASSERT_TRUE(actual.find("\"vector_add\"") != std::string::npos &&
+                actual.substr(actual.size() - 20) == ",,,,,,,,,,,,,,,,,,,\n", "Other rows get empty columns");
+}
+
+TEST(counter_values) {
+    std::string path = temp_path("counters");
+    FILE* fp = fopen(path.c_str(), "w+");
+    rpv3::binary::Writer writer;
+    writer.begin(fp, 0);
+    uint32_t add = writer.intern("vector_add");
+    uint32_t waves = writer.intern("SQ_WAVES");
+    uint32_t valu = writer.intern("SQ_INSTS_VALU");
+    unsigned char buffer[rpv3::binary::kRecordSize];
+
+    rpv3::binary::CounterValue value;
+    value.agent_id = 3;
+    writer.encode(make_dispatch(add, 1, 0, 0), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    value.dispatch_id = 1;
+    value.name_id = waves;
+    value.instances = 4;
+    value.value = 4096.0;
+    writer.encode(value, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    value.name_id = valu;
+    value.instances = 1;
+    value.value = 1.5e9;
+    writer.encode(value, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    /* Second dispatch without SQ_INSTS_VALU, then one traced without counters */
+    writer.encode(make_dispatch(add, 2, 0, 0), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    value.dispatch_id = 2;
+    value.name_id = waves;
+    value.value = 64.0;
+    writer.encode(value, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    writer.encode(make_dispatch(add, 3, 0, 0), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    writer.finish(fp);
+    fclose(fp);
+
+    rpv3::binary::Reader reader;
+    ASSERT_TRUE(reader.open(path.c_str()), "Reader accepts the trace");
+    rpv3::binary::CounterValue back = reader.counter_value(1);
+    ASSERT_EQUALS(rpv3::binary::kRecordCounter, reader.record(1).kind, "Counter record kind");
+    ASSERT_TRUE(back.dispatch_id == 1 && back.name_id == waves && back.agent_id == 3, "Ids survive encoding");
+    ASSERT_TRUE(back.value == 4096.0 && back.instances == 4, "Value and instance count survive encoding");
+
+    FILE* csv = tmpfile();
+    rpv3::binary::write_counter_csv(reader, csv);
+    std::string actual = read_file(csv);
+    fclose(csv);
+
+    std::string expected =
+        "KernelName,DispatchID,CorrelationID,KernelID,AgentID,GridX,GridY,GridZ,WorkgroupX,WorkgroupY,WorkgroupZ,"
+        "SQ_WAVES,SQ_INSTS_VALU\n"
+        "\"vector_add\",1,101,7,3,1048576,2,1,256,1,1,4096,1.5e+09\n"
+        "\"vector_add\",2,102,7,3,1048576,2,1,256,1,1,64,\n";
+    ASSERT_TRUE(actual == expected, "One row per counted dispatch, missing counters empty");
+
+    csv = tmpfile();
+    rpv3::binary::write_csv(reader, csv);
+    actual = read_file(csv);
+    fclose(csv);
+    unlink(path.c_str());
+    ASSERT_TRUE(actual.find("SQ_WAVES") == std::string::npos, "Dispatch CSV skips counter records");
+}
+
+TEST(counter_metric_roundtrip) {
+    std::string path = temp_path("metrics");
+    FILE* fp = fopen(path.c_str(), "w+");
+    rpv3::binary::Writer writer;
+    writer.begin(fp, 0);
+    uint32_t add = writer.intern("vector_add");
+    uint32_t valu = writer.intern("SQ_INSTS_VALU");
+    uint32_t waves = writer.intern("SQ_WAVES");
+    uint32_t per_wave = writer.intern("VALU_PER_WAVE");
+    unsigned char buffer[rpv3::binary::kRecordSize];
+
+    /* --counters SQ_WAVES,SQ_INSTS_VALU,VALU_PER_WAVE=SQ_INSTS_VALU/SQ_WAVES */
+    for (uint32_t name : {waves, valu}) {
+        writer.encode_column(name, 0, buffer);
+        fwrite(buffer, 1, sizeof(buffer), fp);
+    }
+    writer.encode_column(per_wave, rpv3::binary::kCounterMetric, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+
+    /* SQ_INSTS_VALU is written first, unlike the declared order */
+    writer.encode(make_dispatch(add, 1, 0, 0), buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    rpv3::binary::CounterValue value;
+    value.dispatch_id = 1;
+    value.agent_id = 3;
+    value.name_id = valu;
+    value.instances = 1;
+    value.value = 10.0;
+    writer.encode(value, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    value.name_id = waves;
+    value.instances = 4;
+    value.value = 4.0;
+    writer.encode(value, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    value.name_id = per_wave;
+    value.instances = 0;
+    value.flags = rpv3::binary::kCounterMetric;
+    value.value = 2.5;
+    writer.encode(value, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    writer.finish(fp);
+    fclose(fp);
+
+    rpv3::binary::Reader reader;
+    ASSERT_TRUE(reader.open(path.c_str()), "Reader accepts the trace");
+    ASSERT_EQUALS(rpv3::binary::kRecordCounterColumn, reader.record(2).kind, "Column record kind");
+    ASSERT_TRUE(reader.counter_value(2).flags == rpv3::binary::kCounterMetric, "Metric flag survives encoding");
+    ASSERT_TRUE(reader.counter_value(6).flags == rpv3::binary::kCounterMetric, "Metric value flagged");
+
+    FILE* csv = tmpfile();
+    rpv3::binary::write_counter_csv(reader, csv);
+    std::string actual = read_file(csv);
+    fclose(csv);
+    unlink(path.c_str());
+
+    std::string expected =
+        rpv3::counter_csv_header({"SQ_WAVES", "SQ_INSTS_VALU", "VALU_PER_WAVE"}) +
+        "\"vector_add\",1,101,7,3,1048576,2,1,256,1,1,4,10,2.5\n";
+    ASSERT_TRUE(actual == expected, "Declared column order, metric value kept");
+}
+
+TEST(joined_roundtrip) {
+    std::string path = temp_path("joined");
+    FILE* fp = fopen(path.c_str(), "w+");
+    rpv3::binary::Writer writer;
+    writer.begin(fp, 50, rpv3::binary::kFlagBlasColumns);
+    uint32_t gemm = writer.intern("Cijk_Ailk_Bljk_SB_MT64x64x16");
+    uint32_t add = writer.intern("vector_add");
+    uint32_t waves = writer.intern("SQ_WAVES");
+    unsigned char buffer[rpv3::binary::kRecordSize];
+    writer.encode_column(waves, 0, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+
+    /* --timeline --rocblas with counters: a library dispatch is written with
+     * its counter values, then its log line */
+    Record dispatch = make_dispatch(gemm, 1, 100, 1100);
+    writer.encode(dispatch, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    rpv3::binary::CounterValue value;
+    value.dispatch_id = 1;
+    value.agent_id = 3;
+    value.name_id = waves;
+    value.instances = 2;
+    value.value = 64.0;
+    writer.encode(value, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    Record note;
+    note.kind = rpv3::binary::kRecordAnnotation;
+    note.string_id = writer.intern("rocblas_sgemm,N,N,64,64,64");
+    note.dispatch.dispatch_id = 1;
+    writer.encode(note, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    rpv3::binary::BlasRecord blas;
+    blas.dispatch_id = 1;
+    blas.call.family = rpv3::BlasFamily::Gemm;
+    blas.call.function = "gemm";
+    blas.call.precision = "f32_r";
+    blas.call.m = blas.call.n = blas.call.k = 64;
+    writer.encode(blas, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+
+    /* Not counted */
+    Record other = make_dispatch(add, 2, 2000, 2500);
+    writer.encode(other, buffer);
+    fwrite(buffer, 1, sizeof(buffer), fp);
+    writer.finish(fp);
+    fclose(fp);
+
+    rpv3::binary::Reader reader;
+    ASSERT_TRUE(reader.open(path.c_str()), "Reader accepts the trace");
+    FILE* csv = tmpfile();
+    rpv3::binary::write_joined_csv(reader, csv);
+    std::string actual = read_file(csv);
+    fclose(csv);
+
+    const rpv3::BlasWork work = rpv3::blas_work(blas.call);
+    rpv3::RecordBuffer expected;
+    expected.append(rpv3::joined_csv_header(true, {"SQ_WAVES"}));
+    rpv3::format_csv_fields(expected, "Cijk_Ailk_Bljk_SB_MT64x64x16", dispatch.dispatch, 50);
+    rpv3::format_csv_blas_fields(expected, &blas.call, rpv3::achieved_tflops(work, 1000),
+                                 rpv3::achieved_gbps(work, 1000));
+    expected.append(",64\n# rocblas_sgemm,N,N,64,64,64\n");
+    rpv3::format_csv_fields(expected, "vector_add", other.dispatch, 50);
+    rpv3::format_csv_blas_fields(expected, nullptr, 0.0, 0.0);
+    expected.append(",\n");
+    ASSERT_TRUE(actual == std::string(expected.data(), expected.size()),
+                "Timeline, BLAS and counter columns in one row, line after it");
+
+    csv = tmpfile();
+    rpv3::binary::write_counter_csv(reader, csv);
+    actual = read_file(csv);
+    fclose(csv);
+    unlink(path.c_str());
+    ASSERT_TRUE(actual.find("\"Cijk_Ailk_Bljk_SB_MT64x64x16\",1,") != std::string::npos &&
+                    actual.find("vector_add") == std::string::npos,
+                "Counter rows alone: the counted dispatch only");
+}
+
+TEST(rejects_truncated) {
+    std::string path = temp_path("truncated");
+    FILE* fp = fopen(path.c_str(), "w+");
+    write_trace(fp, 0);
+    fflush(fp);
+    long size = ftell(fp);
+    fclose(fp);
+    ASSERT_EQUALS(0, truncate(path.c_str(), size - 10), "Truncate trace");
+
+    rpv3::binary::Reader reader;
+    ASSERT_TRUE(!reader.open(path.c_str()), "Trace without footer is rejected");
+    ASSERT_TRUE(!reader.error().empty(), "Reader reports an error message");
+
+    ASSERT_TRUE(!reader.open("/nonexistent/trace.rpv3"), "Missing file is rejected");
+    unlink(path.c_str());
+}
+
+int main() {
+    test_banner("RPV3 Binary Format Unit Tests");
+
+    run_test_encode_decode();
+    run_test_intern_deduplicates();
+    run_test_csv_roundtrip();
+    run_test_header_patched();
+    run_test_mangled_names();
+    run_test_blas_columns();
+    run_test_counter_values();
+    run_test_counter_metric_roundtrip();
+    run_test_joined_roundtrip();
+    run_test_rejects_truncated();
+
+    return test_summary("RPV3 Binary Format");
+}
@@ -0,0 +1,127 @@
+/* MIT License
+ * Unit tests for rpv3_blas_bench.cpp
+ */
+
+#include "../rpv3_blas_bench.h"
+#include "test_utils.h"
+
+#include <cstdio>
+#include <limits>
+#include <string>
+
+using rpv3::BlasCall;
+
+namespace {
+
+BlasCall parse(const char* line) {
+    BlasCall call;
+    rpv3::parse_blas_call(line, call);
+    return call;
+}
+
+bool contains(const std::string& text, const char* part) {
+    return text.find(part) != std::string::npos;
+}
+
+} // namespace
+
+TEST(gemm_command) {
+    BlasCall call = parse("rocblas_sgemm,N,T,1024,512,256,1,0x7f00,1024,0x7f01,512,0,0x7f02,1024");
+    std::string command = rpv3::bench_command(call);
+    ASSERT_TRUE(command == "rocblas-bench -f gemm -r f32_r --transposeA N --transposeB T -m 1024 -n 512 -k 256"
+                           " --alpha 1 --lda 1024 --ldb 512 --beta 0 --ldc 1024",
+                "Trace line to command");
+
+    // The command is a bench-layer line, so it parses back to the same call
+    BlasCall again = parse(command.c_str());
+    ASSERT_TRUE(rpv3::bench_command(again) == command, "Command round-trips through the parser");
+}
+
+TEST(ex_and_batched_command) {
+    BlasCall call = parse("./rocblas-bench -f gemm_strided_batched_ex --transposeA N --transposeB N -m 128 -n 128 -k 64"
+                          " --alpha 1 --a_type f16_r --lda 128 --stride_a 8192 --b_type f16_r --ldb 64"
+                          " --stride_b 8192 --beta 0 --c_type f16_r --ldc 128 --stride_c 16384 --d_type f16_r"
+                          " --ldd 128 --stride_d 16384 --batch_count 16 --compute_type f32_r");
+    std::string command = rpv3::bench_command(call);
+    ASSERT_TRUE(contains(command, "-f gemm_strided_batched_ex --a_type f16_r --b_type f16_r --c_type f16_r"
+                                  " --d_type f16_r --compute_type f32_r"), "_ex types instead of -r");
+    ASSERT_TRUE(contains(command, "--ldd 128 --stride_d 16384 --batch_count 16"), "D follows C, batches kept");
+
+    std::string yaml = rpv3::bench_yaml(call);
+    ASSERT_TRUE(contains(yaml, "{ rocblas_function: \"rocblas_gemm_strided_batched_ex\", a_type: \"f16_r\""),
+                "_ex routine name has no precision prefix");
+    ASSERT_TRUE(contains(yaml, "compute_type: \"f32_r\", transA: \"N\""), "Strings quoted");
+    ASSERT_TRUE(contains(yaml, "M: 128, N: 128, K: 64"), "Numbers unquoted");
+}
+
+TEST(mixed_datatypes) {
+    BlasCall call = parse("rocblas_gemm_ex,N,T,1024,1024,512,1,0x1,i8_r,1024,0x2,i8_r,1024,0,0x3,i32_r,1024,"
+                          "0x4,i32_r,1024,i32_r,rocblas_gemm_algo_standard,0,none");
+    std::string command = rpv3::bench_command(call);
+    ASSERT_TRUE(contains(command, "--a_type i8_r --b_type i8_r --c_type i32_r --d_type i32_r --compute_type i32_r"),
+                "int8 inputs, int32 output");
+    ASSERT_TRUE(contains(rpv3::bench_yaml(call), "b_type: \"i8_r\", c_type: \"i32_r\", d_type: \"i32_r\""),
+                "Same types in the YAML");
+}
+
+TEST(gemv_and_trsm_yaml) {
+    BlasCall gemv = parse("rocblas_dgemv,T,1000,500,2,0x7f00,1000,0x7f01,1,0.5,0x7f02,1");
+    std::string yaml = rpv3::bench_yaml(gemv);
+    ASSERT_TRUE(contains(yaml, "rocblas_function: \"rocblas_dgemv\""), "Precision prefix restored");
+    ASSERT_TRUE(contains(yaml, "incx: 1, beta: 0.5, incy: 1"), "gemv increments");
+    ASSERT_TRUE(!contains(yaml, "ldb"), "No ldb for gemv");
+
+    BlasCall trsm = parse("rocblas_strsm,L,U,N,N,256,128,1,0x7f00,256,0x7f01,256");
+    std::string command = rpv3::bench_command(trsm);
+    ASSERT_TRUE(contains(command, "--side L --uplo U --transposeA N --diag N -m 256 -n 128"), "trsm flags");
+    ASSERT_TRUE(!contains(command, " -k "), "No K for trsm");
+
+    gemv.alpha = std::numeric_limits<double>::quiet_NaN();
+    ASSERT_TRUE(!contains(rpv3::bench_command(gemv), "--alpha"), "Device-pointer alpha left out");
+}
+
+TEST(dedupe_and_rank) {
+    rpv3::BlasBenchTable table;
+    BlasCall small = parse("rocblas_sgemm,N,N,64,64,64,1,0x1,64,0x2,64,0,0x3,64");
+    BlasCall big = parse("rocblas_sgemm,N,N,4096,4096,4096,1,0x1,4096,0x2,4096,0,0x3,4096");
+    BlasCall beta = parse("rocblas_sgemm,N,N,64,64,64,1,0x1,64,0x2,64,1,0x3,64");
+    for (int i = 0; i < 100; i++) {
+        table.record(small, 1000);
+    }
+    table.record(big, 500000);
+    table.record(big, 500000);
+    table.record(beta, 1000);
+    table.record(parse("rocblas_strsm,L,U,N,N,2048,2048,1,0x7f00,2048,0x7f01,2048"), 1000000);
+
+    std::vector<rpv3::BenchRow> rows = table.rows();
+    ASSERT_EQUALS(3, (int)rows.size(), "Distinct argument lists, beta included, trsm dispatches left out");
+    ASSERT_TRUE(rows[0].call.m == 4096 && rows[0].count == 2, "Most GPU time first");
+    ASSERT_EQUALS(100, (int)rows[1].count, "Repeated calls counted once");
+    ASSERT_EQUALS(100000, (int)rows[1].total_ns, "Total time");
+
+    FILE* out = tmpfile();
+    ASSERT_TRUE(rpv3::write_bench_yaml(out, rows), "Write succeeds");
+    rewind(out);
+    std::string text;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), out)) > 0) {
+        text.append(chunk, n);
+    }
+    fclose(out);
+    ASSERT_TRUE(contains(text, "# 1. 2 calls, 1.000 ms GPU time (90.8%), 500.000 us mean\n"
+                               "#    rocblas-bench -f gemm -r f32_r"), "Ranked comment with the command");
+    ASSERT_TRUE(contains(text, "\n- { rocblas_function: \"rocblas_sgemm\""), "YAML list entry");
+}
+
+int main() {
+    test_banner("RPV3 BLAS Bench Unit Tests");
+
+    run_test_gemm_command();
+    run_test_ex_and_batched_command();
+    run_test_mixed_datatypes();
+    run_test_gemv_and_trsm_yaml();
+    run_test_dedupe_and_rank();
+
+    return test_summary("RPV3 BLAS Bench");
+}
@@ -0,0 +1,132 @@
+/* MIT License
+ * Unit tests for rpv3_blas_parser.cpp
+ */
+
+#include "../rpv3_blas_parser.h"
+#include "test_utils.h"
+
+#include <cmath>
+
+using rpv3::BlasCall;
+using rpv3::BlasFamily;
+using rpv3::kBlasNone;
+using rpv3::parse_blas_call;
+
+TEST(trace_gemm) {
+    BlasCall call;
+    ASSERT_TRUE(parse_blas_call("rocblas_sgemm,N,T,1024,512,256,1,0x7f00a000,1024,0x7f00b000,512,0,0x7f00c000,1024,atomics_allowed",
+                                call), "sgemm trace line parses");
+    ASSERT_TRUE(call.family == BlasFamily::Gemm && call.function == "gemm", "Routine without precision");
+    ASSERT_TRUE(call.precision == "f32_r" && call.compute_type == "f32_r", "Precision from the prefix");
+    ASSERT_TRUE(call.trans_a == 'N' && call.trans_b == 'T', "Transpose flags");
+    ASSERT_TRUE(call.m == 1024 && call.n == 512 && call.k == 256, "M, N, K");
+    ASSERT_TRUE(call.lda == 1024 && call.ldb == 512 && call.ldc == 1024, "Leading dimensions");
+    ASSERT_TRUE(call.alpha == 1.0 && call.beta == 0.0, "Host scalars");
+    ASSERT_TRUE(call.stride_a == kBlasNone && call.batch_count == 1, "Not batched");
+}
+
+TEST(trace_strided_batched) {
+    BlasCall call;
+    ASSERT_TRUE(parse_blas_call("# rocblas_dgemm_strided_batched,T,N,64,64,32,0x7f0010,0x7f0020,32,2048,0x7f0030,32,2048,0x7f0040,0x7f0050,64,4096,16",
+                                call), "Annotation form with device pointer scalars parses");
+    ASSERT_TRUE(call.function == "gemm_strided_batched" && call.precision == "f64_r", "Routine and precision");
+    ASSERT_TRUE(call.stride_a == 2048 && call.stride_b == 2048 && call.stride_c == 4096, "Strides");
+    ASSERT_TRUE(call.batch_count == 16, "Batch count");
+    ASSERT_TRUE(std::isnan(call.alpha) && std::isnan(call.beta), "Device pointer scalars have no value");
+}
+
+TEST(trace_gemm_ex) {
+    BlasCall call;
+    ASSERT_TRUE(parse_blas_call("rocblas_gemm_ex,N,N,4096,4096,4096,1,0x1,f16_r,4096,0x2,f16_r,4096,0,0x3,f16_r,4096,0x4,f16_r,4096,f32_r,rocblas_gemm_algo_standard,0,none",
+                                call), "gemm_ex trace line parses");
+    ASSERT_TRUE(call.function == "gemm_ex" && call.precision == "f16_r", "Datatype of A");
+    ASSERT_TRUE(call.compute_type == "f32_r", "Compute type");
+    ASSERT_TRUE(call.m == 4096 && call.k == 4096 && call.ldc == 4096, "Dimensions");
+
+    ASSERT_TRUE(parse_blas_call("rocblas_gemm_strided_batched_ex,T,N,128,256,64,1,0x1,bf16_r,64,8192,0x2,bf16_r,64,16384,0,0x3,f32_r,128,32768,0x4,f32_r,128,32768,8,f32_r,rocblas_gemm_algo_standard,0,none",
+                                call), "gemm_strided_batched_ex trace line parses");
+    ASSERT_TRUE(call.precision == "bf16_r" && call.stride_b == 16384 && call.batch_count == 8, "Batched _ex fields");
+    ASSERT_TRUE(call.b_type == "bf16_r" && call.c_type == "f32_r" && call.d_type == "f32_r", "Strided B, C and D types");
+
+    ASSERT_TRUE(parse_blas_call("rocblas_gemm_ex,N,T,1024,1024,512,1,0x1,i8_r,1024,0x2,i8_r,1024,0,0x3,i32_r,1024,0x4,i32_r,1024,i32_r,rocblas_gemm_algo_standard,0,none",
+                                call), "int8 gemm_ex trace line parses");
+    ASSERT_TRUE(call.precision == "i8_r" && call.b_type == "i8_r", "int8 inputs");
+    ASSERT_TRUE(call.c_type == "i32_r" && call.d_type == "i32_r" && call.compute_type == "i32_r", "int32 output");
+
+    ASSERT_TRUE(parse_blas_call("rocblas_gemm_batched_ex,N,N,64,64,64,1,0x1,i8_r,64,0x2,i8_r,64,0,0x3,i32_r,64,0x4,i32_r,64,4,i32_r,rocblas_gemm_algo_standard,0,none",
+                                call), "Batched int8 line parses");
+    ASSERT_TRUE(call.batch_count == 4 && call.c_type == "i32_r" && call.d_type == "i32_r", "Batched B, C and D types");
+}
+
+TEST(trace_trsm_and_gemv) {
+    BlasCall call;
+    ASSERT_TRUE(parse_blas_call("rocblas_strsm,L,U,N,N,256,128,1,0x1,256,0x2,256", call), "trsm trace line parses");
+    ASSERT_TRUE(call.family == BlasFamily::Trsm && call.side == 'L' && call.uplo == 'U', "Side and uplo");
+    ASSERT_TRUE(call.trans_a == 'N' && call.diag == 'N', "Transpose and diag");
+    ASSERT_TRUE(call.m == 256 && call.n == 128 && call.k == kBlasNone, "trsm has no K");
+    ASSERT_TRUE(call.lda == 256 && call.ldb == 256 && call.ldc == kBlasNone, "trsm leading dimensions");
+
+    ASSERT_TRUE(parse_blas_call("rocblas_zgemv,C,1000,500,1,0x1,1000,0x2,1,0,0x3,2", call), "gemv trace line parses");
+    ASSERT_TRUE(call.family == BlasFamily::Gemv && call.precision == "f64_c", "Complex double gemv");
+    ASSERT_TRUE(call.trans_a == 'C' && call.m == 1000 && call.n == 500, "Transpose and size");
+    ASSERT_TRUE(call.ldb == 1 && call.ldc == 2, "incx and incy");
+}
+
+TEST(bench_lines) {
+    BlasCall call;
+    ASSERT_TRUE(parse_blas_call("./rocblas-bench -f gemm -r f32_r --transposeA N --transposeB T -m 1024 -n 512 -k 256 "
+                                "--alpha 1 --lda 1024 --ldb 512 --beta 0 --ldc 1024", call), "Bench gemm line parses");
+    ASSERT_TRUE(call.function == "gemm" && call.precision == "f32_r", "Routine and precision");
+    ASSERT_TRUE(call.trans_a == 'N' && call.trans_b == 'T' && call.m == 1024 && call.k == 256, "Shape");
+    ASSERT_TRUE(call.alpha == 1.0 && call.beta == 0.0, "Scalars");
+
+    BlasCall from_trace;
+    parse_blas_call("rocblas_sgemm,N,T,1024,512,256,1,0x1,1024,0x2,512,0,0x3,1024", from_trace);
+    ASSERT_TRUE(call.m == from_trace.m && call.lda == from_trace.lda && call.ldc == from_trace.ldc &&
+                call.trans_b == from_trace.trans_b, "Both layers give the same call");
+
+    ASSERT_TRUE(parse_blas_call("rocblas-bench -f gemm_strided_batched_ex --transposeA N --transposeB N -m 64 -n 64 -k 64 "
+                                "--a_type f16_r --b_type f16_r --c_type f16_r --d_type f16_r --compute_type f32_r "
+                                "--lda 64 --stride_a 4096 --ldb 64 --stride_b 4096 --ldc 64 --stride_c 4096 "
+                                "--batch_count 32 --algo 0 --solution_index 0 --flags 0", call),
+                "Bench strided_batched_ex line parses");
+    ASSERT_TRUE(call.precision == "f16_r" && call.compute_type == "f32_r", "Datatypes");
+    ASSERT_TRUE(call.stride_c == 4096 && call.batch_count == 32, "Batch fields");
+
+    ASSERT_TRUE(parse_blas_call("rocblas-bench -f gemm_ex --transposeA N --transposeB N -m 64 -n 64 -k 64 "
+                                "--a_type i8_r --b_type i8_r --c_type i32_r --d_type i32_r --compute_type i32_r "
+                                "--lda 64 --ldb 64 --ldc 64 --ldd 64", call), "Bench int8 gemm_ex line parses");
+    ASSERT_TRUE(call.precision == "i8_r" && call.b_type == "i8_r" && call.c_type == "i32_r" && call.d_type == "i32_r",
+                "Bench B, C and D types");
+
+    ASSERT_TRUE(parse_blas_call("./rocblas-bench -f gemv -r f64_r --transposeA T -m 300 -n 200 --alpha 2 --lda 300 --incx 1 --beta 1 --incy 1",
+                                call), "Bench gemv line parses");
+    ASSERT_TRUE(call.family == BlasFamily::Gemv && call.ldb == 1 && call.k == kBlasNone, "gemv fields");
+}
+
+TEST(rejects) {
+    BlasCall call;
+    call.m = 42;
+    ASSERT_TRUE(!parse_blas_call("", call), "Empty line");
+    ASSERT_TRUE(!parse_blas_call("rocblas_create_handle,atomics_allowed", call), "Bookkeeping line");
+    ASSERT_TRUE(!parse_blas_call("rocblas_saxpy,1024,1,0x1,1,0x2,1", call), "Unsupported routine");
+    ASSERT_TRUE(!parse_blas_call("rocblas_qgemm,N,N,1,1,1", call), "Unknown precision prefix");
+    ASSERT_TRUE(!parse_blas_call("rocblas_sgemm,N,N,64,abc,64,1,0x1,64,0x2,64,0,0x3,64", call), "Bad dimension");
+    ASSERT_TRUE(!parse_blas_call("rocblas_sgemm,N,N,64", call), "Truncated line");
+    ASSERT_TRUE(!parse_blas_call("./rocblas-bench -f gemm -r f32_r -m 64", call), "Bench line without N and K");
+    ASSERT_TRUE(!parse_blas_call("Cijk_Ailk_Bljk_SB_MT64x64x16", call), "Kernel name");
+    ASSERT_EQUALS(42, (int)call.m, "Failed parses leave the call untouched");
+}
+
+int main() {
+    test_banner("RPV3 BLAS Parser Unit Tests");
+
+    run_test_trace_gemm();
+    run_test_trace_strided_batched();
+    run_test_trace_gemm_ex();
+    run_test_trace_trsm_and_gemv();
+    run_test_bench_lines();
+    run_test_rejects();
+
+    return test_summary("RPV3 BLAS Parser");
+}
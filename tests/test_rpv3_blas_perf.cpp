@@ -0,0 +1,203 @@
+/* MIT License
+ * Unit tests for rpv3_blas_perf.cpp
+ */
+
+#include "../rpv3_blas_perf.h"
+#include "test_utils.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+using rpv3::BlasCall;
+using rpv3::BlasFamily;
+using rpv3::BlasWork;
+
+namespace {
+
+BlasCall gemm(const char* precision, int64_t m, int64_t n, int64_t k) {
+    BlasCall call;
+    call.family = BlasFamily::Gemm;
+    call.function = "gemm";
+    call.precision = precision;
+    call.compute_type = precision;
+    call.trans_a = 'N';
+    call.trans_b = 'N';
+    call.m = m;
+    call.n = n;
+    call.k = k;
+    return call;
+}
+
+bool near(double a, double b) {
+    return std::fabs(a - b) <= 1e-9 * std::fabs(b);
+}
+
+} // namespace
+
+TEST(element_bytes) {
+    ASSERT_EQUALS(2, (int)rpv3::blas_element_bytes("f16_r"), "Half");
+    ASSERT_EQUALS(2, (int)rpv3::blas_element_bytes("bf16_r"), "bfloat16");
+    ASSERT_EQUALS(8, (int)rpv3::blas_element_bytes("f32_c"), "Complex float");
+    ASSERT_EQUALS(16, (int)rpv3::blas_element_bytes("f64_c"), "Complex double");
+    ASSERT_EQUALS(0, (int)rpv3::blas_element_bytes("f128_r"), "Unknown datatype");
+}
+
+TEST(gemm_work) {
+    BlasCall call = gemm("f32_r", 1024, 512, 256);
+    BlasWork work = rpv3::blas_work(call);
+    ASSERT_TRUE(near(work.flops, 2.0 * 1024 * 512 * 256), "2MNK FLOPs");
+    ASSERT_TRUE(near(work.bytes, (1024.0 * 256 + 256.0 * 512 + 1024.0 * 512) * 4), "A and B read, C written");
+
+    call.beta = 1.0;
+    ASSERT_TRUE(near(rpv3::blas_work(call).bytes, (1024.0 * 256 + 256.0 * 512 + 2 * 1024.0 * 512) * 4),
+                "C also read when beta is non-zero");
+
+    call.batch_count = 8;
+    ASSERT_TRUE(near(rpv3::blas_work(call).flops, 8 * 2.0 * 1024 * 512 * 256), "Batches multiply the work");
+
+    BlasCall complex = gemm("f64_c", 64, 64, 64);
+    ASSERT_TRUE(near(rpv3::blas_work(complex).flops, 8.0 * 64 * 64 * 64), "Complex multiply-add is 8 FLOPs");
+
+    ASSERT_TRUE(rpv3::blas_work(gemm("f32_r", 64, 64, rpv3::kBlasNone)).flops == 0.0, "Missing K gives no work");
+    ASSERT_TRUE(rpv3::blas_work(gemm("x", 64, 64, 64)).flops == 0.0, "Unknown datatype gives no work");
+}
+
+TEST(trsm_and_gemv_work) {
+    BlasCall trsm;
+    trsm.family = BlasFamily::Trsm;
+    trsm.precision = "f64_r";
+    trsm.side = 'L';
+    trsm.m = 256;
+    trsm.n = 128;
+    BlasWork work = rpv3::blas_work(trsm);
+    ASSERT_TRUE(near(work.flops, 256.0 * 256 * 128), "Left trsm is M^2 N");
+    ASSERT_TRUE(near(work.bytes, (256.0 * 257 / 2 + 2 * 256.0 * 128) * 8), "Triangle read, B read and written");
+    trsm.side = 'R';
+    ASSERT_TRUE(near(rpv3::blas_work(trsm).flops, 128.0 * 128 * 256), "Right trsm is M N^2");
+
+    BlasCall gemv;
+    gemv.family = BlasFamily::Gemv;
+    gemv.precision = "f32_r";
+    gemv.trans_a = 'T';
+    gemv.m = 1000;
+    gemv.n = 500;
+    work = rpv3::blas_work(gemv);
+    ASSERT_TRUE(near(work.flops, 2.0 * 1000 * 500), "gemv is 2MN");
+    ASSERT_TRUE(near(work.bytes, (1000.0 * 500 + 1000 + 500) * 4), "Transposed: x has M elements, y has N");
+}
+
+TEST(rates_and_peak) {
+    BlasWork work;
+    work.flops = 2e12;
+    work.bytes = 4e9;
+    ASSERT_TRUE(near(rpv3::achieved_tflops(work, 1000000000), 2.0), "2e12 FLOPs in 1 s is 2 TFLOP/s");
+    ASSERT_TRUE(near(rpv3::achieved_gbps(work, 1000000000), 4.0), "4e9 bytes in 1 s is 4 GB/s");
+    ASSERT_TRUE(rpv3::achieved_tflops(work, 0) == 0.0, "Unknown duration gives no rate");
+    ASSERT_TRUE(near(rpv3::estimate_peak_tflops("gfx942", "f16_r", 304, 2100), 1307.4432), "MI300X f16 matrix peak");
+    ASSERT_TRUE(near(rpv3::estimate_peak_tflops("gfx942", "f64_c", 304, 2100), 163.4304), "Complex uses its real type");
+    ASSERT_TRUE(near(rpv3::estimate_peak_tflops("gfx90a:sramecc+:xnack-", "bf16_r", 104, 1700), 181.0432),
+                "Feature suffix ignored");
+    ASSERT_TRUE(rpv3::estimate_peak_tflops("gfx1100", "f16_r", 48, 2500) == 0.0, "Unknown target");
+    ASSERT_TRUE(rpv3::estimate_peak_tflops("gfx908", "f8_r", 120, 1502) == 0.0, "No f8 on gfx908");
+
+    rpv3::BlasPeak peak;
+    peak.target = "gfx942";
+    peak.cu_count = 304;
+    peak.clock_mhz = 2100;
+    ASSERT_TRUE(near(peak.tflops_for("f32_r"), 163.4304), "Estimated per datatype");
+    peak.tflops = 500.0;
+    ASSERT_TRUE(near(peak.tflops_for("f32_r"), 500.0), "--peak-tflops applies to every type");
+}
+
+std::string print_table(const std::vector<rpv3::BlasShapeRow>& rows, const rpv3::BlasPeak& peak) {
+    FILE* out = tmpfile();
+    rpv3::print_blas_efficiency(out, rows, peak);
+    rewind(out);
+    std::string text;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), out)) > 0) {
+        text.append(chunk, n);
+    }
+    fclose(out);
+    return text;
+}
+
+TEST(efficiency_table) {
+    rpv3::BlasEfficiencyTable table;
+    BlasCall big = gemm("f16_r", 4096, 4096, 4096);
+    BlasCall small = gemm("f16_r", 64, 64, 64);
+    const double big_flops = 2.0 * 4096 * 4096 * 4096;
+
+    // Three durations: 100, 200 and 400 us
+    table.record(big, 100000);
+    table.record(big, 400000);
+    table.record(big, 200000);
+    table.record(small, 5000);
+    table.record(small, 0);  // Ignored
+    BlasCall unknown = gemm("f16_r", 64, 64, rpv3::kBlasNone);
+    table.record(unknown, 5000);  // Ignored
+    BlasCall trsm;
+    trsm.family = BlasFamily::Trsm;
+    trsm.function = "trsm";
+    trsm.precision = "f32_r";
+    trsm.side = 'L';
+    trsm.m = 2048;
+    trsm.n = 2048;
+    table.record(trsm, 5000);  // Ignored: one of its several dispatches
+
+    std::vector<rpv3::BlasShapeRow> rows = table.rows();
+    ASSERT_EQUALS(2, (int)rows.size(), "One row per shape with work");
+    ASSERT_TRUE(rows[0].m == 4096 && rows[0].count == 3, "Most GPU time first");
+    ASSERT_EQUALS(700000, (int)rows[0].total_ns, "Total time");
+    ASSERT_TRUE(near(rows[0].max_tflops, big_flops / 100000 / 1000), "Max is the fastest dispatch");
+    ASSERT_TRUE(near(rows[0].min_tflops, big_flops / 400000 / 1000), "Min is the slowest dispatch");
+    double median = big_flops / 200000 / 1000;
+    ASSERT_TRUE(std::fabs(rows[0].median_tflops - median) <= 0.04 * median, "Median within a bucket");
+    ASSERT_EQUALS(1, (int)rows[1].count, "Zero-duration dispatch not counted");
+
+    rpv3::BlasPeak peak;
+    peak.tflops = 1000.0;
+    std::string text = print_table(rows, peak);
+    ASSERT_TRUE(text.find("% of 1000.0 TFLOP/s peak") != std::string::npos, "Peak in the title");
+    ASSERT_TRUE(text.find("Median %") != std::string::npos, "Efficiency columns");
+    ASSERT_TRUE(text.find("gemm                     f16_r       4096     4096     4096          3") != std::string::npos,
+                "Shape row");
+
+    // Estimated peaks: each row against its own type, unknown types left blank
+    rows[1].precision = "f32_r";
+    BlasCall odd = gemm("u8_r", 128, 128, 128);
+    rpv3::BlasEfficiencyTable odd_table;
+    odd_table.record(odd, 1000);
+    ASSERT_EQUALS(1, (int)odd_table.rows().size(), "u8 has an element size");
+    rows.push_back(odd_table.rows()[0]);
+    peak = rpv3::BlasPeak();
+    peak.target = "gfx942";
+    peak.cu_count = 304;
+    peak.clock_mhz = 2100;
+    text = print_table(rows, peak);
+    ASSERT_TRUE(text.find("% of the gfx942 dense peak of each type") != std::string::npos, "Target in the title");
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%9.2f", rows[0].median_tflops * 100.0 / 1307.4432);
+    ASSERT_TRUE(text.find(expected) != std::string::npos, "f16 row against the f16 peak");
+    snprintf(expected, sizeof(expected), "%9.2f", rows[1].median_tflops * 100.0 / 163.4304);
+    ASSERT_TRUE(text.find(expected) != std::string::npos, "f32 row against the f32 peak");
+    ASSERT_TRUE(text.find("        -         -         -\n") != std::string::npos, "No peak for u8");
+
+    // No peak at all: achieved rates only
+    text = print_table(rows, rpv3::BlasPeak());
+    ASSERT_TRUE(text.find("achieved TFLOP/s (peak unknown)") != std::string::npos, "Unknown peak");
+}
+
+int main() {
+    test_banner("RPV3 BLAS Perf Unit Tests");
+
+    run_test_element_bytes();
+    run_test_gemm_work();
+    run_test_trsm_and_gemv_work();
+    run_test_rates_and_peak();
+    run_test_efficiency_table();
+
+    return test_summary("RPV3 BLAS Perf");
+}
@@ -0,0 +1,257 @@
+/* MIT License
+ * Unit tests for rpv3_counter_catalog.cpp
+ */
+
+#include "../rpv3_counter_catalog.h"
+#include "test_utils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+using rpv3::CatalogCounter;
+using rpv3::CounterCatalog;
+
+namespace {
+
+/* Stand-in for rocprofiler agent enumeration: what each GPU reports, and
+ * how many times its counters were queried */
+struct MockAgent {
+    const char* product;
+    const char* target;
+    std::vector<CatalogCounter> counters;
+    int queries = 0;
+};
+
+std::vector<MockAgent> mock_node() {
+    std::vector<CatalogCounter> mi210 = {
+        {"SQ_WAVES", 11}, {"SQ_INSTS_VALU", 12}, {"SQ_INSTS_SALU", 13}, {"TCC_EA_RDREQ_sum", 40}};
+    std::vector<MockAgent> agents;
+    for (int i = 0; i < 8; i++) {
+        agents.push_back(MockAgent{"AMD Instinct MI210", "gfx90a", mi210});
+    }
+    agents.push_back(MockAgent{"AMD Radeon PRO W7900", "gfx1100", {{"SQ_WAVES", 7}, {"GRBM_COUNT", 3}}});
+    return agents;
+}
+
+std::string key_of(const MockAgent& agent, const char* version = "0.6.0") {
+    return rpv3::counter_catalog_key(agent.product, agent.target, version);
+}
+
+/* What the tracer does per agent at setup */
+void setup_agents(CounterCatalog& catalog, std::vector<MockAgent>& agents, const char* version = "0.6.0") {
+    for (MockAgent& agent : agents) {
+        catalog.counters(key_of(agent, version), [&agent]() {
+            agent.queries++;
+            return agent.counters;
+        });
+    }
+}
+
+int total_queries(const std::vector<MockAgent>& agents) {
+    int total = 0;
+    for (const MockAgent& agent : agents) {
+        total += agent.queries;
+    }
+    return total;
+}
+
+/* Profiles hold two counters; counter 3 is rejected outright */
+CounterCatalog::Fits two_per_pass(int& calls) {
+    return [&calls](const std::vector<size_t>& pass) {
+        calls++;
+        for (size_t i : pass) {
+            if (i == 3) {
+                return false;
+            }
+        }
+        return pass.size() <= 2;
+    };
+}
+
+std::string temp_dir() {
+    char dir[] = "/tmp/rpv3_catalog_XXXXXX";
+    return mkdtemp(dir) ? std::string(dir) : std::string();
+}
+
+void write_file(const std::string& path, const char* text) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file) {
+        fputs(text, file);
+        fclose(file);
+    }
+}
+
+} // namespace
+
+TEST(one_query_per_agent_kind) {
+    std::vector<MockAgent> agents = mock_node();
+    CounterCatalog catalog;
+    setup_agents(catalog, agents);
+    ASSERT_EQUALS(2, total_queries(agents), "Nine GPUs of two kinds query twice");
+    ASSERT_EQUALS(1, agents[0].queries, "First MI210 queried");
+    ASSERT_EQUALS(0, agents[7].queries, "Other MI210s share its entry");
+    ASSERT_EQUALS(2, (int)catalog.size(), "One entry per kind");
+    ASSERT_TRUE(catalog.dirty(), "New entries need saving");
+
+    uint64_t id = 0;
+    ASSERT_TRUE(catalog.find(key_of(agents[0]), "SQ_INSTS_SALU", id) && id == 13, "Name resolves to its id");
+    ASSERT_TRUE(catalog.find(key_of(agents[8]), "SQ_WAVES", id) && id == 7, "Per-kind ids");
+    ASSERT_TRUE(!catalog.find(key_of(agents[8]), "SQ_INSTS_VALU", id), "Counter the agent lacks");
+    ASSERT_TRUE(!catalog.find("unknown|gfx000|0.6.0", "SQ_WAVES", id), "Agent kind never queried");
+
+    const std::vector<CatalogCounter>& counters = catalog.counters(key_of(agents[0]), nullptr);
+    ASSERT_TRUE(counters.front().name == "SQ_INSTS_SALU" && counters.back().name == "TCC_EA_RDREQ_sum",
+                "Catalog sorted by name");
+}
+
+TEST(plans_cached) {
+    std::vector<MockAgent> agents = mock_node();
+    CounterCatalog catalog;
+    setup_agents(catalog, agents);
+    const std::string key = key_of(agents[0]);
+    const std::vector<std::string> names = {"SQ_WAVES", "SQ_INSTS_VALU", "SQ_INSTS_SALU", "GRBM_COUNT"};
+
+    int calls = 0;
+    bool planned = false;
+    const rpv3::CounterPlan& plan = catalog.plan(key, names, two_per_pass(calls), &planned);
+    ASSERT_TRUE(planned, "First plan is made");
+    ASSERT_TRUE(calls > 0, "Made with trial profiles");
+    ASSERT_EQUALS(2, (int)plan.passes.size(), "Three counters in two passes");
+    ASSERT_TRUE(plan.rejected.size() == 1 && plan.rejected[0] == 3, "Fourth counter rejected");
+
+    const int first_calls = calls;
+    catalog.plan(key, names, two_per_pass(calls), &planned);
+    ASSERT_TRUE(!planned && calls == first_calls, "Same list on another agent: no trials");
+
+    catalog.plan(key, {"SQ_WAVES"}, two_per_pass(calls), &planned);
+    ASSERT_TRUE(planned, "Another list is planned on its own");
+}
+
+TEST(round_trip) {
+    const std::string dir = temp_dir();
+    ASSERT_TRUE(!dir.empty(), "Temporary directory");
+    const std::string path = dir + "/cache/rpv3/counter-catalog";
+    const std::vector<std::string> names = {"SQ_WAVES", "SQ_INSTS_VALU", "SQ_INSTS_SALU", "GRBM_COUNT"};
+
+    {
+        std::vector<MockAgent> agents = mock_node();
+        CounterCatalog catalog;
+        ASSERT_TRUE(!catalog.load(path), "No file on the first run");
+        setup_agents(catalog, agents);
+        int calls = 0;
+        catalog.plan(key_of(agents[0]), names, two_per_pass(calls));
+        std::string error;
+        ASSERT_TRUE(catalog.save(path, &error), "Saved, directories created");
+        ASSERT_TRUE(!catalog.dirty(), "Clean after saving");
+    }
+
+    /* A later run on the same node */
+    std::vector<MockAgent> agents = mock_node();
+    CounterCatalog catalog;
+    std::string error;
+    ASSERT_TRUE(catalog.load(path, &error), "Cache loads");
+    setup_agents(catalog, agents);
+    ASSERT_EQUALS(0, total_queries(agents), "Nothing queried");
+    ASSERT_TRUE(!catalog.dirty(), "Nothing to save");
+    ASSERT_TRUE(catalog.loaded(key_of(agents[0])), "Catalog from disk");
+
+    uint64_t id = 0;
+    ASSERT_TRUE(catalog.find(key_of(agents[0]), "TCC_EA_RDREQ_sum", id) && id == 40, "Ids survive");
+    int calls = 0;
+    bool planned = true;
+    const rpv3::CounterPlan& plan = catalog.plan(key_of(agents[0]), names, two_per_pass(calls), &planned);
+    ASSERT_TRUE(!planned && calls == 0, "Plan from disk, no trials");
+    ASSERT_TRUE(plan.passes.size() == 2 && plan.passes[0] == std::vector<size_t>({0, 1}) &&
+                    plan.passes[1] == std::vector<size_t>({2}),
+                "Passes survive");
+    ASSERT_TRUE(plan.rejected == std::vector<size_t>({3}), "Rejected counters survive");
+
+    /* A ROCm upgrade changes the key */
+    setup_agents(catalog, agents, "0.7.0");
+    ASSERT_EQUALS(2, total_queries(agents), "New release queried again");
+    ASSERT_TRUE(!catalog.loaded(key_of(agents[0], "0.7.0")), "Queried, not loaded");
+    ASSERT_TRUE(catalog.save(path), "Saved again");
+
+    CounterCatalog reloaded;
+    reloaded.load(path);
+    ASSERT_EQUALS(4, (int)reloaded.size(), "Entries of both releases kept");
+
+    remove(path.c_str());
+    rmdir((dir + "/cache/rpv3").c_str());
+    rmdir((dir + "/cache").c_str());
+    rmdir(dir.c_str());
+}
+
+TEST(forget_stale) {
+    std::vector<MockAgent> agents = mock_node();
+    CounterCatalog catalog;
+    setup_agents(catalog, agents);
+    const std::string key = key_of(agents[0]);
+    catalog.forget(key);
+    agents[0].counters[0].id = 99;
+    setup_agents(catalog, agents);
+    ASSERT_EQUALS(2, agents[0].queries, "Forgotten entry queried again");
+    uint64_t id = 0;
+    catalog.find(key, agents[0].counters[0].name, id);
+    ASSERT_EQUALS(99, id, "Fresh ids replace the stale ones");
+}
+
+TEST(unusable_files) {
+    const std::string dir = temp_dir();
+    ASSERT_TRUE(!dir.empty(), "Temporary directory");
+    const std::string path = dir + "/counter-catalog";
+    CounterCatalog catalog;
+    std::string error = "x";
+
+    ASSERT_TRUE(!catalog.load(path, &error) && error.empty(), "Missing file is not an error");
+
+    write_file(path, "rpv3-counter-catalog 999\nagent a|b|c\n");
+    ASSERT_TRUE(!catalog.load(path, &error) && error.empty(), "Other format version quietly rebuilt");
+
+    write_file(path, "hello\n");
+    ASSERT_TRUE(!catalog.load(path, &error) && !error.empty(), "Not a catalog");
+
+    write_file(path, "rpv3-counter-catalog 1\nagent a|b|c\ncounter x SQ_WAVES\n");
+    ASSERT_TRUE(!catalog.load(path, &error) && !error.empty(), "Bad counter id");
+
+    write_file(path, "rpv3-counter-catalog 1\nagent a|b|c\ncounter 1 SQ_WAVES\nplan SQ_WAVES\npass 0 1\n");
+    ASSERT_TRUE(!catalog.load(path, &error) && !error.empty(), "Pass index past the plan's names");
+    ASSERT_EQUALS(0, (int)catalog.size(), "Left empty");
+
+    write_file(path, "rpv3-counter-catalog 1\nagent a|b|c\ncounter 2 SQ_WAVES\ncounter 1 GRBM_COUNT\n"
+                     "agent d|e|f\n");
+    ASSERT_TRUE(catalog.load(path, &error), "Valid file");
+    uint64_t id = 0;
+    ASSERT_TRUE(catalog.find("a|b|c", "SQ_WAVES", id) && id == 2, "Unsorted catalog still found");
+    int queries = 0;
+    catalog.counters("d|e|f", [&queries]() { queries++; return std::vector<CatalogCounter>(); });
+    ASSERT_EQUALS(0, queries, "Agent without counters is cached too");
+
+    remove(path.c_str());
+    rmdir(dir.c_str());
+}
+
+TEST(default_path) {
+    setenv("XDG_CACHE_HOME", "/xdg", 1);
+    setenv("HOME", "/home/user", 1);
+    ASSERT_TRUE(rpv3::default_counter_catalog_path() == "/xdg/rpv3/counter-catalog", "XDG cache directory");
+    unsetenv("XDG_CACHE_HOME");
+    ASSERT_TRUE(rpv3::default_counter_catalog_path() == "/home/user/.cache/rpv3/counter-catalog", "Under HOME");
+    unsetenv("HOME");
+    ASSERT_TRUE(rpv3::default_counter_catalog_path().empty(), "Nowhere to cache");
+}
+
+int main() {
+    test_banner("RPV3 Counter Catalog Unit Tests");
+
+    run_test_one_query_per_agent_kind();
+    run_test_plans_cached();
+    run_test_round_trip();
+    run_test_forget_stale();
+    run_test_unusable_files();
+    run_test_default_path();
+
+    return test_summary("RPV3 Counter Catalog");
+}
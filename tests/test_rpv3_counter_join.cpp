@@ -0,0 +1,195 @@
+/* MIT License
+ * Unit tests for rpv3_counter_join.cpp
+ */
+
+#include "../rpv3_counter_join.h"
+#include "test_utils.h"
+
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+using rpv3::CounterJoin;
+using rpv3::CounterRow;
+using rpv3::TimedDispatch;
+using Match = rpv3::CounterJoin::Match;
+
+namespace {
+
+TimedDispatch make_timed(uint64_t dispatch_id) {
+    TimedDispatch timed;
+    timed.dispatch.dispatch_id = dispatch_id;
+    timed.dispatch.start_ns = 1000;
+    timed.dispatch.end_ns = 3000;
+    timed.sequence = dispatch_id + 10;
+    return timed;
+}
+
+CounterRow make_row(uint64_t dispatch_id, double value) {
+    CounterRow row;
+    row.dispatch.dispatch_id = dispatch_id;
+    row.values.assign(1, value);
+    row.instances.assign(1, 1);
+    return row;
+}
+
+} // namespace
+
+TEST(uncounted) {
+    CounterJoin join;
+    CounterRow row;
+    ASSERT_TRUE(join.add_dispatch(make_timed(1), row) == Match::Uncounted, "Not expected, written alone");
+    ASSERT_EQUALS(0, (int)join.held(), "Nothing held");
+}
+
+TEST(timeline_first) {
+    CounterJoin join;
+    join.expect(2);
+    CounterRow row;
+    ASSERT_TRUE(join.add_dispatch(make_timed(2), row) == Match::Held, "Timeline record waits for its row");
+
+    CounterRow counters = make_row(2, 64.0);
+    TimedDispatch timed;
+    ASSERT_TRUE(join.add_row(counters, timed) == Match::Joined, "Row completes the record");
+    ASSERT_EQUALS(3000, timed.dispatch.end_ns, "Timestamps from the timeline");
+    ASSERT_EQUALS(12, timed.sequence, "Sequence kept");
+    ASSERT_TRUE(counters.values[0] == 64.0, "Row left with the caller");
+    ASSERT_EQUALS(0, (int)join.held(), "Entry released");
+}
+
+TEST(counters_first) {
+    CounterJoin join;
+    join.expect(3);
+    CounterRow counters = make_row(3, 8.0);
+    TimedDispatch timed;
+    ASSERT_TRUE(join.add_row(counters, timed) == Match::Held, "Row waits for its timeline record");
+
+    CounterRow row;
+    ASSERT_TRUE(join.add_dispatch(make_timed(3), row) == Match::Joined, "Timeline record completes the row");
+    ASSERT_TRUE(row.values.size() == 1 && row.values[0] == 8.0, "Held row handed over");
+}
+
+TEST(discarded) {
+    CounterJoin join;
+    join.expect(4);
+    join.expect(5);
+    join.discard(4);
+    CounterRow counters = make_row(4, 1.0);
+    TimedDispatch timed;
+    ASSERT_TRUE(join.add_row(counters, timed) == Match::Uncounted, "Row of a discarded dispatch dropped");
+
+    CounterRow early = make_row(5, 1.0);
+    join.add_row(early, timed);
+    join.discard(5);
+    ASSERT_EQUALS(0, (int)join.held(), "Discard after the row drops it");
+}
+
+TEST(deferred) {
+    CounterJoin join;
+    join.expect(6);
+    join.expect(7);
+    join.defer(6);
+    join.defer(7);
+    CounterRow counters = make_row(6, 4.0);
+    TimedDispatch timed;
+    ASSERT_TRUE(join.add_row(counters, timed) == Match::Held, "Row waits for the later record");
+
+    TimedDispatch library = make_timed(6);
+    library.record = "row";
+    library.annotation = "# line\n";
+    CounterRow row;
+    ASSERT_TRUE(join.add_dispatch(library, row) == Match::Joined && row.values[0] == 4.0,
+                "Record handed over later meets its row");
+
+    /* Dispatch 7 never handed over (sampled away) */
+    CounterRow late = make_row(7, 1.0);
+    join.add_row(late, timed);
+    std::vector<TimedDispatch> dispatches;
+    std::vector<CounterRow> rows;
+    join.drain(dispatches, rows);
+    ASSERT_TRUE(dispatches.empty() && rows.empty(), "Row of a deferred dispatch dropped quietly");
+    ASSERT_EQUALS(0, (int)join.held(), "Nothing left");
+}
+
+TEST(drain) {
+    CounterJoin join;
+    join.expect(9);
+    join.expect(7);
+    join.expect(8);
+    CounterRow row;
+    join.add_dispatch(make_timed(9), row);
+    join.add_dispatch(make_timed(7), row);
+    CounterRow counters = make_row(8, 2.0);
+    TimedDispatch timed;
+    join.add_row(counters, timed);
+
+    std::vector<TimedDispatch> dispatches;
+    std::vector<CounterRow> rows;
+    join.drain(dispatches, rows);
+    ASSERT_EQUALS(2, (int)dispatches.size(), "Timeline records without rows");
+    ASSERT_EQUALS(7, dispatches[0].dispatch.dispatch_id, "In dispatch order");
+    ASSERT_EQUALS(1, (int)rows.size(), "Rows without timeline records");
+    ASSERT_EQUALS(0, (int)join.held(), "Nothing left");
+}
+
+TEST(concurrent) {
+    CounterJoin join;
+    const uint64_t n = 20000;
+    for (uint64_t id = 0; id < n; id++) {
+        join.expect(id);
+    }
+    int joined_timeline = 0;
+    int joined_counters = 0;
+    std::thread timeline([&] {
+        for (uint64_t id = 0; id < n; id++) {
+            CounterRow row;
+            joined_timeline += join.add_dispatch(make_timed(id), row) == Match::Joined ? 1 : 0;
+        }
+    });
+    std::thread counters([&] {
+        for (uint64_t id = 0; id < n; id++) {
+            CounterRow row = make_row(id, 1.0);
+            TimedDispatch timed;
+            joined_counters += join.add_row(row, timed) == Match::Joined ? 1 : 0;
+        }
+    });
+    timeline.join();
+    counters.join();
+    ASSERT_EQUALS(n, joined_timeline + joined_counters, "Every dispatch joined exactly once");
+    ASSERT_EQUALS(0, (int)join.held(), "Nothing left");
+}
+
+TEST(format) {
+    std::vector<std::string> columns = {"SQ_WAVES", "WAVES_PER_US"};
+    std::string header = rpv3::joined_csv_header(false, columns);
+    ASSERT_TRUE(header.find("DurationNs") != std::string::npos, "Timeline columns first");
+    ASSERT_TRUE(header.size() > 25 && header.compare(header.size() - 23, 23, ",SQ_WAVES,WAVES_PER_US\n") == 0,
+                "Counter columns last");
+    header = rpv3::joined_csv_header(true, columns);
+    ASSERT_TRUE(header.find(",AchievedGBps,SQ_WAVES,WAVES_PER_US\n") != std::string::npos,
+                "BLAS columns before the counter columns");
+
+    rpv3::RecordBuffer out;
+    rpv3::format_counter_line(out, columns, {64.0, NAN});
+    ASSERT_TRUE(std::string(out.data(), out.size()) == "  Counters: SQ_WAVES=64\n", "Text line skips NaN");
+
+    out.clear();
+    rpv3::format_counter_fields(out, {64.0, NAN});
+    ASSERT_TRUE(std::string(out.data(), out.size()) == ",64,", "CSV fields, NaN empty");
+}
+
+int main() {
+    test_banner("RPV3 Counter Join Unit Tests");
+
+    run_test_uncounted();
+    run_test_timeline_first();
+    run_test_counters_first();
+    run_test_discarded();
+    run_test_deferred();
+    run_test_drain();
+    run_test_concurrent();
+    run_test_format();
+
+    return test_summary("RPV3 Counter Join");
+}
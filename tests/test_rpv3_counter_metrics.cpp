@@ -0,0 +1,108 @@
+/* MIT License
+ * Unit tests for rpv3_counter_metrics.cpp
+ */
+
+#include "../rpv3_counter_metrics.h"
+#include "test_utils.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using rpv3::CounterMetrics;
+
+TEST(plain_counters) {
+    CounterMetrics metrics;
+    ASSERT_TRUE(metrics.empty(), "Nothing compiled yet");
+    ASSERT_TRUE(metrics.compile("SQ_WAVES, SQ_INSTS_VALU"), "Counter list compiles");
+    ASSERT_EQUALS(2, (int)metrics.counters().size(), "Two counters collected");
+    ASSERT_EQUALS(2, (int)metrics.columns().size(), "Two columns written");
+    ASSERT_TRUE(!metrics.has_derived() && !metrics.uses_duration(), "No metrics");
+    ASSERT_EQUALS(1, metrics.counter_of(1), "Column 1 is counter 1");
+
+    const double counters[] = {64.0, 8192.0};
+    double out[2];
+    metrics.evaluate(counters, NAN, out);
+    ASSERT_TRUE(out[0] == 64.0 && out[1] == 8192.0, "Counters pass through");
+}
+
+TEST(derived_metrics) {
+    CounterMetrics metrics;
+    ASSERT_TRUE(metrics.compile("SQ_WAVES,VALU_PER_WAVE=SQ_INSTS_VALU/SQ_WAVES,"
+                                "SCALED=-(VALU_PER_WAVE+2)*1.5e1,RATE=SQ_WAVES/DurationNs"),
+                "Metrics compile");
+    ASSERT_EQUALS(2, (int)metrics.counters().size(), "Referenced counter collected once");
+    ASSERT_TRUE(metrics.counters()[1] == "SQ_INSTS_VALU", "Referenced counter after listed ones");
+    ASSERT_EQUALS(4, (int)metrics.columns().size(), "Referenced counter is not a column");
+    ASSERT_TRUE(metrics.has_derived() && metrics.uses_duration(), "Metrics and duration used");
+    ASSERT_EQUALS(0, metrics.counter_of(0), "Column 0 is a counter");
+    ASSERT_EQUALS(-1, metrics.counter_of(1), "Column 1 is a metric");
+
+    const double counters[] = {64.0, 512.0};
+    double out[4];
+    metrics.evaluate(counters, 1000.0, out);
+    ASSERT_TRUE(out[1] == 8.0, "Ratio of counters");
+    ASSERT_TRUE(out[2] == -150.0, "Earlier metric, precedence and unary minus");
+    ASSERT_TRUE(out[3] == 0.064, "Duration");
+
+    metrics.evaluate(counters, NAN, out);
+    ASSERT_TRUE(std::isnan(out[3]) && out[1] == 8.0, "Unknown duration only affects its metric");
+}
+
+TEST(not_computable) {
+    CounterMetrics metrics;
+    ASSERT_TRUE(metrics.compile("RATIO=A/B,SUM=A+B"), "Compiles");
+    const double zero[] = {1.0, 0.0};
+    double out[2];
+    metrics.evaluate(zero, NAN, out);
+    ASSERT_TRUE(std::isnan(out[0]) && out[1] == 1.0, "Division by zero is NaN");
+
+    const double missing[] = {NAN, 2.0};
+    metrics.evaluate(missing, NAN, out);
+    ASSERT_TRUE(std::isnan(out[0]) && std::isnan(out[1]), "Uncollected counter is NaN");
+}
+
+TEST(errors) {
+    CounterMetrics metrics;
+    ASSERT_TRUE(metrics.compile("SQ_WAVES"), "First list");
+
+    std::string error;
+    ASSERT_TRUE(!metrics.compile("X=SQ_WAVES/", &error), "Missing operand");
+    ASSERT_TRUE(error == "X: expression ends early", "Names the metric");
+    ASSERT_TRUE(!metrics.compile("X=(SQ_WAVES", &error) && error == "X: missing ')'", "Unbalanced parenthesis");
+    ASSERT_TRUE(!metrics.compile("X=X+1", &error) && error == "X: refers to itself", "Self reference");
+    ASSERT_TRUE(!metrics.compile("SQ_WAVES", &error) && error == "'SQ_WAVES' listed twice", "Duplicate column");
+    ASSERT_TRUE(!metrics.compile("A,,B", &error) && error == "empty counter name", "Empty item");
+    ASSERT_TRUE(!metrics.compile("1X=2", &error), "Bad name");
+    ASSERT_TRUE(!metrics.compile("DurationNs", &error), "Duration is not a counter");
+    ASSERT_TRUE(!metrics.compile("X=A$B", &error), "Unknown character");
+
+    ASSERT_TRUE(!metrics.compile("GRBM_COUNT,Y=1/", &error), "Later item fails");
+    ASSERT_EQUALS(1, (int)metrics.columns().size(), "Failed lists leave the set unchanged");
+    ASSERT_EQUALS(1, (int)metrics.counters().size(), "No counters added by failed lists");
+}
+
+TEST(nesting_limit) {
+    CounterMetrics metrics;
+    std::string deep = "X=";
+    for (int i = 0; i < 40; i++) {
+        deep += "1+(";
+    }
+    deep += "1";
+    deep.append(40, ')');
+    std::string error;
+    ASSERT_TRUE(!metrics.compile(deep, &error), "Stack limit enforced");
+    ASSERT_TRUE(metrics.compile("Y=1+(1+(1+(1)))"), "Shallow nesting compiles");
+}
+
+int main() {
+    test_banner("RPV3 Counter Metrics Unit Tests");
+
+    run_test_plain_counters();
+    run_test_derived_metrics();
+    run_test_not_computable();
+    run_test_errors();
+    run_test_nesting_limit();
+
+    return test_summary("RPV3 Counter Metrics");
+}
@@ -0,0 +1,117 @@
+/* MIT License
+ * Unit tests for rpv3_counter_passes.cpp
+ */
+
+#include "../rpv3_counter_passes.h"
+#include "test_utils.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using rpv3::CounterEstimates;
+using rpv3::CounterRow;
+
+namespace {
+
+/* Mock hardware: two counters per profile, counter 5 never countable,
+ * counters 0 and 1 share a block that takes only one of them */
+bool mock_fits(const std::vector<size_t>& pass) {
+    bool block = false;
+    for (size_t counter : pass) {
+        if (counter == 5) {
+            return false;
+        }
+        if (counter <= 1) {
+            if (block) {
+                return false;
+            }
+            block = true;
+        }
+    }
+    return pass.size() <= 2;
+}
+
+CounterRow make_row(uint64_t kernel_id, size_t columns) {
+    CounterRow row;
+    row.dispatch.kernel_id = kernel_id;
+    row.values.assign(columns, 0.0);
+    row.instances.assign(columns, 0);
+    return row;
+}
+
+} // namespace
+
+TEST(plan_passes) {
+    std::vector<size_t> rejected;
+    auto passes = rpv3::plan_counter_passes(6, mock_fits, &rejected);
+    ASSERT_EQUALS(3, (int)passes.size(), "Five countable counters need three passes");
+    ASSERT_TRUE(passes[0] == std::vector<size_t>({0, 2}), "Counter 1 conflicts with 0, 2 fills the first pass");
+    ASSERT_TRUE(passes[1] == std::vector<size_t>({1, 3}), "Counter 1 opens the second pass");
+    ASSERT_TRUE(passes[2] == std::vector<size_t>({4}), "Counter 4 opens the third pass");
+    ASSERT_TRUE(rejected == std::vector<size_t>({5}), "Uncountable counter rejected");
+
+    auto single = rpv3::plan_counter_passes(2, [](const std::vector<size_t>&) { return true; });
+    ASSERT_EQUALS(1, (int)single.size(), "Counters that fit together stay in one pass");
+}
+
+TEST(estimates) {
+    CounterEstimates estimates;
+    /* Kernel 7: pass A collects column 0, pass B column 1 */
+    CounterRow a = make_row(7, 2);
+    a.values[0] = 100.0;
+    a.instances[0] = 4;
+    CounterRow b = make_row(7, 2);
+    b.values[1] = 30.0;
+    b.instances[1] = 1;
+    CounterRow a2 = a;
+    a2.values[0] = 200.0;
+    estimates.add(a);
+    estimates.add(b);
+    estimates.add(a2);
+    estimates.add(make_row(9, 2));
+
+    auto rows = estimates.rows();
+    ASSERT_EQUALS(2, (int)rows.size(), "Two kernels");
+    ASSERT_EQUALS(7, rows[0].kernel_id, "Most dispatches first");
+    ASSERT_EQUALS(3, rows[0].dispatches, "Every pass counts as a dispatch");
+    ASSERT_TRUE(rows[0].means[0] == 150.0 && rows[0].samples[0] == 2, "Mean over the dispatches that collected it");
+    ASSERT_TRUE(rows[0].means[1] == 30.0 && rows[0].samples[1] == 1, "Other pass's counter");
+    ASSERT_TRUE(std::isnan(rows[1].means[0]) && rows[1].samples[0] == 0, "No samples, no estimate");
+}
+
+TEST(format) {
+    rpv3::CounterEstimateRow row;
+    row.kernel_id = 7;
+    row.name = "gemm";
+    row.dispatches = 3;
+    row.means = {150.0, 30.0};
+    row.samples = {2, 1};
+    std::vector<std::string> counters = {"SQ_WAVES", "SQ_INSTS_VALU"};
+    std::vector<std::string> columns = {"SQ_WAVES", "VALU_PER_WAVE"};
+    std::vector<std::vector<double>> values = {{150.0, 0.2}};
+
+    rpv3::RecordBuffer out;
+    rpv3::format_estimates_csv(out, {row}, columns, values, counters);
+    ASSERT_TRUE(std::string(out.data(), out.size()) ==
+                    "KernelName,KernelID,Dispatches,SQ_WAVES,VALU_PER_WAVE,SQ_WAVESSamples,SQ_INSTS_VALUSamples\n"
+                    "\"gemm\",7,3,150,0.2,2,1\n",
+                "CSV estimates with samples per counter");
+
+    out.clear();
+    values[0][1] = NAN;
+    rpv3::format_estimates_text(out, {row}, columns, values, counters);
+    ASSERT_TRUE(std::string(out.data(), out.size()).find(
+                    "gemm (3 dispatches): SQ_WAVES=150 samples SQ_WAVES=2,SQ_INSTS_VALU=1\n") != std::string::npos,
+                "Text estimate, uncomputable metric left out");
+}
+
+int main() {
+    test_banner("RPV3 Counter Passes Unit Tests");
+
+    run_test_plan_passes();
+    run_test_estimates();
+    run_test_format();
+
+    return test_summary("RPV3 Counter Passes");
+}
@@ -0,0 +1,102 @@
+/* MIT License
+ * Unit tests for rpv3_counter_select.cpp
+ */
+
+#include "../rpv3_counter_select.h"
+#include "test_utils.h"
+
+#include <thread>
+#include <vector>
+
+using rpv3::CounterSelector;
+
+TEST(every_dispatch) {
+    CounterSelector selector;
+    uint32_t pass = 99;
+    ASSERT_TRUE(selector.select(7, 1, pass) && pass == 0, "Counted on the only pass");
+    ASSERT_TRUE(selector.select(7, 1, pass) && selector.select(7, 1, pass), "No policy counts every dispatch");
+    ASSERT_EQUALS(3, selector.counted(), "Three counted");
+    ASSERT_EQUALS(0, selector.skipped(), "None skipped");
+}
+
+TEST(first_dispatches) {
+    CounterSelector selector;
+    selector.configure(2, 0);
+    uint32_t pass = 0;
+    ASSERT_TRUE(selector.select(7, 1, pass), "First dispatch counted");
+    ASSERT_TRUE(selector.select(8, 1, pass), "Other kernel has its own count");
+    ASSERT_TRUE(selector.select(7, 1, pass), "Second dispatch counted");
+    ASSERT_TRUE(!selector.select(7, 1, pass), "Third dispatch runs uncounted");
+    ASSERT_TRUE(!selector.select(7, 1, pass), "And every later one");
+    ASSERT_EQUALS(2, selector.skipped(), "Skipped dispatches reported");
+}
+
+TEST(one_in_n) {
+    CounterSelector selector;
+    selector.configure(0, 3);
+    uint32_t pass = 0;
+    int counted = 0;
+    for (int i = 0; i < 9; i++) {
+        counted += selector.select(7, 1, pass) ? 1 : 0;
+    }
+    ASSERT_EQUALS(3, counted, "Dispatches 1, 4 and 7 counted");
+}
+
+TEST(passes_rotate_over_counted) {
+    CounterSelector selector;
+    selector.configure(0, 2);
+    std::vector<uint32_t> passes;
+    uint32_t pass = 0;
+    for (int i = 0; i < 8; i++) {
+        if (selector.select(7, 2, pass)) {
+            passes.push_back(pass);
+        }
+    }
+    /* Rotating over all dispatches would give pass 0 every time */
+    ASSERT_TRUE(passes == std::vector<uint32_t>({0, 1, 0, 1}), "Every counted dispatch moves to the next pass");
+}
+
+TEST(table_grows) {
+    CounterSelector selector(2);
+    selector.configure(0, 2);
+    uint32_t pass = 0;
+    for (uint64_t id = 0; id < 100; id++) {
+        ASSERT_TRUE(selector.select(id, 1, pass), "First dispatch of every kernel counted");
+    }
+    ASSERT_EQUALS(100, (int)selector.kernels(), "Every kernel tracked");
+    /* Counts made before the table grew carry over */
+    ASSERT_TRUE(!selector.select(0, 1, pass), "Second dispatch of an early kernel skipped");
+    ASSERT_TRUE(selector.select(0, 1, pass), "Third counted");
+}
+
+TEST(concurrent) {
+    CounterSelector selector(2);
+    selector.configure(1000, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&selector] {
+            uint32_t pass = 0;
+            for (int i = 0; i < 10000; i++) {
+                selector.select((uint64_t)(i % 8), 3, pass);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQUALS(8000, selector.counted(), "Exactly the first 1000 of each kernel counted");
+    ASSERT_EQUALS(32000, selector.skipped(), "The rest skipped");
+}
+
+int main() {
+    test_banner("RPV3 Counter Select Unit Tests");
+
+    run_test_every_dispatch();
+    run_test_first_dispatches();
+    run_test_one_in_n();
+    run_test_passes_rotate_over_counted();
+    run_test_table_grows();
+    run_test_concurrent();
+
+    return test_summary("RPV3 Counter Select");
+}
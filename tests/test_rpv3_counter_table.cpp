@@ -0,0 +1,125 @@
+/* MIT License
+ * Unit tests for rpv3_counter_table.cpp
+ */
+
+#include "../rpv3_counter_table.h"
+#include "test_utils.h"
+
+#include <string>
+
+using rpv3::CounterRow;
+using rpv3::CounterTable;
+
+namespace {
+
+rpv3::DispatchRecord make_dispatch(uint64_t dispatch_id, uint64_t kernel_id) {
+    rpv3::DispatchRecord dispatch;
+    dispatch.dispatch_id = dispatch_id;
+    dispatch.correlation_id = dispatch_id + 100;
+    dispatch.kernel_id = kernel_id;
+    dispatch.grid[0] = 1048576;
+    dispatch.grid[1] = 1;
+    dispatch.grid[2] = 1;
+    dispatch.workgroup[0] = 256;
+    dispatch.workgroup[1] = 1;
+    dispatch.workgroup[2] = 1;
+    return dispatch;
+}
+
+} // namespace
+
+TEST(columns) {
+    CounterTable table;
+    ASSERT_EQUALS(0, (int)table.add_column("SQ_WAVES"), "Declared column");
+    ASSERT_EQUALS(0, (int)table.add_column("SQ_WAVES"), "Declared once");
+    ASSERT_EQUALS(0, (int)table.add_counter(11, "SQ_WAVES"), "First counter is column 0");
+    ASSERT_EQUALS(1, (int)table.add_counter(12, "SQ_INSTS_VALU"), "Second counter is column 1");
+    ASSERT_EQUALS(0, (int)table.add_counter(11, "SQ_WAVES"), "Same id keeps its column");
+    ASSERT_EQUALS(1, (int)table.add_counter(212, "SQ_INSTS_VALU"), "Same name on another agent shares the column");
+    ASSERT_EQUALS(2, (int)table.columns().size(), "Two named columns");
+    ASSERT_EQUALS(1, table.column(212), "Second agent id resolves");
+    ASSERT_EQUALS(-1, table.column(99), "Unselected counter has no column");
+}
+
+TEST(row_per_dispatch) {
+    CounterTable table;
+    table.add_counter(11, "SQ_WAVES");
+    table.add_counter(12, "SQ_INSTS_VALU");
+    table.begin_dispatch(make_dispatch(1, 7), 3);
+    table.begin_dispatch(make_dispatch(2, 8), 3);
+    ASSERT_EQUALS(2, (int)table.pending_dispatches(), "Both dispatches waiting for records");
+
+    CounterRow row;
+    /* Four shader engine instances of SQ_WAVES, one of SQ_INSTS_VALU */
+    ASSERT_TRUE(!table.add(1, 11, 1000.0, row), "First record opens the row");
+    ASSERT_TRUE(!table.add(1, 11, 1000.0, row), "Same dispatch");
+    ASSERT_TRUE(!table.add(1, 12, 5e8, row), "Same dispatch, other counter");
+    ASSERT_TRUE(!table.add(1, 11, 2000.0, row), "Same dispatch");
+    ASSERT_TRUE(!table.add(1, 99, 1.0, row), "Unknown counter ignored");
+    ASSERT_TRUE(!table.add(1, 11, 96.0, row), "Same dispatch");
+    ASSERT_EQUALS(1, (int)table.pending_dispatches(), "Open row took its dispatch");
+
+    ASSERT_TRUE(table.add(2, 11, 64.0, row), "Next dispatch completes the first row");
+    ASSERT_EQUALS(1, row.dispatch.dispatch_id, "Completed row is dispatch 1");
+    ASSERT_EQUALS(7, row.dispatch.kernel_id, "Kernel from begin_dispatch");
+    ASSERT_EQUALS(3, row.agent_id, "Agent from begin_dispatch");
+    ASSERT_EQUALS(1048576, row.dispatch.grid[0], "Grid from begin_dispatch");
+    ASSERT_TRUE(row.values[0] == 4096.0 && row.instances[0] == 4, "Instances summed");
+    ASSERT_TRUE(row.values[1] == 5e8 && row.instances[1] == 1, "Single instance");
+
+    ASSERT_TRUE(table.finish(row), "Open row flushed at the end");
+    ASSERT_EQUALS(2, row.dispatch.dispatch_id, "Last row is dispatch 2");
+    ASSERT_TRUE(row.has(0) && !row.has(1), "Only SQ_WAVES collected");
+    ASSERT_TRUE(!table.finish(row), "Nothing left open");
+    ASSERT_EQUALS(0, (int)table.pending_dispatches(), "Every dispatch consumed");
+}
+
+TEST(unknown_dispatch) {
+    CounterTable table;
+    table.add_counter(11, "SQ_WAVES");
+    CounterRow row;
+    table.add(42, 11, 8.0, row);
+    ASSERT_TRUE(table.finish(row), "Row without begin_dispatch still produced");
+    ASSERT_EQUALS(42, row.dispatch.dispatch_id, "Dispatch id from the record");
+    ASSERT_EQUALS(0, row.dispatch.kernel_id, "Kernel unknown");
+}
+
+TEST(csv_and_text) {
+    CounterTable table;
+    table.add_counter(11, "SQ_WAVES");
+    table.add_counter(12, "SQ_INSTS_VALU");
+    table.begin_dispatch(make_dispatch(5, 7), 2);
+    CounterRow row;
+    table.add(5, 11, 4096.0, row);
+    table.add(5, 11, 0.5, row);
+    table.finish(row);
+
+    ASSERT_TRUE(rpv3::counter_csv_header(table.columns()) ==
+                    "KernelName,DispatchID,CorrelationID,KernelID,AgentID,GridX,GridY,GridZ,"
+                    "WorkgroupX,WorkgroupY,WorkgroupZ,SQ_WAVES,SQ_INSTS_VALU\n",
+                "Header names every counter column");
+
+    std::vector<double> values;
+    rpv3::counter_values(row, values);
+    rpv3::RecordBuffer out;
+    rpv3::format_counter_csv_row(out, "vector_add", row, values);
+    ASSERT_TRUE(std::string(out.data(), out.size()) == "\"vector_add\",5,105,7,2,1048576,1,1,256,1,1,4096.5,\n",
+                "CSV row, uncollected column empty");
+
+    out.clear();
+    rpv3::format_counter_text(out, "vector_add", row, table.columns(), values);
+    ASSERT_TRUE(std::string(out.data(), out.size()) ==
+                    "[Counters] vector_add dispatch 5 agent 2 grid [1048576, 1, 1]: SQ_WAVES=4096.5\n",
+                "One text line per dispatch");
+}
+
+int main() {
+    test_banner("RPV3 Counter Table Unit Tests");
+
+    run_test_columns();
+    run_test_row_per_dispatch();
+    run_test_unknown_dispatch();
+    run_test_csv_and_text();
+
+    return test_summary("RPV3 Counter Table");
+}
@@ -0,0 +1,112 @@
+/* MIT License
+ * Unit tests for rpv3_filter.cpp
+ */
+
+#include "../rpv3_filter.h"
+#include "test_utils.h"
+
+#include <string>
+
+namespace {
+
+rpv3::DispatchRecord sample_record() {
+    rpv3::DispatchRecord record;
+    record.kernel_id = 3;
+    record.grid[0] = 1024;
+    record.grid[1] = 4;
+    record.grid[2] = 1;
+    record.workgroup[0] = 256;
+    record.workgroup[1] = 1;
+    record.workgroup[2] = 1;
+    record.private_segment_size = 0;
+    record.group_segment_size = 8192;
+    record.start_ns = 1000000;
+    record.end_ns = 1025000;  // 25 us
+    return record;
+}
+
+bool accepts(const char* expression) {
+    rpv3::DispatchFilter filter;
+    return filter.compile(expression) && filter.matches(sample_record());
+}
+
+} // namespace
+
+TEST(name_patterns) {
+    rpv3::NameFilter filter;
+    ASSERT_TRUE(filter.empty() && filter.matches("anything"), "Empty name filter accepts every kernel");
+
+    filter.add_include("Cijk_*");
+    filter.add_include("vector_add");
+    ASSERT_TRUE(filter.matches("Cijk_Ailk_Bljk_SB_MT64x64x16"), "Glob include matches");
+    ASSERT_TRUE(filter.matches("vector_add(float const*, float*, int)"), "Plain include matches as a substring");
+    ASSERT_TRUE(!filter.matches("matrix_transpose(float*)"), "Names matching no include are rejected");
+
+    filter.add_exclude("*_Bias_*");
+    ASSERT_TRUE(!filter.matches("Cijk_Ailk_Bljk_SB_Bias_MT64"), "Exclude wins over include");
+
+    rpv3::NameFilter exclude_only;
+    exclude_only.add_exclude("elementwise");
+    ASSERT_TRUE(exclude_only.matches("gemm") && !exclude_only.matches("at::native::elementwise_kernel<128>"),
+                "Exclude-only filter keeps everything else");
+}
+
+TEST(numeric_predicates) {
+    ASSERT_TRUE(accepts("duration>=25us"), "duration>=25us holds for 25 us");
+    ASSERT_TRUE(!accepts("duration>25us"), "duration>25us fails for 25 us");
+    ASSERT_TRUE(accepts("duration<1ms"), "Millisecond unit");
+    ASSERT_TRUE(accepts("duration==25000"), "Nanoseconds are the default unit");
+    ASSERT_TRUE(accepts("grid=4096"), "grid is the total number of work-items");
+    ASSERT_TRUE(accepts("wg<=256"), "wg is an alias for workgroup");
+    ASSERT_TRUE(accepts("lds>=8K"), "lds accepts a K suffix");
+    ASSERT_TRUE(accepts("scratch==0"), "scratch compares the private segment size");
+    ASSERT_TRUE(accepts("scratch!=1,lds>0,duration>10us"), "Comma-separated predicates all hold");
+    ASSERT_TRUE(!accepts("lds>0,grid<100"), "One failing predicate rejects the dispatch");
+}
+
+TEST(compile_errors) {
+    const char* invalid[] = {"", "duration", "speed>1", "duration>>1", "duration>abc",
+                             "duration>10xs", "grid>4K", "lds>0,", "lds>0,,grid>1"};
+    bool all_rejected = true;
+    for (const char* expression : invalid) {
+        rpv3::DispatchFilter filter;
+        std::string error;
+        if (filter.compile(expression, &error) || error.empty() || !filter.empty()) {
+            printf("    accepted: '%s'\n", expression);
+            all_rejected = false;
+        }
+    }
+    ASSERT_TRUE(all_rejected, "Malformed expressions are rejected with a message");
+
+    rpv3::DispatchFilter filter;
+    filter.compile("lds>0");
+    filter.compile("grid>1");
+    ASSERT_EQUALS(2, (int)filter.predicates().size(), "Repeated compile calls accumulate predicates");
+    ASSERT_TRUE(!filter.uses_duration(), "No duration predicate");
+    filter.compile("duration>1us");
+    ASSERT_TRUE(filter.uses_duration(), "Duration predicate is reported");
+}
+
+TEST(launch_and_missing_timestamps) {
+    rpv3::DispatchFilter filter;
+    filter.compile("duration>1ms,lds>0");
+    rpv3::DispatchRecord record = sample_record();
+    ASSERT_TRUE(filter.matches_launch(record), "Launch check ignores duration predicates");
+    ASSERT_TRUE(!filter.matches(record), "Full check applies duration predicates");
+
+    record.end_ns = 0;
+    rpv3::DispatchFilter any_duration;
+    any_duration.compile("duration>=0");
+    ASSERT_TRUE(!any_duration.matches(record), "Duration predicates fail without an end timestamp");
+}
+
+int main() {
+    test_banner("RPV3 Filter Unit Tests");
+
+    run_test_name_patterns();
+    run_test_numeric_predicates();
+    run_test_compile_errors();
+    run_test_launch_and_missing_timestamps();
+
+    return test_summary("RPV3 Filter");
+}
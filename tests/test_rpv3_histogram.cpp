@@ -0,0 +1,154 @@
+/* MIT License
+ * Unit tests for rpv3_histogram.cpp
+ */
+
+#include "../rpv3_histogram.h"
+#include "test_utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using rpv3::LatencyHistogram;
+
+TEST(bucket_layout) {
+    bool contiguous = true;
+    for (size_t i = 0; i + 1 < LatencyHistogram::kBucketCount; i++) {
+        if (LatencyHistogram::bucket_high(i) + 1 != LatencyHistogram::bucket_low(i + 1)) {
+            contiguous = false;
+        }
+    }
+    ASSERT_TRUE(contiguous, "Buckets tile the value range without gaps");
+
+    bool consistent = true;
+    const uint64_t probes[] = {0, 1, 31, 32, 33, 63, 64, 65, 1000, 4095, 4096, 123456789,
+                               1ULL << 40, (1ULL << 41) - 1};
+    for (uint64_t v : probes) {
+        size_t i = LatencyHistogram::bucket_index(v);
+        if (v < LatencyHistogram::bucket_low(i) || v > LatencyHistogram::bucket_high(i)) {
+            printf("    %lu -> bucket %zu [%lu, %lu]\n", (unsigned long)v, i,
+                   (unsigned long)LatencyHistogram::bucket_low(i),
+                   (unsigned long)LatencyHistogram::bucket_high(i));
+            consistent = false;
+        }
+    }
+    ASSERT_TRUE(consistent, "Every value falls inside its bucket's range");
+    ASSERT_TRUE(LatencyHistogram::bucket_index(~0ULL) == LatencyHistogram::kBucketCount - 1,
+                "Huge values saturate into the last bucket");
+
+    bool bounded_error = true;
+    for (size_t i = LatencyHistogram::kSubBuckets; i + 1 < LatencyHistogram::kBucketCount; i++) {
+        double width = (double)(LatencyHistogram::bucket_high(i) - LatencyHistogram::bucket_low(i) + 1);
+        if (width / (double)LatencyHistogram::bucket_low(i) > 1.0 / LatencyHistogram::kSubBuckets + 1e-12) {
+            bounded_error = false;
+        }
+    }
+    ASSERT_TRUE(bounded_error, "Bucket width is at most 1/32 of its value");
+    ASSERT_TRUE(rpv3::kHistogramBytes < 16 * 1024, "Histogram memory per kernel is fixed and under 16 KiB");
+}
+
+TEST(percentiles) {
+    LatencyHistogram h;
+    ASSERT_TRUE(h.percentile(0.5) == 0 && h.count() == 0, "Empty histogram reports 0");
+
+    /* 1..100000 ns: exact pXX is XX% of 100000 */
+    for (uint64_t v = 1; v <= 100000; v++) h.record(v);
+    ASSERT_TRUE(h.count() == 100000 && h.max() == 100000, "Count and max are exact");
+
+    const double qs[] = {0.5, 0.9, 0.99, 0.999};
+    bool within = true;
+    for (double q : qs) {
+        double exact = q * 100000.0;
+        double got = (double)h.percentile(q);
+        if (got < exact || got > exact * (1.0 + 1.0 / 32) + 1) {
+            printf("    p%.1f: got %.0f, exact %.0f\n", q * 100, got, exact);
+            within = false;
+        }
+    }
+    ASSERT_TRUE(within, "Percentiles are within one bucket above the exact value");
+    ASSERT_TRUE(h.percentile(1.0) == 100000, "p100 is capped at the recorded maximum");
+
+    /* Tail latency survives: 999 fast dispatches and one slow one */
+    LatencyHistogram tail;
+    for (int i = 0; i < 999; i++) tail.record(2000);
+    tail.record(5000000);
+    ASSERT_TRUE(tail.percentile(0.5) < 2100, "p50 reflects the fast dispatches");
+    ASSERT_TRUE(tail.percentile(0.9999) == 5000000, "Extreme percentile reaches the outlier");
+}
+
+TEST(merge) {
+    LatencyHistogram a, b, all;
+    for (uint64_t v = 1; v <= 5000; v++) {
+        (v % 2 ? a : b).record(v * 37);
+        all.record(v * 37);
+    }
+    a.merge(b);
+    bool same = a.count() == all.count() && a.max() == all.max();
+    for (size_t i = 0; i < LatencyHistogram::kBucketCount && same; i++) {
+        same = a.bucket_count(i) == all.bucket_count(i);
+    }
+    ASSERT_TRUE(same, "Merging histograms equals recording all values in one");
+}
+
+TEST(table_concurrent) {
+    rpv3::HistogramTable table(64);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; t++) {
+        workers.emplace_back([&table, t] {
+            for (uint64_t i = 0; i < 50000; i++) {
+                table.record(i % 32, 100 + i % 1000 + (uint64_t)t);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    std::vector<rpv3::HistogramEntry> entries = table.entries();
+    uint64_t total = 0;
+    for (const auto& e : entries) total += e.histogram->count();
+    ASSERT_EQUALS(32, (int)entries.size(), "One histogram per kernel id");
+    ASSERT_TRUE(total == 8 * 50000, "No dispatch lost under concurrent recording");
+    ASSERT_TRUE(table.overflow() == 0, "No overflow below capacity");
+
+    rpv3::HistogramTable small(4);
+    for (uint64_t k = 0; k < 6; k++) small.record(k, 10);
+    ASSERT_TRUE(small.entries().size() == 4 && small.overflow() == 2, "Kernels beyond capacity are counted as overflow");
+}
+
+TEST(csv_dump) {
+    LatencyHistogram h;
+    h.record(10);
+    h.record(10);
+    h.record(1000);
+    std::vector<rpv3::NamedHistogram> kernels = {{"my_kernel", 1, &h}};
+
+    char* text = nullptr;
+    size_t size = 0;
+    FILE* out = open_memstream(&text, &size);
+    bool ok = rpv3::write_histogram_csv(out, kernels);
+    fclose(out);
+    std::string csv(text, size);
+    free(text);
+
+    ASSERT_TRUE(ok, "Dump succeeds");
+    ASSERT_TRUE(csv == "# rpv3-histogram v1 sub_bucket_bits=5\n"
+                       "KernelName,BucketLowNs,BucketHighNs,Count\n"
+                       "\"my_kernel\",10,10,2\n"
+                       "\"my_kernel\",992,1007,1\n",
+                "Dump lists non-empty buckets with their bounds");
+}
+
+int main() {
+    test_banner("RPV3 Histogram Unit Tests");
+
+    run_test_bucket_layout();
+    run_test_percentiles();
+    run_test_merge();
+    run_test_table_concurrent();
+    run_test_csv_dump();
+
+    return test_summary("RPV3 Histogram");
+}
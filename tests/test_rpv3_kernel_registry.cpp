@@ -0,0 +1,184 @@
+/* MIT License
+ * Unit tests for rpv3_kernel_registry.cpp
+ */
+
+#include "../rpv3_demangle.h"
+#include "../rpv3_kernel_registry.h"
+#include "test_utils.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using rpv3::KernelRegistry;
+using rpv3::KernelSymbol;
+
+/* Every name the stress writers register for an id starts with this prefix */
+static std::string name_for(uint64_t kernel_id, int version) {
+    return "kernel_" + std::to_string(kernel_id) + "_v" + std::to_string(version);
+}
+
+static bool name_matches_id(std::string_view name, uint64_t kernel_id) {
+    std::string prefix = "kernel_" + std::to_string(kernel_id) + "_v";
+    return name.substr(0, prefix.size()) == prefix;
+}
+
+TEST(insert_find_erase) {
+    KernelRegistry registry(4);
+    ASSERT_TRUE(registry.find(1) == nullptr, "Empty registry finds nothing");
+    ASSERT_TRUE(registry.name(1) == "<unknown>", "Unknown kernels use the fallback name");
+
+    registry.insert(1, "gemm_kernel", 3);
+    const KernelSymbol* symbol = registry.find(1);
+    ASSERT_TRUE(symbol && registry.name(*symbol) == "gemm_kernel" && symbol->flags == 3, "Inserted symbol is found");
+
+    std::string_view view = registry.name(*symbol);
+    registry.insert(1, "gemm_kernel_v2");
+    ASSERT_TRUE(registry.name(1) == "gemm_kernel_v2", "Re-registering replaces the name");
+    ASSERT_EQUALS(1, (int)registry.size(), "Re-registering does not add a symbol");
+
+    registry.erase(1);
+    ASSERT_TRUE(registry.find(1) == nullptr, "Erased symbol is gone");
+    ASSERT_EQUALS(0, (int)registry.size(), "Erase removes the symbol");
+    ASSERT_TRUE(view == "gemm_kernel" && view.data()[view.size()] == '\0',
+                "Views stay valid and terminated after erase");
+
+    registry.insert(1, "gemm_kernel");
+    ASSERT_TRUE(registry.name(1).data() == view.data(), "Names are interned once");
+
+    /* Growth keeps every entry reachable */
+    for (uint64_t id = 100; id < 5100; id++) {
+        registry.insert(id, name_for(id, 0));
+    }
+    bool all_found = true;
+    for (uint64_t id = 100; id < 5100; id++) {
+        if (registry.name(id) != name_for(id, 0)) {
+            all_found = false;
+        }
+    }
+    ASSERT_TRUE(all_found, "All symbols survive table growth");
+    ASSERT_EQUALS(5001, (int)registry.size(), "Size counts live symbols");
+}
+
+TEST(demangle) {
+    ASSERT_TRUE(rpv3::strip_kd_suffix("kernel.kd") == "kernel", "Descriptor suffix is stripped");
+    ASSERT_TRUE(rpv3::strip_kd_suffix("kernel.kd.x") == "kernel.kd.x", "Only a trailing .kd is stripped");
+    ASSERT_TRUE(rpv3::demangle_symbol("_Z10vector_addPKfS0_Pfi.kd") ==
+                "vector_add(float const*, float const*, float*, int)", "Mangled names are demangled");
+    ASSERT_TRUE(rpv3::demangle_symbol("Cijk_Ailk_Bljk_SB.kd") == "Cijk_Ailk_Bljk_SB", "Plain names pass through");
+    ASSERT_TRUE(rpv3::demangle_symbol("i") == "i", "Short names are not read as mangled types");
+    ASSERT_TRUE(rpv3::demangle_symbol("_Zbroken") == "_Zbroken", "Invalid manglings are kept");
+
+    /* Registration stores the mangled name; demangling waits for the first lookup */
+    KernelRegistry registry;
+    const KernelSymbol* a = registry.insert(1, "_Z6kernelv.kd");
+    registry.insert(2, "_Z6kernelv.kd");  /* Same code object on another agent */
+    registry.insert(3, "_Z5otherv.kd");
+    ASSERT_TRUE(a->mangled == "_Z6kernelv.kd", "Mangled name is kept as registered");
+    ASSERT_EQUALS(0, (int)registry.demangled_count(), "Nothing is demangled at registration");
+
+    ASSERT_TRUE(registry.name(1) == "kernel()", "First lookup demangles");
+    ASSERT_TRUE(a->demangled.load() != nullptr, "Result is cached in the entry");
+    ASSERT_TRUE(registry.name(2).data() == registry.name(1).data(), "Kernels with one mangled name share the result");
+    ASSERT_EQUALS(1, (int)registry.demangled_count(), "Each mangled name is demangled once");
+    ASSERT_TRUE(registry.demangled("_Z5otherv.kd") == "other()" && registry.name(3) == "other()",
+                "Demangling before registration seeds the cache");
+    ASSERT_EQUALS(2, (int)registry.demangled_count(), "Unused names are never demangled");
+}
+
+TEST(arena) {
+    rpv3::StringArena arena;
+    std::string_view a = arena.intern("alpha");
+    std::string_view b = arena.intern(std::string("alpha"));
+    ASSERT_TRUE(a.data() == b.data(), "Equal strings share storage");
+
+    std::string big(rpv3::StringArena::kChunkSize + 10, 'x');
+    std::string_view large = arena.intern(big);
+    std::string_view after = arena.intern("beta");
+    ASSERT_TRUE(large == big && after == "beta" && a == "alpha", "Oversized strings do not disturb the chunk");
+    ASSERT_TRUE(arena.bytes_used() == 6 + big.size() + 1 + 5, "Bytes are counted once per distinct string");
+}
+
+/* Writers load, reload and unload symbols while readers look them up and
+ * demangle them on first use. A reader must only ever see nothing or a name
+ * that belongs to the id it asked for. */
+TEST(concurrent_stress) {
+    constexpr uint64_t kKernels = 20000;
+    constexpr int kWriters = 2;
+    constexpr int kReaders = 6;
+    constexpr uint64_t kLookupsPerReader = 2000000;
+
+    KernelRegistry registry(16);  // Small start so growth happens under load
+    std::atomic<bool> writers_done{false};
+    std::atomic<uint64_t> mismatches{0};
+    std::atomic<uint64_t> hits{0};
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < kWriters; w++) {
+        threads.emplace_back([&, w] {
+            for (int version = 0; version < 3; version++) {
+                for (uint64_t id = (uint64_t)w; id < kKernels; id += kWriters) {
+                    registry.insert(id, name_for(id, version), (uint32_t)version);
+                    if (version == 1 && id % 7 == 0) {
+                        registry.erase(id);
+                    }
+                }
+            }
+        });
+    }
+    for (int r = 0; r < kReaders; r++) {
+        threads.emplace_back([&, r] {
+            uint64_t local_hits = 0;
+            uint64_t state = 0x2545f4914f6cdd1dULL + (uint64_t)r;
+            for (uint64_t i = 0; i < kLookupsPerReader; i++) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                uint64_t id = state % kKernels;
+                const KernelSymbol* symbol = registry.find(id);
+                if (symbol) {
+                    local_hits++;
+                    if (symbol->kernel_id != id || !name_matches_id(registry.name(*symbol), id)) {
+                        mismatches.fetch_add(1);
+                    }
+                }
+            }
+            hits.fetch_add(local_hits);
+        });
+    }
+    for (int w = 0; w < kWriters; w++) {
+        threads[w].join();
+    }
+    writers_done = true;
+    for (size_t t = kWriters; t < threads.size(); t++) {
+        threads[t].join();
+    }
+
+    printf("    %lu lookups, %lu hits, %zu arena bytes\n",
+           (unsigned long)(kReaders * kLookupsPerReader), (unsigned long)hits.load(), registry.arena_bytes());
+    ASSERT_TRUE(writers_done && mismatches.load() == 0, "Readers never see a torn or foreign entry");
+    ASSERT_TRUE(hits.load() > 0, "Readers find symbols while writers run");
+
+    bool final_state = true;
+    for (uint64_t id = 0; id < kKernels; id++) {
+        const KernelSymbol* symbol = registry.find(id);
+        if (!symbol || registry.name(*symbol) != name_for(id, 2) || symbol->flags != 2) {
+            final_state = false;
+        }
+    }
+    ASSERT_TRUE(final_state, "Last registration wins for every kernel");
+    ASSERT_TRUE(registry.size() == kKernels, "Size matches after concurrent churn");
+}
+
+int main() {
+    test_banner("RPV3 Kernel Registry Unit Tests");
+
+    run_test_insert_find_erase();
+    run_test_demangle();
+    run_test_arena();
+    run_test_concurrent_stress();
+
+    return test_summary("RPV3 Kernel Registry");
+}
@@ -0,0 +1,143 @@
+/* MIT License
+ * Unit tests for rpv3_kernel_stats.cpp
+ */
+
+#include "../rpv3_kernel_stats.h"
+#include "test_utils.h"
+
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string str(const rpv3::RecordBuffer& buffer) {
+    return std::string(buffer.data(), buffer.size());
+}
+
+bool near(double a, double b) {
+    return std::fabs(a - b) <= 1e-6 * std::max(1.0, std::fabs(b));
+}
+
+// Two-pass reference statistics
+void reference(const std::vector<uint64_t>& values, double& mean, double& stddev) {
+    double sum = 0.0;
+    for (uint64_t v : values) sum += (double)v;
+    mean = sum / (double)values.size();
+    double sq = 0.0;
+    for (uint64_t v : values) sq += ((double)v - mean) * ((double)v - mean);
+    stddev = std::sqrt(sq / (double)(values.size() - 1));
+}
+
+} // namespace
+
+TEST(welford_matches_two_pass) {
+    std::vector<uint64_t> values = {1200, 1350, 980, 4000, 1210, 1190, 25000, 1300};
+    rpv3::KernelStats stats;
+    for (uint64_t v : values) stats.add(v);
+
+    double mean, stddev;
+    reference(values, mean, stddev);
+    ASSERT_EQUALS(8, (int)stats.count, "Count matches the number of samples");
+    ASSERT_TRUE(stats.total_ns == 36230, "Total is the exact sum");
+    ASSERT_TRUE(stats.min_ns == 980 && stats.max_ns == 25000, "Min and max are tracked");
+    ASSERT_TRUE(near(stats.mean_ns, mean), "Welford mean matches the two-pass mean");
+    ASSERT_TRUE(near(stats.stddev_ns(), stddev), "Welford stddev matches the two-pass stddev");
+
+    rpv3::KernelStats single;
+    single.add(500);
+    ASSERT_TRUE(single.stddev_ns() == 0.0, "Stddev of a single dispatch is zero");
+}
+
+TEST(merge_matches_sequential) {
+    rpv3::KernelStats all, a, b, empty;
+    for (uint64_t i = 1; i <= 1000; i++) {
+        uint64_t v = 1000 + (i * 7919) % 5003;
+        all.add(v);
+        (i % 3 ? a : b).add(v);
+    }
+    a.merge(b);
+    a.merge(empty);
+    ASSERT_TRUE(a.count == all.count && a.total_ns == all.total_ns, "Merged count and total match");
+    ASSERT_TRUE(a.min_ns == all.min_ns && a.max_ns == all.max_ns, "Merged min and max match");
+    ASSERT_TRUE(near(a.mean_ns, all.mean_ns), "Merged mean matches");
+    ASSERT_TRUE(near(a.stddev_ns(), all.stddev_ns()), "Merged stddev matches");
+
+    empty.merge(all);
+    ASSERT_TRUE(empty.count == all.count && near(empty.mean_ns, all.mean_ns), "Merging into empty copies");
+}
+
+TEST(table_concurrent_record) {
+    rpv3::KernelStatsTable table;
+    const int threads = 8;
+    const uint64_t per_thread = 20000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&table, t] {
+            for (uint64_t i = 0; i < per_thread; i++) {
+                table.record(i % 4, 100 + (uint64_t)t);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    std::vector<rpv3::KernelSummaryRow> rows = table.rows();
+    ASSERT_EQUALS(4, (int)rows.size(), "One row per kernel id");
+    uint64_t total_count = 0;
+    for (const auto& row : rows) total_count += row.stats.count;
+    ASSERT_TRUE(total_count == threads * per_thread, "No dispatch is lost across threads");
+    ASSERT_TRUE(rows[0].stats.min_ns == 100 && rows[0].stats.max_ns == 107, "Shards merge min and max");
+}
+
+TEST(rows_sorted_by_total) {
+    rpv3::KernelStatsTable table;
+    table.record(1, 10);
+    table.record(2, 500);
+    table.record(3, 200);
+    table.record(3, 200);
+    std::vector<rpv3::KernelSummaryRow> rows = table.rows();
+    ASSERT_TRUE(rows.size() == 3 && rows[0].kernel_id == 2 && rows[1].kernel_id == 3 && rows[2].kernel_id == 1,
+                "Rows are ordered by total time, largest first");
+}
+
+TEST(summary_formats) {
+    std::vector<rpv3::KernelSummaryRow> rows(2);
+    rows[0].kernel_id = 7;
+    rows[0].name = "gemm_kernel";
+    rows[0].stats.add(3000);
+    rows[0].stats.add(5000);
+    rows[1].kernel_id = 9;
+    rows[1].name = std::string(120, 'x');
+    rows[1].stats.add(2000);
+
+    rpv3::RecordBuffer csv;
+    rpv3::format_summary_csv(csv, rows);
+    ASSERT_TRUE(str(csv) ==
+                "KernelName,KernelID,Count,TotalNs,MeanNs,MinNs,MaxNs,StddevNs,PercentTotal\n"
+                "\"gemm_kernel\",7,2,8000,4000.000,3000,5000,1414.214,80.000\n"
+                "\"" + std::string(120, 'x') + "\",9,1,2000,2000.000,2000,2000,0.000,20.000\n",
+                "CSV summary has one row per kernel with full names");
+
+    rpv3::RecordBuffer text;
+    rpv3::format_summary_text(text, rows);
+    std::string t = str(text);
+    ASSERT_TRUE(t.find("2 unique kernels, 3 dispatches, 0.010 ms total GPU time") != std::string::npos,
+                "Text summary reports totals");
+    ASSERT_TRUE(t.find(std::string(77, 'x') + "... |") != std::string::npos,
+                "Long kernel names are truncated in the text table");
+    ASSERT_TRUE(t.find("gemm_kernel") != std::string::npos && t.find("80.000%") != std::string::npos,
+                "Text summary lists each kernel with its share of GPU time");
+}
+
+int main() {
+    test_banner("RPV3 Kernel Stats Unit Tests");
+
+    run_test_welford_matches_two_pass();
+    run_test_merge_matches_sequential();
+    run_test_table_concurrent_record();
+    run_test_rows_sorted_by_total();
+    run_test_summary_formats();
+
+    return test_summary("RPV3 Kernel Stats");
+}
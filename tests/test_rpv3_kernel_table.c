@@ -0,0 +1,186 @@
+/* MIT License
+ * Unit tests for rpv3_kernel_table.c
+ * Checks growth past the old 256-kernel cap and concurrent lookups
+ */
+
+#include "../rpv3_kernel_table.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Test counter */
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* Color codes */
+#define RED "\033[0;31m"
+#define GREEN "\033[0;32m"
+#define BLUE "\033[0;34m"
+#define NC "\033[0m"
+
+/* Test macros */
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        tests_run++; \
+        printf(BLUE "Running: " NC "%s\n", #name); \
+        test_##name(); \
+    } \
+    void test_##name()
+
+#define ASSERT_TRUE(cond, msg) \
+    do { \
+        if (cond) { \
+            tests_passed++; \
+            printf(GREEN "  ✓ PASS" NC ": %s\n", msg); \
+        } else { \
+            tests_failed++; \
+            printf(RED "  ✗ FAIL" NC ": %s\n", msg); \
+        } \
+    } while(0)
+
+static void name_for(uint64_t kernel_id, char* out, size_t size) {
+    snprintf(out, size, "Cijk_Ailk_Bljk_SB_MT64x64x16_kernel_%lu", (unsigned long)kernel_id);
+}
+
+/* Test cases */
+
+TEST(insert_lookup) {
+    rpv3_kernel_table_t table;
+    ASSERT_TRUE(rpv3_kernel_table_init(&table, 4) == 0, "Table initializes");
+    ASSERT_TRUE(rpv3_kernel_table_lookup(&table, 1) == NULL, "Empty table finds nothing");
+
+    rpv3_kernel_table_insert(&table, 1, "vector_add");
+    rpv3_kernel_table_insert(&table, 2, "matrix_transpose");
+    ASSERT_TRUE(strcmp(rpv3_kernel_table_lookup(&table, 1), "vector_add") == 0, "First kernel found");
+    ASSERT_TRUE(strcmp(rpv3_kernel_table_lookup(&table, 2), "matrix_transpose") == 0, "Second kernel found");
+
+    const char* first_name = rpv3_kernel_table_lookup(&table, 1);
+    ASSERT_TRUE(rpv3_kernel_table_insert(&table, 1, "vector_add_v2") == 0, "Re-registering succeeds");
+    ASSERT_TRUE(rpv3_kernel_table_lookup(&table, 1) == first_name, "First name wins");
+    ASSERT_TRUE(rpv3_kernel_table_size(&table) == 2, "Re-registering does not add a kernel");
+
+    /* Names longer than the old 256-byte field are kept whole */
+    char long_name[1024];
+    memset(long_name, 'k', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+    rpv3_kernel_table_insert(&table, 3, long_name);
+    ASSERT_TRUE(strlen(rpv3_kernel_table_lookup(&table, 3)) == sizeof(long_name) - 1, "Long names are not truncated");
+
+    rpv3_kernel_table_destroy(&table);
+}
+
+TEST(no_fixed_cap) {
+    rpv3_kernel_table_t table;
+    rpv3_kernel_table_init(&table, 16);
+    char name[128];
+    for (uint64_t id = 0; id < 20000; id++) {
+        name_for(id, name, sizeof(name));
+        rpv3_kernel_table_insert(&table, id * 7919, name);
+    }
+    int all_found = 1;
+    for (uint64_t id = 0; id < 20000; id++) {
+        const char* found = rpv3_kernel_table_lookup(&table, id * 7919);
+        name_for(id, name, sizeof(name));
+        if (!found || strcmp(found, name) != 0) {
+            all_found = 0;
+        }
+    }
+    ASSERT_TRUE(all_found, "20000 kernels survive growth");
+    ASSERT_TRUE(rpv3_kernel_table_size(&table) == 20000, "Size counts every kernel");
+    ASSERT_TRUE(rpv3_kernel_table_lookup(&table, 1) == NULL, "Unregistered id is not found");
+    rpv3_kernel_table_destroy(&table);
+}
+
+/* One writer registers kernels while readers look them up */
+#define STRESS_KERNELS 50000
+#define STRESS_READERS 4
+#define STRESS_LOOKUPS 1000000
+
+static rpv3_kernel_table_t stress_table;
+static atomic_int stress_mismatches = 0;
+static atomic_long stress_hits = 0;
+
+static void* stress_writer(void* arg) {
+    (void)arg;
+    char name[128];
+    for (uint64_t id = 0; id < STRESS_KERNELS; id++) {
+        name_for(id, name, sizeof(name));
+        rpv3_kernel_table_insert(&stress_table, id, name);
+    }
+    return NULL;
+}
+
+static void* stress_reader(void* arg) {
+    uint64_t state = 0x9e3779b97f4a7c15ULL + (uint64_t)(size_t)arg;
+    long hits = 0;
+    char expected[128];
+    for (long i = 0; i < STRESS_LOOKUPS; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        uint64_t id = state % STRESS_KERNELS;
+        const char* found = rpv3_kernel_table_lookup(&stress_table, id);
+        if (found) {
+            hits++;
+            name_for(id, expected, sizeof(expected));
+            if (strcmp(found, expected) != 0) {
+                atomic_fetch_add(&stress_mismatches, 1);
+            }
+        }
+    }
+    atomic_fetch_add(&stress_hits, hits);
+    return NULL;
+}
+
+TEST(concurrent_lookups) {
+    rpv3_kernel_table_init(&stress_table, 16);
+    pthread_t writer;
+    pthread_t readers[STRESS_READERS];
+    pthread_create(&writer, NULL, stress_writer, NULL);
+    for (size_t r = 0; r < STRESS_READERS; r++) {
+        pthread_create(&readers[r], NULL, stress_reader, (void*)r);
+    }
+    pthread_join(writer, NULL);
+    for (size_t r = 0; r < STRESS_READERS; r++) {
+        pthread_join(readers[r], NULL);
+    }
+    printf("    %d lookups, %ld hits\n", STRESS_READERS * STRESS_LOOKUPS, atomic_load(&stress_hits));
+    ASSERT_TRUE(atomic_load(&stress_mismatches) == 0, "Readers never see a wrong or partial name");
+    ASSERT_TRUE(rpv3_kernel_table_size(&stress_table) == STRESS_KERNELS, "Every kernel registered");
+    rpv3_kernel_table_destroy(&stress_table);
+}
+
+int main() {
+    printf("\n");
+    printf(BLUE "========================================\n" NC);
+    printf(BLUE "RPV3 Kernel Table Unit Tests\n" NC);
+    printf(BLUE "========================================\n" NC);
+    printf("\n");
+
+    /* Run all tests */
+    run_test_insert_lookup();
+    run_test_no_fixed_cap();
+    run_test_concurrent_lookups();
+
+    /* Print summary */
+    printf("\n");
+    printf("========================================\n");
+    printf("Test Summary\n");
+    printf("========================================\n");
+    printf("Tests run:    %d\n", tests_run);
+    printf(GREEN "Tests passed: %d\n" NC, tests_passed);
+    printf(RED "Tests failed: %d\n" NC, tests_failed);
+    printf("========================================\n");
+
+    if (tests_failed == 0) {
+        printf(GREEN "All tests passed!\n" NC);
+        return 0;
+    } else {
+        printf(RED "Some tests failed!\n" NC);
+        return 1;
+    }
+}
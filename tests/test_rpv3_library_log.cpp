@@ -0,0 +1,203 @@
+/* MIT License
+ * Unit tests for rpv3_library_log.cpp
+ */
+
+#include "../rpv3_library_log.h"
+#include "test_utils.h"
+
+#include <string>
+#include <vector>
+
+using rpv3::LibraryLog;
+
+namespace {
+
+constexpr uint64_t kMs = 1000000;
+
+const char* kTensileKernel = "Cijk_Ailk_Bljk_SB_MT64x64x16_SE_K1";
+const char* kHipblasltKernel = "Cijk_Alik_Bljk_BBS_BH_Bias_HA_S_SAV_UserArgs_MT128x128x64_MI16x16x1_SN_K1";
+const char* kMiopenKernel = "naive_conv_fwd_nchw_float_double_float";
+const char* kRocsolverKernel = "_ZN9rocsolver4v3_117getf2_small_kernelIdEEviPT_";
+
+bool has_env(const LibraryLog& log, const std::string& name) {
+    for (const char* const* env = log.log_env(); *env; env++) {
+        if (name == *env) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(registry) {
+    ASSERT_EQUALS(4, (int)rpv3::library_logs().size(), "Four libraries");
+    ASSERT_TRUE(rpv3::find_library_log("rocblas") == &rpv3::rocblas_log(), "Found by option name");
+    ASSERT_TRUE(rpv3::find_library_log("rocsolver") == &rpv3::rocsolver_log(), "rocSOLVER");
+    ASSERT_TRUE(rpv3::find_library_log("cublas") == nullptr, "Unknown id");
+    ASSERT_TRUE(has_env(rpv3::rocblas_log(), "ROCBLAS_LOG_BENCH_PATH"), "rocBLAS bench layer path");
+    ASSERT_TRUE(has_env(rpv3::hipblaslt_log(), "HIPBLASLT_LOG_FILE"), "hipBLASLt log file");
+    ASSERT_TRUE(*rpv3::miopen_log().log_env() == nullptr, "MIOpen logs to stderr only");
+    ASSERT_TRUE(rpv3::rocsolver_log().pairing() == rpv3::LogPairing::Span, "rocSOLVER spans its kernels");
+}
+
+TEST(routing) {
+    const std::vector<const LibraryLog*> all = rpv3::library_logs();
+    ASSERT_EQUALS(0, rpv3::route_kernel(all, kTensileKernel), "Plain Tensile kernel goes to rocBLAS first");
+    ASSERT_EQUALS(1, rpv3::route_kernel(all, kHipblasltKernel), "hipBLASLt user-argument kernel");
+    ASSERT_EQUALS(2, rpv3::route_kernel(all, kMiopenKernel), "MIOpen solver kernel");
+    ASSERT_EQUALS(3, rpv3::route_kernel(all, kRocsolverKernel), "rocSOLVER kernel");
+    ASSERT_EQUALS(-1, rpv3::route_kernel(all, "_Z10vector_addPfS_S_i"), "Application kernel");
+    ASSERT_EQUALS(-1, rpv3::route_kernel(all, "batched_transpose_32x32_dword"), "MIOpen helper not claimed");
+
+    const std::vector<const LibraryLog*> lt_only = {&rpv3::hipblaslt_log()};
+    ASSERT_EQUALS(0, rpv3::route_kernel(lt_only, kTensileKernel), "Any Tensile kernel without rocBLAS");
+    const std::vector<const LibraryLog*> none;
+    ASSERT_EQUALS(-1, rpv3::route_kernel(none, kTensileKernel), "No libraries enabled");
+}
+
+TEST(rocblas_lines) {
+    const LibraryLog& log = rpv3::rocblas_log();
+    ASSERT_TRUE(log.is_call_line("rocblas_sgemm,N,T,64,64,64,1,0x1,64,0x2,64,0,0x3,64"), "Trace line");
+    ASSERT_TRUE(!log.is_call_line("rocblas_create_handle"), "Bookkeeping skipped");
+    ASSERT_TRUE(!log.is_call_line(""), "Empty line skipped");
+    ASSERT_TRUE(log.is_call_line("./rocblas-bench -f gemm_strided_batched_ex -r f16_r -m 64"), "Bench line");
+    ASSERT_TRUE(!log.is_call_line("rocblas_sgemv,N,64,64,1,0x1,64,0x2,1,0,0x3,1"), "gemv runs no Tensile kernel");
+    ASSERT_TRUE(!log.is_call_line("./rocblas-bench -f axpy -r f32_r -n 1024"), "Nor does axpy");
+    ASSERT_TRUE(log.is_call_line("rocblas_dtrsm,L,U,N,N,256,128,1,0x1,256,0x2,256"), "trsm runs Tensile gemms");
+    ASSERT_TRUE(log.is_call_line("./rocblas-bench -f syrk_strided_batched -r f32_r -n 512"), "So do batched syrks");
+    ASSERT_TRUE(log.is_call_line("rocblas_zherk,U,N,64,64"), "And herk");
+    ASSERT_TRUE(!log.spans_kernels("rocblas_hgemm_batched,N,N,64") && !log.spans_kernels("rocblas_gemm_strided_batched_ex,N"),
+                "A gemm runs one kernel");
+    ASSERT_TRUE(log.spans_kernels("rocblas_strsm_batched,L,U,N,N,64") && log.spans_kernels("./rocblas-bench -f trmm -r f32_r"),
+                "Other routines run several");
+    ASSERT_TRUE(!log.is_call_line("rocblas_sgemmx,N,N,64"), "Only known routines");
+    ASSERT_TRUE(log.call_key("rocblas_sgemm,N,T,64") == "rocblas_sgemm", "Trace key");
+    ASSERT_TRUE(log.call_key("./rocblas-bench -f gemm_ex --transposeA N -m 64") == "gemm_ex", "Bench key");
+
+    rpv3::BlasCall call;
+    ASSERT_TRUE(log.parse_call("rocblas_sgemm,N,T,128,64,32,1,0x1,128,0x2,64,0,0x3,128", call), "Typed call");
+    ASSERT_EQUALS(128, (int)call.m, "M parsed");
+    ASSERT_TRUE(!rpv3::hipblaslt_log().parse_call("rocblas_sgemm,N,T,128,64,32", call), "Only rocBLAS parses");
+}
+
+/* The reader thread's filter in front of the correlator */
+TEST(rocblas_pairs_gemms_only) {
+    const LibraryLog& log = rpv3::rocblas_log();
+    rpv3::LogCorrelator correlator(10 * kMs);
+    const char* lines[] = {
+        "rocblas_sgemm,N,N,64,64,64,1,0x1,64,0x2,64,0,0x3,64",
+        "rocblas_saxpy,1024,1,0x1,1,0x2,1",
+        "rocblas_dgemm,T,N,128,128,128,1,0x1,128,0x2,128,0,0x3,128",
+    };
+    uint64_t arrived = 0;
+    for (const char* line : lines) {
+        arrived += kMs;
+        if (log.is_call_line(line)) {
+            correlator.push_line(arrived, line);
+        }
+    }
+    /* Only the two GEMMs launched a claimed kernel */
+    for (uint64_t dispatch_id = 1; dispatch_id <= 2; dispatch_id++) {
+        rpv3::PendingDispatch dispatch;
+        dispatch.dispatch_id = dispatch_id;
+        dispatch.timestamp_ns = (dispatch_id * 2) * kMs;
+        dispatch.recorded = true;
+        correlator.push_dispatch(std::move(dispatch));
+    }
+
+    std::vector<std::string> paired(3);
+    correlator.match(20 * kMs, [&paired](const rpv3::PendingDispatch& dispatch, const rpv3::LogLine* line) {
+        paired[dispatch.dispatch_id] = line ? line->text : std::string();
+    });
+    ASSERT_TRUE(paired[1] == lines[0], "First GEMM line on the first dispatch");
+    ASSERT_TRUE(paired[2] == lines[2], "axpy line skipped, second GEMM line on the second dispatch");
+    ASSERT_EQUALS(0, (int)correlator.unmatched_lines(), "No line left over");
+}
+
+TEST(rocblas_trsm_keeps_its_gemms) {
+    const LibraryLog& log = rpv3::rocblas_log();
+    rpv3::LogCorrelator correlator(10 * kMs);
+    const char* trsm = "rocblas_strsm,L,L,N,N,2048,2048,1,0x1,2048,0x2,2048";
+    const char* gemm = "rocblas_sgemm,N,N,64,64,64,1,0x1,64,0x2,64,0,0x3,64";
+    const char* small_trsm = "rocblas_strsm,L,L,N,N,16,16,1,0x1,16,0x2,16";
+    const char* dgemm = "rocblas_dgemm,T,N,128,128,128,1,0x1,128,0x2,128,0,0x3,128";
+    auto push = [&](uint64_t arrived, const char* line) {
+        if (log.is_call_line(line)) {
+            correlator.push_line(arrived, line, log.spans_kernels(line));
+        }
+    };
+    auto dispatch = [&](uint64_t dispatch_id, uint64_t start) {
+        rpv3::PendingDispatch pending;
+        pending.dispatch_id = dispatch_id;
+        pending.timestamp_ns = start;
+        pending.recorded = true;
+        correlator.push_dispatch(std::move(pending));
+    };
+    /* The trsm runs three Tensile gemms, the small one only its own kernels */
+    push(1 * kMs, trsm);
+    dispatch(1, 2 * kMs);
+    dispatch(2, 3 * kMs);
+    dispatch(3, 4 * kMs);
+    push(5 * kMs, gemm);
+    dispatch(4, 6 * kMs);
+    push(7 * kMs, small_trsm);
+    push(8 * kMs, dgemm);
+    dispatch(5, 9 * kMs);
+
+    std::vector<std::string> paired(6);
+    correlator.flush([&paired](const rpv3::PendingDispatch& pending, const rpv3::LogLine* line) {
+        paired[pending.dispatch_id] = line ? line->text : std::string();
+    });
+    ASSERT_TRUE(paired[1] == trsm && paired[2] == trsm && paired[3] == trsm, "The trsm line covers its gemms");
+    ASSERT_TRUE(paired[4] == gemm, "The gemm line pairs with the gemm dispatch");
+    ASSERT_TRUE(paired[5] == dgemm, "A trsm without Tensile kernels takes none");
+    ASSERT_EQUALS(1, (int)correlator.unmatched_lines(), "Small trsm left without a dispatch");
+    ASSERT_EQUALS(0, (int)correlator.unmatched_dispatches(), "Every dispatch has its line");
+}
+
+TEST(hipblaslt_lines) {
+    const LibraryLog& log = rpv3::hipblaslt_log();
+    const char* bench = "hipblaslt-bench --api_method c -m 4096 -n 4096 -k 4096 --a_type f16_r --b_type f16_r";
+    const char* trace = "[2024-05-01 10:00:00][HIPBLASLT][1234][Trace][hipblasLtMatmul] A=0x7f00 Adesc=[type=R_16F]";
+    ASSERT_TRUE(log.is_call_line(bench) && log.is_call_line(trace), "Bench and trace matmuls");
+    ASSERT_TRUE(!log.is_call_line("[2024-05-01 10:00:00][HIPBLASLT][1234][Trace][hipblasLtMatmulDescCreate] "),
+                "Descriptor calls launch nothing");
+    ASSERT_TRUE(log.call_key(bench) == "hipblasLtMatmul", "Key");
+}
+
+TEST(miopen_lines) {
+    const LibraryLog& log = rpv3::miopen_log();
+    const char* command = "MIOpen(HIP): Command [LogCmdConvolution] ./bin/MIOpenDriver convfp16 -n 32 -c 64 "
+                          "-H 56 -W 56 -k 64 -y 3 -x 3 -p 1 -q 1 -u 1 -v 1 -l 1 -j 1 -m conv -g 1 -F 1 -t 1";
+    ASSERT_TRUE(log.is_call_line(command), "Convolution command");
+    ASSERT_TRUE(!log.is_call_line("MIOpen(HIP): Command [LogCmdBNorm] ./bin/MIOpenDriver bnormfp16 -n 32"),
+                "Batch norm commands are not paired");
+    ASSERT_TRUE(!log.is_call_line("MIOpen(HIP): Info [FindSolution] ConvHipImplicitGemm"), "Info line");
+    ASSERT_TRUE(log.call_key(command) == "convfp16", "Driver subcommand");
+}
+
+TEST(rocsolver_lines) {
+    const LibraryLog& log = rpv3::rocsolver_log();
+    ASSERT_TRUE(log.is_call_line("rocsolver_dgetrf(handle=0x1, m=1024, n=1024, A=0x2, lda=1024)"), "Trace line");
+    ASSERT_TRUE(!log.is_call_line("    rocsolver_dgetf2(handle=0x1, m=1024, n=64)"), "Nested call skipped");
+    ASSERT_TRUE(!log.is_call_line("------- ENTER rocsolver_dgetrf trace tree -------"), "Tree marker skipped");
+    ASSERT_TRUE(log.is_call_line("rocsolver-bench -f getrf -r d -m 1024 -n 1024 --lda 1024"), "Bench line");
+    ASSERT_TRUE(log.call_key("rocsolver_dgetrf(handle=0x1, m=1024)") == "rocsolver_dgetrf", "Trace key");
+    ASSERT_TRUE(log.call_key("rocsolver-bench -f getrf -r d -m 1024") == "getrf", "Bench key");
+}
+
+int main() {
+    test_banner("RPV3 Library Log Unit Tests");
+
+    run_test_registry();
+    run_test_routing();
+    run_test_rocblas_lines();
+    run_test_rocblas_pairs_gemms_only();
+    run_test_rocblas_trsm_keeps_its_gemms();
+    run_test_hipblaslt_lines();
+    run_test_miopen_lines();
+    run_test_rocsolver_lines();
+
+    return test_summary("RPV3 Library Log");
+}
@@ -0,0 +1,247 @@
+/* MIT License
+ * Unit tests for rpv3_line_reader.cpp
+ */
+
+#include "../rpv3_line_reader.h"
+#include "test_utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using rpv3::LineReader;
+
+namespace {
+
+struct Pipe {
+    int fds[2] = {-1, -1};
+    Pipe() {
+        if (pipe(fds) == 0) {
+            fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        }
+    }
+    ~Pipe() {
+        close(fds[0]);
+        if (fds[1] != -1) close(fds[1]);
+    }
+    void write_text(const std::string& text) {
+        ssize_t n = write(fds[1], text.data(), text.size());
+        (void)n;
+    }
+    void close_writer() {
+        close(fds[1]);
+        fds[1] = -1;
+    }
+};
+
+std::vector<std::string> read_all(LineReader& reader, int fd) {
+    std::vector<std::string> lines;
+    std::string line;
+    while (reader.next_line(fd, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+std::string read_file(const char* path) {
+    std::string text;
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        return text;
+    }
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        text.append(chunk, n);
+    }
+    fclose(in);
+    return text;
+}
+
+// Synthetic rocBLAS trace log, several times the reader's buffer
+std::string synthetic_log(size_t bytes) {
+    std::string log;
+    for (int i = 0; log.size() < bytes; i++) {
+        log += "rocblas_sgemm,N,T," + std::to_string(64 + i % 4096) + ",512,256,1,0x7f00,1024,0x7f01,512,0,0x7f02,1024\n";
+        if (i % 97 == 0) {
+            log += "rocblas_set_stream,0x1\r\n";
+        }
+    }
+    return log;
+}
+
+} // namespace
+
+TEST(splits_lines) {
+    Pipe p;
+    LineReader reader;
+    p.write_text("rocblas_sgemm,N,N,128\r\nrocblas_create_handle\n\nrocblas_dgemv,T");
+
+    std::vector<std::string> lines = read_all(reader, p.fds[0]);
+    ASSERT_EQUALS(3, (int)lines.size(), "Complete lines are returned, the partial one is held");
+    ASSERT_TRUE(lines[0] == "rocblas_sgemm,N,N,128", "CRLF is stripped");
+    ASSERT_TRUE(lines[1] == "rocblas_create_handle" && lines[2].empty(), "Lines come back in order");
+    ASSERT_TRUE(rpv3::is_rocblas_bookkeeping(lines[1]) && !rpv3::is_rocblas_bookkeeping(lines[0]),
+                "Handle bookkeeping lines are recognised");
+
+    p.write_text(",64,64\nrocblas_set_stream,0x1\n");
+    lines = read_all(reader, p.fds[0]);
+    ASSERT_TRUE(lines.size() == 2 && lines[0] == "rocblas_dgemv,T,64,64",
+                "Held partial line is completed by the next write");
+}
+
+TEST(one_read_per_chunk) {
+    Pipe p;
+    LineReader reader;
+    std::string text;
+    for (int i = 0; i < 100; i++) {
+        text += "rocblas_gemm_ex,N,T,1024,1024,1024,alpha,1,f16_r,1024,f16_r,1024,beta,0,f32_r,1024\n";
+    }
+    p.write_text(text);
+    std::vector<std::string> lines = read_all(reader, p.fds[0]);
+    ASSERT_EQUALS(100, (int)lines.size(), "All lines read");
+    ASSERT_TRUE(reader.read_calls() <= 2, "A batch of lines costs one read plus the EAGAIN probe");
+    ASSERT_TRUE(reader.bytes_read() == text.size(), "Byte count matches");
+}
+
+TEST(tee_gets_raw_bytes) {
+    Pipe p;
+    LineReader reader;
+    char* teed = nullptr;
+    size_t teed_size = 0;
+    FILE* tee = open_memstream(&teed, &teed_size);
+    reader.set_tee(tee);
+
+    const std::string text = "rocblas_create_handle\r\nrocblas_sgemm,N,N\npartial";
+    p.write_text(text);
+    std::string line;
+    ASSERT_TRUE(reader.next_line(p.fds[0], line), "First line available");
+    fclose(tee);
+    ASSERT_TRUE(std::string(teed, teed_size) == text, "Tee receives every byte read, unfiltered");
+    free(teed);
+    reader.set_tee(nullptr);
+}
+
+TEST(fifo_tee_is_byte_identical) {
+    char fifo[64];
+    char log_path[64];
+    snprintf(fifo, sizeof(fifo), "/tmp/rpv3_tee_fifo_%d", (int)getpid());
+    snprintf(log_path, sizeof(log_path), "/tmp/rpv3_tee_log_%d", (int)getpid());
+    ASSERT_TRUE(mkfifo(fifo, 0600) == 0, "FIFO created");
+    int fd = open(fifo, O_RDONLY | O_NONBLOCK);
+    FILE* tee = fopen(log_path, "w");
+
+    // Writer in odd-sized chunks so lines straddle reads
+    const std::string log = synthetic_log(1024 * 1024);
+    std::thread writer([&]() {
+        int out = open(fifo, O_WRONLY);
+        for (size_t offset = 0, chunk = 1; offset < log.size(); offset += chunk, chunk = chunk * 7 % 9001 + 1) {
+            size_t length = std::min(chunk, log.size() - offset);
+            for (size_t done = 0; done < length;) {
+                ssize_t n = write(out, log.data() + offset + done, length - done);
+                if (n > 0) done += (size_t)n;
+            }
+        }
+        close(out);
+    });
+
+    LineReader reader(4096);
+    reader.set_tee(tee);
+    std::string line;
+    size_t lines = 0;
+    while (reader.bytes_read() < log.size()) {
+        if (reader.next_line(fd, line)) {
+            lines++;
+        } else {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            poll(&pfd, 1, 10);
+        }
+    }
+    while (reader.next_line(fd, line)) {
+        lines++;
+    }
+    writer.join();
+    reader.set_tee(nullptr);
+    fclose(tee);
+    close(fd);
+
+    std::string teed = read_file(log_path);
+    unlink(fifo);
+    unlink(log_path);
+    ASSERT_TRUE(teed.size() == log.size(), "Log has every byte");
+    ASSERT_TRUE(teed == log, "Log is byte-for-byte identical");
+    ASSERT_TRUE(reader.spliced_bytes() == log.size(), "Copied in the kernel with tee/splice");
+    size_t newlines = 0;
+    for (char c : log) newlines += (c == '\n');
+    ASSERT_EQUALS((int)newlines, (int)lines, "Every line parsed as well");
+}
+
+TEST(regular_file_tee_falls_back) {
+    char in_path[64];
+    char log_path[64];
+    snprintf(in_path, sizeof(in_path), "/tmp/rpv3_tee_in_%d", (int)getpid());
+    snprintf(log_path, sizeof(log_path), "/tmp/rpv3_tee_log_%d", (int)getpid());
+    const std::string log = synthetic_log(100 * 1024);
+    FILE* in = fopen(in_path, "wb");
+    fwrite(log.data(), 1, log.size(), in);
+    fclose(in);
+
+    int fd = open(in_path, O_RDONLY);
+    FILE* tee = fopen(log_path, "w");
+    LineReader reader;
+    reader.set_tee(tee);
+    read_all(reader, fd);
+    reader.set_tee(nullptr);
+    fclose(tee);
+    close(fd);
+
+    std::string teed = read_file(log_path);
+    unlink(in_path);
+    unlink(log_path);
+    ASSERT_TRUE(teed == log, "Log is byte-for-byte identical");
+    ASSERT_TRUE(reader.spliced_bytes() == 0, "Regular file input uses the buffered copy");
+}
+
+TEST(long_lines_truncated) {
+    Pipe p;
+    LineReader reader(16);
+    p.write_text(std::string(40, 'x') + "\nshort\n");
+    std::vector<std::string> lines = read_all(reader, p.fds[0]);
+    ASSERT_EQUALS(2, (int)lines.size(), "Overlong line yields one truncated line");
+    ASSERT_TRUE(lines[0] == std::string(15, 'x'), "Truncated to capacity - 1 bytes");
+    ASSERT_TRUE(lines[1] == "short", "Reader resynchronises at the next newline");
+    ASSERT_TRUE(reader.truncated_lines() == 1, "Truncation is counted");
+}
+
+TEST(eof) {
+    Pipe p;
+    LineReader reader;
+    p.write_text("last line\n");
+    p.close_writer();
+    std::vector<std::string> lines = read_all(reader, p.fds[0]);
+    ASSERT_TRUE(lines.size() == 1 && lines[0] == "last line", "Lines before EOF are returned");
+    std::string line;
+    ASSERT_TRUE(!reader.next_line(p.fds[0], line), "EOF returns false");
+}
+
+int main() {
+    test_banner("RPV3 Line Reader Unit Tests");
+
+    run_test_splits_lines();
+    run_test_one_read_per_chunk();
+    run_test_tee_gets_raw_bytes();
+    run_test_fifo_tee_is_byte_identical();
+    run_test_regular_file_tee_falls_back();
+    run_test_long_lines_truncated();
+    run_test_eof();
+
+    return test_summary("RPV3 Line Reader");
+}
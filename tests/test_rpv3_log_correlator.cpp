@@ -0,0 +1,292 @@
+/* MIT License
+ * Unit tests for rpv3_log_correlator.cpp
+ */
+
+#include "../rpv3_log_correlator.h"
+#include "test_utils.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using rpv3::LogCorrelator;
+using rpv3::LogLine;
+using rpv3::PendingDispatch;
+
+namespace {
+
+constexpr uint64_t kMs = 1000000;
+
+struct Resolved {
+    uint64_t dispatch_id;
+    std::string record;
+    std::string line;  // Empty when resolved without a line
+};
+
+struct Collector {
+    std::vector<Resolved> resolved;
+    LogCorrelator::Sink sink() {
+        return [this](const PendingDispatch& dispatch, const LogLine* line) {
+            resolved.push_back({dispatch.dispatch_id, dispatch.record, line ? line->text : std::string()});
+        };
+    }
+};
+
+PendingDispatch make_dispatch(uint64_t dispatch_id, uint64_t start_ns, bool recorded = true) {
+    PendingDispatch dispatch;
+    dispatch.dispatch_id = dispatch_id;
+    dispatch.timestamp_ns = start_ns;
+    dispatch.recorded = recorded;
+    dispatch.record = "record " + std::to_string(dispatch_id);
+    return dispatch;
+}
+
+} // namespace
+
+TEST(pairs_in_order) {
+    LogCorrelator correlator(10 * kMs);
+    Collector out;
+    correlator.push_line(1 * kMs, "rocblas_sgemm,N,N,64,64,64");
+    correlator.push_line(2 * kMs, "rocblas_dgemm,T,N,128,128,128");
+    correlator.push_dispatch(make_dispatch(7, 3 * kMs));
+    correlator.push_dispatch(make_dispatch(8, 4 * kMs));
+
+    ASSERT_TRUE(correlator.try_match(5 * kMs, out.sink()), "Uncontended try_match runs");
+    ASSERT_EQUALS(2, (int)out.resolved.size(), "Both dispatches resolved");
+    ASSERT_TRUE(out.resolved[0].dispatch_id == 7 && out.resolved[0].line == "rocblas_sgemm,N,N,64,64,64",
+                "First line goes to the first dispatch");
+    ASSERT_TRUE(out.resolved[1].record == "record 8" && out.resolved[1].line == "rocblas_dgemm,T,N,128,128,128",
+                "Record travels with its line");
+    ASSERT_TRUE(correlator.matched() == 2 && correlator.unmatched_dispatches() == 0, "Both counted as matched");
+}
+
+TEST(dispatch_waits_for_line) {
+    LogCorrelator correlator(10 * kMs);
+    Collector out;
+    correlator.push_dispatch(make_dispatch(1, 100 * kMs));
+    correlator.match(101 * kMs, out.sink());
+    ASSERT_EQUALS(0, (int)out.resolved.size(), "Dispatch is held while its line may still arrive");
+
+    correlator.push_line(102 * kMs, "rocblas_sgemm");
+    correlator.match(102 * kMs, out.sink());
+    ASSERT_TRUE(out.resolved.size() == 1 && out.resolved[0].line == "rocblas_sgemm", "Late line is attached");
+
+    correlator.push_dispatch(make_dispatch(2, 200 * kMs));
+    correlator.match(205 * kMs, out.sink());
+    ASSERT_EQUALS(1, (int)out.resolved.size(), "Still inside the window");
+    correlator.match(211 * kMs, out.sink());
+    ASSERT_TRUE(out.resolved.size() == 2 && out.resolved[1].line.empty() && out.resolved[1].record == "record 2",
+                "Record is released without a line once the window passes");
+    ASSERT_EQUALS(1, (int)correlator.unmatched_dispatches(), "Counted as unmatched");
+}
+
+TEST(window_resynchronises) {
+    // Dispatch 1 came from a library that logs nothing; the first line is
+    // dispatch 2's and arrived long after dispatch 1 started
+    LogCorrelator correlator(10 * kMs);
+    Collector out;
+    correlator.push_dispatch(make_dispatch(1, 0));
+    correlator.push_dispatch(make_dispatch(2, 90 * kMs));
+    correlator.push_line(95 * kMs, "rocblas_gemm_ex");
+    correlator.match(96 * kMs, out.sink());
+
+    ASSERT_EQUALS(2, (int)out.resolved.size(), "Both dispatches resolved");
+    ASSERT_TRUE(out.resolved[0].line.empty(), "Early dispatch does not take a later line");
+    ASSERT_TRUE(out.resolved[1].line == "rocblas_gemm_ex", "Line goes to the dispatch it belongs to");
+
+    // Lines may precede their dispatch by any amount (queued kernels)
+    correlator.push_line(100 * kMs, "rocblas_sgemm");
+    correlator.push_dispatch(make_dispatch(3, 900 * kMs));
+    correlator.match(901 * kMs, out.sink());
+    ASSERT_TRUE(out.resolved.size() == 3 && out.resolved[2].line == "rocblas_sgemm", "Old lines still match");
+}
+
+TEST(flush) {
+    LogCorrelator correlator(10 * kMs);
+    Collector out;
+    correlator.push_dispatch(make_dispatch(1, 100 * kMs));
+    correlator.push_dispatch(make_dispatch(2, 100 * kMs, false));
+    correlator.flush(out.sink());
+    ASSERT_EQUALS(2, (int)out.resolved.size(), "Flush resolves waiting dispatches");
+    ASSERT_EQUALS(2, (int)correlator.unmatched_dispatches(), "Both resolved without lines");
+
+    correlator.push_line(100 * kMs, "rocblas_sgemm");
+    correlator.push_line(100 * kMs, "rocblas_dgemm");
+    correlator.push_dispatch(make_dispatch(3, 100 * kMs));
+    ASSERT_TRUE(correlator.try_match(0, out.sink()), "Matching after a flush");
+    ASSERT_TRUE(out.resolved.size() == 3 && out.resolved[2].line == "rocblas_sgemm",
+                "Late dispatches still pair with queued lines");
+
+    correlator.push_dispatch(make_dispatch(4, 500 * kMs));
+    correlator.push_dispatch(make_dispatch(5, 500 * kMs));
+    correlator.try_match(0, out.sink());
+    ASSERT_EQUALS(5, (int)out.resolved.size(), "After a flush nothing waits for the window");
+
+    correlator.push_line(600 * kMs, "rocblas_unclaimed");
+    correlator.flush(out.sink());
+    ASSERT_EQUALS(1, (int)correlator.unmatched_lines(), "Lines no dispatch claimed are counted");
+}
+
+TEST(span_pairing) {
+    // rocSOLVER: each call runs several kernels
+    LogCorrelator correlator(1 * kMs, rpv3::LogPairing::Span);
+    Collector out;
+    correlator.push_line(10 * kMs, "rocsolver_dgetrf");
+    correlator.push_dispatch(make_dispatch(1, 11 * kMs));
+    correlator.push_dispatch(make_dispatch(2, 12 * kMs));
+    correlator.match(12 * kMs + kMs / 2, out.sink());
+    ASSERT_EQUALS(1, (int)out.resolved.size(), "Last dispatch waits while a new call may still start");
+
+    correlator.push_line(20 * kMs, "rocsolver_dpotrf");
+    correlator.push_dispatch(make_dispatch(3, 20 * kMs));
+    correlator.match(20 * kMs, out.sink());
+    ASSERT_EQUALS(2, (int)out.resolved.size(), "A later line settles the earlier dispatch");
+    ASSERT_TRUE(out.resolved[0].line == "rocsolver_dgetrf" && out.resolved[1].line == "rocsolver_dgetrf",
+                "One line covers every kernel of its call");
+
+    // A line read slightly after its kernel started is still taken
+    correlator.push_line(30 * kMs + kMs / 2, "rocsolver_dgeqrf");
+    correlator.push_line(31 * kMs + kMs / 2, "rocsolver_dormqr");
+    correlator.push_dispatch(make_dispatch(4, 30 * kMs));
+    correlator.push_dispatch(make_dispatch(5, 32 * kMs));
+    correlator.match(40 * kMs, out.sink());
+    ASSERT_EQUALS(5, (int)out.resolved.size(), "All resolved past the window");
+    ASSERT_TRUE(out.resolved[2].line == "rocsolver_dpotrf", "Dispatch 3 belongs to the call before it");
+    ASSERT_TRUE(out.resolved[3].line == "rocsolver_dgeqrf", "Lag inside the window");
+    ASSERT_TRUE(out.resolved[4].line == "rocsolver_dormqr", "Next call takes over");
+    ASSERT_EQUALS(5, (int)correlator.matched(), "Every dispatch has a call");
+
+    // Calls that launched no claimed kernel are skipped over
+    correlator.push_line(50 * kMs, "rocsolver_dlaswp");
+    correlator.push_line(51 * kMs, "rocsolver_dgetrs");
+    correlator.push_dispatch(make_dispatch(6, 52 * kMs));
+    correlator.flush(out.sink());
+    ASSERT_TRUE(out.resolved.size() == 6 && out.resolved[5].line == "rocsolver_dgetrs", "Latest call wins");
+    ASSERT_EQUALS(1, (int)correlator.unmatched_lines(), "Skipped call counted as unclaimed");
+
+    LogCorrelator fresh(1 * kMs, rpv3::LogPairing::Span);
+    fresh.push_dispatch(make_dispatch(1, 5 * kMs));
+    fresh.match(10 * kMs, out.sink());
+    ASSERT_TRUE(out.resolved.size() == 7 && out.resolved[6].line.empty(), "No call before the first line");
+    ASSERT_EQUALS(1, (int)fresh.unmatched_dispatches(), "Counted without a line");
+}
+
+TEST(span_lines) {
+    // One-per-call pairing with a line that may run several kernels
+    LogCorrelator correlator(10 * kMs);
+    Collector out;
+    correlator.push_line(1 * kMs, "rocblas_strsm", true);
+    correlator.push_dispatch(make_dispatch(1, 2 * kMs));
+    correlator.push_dispatch(make_dispatch(2, 3 * kMs));
+    correlator.match(4 * kMs, out.sink());
+    ASSERT_EQUALS(1, (int)out.resolved.size(), "A later kernel waits for a line that may still come");
+
+    correlator.push_line(4 * kMs, "rocblas_sgemm");
+    correlator.match(4 * kMs, out.sink());
+    ASSERT_TRUE(out.resolved.size() == 2 && out.resolved[1].line == "rocblas_strsm",
+                "A line read after the kernel started does not take it");
+
+    correlator.push_dispatch(make_dispatch(3, 5 * kMs));
+    correlator.push_dispatch(make_dispatch(4, 6 * kMs));
+    correlator.match(20 * kMs, out.sink());
+    ASSERT_TRUE(out.resolved.size() == 4 && out.resolved[2].line == "rocblas_sgemm", "The gemm ends the span");
+    ASSERT_TRUE(out.resolved[3].line.empty(), "A one-kernel call covers nothing after it");
+    ASSERT_EQUALS(1, (int)correlator.unmatched_dispatches(), "Dispatch without a line counted");
+}
+
+TEST(try_match_never_waits) {
+    LogCorrelator correlator(10 * kMs);
+    std::atomic<bool> in_sink{false};
+    std::atomic<bool> release{false};
+    correlator.push_line(0, "rocblas_sgemm");
+    correlator.push_dispatch(make_dispatch(1, 0));
+
+    std::thread matcher([&] {
+        correlator.match(0, [&](const PendingDispatch&, const LogLine*) {
+            in_sink = true;
+            while (!release) {
+                std::this_thread::yield();
+            }
+        });
+    });
+    while (!in_sink) {
+        std::this_thread::yield();
+    }
+    correlator.push_dispatch(make_dispatch(2, 0));
+    bool ran = correlator.try_match(0, [](const PendingDispatch&, const LogLine*) {});
+    release = true;
+    matcher.join();
+    ASSERT_TRUE(!ran, "try_match returns at once while another thread matches");
+}
+
+/* Several callback threads push dispatches and try to match while a reader
+ * thread pushes lines and matches. Every dispatch must be resolved exactly
+ * once with a line, and each thread's dispatches in the order it pushed them. */
+TEST(concurrent_stress) {
+    constexpr int kThreads = 4;
+    constexpr uint64_t kPerThread = 25000;
+    constexpr uint64_t kTotal = kThreads * kPerThread;
+
+    LogCorrelator correlator(~0ULL / 4);
+    std::vector<uint64_t> next_expected(kThreads, 0);
+    std::atomic<uint64_t> order_errors{0};
+    std::atomic<uint64_t> resolved{0};
+    std::atomic<uint64_t> with_line{0};
+    // The sink runs under the matcher lock, so it needs no locking of its own
+    LogCorrelator::Sink sink = [&](const PendingDispatch& dispatch, const LogLine* line) {
+        uint64_t thread = dispatch.dispatch_id / kPerThread;
+        uint64_t index = dispatch.dispatch_id % kPerThread;
+        if (next_expected[thread] != index) {
+            order_errors.fetch_add(1);
+        }
+        next_expected[thread] = index + 1;
+        resolved.fetch_add(1);
+        if (line) {
+            with_line.fetch_add(1);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&, t] {
+            for (uint64_t i = 0; i < kPerThread; i++) {
+                correlator.push_dispatch(make_dispatch((uint64_t)t * kPerThread + i, 0));
+                correlator.try_match(0, sink);
+            }
+        });
+    }
+    threads.emplace_back([&] {
+        for (uint64_t i = 0; i < kTotal; i++) {
+            correlator.push_line(0, "rocblas_sgemm");
+            if (i % 64 == 0) {
+                correlator.match(0, sink);
+            }
+        }
+    });
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    correlator.flush(sink);
+
+    printf("    %lu dispatches, %lu matched\n", (unsigned long)resolved.load(), (unsigned long)correlator.matched());
+    ASSERT_TRUE(resolved.load() == kTotal, "Every dispatch resolved exactly once");
+    ASSERT_TRUE(with_line.load() == kTotal && correlator.unmatched_lines() == 0, "Every line claimed");
+    ASSERT_TRUE(order_errors.load() == 0, "Per-thread dispatch order is preserved");
+}
+
+int main() {
+    test_banner("RPV3 Log Correlator Unit Tests");
+
+    run_test_pairs_in_order();
+    run_test_dispatch_waits_for_line();
+    run_test_window_resynchronises();
+    run_test_flush();
+    run_test_span_pairing();
+    run_test_span_lines();
+    run_test_try_match_never_waits();
+    run_test_concurrent_stress();
+
+    return test_summary("RPV3 Log Correlator");
+}
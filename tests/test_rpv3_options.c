@@ -164,6 +164,306 @@ TEST(csv_option) {
     ASSERT_EQUALS(1, rpv3_csv_enabled, "rpv3_csv_enabled should be set to 1");
 }
 
+TEST(async_option) {
+    setenv("RPV3_OPTIONS", "--async", 1);
+    rpv3_async_enabled = 0;
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "--async should return CONTINUE");
+    ASSERT_EQUALS(1, rpv3_async_enabled, "rpv3_async_enabled should be set to 1");
+}
+
+TEST(ring_options) {
+    setenv("RPV3_OPTIONS", "--ring-size 64K --ring-policy spill", 1);
+    rpv3_async_enabled = 0;
+    rpv3_ring_size = RPV3_DEFAULT_RING_SIZE;
+    rpv3_ring_policy = RPV3_RING_POLICY_BLOCK;
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "Ring options should return CONTINUE");
+    ASSERT_EQUALS(65536, (int)rpv3_ring_size, "--ring-size 64K should set 65536 bytes");
+    ASSERT_EQUALS(RPV3_RING_POLICY_SPILL, rpv3_ring_policy, "--ring-policy spill should be selected");
+    ASSERT_EQUALS(1, rpv3_async_enabled, "Ring options should imply --async");
+}
+
+TEST(invalid_ring_size) {
+    setenv("RPV3_OPTIONS", "--ring-size 12Q", 1);
+    rpv3_ring_size = RPV3_DEFAULT_RING_SIZE;
+    redirect_output();
+    rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS((int)RPV3_DEFAULT_RING_SIZE, (int)rpv3_ring_size, "Invalid ring size should be ignored");
+}
+
+TEST(format_option) {
+    setenv("RPV3_OPTIONS", "--format binary", 1);
+    rpv3_output_format = RPV3_FORMAT_TEXT;
+    rpv3_csv_enabled = 0;
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "--format binary should return CONTINUE");
+    ASSERT_EQUALS(RPV3_FORMAT_BINARY, rpv3_output_format, "--format binary should select binary output");
+    ASSERT_EQUALS(0, rpv3_csv_enabled, "--format binary should not enable CSV");
+
+    setenv("RPV3_OPTIONS", "--format csv", 1);
+    redirect_output();
+    rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(1, rpv3_csv_enabled, "--format csv should set rpv3_csv_enabled");
+    rpv3_output_format = RPV3_FORMAT_TEXT;
+    rpv3_csv_enabled = 0;
+}
+
+TEST(backtrace_binary_incompatible) {
+    setenv("RPV3_OPTIONS", "--backtrace --format binary", 1);
+    rpv3_backtrace_enabled = 0;
+    rpv3_output_format = RPV3_FORMAT_TEXT;
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_EXIT, result, "--backtrace with --format binary should return EXIT");
+    rpv3_backtrace_enabled = 0;
+    rpv3_output_format = RPV3_FORMAT_TEXT;
+}
+
+TEST(summary_option) {
+    setenv("RPV3_OPTIONS", "--summary --csv", 1);
+    rpv3_summary_enabled = 0;
+    rpv3_csv_enabled = 0;
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "--summary --csv should return CONTINUE");
+    ASSERT_EQUALS(1, rpv3_summary_enabled, "--summary should set rpv3_summary_enabled");
+    ASSERT_EQUALS(1, rpv3_csv_enabled, "--summary keeps the CSV table format");
+
+    setenv("RPV3_OPTIONS", "--summary --format binary", 1);
+    redirect_output();
+    result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_EXIT, result, "--summary with --format binary should return EXIT");
+
+    setenv("RPV3_OPTIONS", "--summary --backtrace", 1);
+    rpv3_output_format = RPV3_FORMAT_TEXT;
+    rpv3_csv_enabled = 0;
+    redirect_output();
+    result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_EXIT, result, "--summary with --backtrace should return EXIT");
+
+    rpv3_summary_enabled = 0;
+    rpv3_backtrace_enabled = 0;
+    rpv3_csv_enabled = 0;
+    rpv3_output_format = RPV3_FORMAT_TEXT;
+}
+
+TEST(sample_option) {
+    rpv3_sample_mode = RPV3_SAMPLE_NONE;
+    setenv("RPV3_OPTIONS", "--sample every:100", 1);
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "--sample every:100 should return CONTINUE");
+    ASSERT_EQUALS(RPV3_SAMPLE_EVERY, rpv3_sample_mode, "every:N selects RPV3_SAMPLE_EVERY");
+    ASSERT_EQUALS(100, (int)rpv3_sample_every, "every:N stores N");
+
+    setenv("RPV3_OPTIONS", "--sample window:5:95", 1);
+    redirect_output();
+    rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_SAMPLE_WINDOW, rpv3_sample_mode, "window:ON:OFF selects RPV3_SAMPLE_WINDOW");
+    ASSERT_EQUALS(5, (int)rpv3_sample_window_on_ms, "window stores the on period");
+    ASSERT_EQUALS(95, (int)rpv3_sample_window_off_ms, "window stores the off period");
+
+    setenv("RPV3_OPTIONS", "--sample reservoir:16", 1);
+    redirect_output();
+    rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_SAMPLE_RESERVOIR, rpv3_sample_mode, "reservoir:K selects RPV3_SAMPLE_RESERVOIR");
+    ASSERT_EQUALS(16, (int)rpv3_sample_reservoir, "reservoir stores K");
+
+    rpv3_sample_mode = RPV3_SAMPLE_NONE;
+    const char* invalid[] = {"--sample every:0", "--sample every:", "--sample every:10x",
+                             "--sample window:5", "--sample window:0:10", "--sample reservoir:-1",
+                             "--sample bogus:3", "--sample"};
+    int all_rejected = 1;
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        setenv("RPV3_OPTIONS", invalid[i], 1);
+        redirect_output();
+        rpv3_parse_options();
+        restore_output();
+        if (rpv3_sample_mode != RPV3_SAMPLE_NONE) {
+            all_rejected = 0;
+        }
+    }
+    ASSERT_EQUALS(1, all_rejected, "Malformed sampling policies are rejected");
+
+    setenv("RPV3_OPTIONS", "--sample reservoir:4 --backtrace", 1);
+    redirect_output();
+    result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_EXIT, result, "--backtrace with reservoir sampling should return EXIT");
+
+    rpv3_backtrace_enabled = 0;
+    rpv3_sample_mode = RPV3_SAMPLE_NONE;
+}
+
+TEST(filter_options) {
+    rpv3_include_count = 0;
+    rpv3_exclude_count = 0;
+    rpv3_filter_expr = NULL;
+    setenv("RPV3_OPTIONS", "--include Cijk_* --include vector_add --exclude *_Bias_* --filter duration>=10us --filter lds>0", 1);
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "Filter options should return CONTINUE");
+    ASSERT_EQUALS(2, rpv3_include_count, "--include may be repeated");
+    ASSERT_EQUALS(0, strcmp("Cijk_*", rpv3_include_patterns[0]), "First include pattern is stored");
+    ASSERT_EQUALS(0, strcmp("vector_add", rpv3_include_patterns[1]), "Second include pattern is stored");
+    ASSERT_EQUALS(1, rpv3_exclude_count, "--exclude pattern is stored");
+    ASSERT_EQUALS(0, strcmp("*_Bias_*", rpv3_exclude_patterns[0]), "Exclude pattern text is kept");
+    ASSERT_EQUALS(0, strcmp("duration>=10us,lds>0", rpv3_filter_expr), "Repeated --filter expressions are joined");
+
+    free(rpv3_filter_expr);
+    rpv3_filter_expr = NULL;
+    rpv3_include_count = 0;
+    rpv3_exclude_count = 0;
+}
+
+TEST(histogram_options) {
+    rpv3_histogram_enabled = 0;
+    rpv3_histogram_file = NULL;
+    setenv("RPV3_OPTIONS", "--histogram", 1);
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "--histogram should return CONTINUE");
+    ASSERT_EQUALS(1, rpv3_histogram_enabled, "--histogram should set rpv3_histogram_enabled");
+
+    rpv3_histogram_enabled = 0;
+    setenv("RPV3_OPTIONS", "--histogram-dump /tmp/h.csv", 1);
+    redirect_output();
+    rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(1, rpv3_histogram_enabled, "--histogram-dump implies --histogram");
+    ASSERT_EQUALS(0, strcmp("/tmp/h.csv", rpv3_histogram_file), "--histogram-dump stores the path");
+
+    free(rpv3_histogram_file);
+    rpv3_histogram_file = NULL;
+    rpv3_histogram_enabled = 0;
+}
+
+TEST(peak_options) {
+    rpv3_peak_tflops = 0.0;
+    rpv3_peak_gbps = 0.0;
+    setenv("RPV3_OPTIONS", "--peak-tflops 1307.4 --peak-gbps 5300", 1);
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "Peak options should return CONTINUE");
+    ASSERT_EQUALS(1, rpv3_peak_tflops == 1307.4, "--peak-tflops stores the value");
+    ASSERT_EQUALS(1, rpv3_peak_gbps == 5300.0, "--peak-gbps stores the value");
+
+    setenv("RPV3_OPTIONS", "--peak-tflops fast --peak-gbps -1", 1);
+    redirect_output();
+    rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(1, rpv3_peak_tflops == 1307.4 && rpv3_peak_gbps == 5300.0, "Invalid peaks are ignored");
+
+    rpv3_peak_tflops = 0.0;
+    rpv3_peak_gbps = 0.0;
+}
+
+TEST(rocblas_bench_option) {
+    rpv3_rocblas_bench_file = NULL;
+    setenv("RPV3_OPTIONS", "--rocblas /tmp/blas_pipe --rocblas-bench /tmp/bench.yaml", 1);
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "--rocblas-bench should return CONTINUE");
+    ASSERT_EQUALS(0, strcmp("/tmp/bench.yaml", rpv3_rocblas_bench_file), "--rocblas-bench stores the path");
+
+    free(rpv3_rocblas_bench_file);
+    rpv3_rocblas_bench_file = NULL;
+    free(rpv3_rocblas_pipe);
+    rpv3_rocblas_pipe = NULL;
+}
+
+TEST(library_pipe_options) {
+    setenv("RPV3_OPTIONS", "--hipblaslt /tmp/lt_pipe --miopen /tmp/miopen_pipe --rocsolver /tmp/solver_pipe", 1);
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "Library pipes should return CONTINUE");
+    ASSERT_EQUALS(0, strcmp("/tmp/lt_pipe", rpv3_hipblaslt_pipe), "--hipblaslt stores the pipe");
+    ASSERT_EQUALS(0, strcmp("/tmp/miopen_pipe", rpv3_miopen_pipe), "--miopen stores the pipe");
+    ASSERT_EQUALS(0, strcmp("/tmp/solver_pipe", rpv3_rocsolver_pipe), "--rocsolver stores the pipe");
+    ASSERT_EQUALS(1, rpv3_rocblas_pipe == NULL, "--rocblas is not implied");
+
+    free(rpv3_hipblaslt_pipe);
+    free(rpv3_miopen_pipe);
+    free(rpv3_rocsolver_pipe);
+    rpv3_hipblaslt_pipe = NULL;
+    rpv3_miopen_pipe = NULL;
+    rpv3_rocsolver_pipe = NULL;
+}
+
+TEST(counters_option) {
+    rpv3_counter_mode = RPV3_COUNTER_MODE_NONE;
+    rpv3_counters_spec = NULL;
+    setenv("RPV3_OPTIONS", "--counters SQ_WAVES,VALU_UTIL=SQ_INSTS_VALU/SQ_WAVES --counters GRBM_COUNT", 1);
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "--counters should return CONTINUE");
+    ASSERT_EQUALS(RPV3_COUNTER_MODE_CUSTOM, rpv3_counter_mode, "--counters selects the custom counter set");
+    ASSERT_EQUALS(0, strcmp("SQ_WAVES,VALU_UTIL=SQ_INSTS_VALU/SQ_WAVES,GRBM_COUNT", rpv3_counters_spec),
+                  "Repeated --counters lists are joined");
+
+    free(rpv3_counters_spec);
+    rpv3_counters_spec = NULL;
+    rpv3_counter_mode = RPV3_COUNTER_MODE_NONE;
+}
+
+TEST(counter_selection_options) {
+    rpv3_counter_kernel_count = 0;
+    rpv3_counter_first = 0;
+    rpv3_counter_every = 0;
+    setenv("RPV3_OPTIONS", "--counter compute --counter-kernels Cijk_* --counter-kernels *gemm* --counter-first 10 --counter-every 4", 1);
+    redirect_output();
+    int result = rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(RPV3_OPTIONS_CONTINUE, result, "Counter selection options should return CONTINUE");
+    ASSERT_EQUALS(2, rpv3_counter_kernel_count, "--counter-kernels may be repeated");
+    ASSERT_EQUALS(0, strcmp("*gemm*", rpv3_counter_kernel_patterns[1]), "Counter kernel pattern is stored");
+    ASSERT_EQUALS(10, (int)rpv3_counter_first, "--counter-first stores the count");
+    ASSERT_EQUALS(4, (int)rpv3_counter_every, "--counter-every stores the count");
+
+    setenv("RPV3_OPTIONS", "--counter-first 0 --counter-every x", 1);
+    redirect_output();
+    rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(1, rpv3_counter_first == 10 && rpv3_counter_every == 4, "Invalid counts are ignored");
+
+    setenv("RPV3_OPTIONS", "--counter-cache /tmp/rpv3-catalog", 1);
+    redirect_output();
+    rpv3_parse_options();
+    restore_output();
+    ASSERT_EQUALS(0, strcmp("/tmp/rpv3-catalog", rpv3_counter_cache), "--counter-cache stores the path");
+    free(rpv3_counter_cache);
+    rpv3_counter_cache = NULL;
+
+    free(rpv3_counter_kernel_patterns[0]);
+    free(rpv3_counter_kernel_patterns[1]);
+    rpv3_counter_kernel_count = 0;
+    rpv3_counter_first = 0;
+    rpv3_counter_every = 0;
+    rpv3_counter_mode = RPV3_COUNTER_MODE_NONE;
+}
+
 /* Main test runner */
 int main() {
     printf("\n");
@@ -185,6 +485,20 @@ int main() {
     run_test_whitespace_handling();
     run_test_tab_separated_options();
     run_test_csv_option();
+    run_test_async_option();
+    run_test_ring_options();
+    run_test_invalid_ring_size();
+    run_test_format_option();
+    run_test_backtrace_binary_incompatible();
+    run_test_summary_option();
+    run_test_sample_option();
+    run_test_filter_options();
+    run_test_histogram_options();
+    run_test_peak_options();
+    run_test_rocblas_bench_option();
+    run_test_library_pipe_options();
+    run_test_counters_option();
+    run_test_counter_selection_options();
 
     /* Print summary */
     printf("\n");
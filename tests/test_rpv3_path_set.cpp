@@ -0,0 +1,75 @@
+/* MIT License
+ * Unit tests for rpv3_path_set.cpp
+ */
+
+#include "../rpv3_path_set.h"
+#include "test_utils.h"
+
+#include <string>
+
+using rpv3::FdSet;
+using rpv3::PathSet;
+
+TEST(empty_set) {
+    PathSet paths;
+    ASSERT_TRUE(paths.empty(), "New set is empty");
+    ASSERT_TRUE(!paths.contains("/tmp/rocblas_pipe"), "Nothing matches");
+    ASSERT_TRUE(!paths.contains(nullptr), "Null path never matches");
+    ASSERT_TRUE(!paths.add(""), "Empty path rejected");
+    ASSERT_TRUE(paths.empty(), "Still empty");
+}
+
+TEST(add_and_contains) {
+    PathSet paths;
+    ASSERT_TRUE(paths.add("/tmp/rocblas_pipe"), "Pipe added");
+    ASSERT_TRUE(paths.add("/tmp/rocblas_bench.log"), "Bench path added");
+    ASSERT_TRUE(paths.add("/tmp/rocblas_pipe"), "Duplicate accepted");
+    ASSERT_EQUALS(2, (int)paths.size(), "Duplicate not stored twice");
+
+    ASSERT_TRUE(paths.contains("/tmp/rocblas_pipe"), "Pipe matches");
+    ASSERT_TRUE(paths.contains("/tmp/rocblas_bench.log"), "Bench path matches");
+    ASSERT_TRUE(!paths.contains("/tmp/rocblas_pip"), "Prefix does not match");
+    ASSERT_TRUE(!paths.contains("/tmp/rocblas_pipe2"), "Longer path does not match");
+    ASSERT_TRUE(!paths.contains("rocblas_pipe"), "Relative spelling does not match");
+}
+
+TEST(full_set) {
+    PathSet paths;
+    for (size_t i = 0; i < PathSet::kCapacity; i++) {
+        ASSERT_TRUE(paths.add("/tmp/log_" + std::to_string(i)), "Added while there is room");
+    }
+    ASSERT_TRUE(!paths.add("/tmp/one_too_many"), "Full set rejects a new path");
+    ASSERT_TRUE(paths.add("/tmp/log_3"), "Existing path still accepted");
+    for (size_t i = 0; i < PathSet::kCapacity; i++) {
+        ASSERT_TRUE(paths.contains(("/tmp/log_" + std::to_string(i)).c_str()), "Every path found");
+    }
+    ASSERT_TRUE(!paths.contains("/tmp/one_too_many"), "Probe ends on a full table");
+}
+
+TEST(fd_set) {
+    FdSet fds;
+    ASSERT_TRUE(!fds.contains(3), "Nothing tracked yet");
+    ASSERT_TRUE(fds.set(3, true), "fd 3 recorded");
+    ASSERT_TRUE(fds.set(67, true), "fd 67 recorded");
+    ASSERT_TRUE(fds.contains(3) && fds.contains(67), "Both found");
+    ASSERT_TRUE(!fds.contains(4) && !fds.contains(131), "Neighbours untouched");
+
+    ASSERT_TRUE(fds.set(3, false), "fd 3 reused for another file");
+    ASSERT_TRUE(!fds.contains(3) && fds.contains(67), "Only fd 3 cleared");
+
+    ASSERT_TRUE(!fds.set(-1, true), "Negative fd rejected");
+    ASSERT_TRUE(!fds.set(FdSet::kMaxFd, true), "fd beyond the range rejected");
+    ASSERT_TRUE(!fds.contains(FdSet::kMaxFd), "Untracked fd is never a target");
+    ASSERT_TRUE(FdSet::tracked(FdSet::kMaxFd - 1) && !FdSet::tracked(FdSet::kMaxFd), "Range bound");
+}
+
+int main() {
+    test_banner("RPV3 Path Set Unit Tests");
+
+    run_test_empty_set();
+    run_test_add_and_contains();
+    run_test_full_set();
+    run_test_fd_set();
+
+    return test_summary("RPV3 Path Set");
+}
@@ -0,0 +1,202 @@
+/* MIT License
+ * Unit tests for rpv3_record_format.cpp
+ * The formatter must reproduce the printf output it replaced byte for byte
+ */
+
+#include "../rpv3_record_format.h"
+#include "test_utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+std::string str(const rpv3::RecordBuffer& buffer) {
+    return std::string(buffer.data(), buffer.size());
+}
+
+rpv3::DispatchRecord sample_record() {
+    rpv3::DispatchRecord record;
+    record.thread_id = 139872;
+    record.correlation_id = 17;
+    record.kernel_id = 5;
+    record.dispatch_id = 42;
+    record.grid[0] = 1048576;
+    record.grid[1] = 1;
+    record.grid[2] = 1;
+    record.workgroup[0] = 256;
+    record.workgroup[1] = 1;
+    record.workgroup[2] = 1;
+    record.private_segment_size = 0;
+    record.group_segment_size = 4096;
+    record.start_ns = 1234567890123456ULL;
+    record.end_ns = 1234567890135801ULL;
+    return record;
+}
+
+} // namespace
+
+TEST(fixed3_matches_printf) {
+    const double values[] = {0.0, 0.0005, 0.0015, 1.2345, 2.5, 12.3456789, 999.9995,
+                             1e6 + 0.0625, 123456789.987654, 1e15 / 3.0};
+    bool all_match = true;
+    char expected[64];
+    for (double v : values) {
+        rpv3::RecordBuffer buffer;
+        buffer.append_fixed3(v);
+        snprintf(expected, sizeof(expected), "%.3f", v);
+        if (str(buffer) != expected) {
+            printf("    %s != %s\n", str(buffer).c_str(), expected);
+            all_match = false;
+        }
+    }
+    ASSERT_TRUE(all_match, "append_fixed3 matches %.3f for edge values");
+
+    /* Random durations as produced by the tracer */
+    srand(1234);
+    for (int i = 0; i < 100000 && all_match; i++) {
+        uint64_t ns = ((uint64_t)rand() << 16) ^ (uint64_t)rand();
+        double us = ns / 1000.0;
+        rpv3::RecordBuffer buffer;
+        buffer.append_fixed3(us);
+        snprintf(expected, sizeof(expected), "%.3f", us);
+        all_match = (str(buffer) == expected);
+    }
+    ASSERT_TRUE(all_match, "append_fixed3 matches %.3f for random durations");
+}
+
+TEST(integer_helpers) {
+    rpv3::RecordBuffer buffer;
+    buffer.append_u64(18446744073709551615ULL);
+    ASSERT_TRUE(str(buffer) == "18446744073709551615", "append_u64 handles UINT64_MAX");
+
+    char expected[64];
+    buffer.clear();
+    buffer.append_left(3, 2).append('|').append_left(12, 2).append('|').append_left(123, 2);
+    snprintf(expected, sizeof(expected), "%-2d|%-2d|%-2d", 3, 12, 123);
+    ASSERT_TRUE(str(buffer) == expected, "append_left matches %-2d");
+
+    buffer.clear();
+    buffer.append_pointer(0x7f00deadbeefULL).append(' ').append_pointer(0);
+    snprintf(expected, sizeof(expected), "%p %p", (void*)0x7f00deadbeefULL, (void*)0);
+    ASSERT_TRUE(str(buffer) == expected, "append_pointer matches %p");
+
+    buffer.clear();
+    buffer.append_hex(0xabc);
+    ASSERT_TRUE(str(buffer) == "0xabc", "append_hex matches 0x%lx");
+}
+
+TEST(csv_row_matches_printf) {
+    rpv3::DispatchRecord r = sample_record();
+    const uint64_t tracer_start = 1234567000000000ULL;
+    rpv3::RecordBuffer buffer;
+    rpv3::format_csv_row(buffer, "vector_add(float const*, float*, int)", r, tracer_start);
+
+    char expected[512];
+    snprintf(expected, sizeof(expected),
+             "\"%s\",%lu,%lu,%lu,%lu,%u,%u,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu,%.3f,%.3f\n",
+             "vector_add(float const*, float*, int)",
+             (unsigned long)r.thread_id, (unsigned long)r.correlation_id,
+             (unsigned long)r.kernel_id, (unsigned long)r.dispatch_id,
+             r.grid[0], r.grid[1], r.grid[2], r.workgroup[0], r.workgroup[1], r.workgroup[2],
+             r.private_segment_size, r.group_segment_size,
+             (unsigned long)r.start_ns, (unsigned long)r.end_ns,
+             (unsigned long)(r.end_ns - r.start_ns),
+             (r.end_ns - r.start_ns) / 1000.0,
+             (r.start_ns - tracer_start) / 1000000.0);
+    ASSERT_TRUE(str(buffer) == expected, "CSV row matches the previous printf format");
+}
+
+TEST(blas_columns) {
+    std::string header = rpv3::csv_header(true);
+    ASSERT_TRUE(header.compare(0, strlen(rpv3::kCsvHeader) - 1, rpv3::kCsvHeader, strlen(rpv3::kCsvHeader) - 1) == 0,
+                "BLAS header extends the plain one");
+    ASSERT_TRUE(header.find(",BlasFunction,") != std::string::npos && header.back() == '\n', "BLAS columns appended");
+    ASSERT_TRUE(rpv3::csv_header(false) == rpv3::kCsvHeader, "Plain header unchanged");
+
+    rpv3::DispatchRecord r = sample_record();
+    rpv3::RecordBuffer plain;
+    rpv3::format_csv_row(plain, "Cijk_Ailk_Bljk_SB", r, 0);
+    rpv3::RecordBuffer buffer;
+    rpv3::format_csv_fields(buffer, "Cijk_Ailk_Bljk_SB", r, 0);
+    rpv3::format_csv_blas_columns(buffer, nullptr, 0.0, 0.0);
+    std::string empty = str(buffer);
+    ASSERT_TRUE(empty.compare(0, plain.size() - 1, str(plain), 0, plain.size() - 1) == 0, "Fields match the plain row");
+    size_t header_commas = std::count(header.begin(), header.end(), ',');
+    ASSERT_EQUALS(header_commas, (size_t)std::count(empty.begin(), empty.end(), ','), "Empty columns match the header");
+
+    rpv3::BlasCall call;
+    call.function = "gemm_strided_batched";
+    call.precision = "f32_r";
+    call.compute_type = "f32_r";
+    call.trans_a = 'N';
+    call.trans_b = 'T';
+    call.m = 1024;
+    call.n = 512;
+    call.k = 256;
+    call.lda = 1024;
+    call.ldb = 512;
+    call.ldc = 1024;
+    call.stride_a = 262144;
+    call.batch_count = 8;
+    call.alpha = 1.5;
+    buffer.clear();
+    rpv3::format_csv_blas_columns(buffer, &call, 12.5, 0.0);
+    ASSERT_TRUE(str(buffer) == ",gemm_strided_batched,f32_r,f32_r,N,T,1024,512,256,1024,512,1024,262144,,,8,1.5,,12.500,\n",
+                "Typed columns, with unset fields and unknown rates empty");
+}
+
+TEST(text_record_matches_printf) {
+    rpv3::DispatchRecord r = sample_record();
+    const uint64_t tracer_start = 1234567000000000ULL;
+    rpv3::RecordBuffer buffer;
+    rpv3::format_text_record(buffer, 7, "my_kernel", r, rpv3::TextTimestamps::Timeline, tracer_start);
+
+    std::string expected;
+    char line[256];
+    snprintf(line, sizeof(line), "\n[Kernel Trace #%lu]\n", 7UL); expected += line;
+    snprintf(line, sizeof(line), "  Kernel Name: %s\n", "my_kernel"); expected += line;
+    snprintf(line, sizeof(line), "  Thread ID: %lu\n", (unsigned long)r.thread_id); expected += line;
+    snprintf(line, sizeof(line), "  Correlation ID: %lu\n", (unsigned long)r.correlation_id); expected += line;
+    snprintf(line, sizeof(line), "  Kernel ID: %lu\n", (unsigned long)r.kernel_id); expected += line;
+    snprintf(line, sizeof(line), "  Dispatch ID: %lu\n", (unsigned long)r.dispatch_id); expected += line;
+    snprintf(line, sizeof(line), "  Grid Size: [%u, %u, %u]\n", r.grid[0], r.grid[1], r.grid[2]); expected += line;
+    snprintf(line, sizeof(line), "  Workgroup Size: [%u, %u, %u]\n", r.workgroup[0], r.workgroup[1], r.workgroup[2]); expected += line;
+    snprintf(line, sizeof(line), "  Private Segment Size: %u bytes (scratch memory per work-item)\n", r.private_segment_size); expected += line;
+    snprintf(line, sizeof(line), "  Group Segment Size: %u bytes (LDS memory per work-group)\n", r.group_segment_size); expected += line;
+    snprintf(line, sizeof(line), "  Start Timestamp: %lu ns\n", (unsigned long)r.start_ns); expected += line;
+    snprintf(line, sizeof(line), "  End Timestamp: %lu ns\n", (unsigned long)r.end_ns); expected += line;
+    snprintf(line, sizeof(line), "  Duration: %.3f μs\n", (r.end_ns - r.start_ns) / 1000.0); expected += line;
+    snprintf(line, sizeof(line), "  Time Since Start: %.3f ms\n", (r.start_ns - tracer_start) / 1000000.0); expected += line;
+
+    ASSERT_TRUE(str(buffer) == expected, "Timeline text record matches the previous printf sequence");
+
+    buffer.clear();
+    rpv3::format_text_record(buffer, 7, "my_kernel", r, rpv3::TextTimestamps::None, 0);
+    ASSERT_TRUE(str(buffer) == expected.substr(0, expected.find("  Start Timestamp")),
+                "Record without timestamps stops after the segment sizes");
+}
+
+TEST(backtrace_header) {
+    rpv3::DispatchRecord r = sample_record();
+    rpv3::RecordBuffer buffer;
+    rpv3::format_backtrace_header(buffer, 3, "k", r);
+    ASSERT_TRUE(str(buffer) == "\n[Kernel Trace #3]\n  Kernel Name: k\n  Dispatch ID: 42\n  Grid Size: [1048576, 1, 1]\n",
+                "Backtrace header matches the previous format");
+}
+
+int main() {
+    test_banner("RPV3 Record Format Unit Tests");
+
+    run_test_fixed3_matches_printf();
+    run_test_integer_helpers();
+    run_test_csv_row_matches_printf();
+    run_test_blas_columns();
+    run_test_text_record_matches_printf();
+    run_test_backtrace_header();
+
+    return test_summary("RPV3 Record Format");
+}
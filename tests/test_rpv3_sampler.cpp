@@ -0,0 +1,159 @@
+/* MIT License
+ * Unit tests for rpv3_sampler.cpp
+ */
+
+#include "../rpv3_sampler.h"
+#include "test_utils.h"
+
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace {
+
+rpv3::DispatchRecord dispatch(uint64_t kernel_id, uint64_t start_ns) {
+    rpv3::DispatchRecord record;
+    record.kernel_id = kernel_id;
+    record.dispatch_id = start_ns;
+    record.start_ns = start_ns;
+    record.end_ns = start_ns + 100;
+    return record;
+}
+
+} // namespace
+
+TEST(all_keeps_everything) {
+    rpv3::DispatchSampler sampler;
+    ASSERT_TRUE(!sampler.enabled() && !sampler.buffered(), "Default sampler is disabled");
+    bool all = true;
+    for (uint64_t i = 1; i <= 100; i++) all = all && sampler.keep(i, i);
+    ASSERT_TRUE(all, "Default sampler keeps every dispatch");
+}
+
+TEST(every_n) {
+    rpv3::SamplerConfig config;
+    config.mode = rpv3::SampleMode::Every;
+    config.every = 10;
+    rpv3::DispatchSampler sampler;
+    sampler.configure(config);
+
+    std::vector<uint64_t> kept;
+    for (uint64_t i = 1; i <= 35; i++) {
+        const bool keep = sampler.keep(i, 0);
+        if (keep) kept.push_back(i);
+        /* Dispatches 20-29 are filtered out: not part of the population */
+        if (i < 20 || i >= 30) sampler.tally(keep);
+    }
+    ASSERT_TRUE(kept == std::vector<uint64_t>({1, 11, 21, 31}), "every:10 keeps dispatches 1, 11, 21, 31");
+    ASSERT_TRUE(sampler.tallies(), "every:N counts its population with tally()");
+    ASSERT_TRUE(sampler.kept() == 3 && sampler.population() == 25, "Ratio over the dispatches that passed the filters");
+    ASSERT_TRUE(sampler.describe() == "every:10", "Policy is described as on the command line");
+}
+
+TEST(time_window) {
+    rpv3::SamplerConfig config;
+    config.mode = rpv3::SampleMode::Window;
+    config.window_on_ns = 2000000;
+    config.window_off_ns = 8000000;
+    config.origin_ns = 1000000000;
+    rpv3::DispatchSampler sampler;
+    sampler.configure(config);
+
+    ASSERT_TRUE(sampler.needs_timestamp(), "Window mode needs timestamps");
+    ASSERT_TRUE(sampler.keep(1, 1000000000), "Start of the first window is kept");
+    ASSERT_TRUE(sampler.keep(2, 1001999999), "End of the on period is kept");
+    ASSERT_TRUE(!sampler.keep(3, 1002000000), "Off period is skipped");
+    ASSERT_TRUE(!sampler.keep(4, 1009999999), "End of the off period is skipped");
+    ASSERT_TRUE(sampler.keep(5, 1010000000), "Next window is kept");
+    ASSERT_TRUE(sampler.keep(6, 999000000), "Timestamps before the origin count as the first window");
+    ASSERT_TRUE(sampler.describe() == "window:2:8", "Window policy is described in milliseconds");
+}
+
+TEST(reservoir_keeps_rare_kernels) {
+    rpv3::SamplerConfig config;
+    config.mode = rpv3::SampleMode::Reservoir;
+    config.reservoir_size = 8;
+    rpv3::DispatchSampler sampler;
+    sampler.configure(config);
+    ASSERT_TRUE(sampler.buffered(), "Reservoir mode buffers records");
+
+    uint64_t sequence = 0;
+    for (uint64_t i = 0; i < 10000; i++) {
+        sampler.offer(++sequence, dispatch(1, 5000 + i));  // Hot kernel
+        if (i % 2500 == 0) {
+            sampler.offer(++sequence, dispatch(2, 5000 + i));  // Rare kernel, 4 dispatches
+        }
+    }
+
+    std::vector<rpv3::ReservoirCount> counts;
+    std::vector<rpv3::SampledDispatch> kept = sampler.drain(&counts);
+    std::map<uint64_t, int> per_kernel;
+    bool ordered = true;
+    for (size_t i = 0; i < kept.size(); i++) {
+        per_kernel[kept[i].record.kernel_id]++;
+        if (i > 0 && kept[i].record.start_ns < kept[i - 1].record.start_ns) ordered = false;
+    }
+    ASSERT_EQUALS(8, per_kernel[1], "Hot kernel is capped at the reservoir size");
+    ASSERT_EQUALS(4, per_kernel[2], "Every dispatch of a rare kernel is kept");
+    ASSERT_TRUE(ordered, "Drained records are in start time order");
+    ASSERT_TRUE(sampler.kept() == 12, "Drained records are counted as kept");
+    ASSERT_TRUE(!sampler.tallies() && sampler.population() == 10004, "Offered dispatches are the population");
+    ASSERT_EQUALS(2, (int)counts.size(), "One count per kernel");
+    ASSERT_TRUE(counts[0].kernel_id == 1 && counts[0].seen == 10000 && counts[0].kept == 8,
+                "Hot kernel scales by 1250");
+    ASSERT_TRUE(counts[1].kernel_id == 2 && counts[1].seen == 4 && counts[1].kept == 4, "Rare kernel by 1");
+    ASSERT_TRUE(sampler.drain().empty(), "Drain empties the reservoirs");
+}
+
+TEST(reservoir_is_uniform) {
+    /* Each of 100 dispatches should land in a 10-slot reservoir ~10% of the time */
+    const int rounds = 2000;
+    std::vector<int> hits(100, 0);
+    for (int round = 0; round < rounds; round++) {
+        rpv3::SamplerConfig config;
+        config.mode = rpv3::SampleMode::Reservoir;
+        config.reservoir_size = 10;
+        rpv3::DispatchSampler sampler;
+        sampler.configure(config);
+        for (uint64_t i = 0; i < 100; i++) sampler.offer(i + 1, dispatch(7, i));
+        for (const auto& sample : sampler.drain()) hits[sample.record.start_ns]++;
+    }
+    int early = 0, late = 0;
+    for (int i = 0; i < 50; i++) early += hits[i];
+    for (int i = 50; i < 100; i++) late += hits[i];
+    /* Expected 10000 each; allow 5% */
+    ASSERT_TRUE(early > 9500 && early < 10500, "First half of the stream is sampled uniformly");
+    ASSERT_TRUE(late > 9500 && late < 10500, "Second half of the stream is sampled uniformly");
+}
+
+TEST(reservoir_concurrent_offer) {
+    rpv3::SamplerConfig config;
+    config.mode = rpv3::SampleMode::Reservoir;
+    config.reservoir_size = 16;
+    rpv3::DispatchSampler sampler;
+    sampler.configure(config);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; t++) {
+        workers.emplace_back([&sampler, t] {
+            for (uint64_t i = 0; i < 20000; i++) {
+                sampler.offer(i, dispatch(i % 100, (uint64_t)t * 100000 + i));
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    ASSERT_TRUE(sampler.drain().size() == 100 * 16, "Each kernel keeps exactly K samples under contention");
+}
+
+int main() {
+    test_banner("RPV3 Sampler Unit Tests");
+
+    run_test_all_keeps_everything();
+    run_test_every_n();
+    run_test_time_window();
+    run_test_reservoir_keeps_rare_kernels();
+    run_test_reservoir_is_uniform();
+    run_test_reservoir_concurrent_offer();
+
+    return test_summary("RPV3 Sampler");
+}
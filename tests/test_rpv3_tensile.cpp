@@ -0,0 +1,111 @@
+/* MIT License
+ * Unit tests for rpv3_tensile.cpp
+ */
+
+#include "../rpv3_tensile.h"
+#include "test_utils.h"
+
+#include <string>
+
+using rpv3::TensileSolution;
+
+namespace {
+
+// An MI300 half-precision kernel name as rocBLAS ships it (shortened)
+const char* kHalfKernel =
+    "Cijk_Ailk_Bjlk_HHS_BH_MT128x128x32_MI32x32x8x1_SN_1LDSB0_AFC1_GRVW8_GSU1_GSUASB_ISA942_IU1_K1_"
+    "LWPMn1_MIAV0_PGR2_PLR1_SU32_TT2_64_VW2_WS64_WG64_4_1_WGM8";
+
+rpv3::KernelSummaryRow summary_row(uint64_t kernel_id, uint64_t count, uint64_t total_ns) {
+    rpv3::KernelSummaryRow row;
+    row.kernel_id = kernel_id;
+    row.stats.count = count;
+    row.stats.total_ns = total_ns;
+    return row;
+}
+
+} // namespace
+
+TEST(is_tensile_kernel) {
+    ASSERT_TRUE(rpv3::is_tensile_kernel(kHalfKernel), "Cijk name");
+    ASSERT_TRUE(rpv3::is_tensile_kernel("_ZN7Tensile6kernelEv"), "Mangled Tensile namespace");
+    ASSERT_TRUE(!rpv3::is_tensile_kernel("_Z10vector_addPfS_S_i"), "Other kernel");
+}
+
+TEST(decode_mfma_name) {
+    TensileSolution s;
+    ASSERT_TRUE(rpv3::decode_tensile_name(kHalfKernel, s), "Decodes");
+    ASSERT_EQUALS('N', s.trans_a, "Ailk is A not transposed");
+    ASSERT_EQUALS('T', s.trans_b, "Bjlk is B transposed");
+    ASSERT_TRUE(s.types == "HHS", "Types token");
+    ASSERT_EQUALS(128, (int)s.macro_tile0, "MT0");
+    ASSERT_EQUALS(128, (int)s.macro_tile1, "MT1");
+    ASSERT_EQUALS(32, (int)s.depth_u, "Depth-U from the macro tile");
+    ASSERT_TRUE(s.matrix_instruction == "32x32x8x1", "Matrix instruction, MIAV0 not mistaken for it");
+    ASSERT_EQUALS(1, s.global_split_u, "GSU1, GSUASB skipped");
+    ASSERT_EQUALS(8, s.workgroup_mapping, "WGM");
+    ASSERT_TRUE(s.isa == "942", "ISA");
+}
+
+TEST(decode_variants) {
+    TensileSolution s;
+    ASSERT_TRUE(rpv3::decode_tensile_name("Cijk_Alik_BljkC_S_MT64x64x16_SE_GSU4_WGMn8", s), "Older layout");
+    ASSERT_EQUALS('T', s.trans_a, "Alik is A transposed");
+    ASSERT_EQUALS('C', s.trans_b, "Trailing C conjugates");
+    ASSERT_TRUE(s.matrix_instruction.empty(), "No MFMA");
+    ASSERT_EQUALS(4, s.global_split_u, "GSU4");
+    ASSERT_EQUALS(-8, s.workgroup_mapping, "Negative WGM written with n");
+
+    ASSERT_TRUE(rpv3::decode_tensile_name("Cijk_Ailk_Bljk_DB_MT32x32_DU8_K1", s), "Separate DU token");
+    ASSERT_EQUALS(8, (int)s.depth_u, "DU");
+
+    ASSERT_TRUE(!rpv3::decode_tensile_name("Cijk_Ailk_Bljk_S_SE_K1", s), "No macro tile");
+    ASSERT_TRUE(!rpv3::decode_tensile_name("Cijk__Bljk_S_MT64x64x8", s), "Missing A index");
+    ASSERT_TRUE(!rpv3::decode_tensile_name("_Z10vector_addPfS_S_i", s), "Not Tensile");
+}
+
+TEST(group_solutions) {
+    rpv3::TensileSolutionTable table;
+    table.insert(1, kHalfKernel);
+    // Same key (types, tile, MI, GSU, WGM), different PGR
+    std::string sibling = kHalfKernel;
+    sibling.replace(sibling.find("PGR2"), 4, "PGR1");
+    table.insert(2, sibling);
+    table.insert(3, "Cijk_Ailk_Bljk_SB_MT64x64x16_SE_K1");
+    table.insert(4, "_Z10vector_addPfS_S_i");
+    ASSERT_EQUALS(3, (int)table.size(), "Only Tensile GEMMs stored");
+
+    std::vector<rpv3::KernelSummaryRow> rows = {
+        summary_row(1, 10, 1000000), summary_row(2, 5, 500000),
+        summary_row(3, 100, 2000000), summary_row(4, 50, 500000),
+    };
+    std::vector<rpv3::TensileGroupRow> groups = rpv3::group_tensile_solutions(rows, table);
+    ASSERT_EQUALS(2, (int)groups.size(), "Two solution groups");
+    ASSERT_TRUE(groups[0].solution.types == "SB" && groups[0].total_ns == 2000000, "Most GPU time first");
+    ASSERT_EQUALS(2, (int)groups[1].kernels, "Kernels of one solution group merged");
+    ASSERT_EQUALS(15, (int)groups[1].count, "Dispatches summed");
+
+    rpv3::RecordBuffer out;
+    rpv3::format_tensile_summary_csv(out, groups, 4000000);
+    std::string csv(out.data(), out.size());
+    ASSERT_TRUE(csv.find("N,T,HHS,128,128,32,32x32x8x1,1,8,2,15,1500000,37.500\n") != std::string::npos,
+                "CSV row");
+
+    out.clear();
+    rpv3::format_tensile_summary_text(out, groups, 4000000);
+    std::string text(out.data(), out.size());
+    ASSERT_TRUE(text.find("[Tensile Solutions] 2 groups of 3 kernels, 87.500% of GPU time") != std::string::npos,
+                "Text title");
+    ASSERT_TRUE(text.find("NT    HHS    128x128x32     32x32x8x1") != std::string::npos, "Text row");
+}
+
+int main() {
+    test_banner("RPV3 Tensile Unit Tests");
+
+    run_test_is_tensile_kernel();
+    run_test_decode_mfma_name();
+    run_test_decode_variants();
+    run_test_group_solutions();
+
+    return test_summary("RPV3 Tensile");
+}
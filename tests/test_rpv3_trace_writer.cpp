@@ -0,0 +1,194 @@
+/* MIT License
+ * Unit tests for rpv3_trace_writer.cpp
+ * Checks record integrity, per-thread ordering and the ring full policies
+ */
+
+#include "../rpv3_trace_writer.h"
+#include "test_utils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/* Read a whole temporary file back into memory */
+std::string slurp(FILE* fp) {
+    fflush(fp);
+    rewind(fp);
+    std::string contents;
+    char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        contents.append(chunk, n);
+    }
+    return contents;
+}
+
+/* Producer: writes "T<thread> <seq> <padding>\n" records */
+void produce(rpv3::TraceWriter& writer, int thread_idx, int count, size_t padding) {
+    std::string pad(padding, 'x');
+    char line[512];
+    for (int i = 0; i < count; i++) {
+        int len = snprintf(line, sizeof(line), "T%d %d %s\n", thread_idx, i, pad.c_str());
+        writer.write(line, (size_t)len);
+    }
+}
+
+/* Verify every line is intact and each thread's sequence numbers increase.
+ * Returns the number of well-formed lines, or -1 on corruption/reordering. */
+long check_lines(const std::string& contents, int threads, size_t padding) {
+    std::vector<int> next(threads, 0);
+    std::vector<int> last(threads, -1);
+    long lines = 0;
+    size_t pos = 0;
+    while (pos < contents.size()) {
+        size_t nl = contents.find('\n', pos);
+        if (nl == std::string::npos) return -1;
+        std::string line = contents.substr(pos, nl - pos);
+        pos = nl + 1;
+
+        int t = -1, seq = -1;
+        char pad[512] = {0};
+        if (sscanf(line.c_str(), "T%d %d %511s", &t, &seq, pad) != 3) return -1;
+        if (t < 0 || t >= threads || strlen(pad) != padding) return -1;
+        if (seq <= last[t]) return -1;
+        last[t] = seq;
+        next[t]++;
+        lines++;
+    }
+    return lines;
+}
+
+} // namespace
+
+TEST(single_thread_roundtrip) {
+    FILE* fp = tmpfile();
+    rpv3::TraceWriterConfig config;
+    config.ring_size = 4096;
+    rpv3::TraceWriter writer(fp, config);
+    writer.start();
+    produce(writer, 0, 1000, 16);
+    writer.stop();
+
+    std::string contents = slurp(fp);
+    ASSERT_EQUALS(1000, check_lines(contents, 1, 16), "All records written intact and in order");
+    ASSERT_EQUALS(contents.size(), writer.bytes_written(), "Byte counter matches file size");
+    ASSERT_EQUALS(0, writer.dropped_records(), "No records dropped");
+    fclose(fp);
+}
+
+TEST(block_policy_many_threads) {
+    FILE* fp = tmpfile();
+    rpv3::TraceWriterConfig config;
+    config.ring_size = 2048;  /* Tiny ring forces producers to wait */
+    config.policy = rpv3::RingFullPolicy::Block;
+    rpv3::TraceWriter writer(fp, config);
+    writer.start();
+
+    const int threads = 8;
+    const int per_thread = 5000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back(produce, std::ref(writer), t, per_thread, 40);
+    }
+    for (auto& w : workers) w.join();
+    writer.stop();
+
+    ASSERT_EQUALS((long)threads * per_thread, check_lines(slurp(fp), threads, 40),
+                  "Block policy is lossless and keeps per-thread order");
+    ASSERT_EQUALS(0, writer.dropped_records(), "Block policy never drops");
+    fclose(fp);
+}
+
+TEST(spill_policy_many_threads) {
+    FILE* fp = tmpfile();
+    rpv3::TraceWriterConfig config;
+    config.ring_size = 1024;
+    config.policy = rpv3::RingFullPolicy::Spill;
+    config.flush_interval_ms = 50;
+    rpv3::TraceWriter writer(fp, config);
+    writer.start();
+
+    const int threads = 4;
+    const int per_thread = 5000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back(produce, std::ref(writer), t, per_thread, 64);
+    }
+    for (auto& w : workers) w.join();
+    writer.stop();
+
+    ASSERT_EQUALS((long)threads * per_thread, check_lines(slurp(fp), threads, 64),
+                  "Spill policy is lossless and keeps per-thread order");
+    ASSERT_TRUE(writer.spilled_records() > 0, "Small ring actually spilled");
+    fclose(fp);
+}
+
+TEST(drop_policy_counts_losses) {
+    FILE* fp = tmpfile();
+    rpv3::TraceWriterConfig config;
+    config.ring_size = 1024;
+    config.policy = rpv3::RingFullPolicy::Drop;
+    config.flush_interval_ms = 1000;  /* Writer rarely wakes on its own */
+    rpv3::TraceWriter writer(fp, config);
+    writer.start();
+
+    const int total = 20000;
+    produce(writer, 0, total, 64);
+    writer.stop();
+
+    long written = check_lines(slurp(fp), 1, 64);
+    ASSERT_TRUE(written > 0, "Some records were written");
+    ASSERT_EQUALS(total, written + (long)writer.dropped_records(),
+                  "Written plus dropped equals records produced");
+    fclose(fp);
+}
+
+TEST(oversized_record) {
+    FILE* fp = tmpfile();
+    rpv3::TraceWriterConfig config;
+    config.ring_size = 1024;
+    rpv3::TraceWriter writer(fp, config);
+    writer.start();
+
+    std::string big = "T0 0 " + std::string(300, 'x') + "\n";
+    std::string huge(5000, 'y');
+    huge += '\n';
+    writer.write(big.data(), big.size());
+    writer.write(huge.data(), huge.size());
+    writer.write(big.data(), big.size());
+    writer.stop();
+
+    std::string contents = slurp(fp);
+    ASSERT_EQUALS(big.size() * 2 + huge.size(), contents.size(), "Record larger than ring is written");
+    ASSERT_TRUE(contents.compare(big.size(), huge.size(), huge) == 0, "Oversized record keeps its position");
+    fclose(fp);
+}
+
+TEST(write_after_stop) {
+    FILE* fp = tmpfile();
+    rpv3::TraceWriter writer(fp, rpv3::TraceWriterConfig());
+    writer.start();
+    writer.write("a\n", 2);
+    writer.stop();
+    writer.write("b\n", 2);
+    writer.stop();
+    ASSERT_TRUE(slurp(fp) == "a\nb\n", "Records after stop() are written synchronously");
+    fclose(fp);
+}
+
+int main() {
+    test_banner("RPV3 Trace Writer Unit Tests");
+
+    run_test_single_thread_roundtrip();
+    run_test_block_policy_many_threads();
+    run_test_spill_policy_many_threads();
+    run_test_drop_policy_counts_losses();
+    run_test_oversized_record();
+    run_test_write_after_stop();
+
+    return test_summary("RPV3 Trace Writer");
+}
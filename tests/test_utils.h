@@ -0,0 +1,85 @@
+/* MIT License
+ * Test utilities - shared assertion macros for the C++ unit tests
+ * Mirrors the output style of test_rpv3_options.c and test_utils.sh
+ */
+
+#ifndef RPV3_TEST_UTILS_H
+#define RPV3_TEST_UTILS_H
+
+#include <cstdio>
+
+/* Test counters */
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* Color codes */
+#define RED "\033[0;31m"
+#define GREEN "\033[0;32m"
+#define BLUE "\033[0;34m"
+#define NC "\033[0m"
+
+/* Test macros */
+#define TEST(name) \
+    void test_##name(); \
+    void run_test_##name() { \
+        tests_run++; \
+        printf(BLUE "Running: " NC "%s\n", #name); \
+        test_##name(); \
+    } \
+    void test_##name()
+
+#define ASSERT_TRUE(cond, msg) \
+    do { \
+        if (cond) { \
+            tests_passed++; \
+            printf(GREEN "  ✓ PASS" NC ": %s\n", msg); \
+        } else { \
+            tests_failed++; \
+            printf(RED "  ✗ FAIL" NC ": %s\n", msg); \
+            printf("    Condition: %s\n", #cond); \
+        } \
+    } while(0)
+
+#define ASSERT_EQUALS(expected, actual, msg) \
+    do { \
+        long long expected_ = (long long)(expected); \
+        long long actual_ = (long long)(actual); \
+        if (expected_ == actual_) { \
+            tests_passed++; \
+            printf(GREEN "  ✓ PASS" NC ": %s\n", msg); \
+        } else { \
+            tests_failed++; \
+            printf(RED "  ✗ FAIL" NC ": %s\n", msg); \
+            printf("    Expected: %lld, Got: %lld\n", expected_, actual_); \
+        } \
+    } while(0)
+
+/* Print the summary block and return the process exit code */
+static inline int test_summary(const char* suite) {
+    printf("\n");
+    printf("========================================\n");
+    printf("Test Summary: %s\n", suite);
+    printf("========================================\n");
+    printf("Tests run:    %d\n", tests_run);
+    printf(GREEN "Tests passed: %d\n" NC, tests_passed);
+    printf(RED "Tests failed: %d\n" NC, tests_failed);
+    printf("========================================\n");
+
+    if (tests_failed == 0) {
+        printf(GREEN "All tests passed!\n" NC);
+        return 0;
+    }
+    printf(RED "Some tests failed!\n" NC);
+    return 1;
+}
+
+static inline void test_banner(const char* suite) {
+    printf("\n");
+    printf(BLUE "========================================\n" NC);
+    printf(BLUE "%s\n" NC, suite);
+    printf(BLUE "========================================\n" NC);
+    printf("\n");
+}
+
+#endif /* RPV3_TEST_UTILS_H */
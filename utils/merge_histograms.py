@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""
+Merge RPV3 latency histogram dumps (--histogram-dump) from several processes
+and print per-kernel percentiles.
+
+Dumps are merged by kernel name, because kernel ids are only meaningful
+within one process. Bucket bounds are identical in every dump written with
+the same sub_bucket_bits, so merging is a sum of counts per bucket.
+"""
+import argparse
+import csv
+import sys
+from collections import defaultdict
+
+PERCENTILES = [50.0, 90.0, 99.0, 99.9]
+
+
+def read_dump(path, buckets, header):
+    with open(path, newline='') as f:
+        first = f.readline().strip()
+        if not first.startswith('# rpv3-histogram'):
+            sys.exit(f"Error: {path} is not an RPV3 histogram dump")
+        if header[0] is None:
+            header[0] = first
+        elif header[0] != first:
+            sys.exit(f"Error: {path} uses a different bucket layout ({first})")
+        for row in csv.DictReader(f):
+            key = (row['KernelName'], int(row['BucketLowNs']))
+            count, high = buckets[key]
+            buckets[key] = (count + int(row['Count']), max(high, int(row['BucketHighNs'])))
+
+
+def percentile(sorted_buckets, total, q):
+    # Same rule as LatencyHistogram::percentile: upper bound of the bucket holding the rank
+    rank = max(1, min(total, int(q / 100.0 * total + 0.5)))
+    seen = 0
+    for _low, count, high in sorted_buckets:
+        seen += count
+        if seen >= rank:
+            return high
+    return sorted_buckets[-1][2]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Merge RPV3 latency histogram dumps.")
+    parser.add_argument("dumps", nargs='+', help="Histogram CSV files written with --histogram-dump")
+    parser.add_argument("-o", "--output", help="Write the merged histograms to this file")
+    args = parser.parse_args()
+
+    buckets = defaultdict(lambda: (0, 0))
+    header = [None]
+    for path in args.dumps:
+        read_dump(path, buckets, header)
+
+    kernels = defaultdict(list)
+    for (name, low), (count, high) in buckets.items():
+        kernels[name].append((low, count, high))
+
+    summary = []
+    for name, rows in kernels.items():
+        rows.sort()
+        total = sum(count for _, count, _ in rows)
+        summary.append((total, name, [percentile(rows, total, q) for q in PERCENTILES], rows[-1][2]))
+    summary.sort(key=lambda s: (-s[0], s[1]))
+
+    print(f"{'Kernel Name':<60} {'Count':>10} {'p50':>12} {'p90':>12} {'p99':>12} {'p99.9':>12} {'Max':>12}")
+    for total, name, values, max_ns in summary:
+        short = name if len(name) <= 60 else name[:57] + "..."
+        cols = " ".join(f"{v / 1000.0:12.3f}" for v in values)
+        print(f"{short:<60} {total:>10} {cols} {max_ns / 1000.0:12.3f}")
+    print("(microseconds; Max is the upper bound of the highest bucket)")
+
+    if args.output:
+        with open(args.output, 'w', newline='') as f:
+            f.write(header[0] + "\n")
+            f.write("KernelName,BucketLowNs,BucketHighNs,Count\n")
+            for name in sorted(kernels):
+                for low, count, high in kernels[name]:
+                    f.write(f'"{name}",{low},{high},{count}\n')
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,122 @@
+// MIT License
+// rpv3-convert - Expand a binary .rpv3 trace (--format binary) to CSV
+//
+// The output matches the CSV written by RPV3_OPTIONS="--csv" exactly, so
+// existing consumers such as utils/summarize_trace.py work unchanged.
+// With --bench the parsed rocBLAS calls of a --rocblas trace are written as
+// deduplicated rocblas-bench YAML instead (see rpv3_blas_bench.h), with
+// --counters the counter rows of a --counter trace, as written by --csv, and
+// with --joined the dispatch rows of a --timeline --counter trace with their
+// counter columns, as written by --timeline --csv.
+//
+// Usage: rpv3-convert [--info | --bench | --counters | --joined] <trace.rpv3> [output]
+
+#include "rpv3_binary_format.h"
+#include "rpv3_blas_bench.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [--info | --bench | --counters | --joined] <trace.rpv3> [output]\n", prog);
+    fprintf(stderr, "  Converts a binary RPV3 trace to CSV (stdout if no output file is given)\n");
+    fprintf(stderr, "  --info      Print header information instead of converting\n");
+    fprintf(stderr, "  --bench     Write rocblas-bench YAML for the traced rocBLAS calls, most GPU time first\n");
+    fprintf(stderr, "  --counters  Write the counter rows of a --counter trace, one column per counter\n");
+    fprintf(stderr, "  --joined    Write the dispatch rows of a --timeline --counter trace with their counter columns\n");
+}
+
+// Each BLAS call record follows the dispatch it belongs to
+static rpv3::BlasBenchTable collect_bench(const rpv3::binary::Reader& reader) {
+    rpv3::BlasBenchTable table;
+    uint64_t dispatch_id = 0;
+    uint64_t duration_ns = 0;
+    for (uint64_t i = 0; i < reader.record_count(); i++) {
+        rpv3::binary::Record record = reader.record(i);
+        if (record.kind == rpv3::binary::kRecordDispatch) {
+            dispatch_id = record.dispatch.dispatch_id;
+            duration_ns = record.dispatch.duration_ns();
+        } else if (record.kind == rpv3::binary::kRecordBlasCall) {
+            rpv3::binary::BlasRecord blas = reader.blas_record(i);
+            table.record(blas.call, blas.dispatch_id == dispatch_id ? duration_ns : 0);
+        }
+    }
+    return table;
+}
+
+int main(int argc, char** argv) {
+    bool info_only = false;
+    bool bench = false;
+    bool counters = false;
+    bool joined = false;
+    int argi = 1;
+    if (argi < argc && strcmp(argv[argi], "--info") == 0) {
+        info_only = true;
+        argi++;
+    } else if (argi < argc && strcmp(argv[argi], "--bench") == 0) {
+        bench = true;
+        argi++;
+    } else if (argi < argc && strcmp(argv[argi], "--counters") == 0) {
+        counters = true;
+        argi++;
+    } else if (argi < argc && strcmp(argv[argi], "--joined") == 0) {
+        joined = true;
+        argi++;
+    }
+    if (argi >= argc || strcmp(argv[argi], "--help") == 0 || strcmp(argv[argi], "-h") == 0) {
+        usage(argv[0]);
+        return (argi >= argc) ? 1 : 0;
+    }
+
+    const char* input_path = argv[argi++];
+    const char* output_path = (argi < argc) ? argv[argi] : nullptr;
+
+    rpv3::binary::Reader reader;
+    if (!reader.open(input_path)) {
+        fprintf(stderr, "[rpv3-convert] Error: %s: %s\n", input_path, reader.error().c_str());
+        return 1;
+    }
+
+    if (info_only) {
+        printf("File:             %s\n", input_path);
+        printf("Format version:   %u\n", reader.version());
+        printf("Flags:            0x%x%s\n", reader.flags(),
+               (reader.flags() & rpv3::binary::kFlagMangledNames) ? " (mangled kernel names)" : "");
+        printf("Tracer start:     %lu ns\n", (unsigned long)reader.tracer_start_ns());
+        printf("Records:          %lu\n", (unsigned long)reader.record_count());
+        printf("Strings:          %zu\n", reader.string_count());
+        return 0;
+    }
+
+    FILE* out = stdout;
+    if (output_path) {
+        out = fopen(output_path, "w");
+        if (!out) {
+            fprintf(stderr, "[rpv3-convert] Error: cannot open '%s': %s\n", output_path, strerror(errno));
+            return 1;
+        }
+    }
+
+    if (bench) {
+        rpv3::BlasBenchTable table = collect_bench(reader);
+        if (table.size() == 0) {
+            fprintf(stderr, "[rpv3-convert] Warning: %s has no parsed rocBLAS calls (trace with --rocblas)\n",
+                    input_path);
+        }
+        rpv3::write_bench_yaml(out, table.rows());
+    } else if (counters) {
+        rpv3::binary::write_counter_csv(reader, out);
+    } else if (joined) {
+        rpv3::binary::write_joined_csv(reader, out);
+    } else {
+        rpv3::binary::write_csv(reader, out);
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    } else {
+        fflush(out);
+    }
+    return 0;
+}
@@ -49,6 +49,24 @@ def parse_mnk(log_line):
     
     return None
 
+def typed_mnk(row, blas_idx):
+    """
+    Builds the grouping key from the typed BLAS columns the tracer writes
+    with --csv --rocblas (BlasFunction, Precision, TransA, TransB, M, N, K).
+
+    Returns None for rows without a parsed call, so older traces and
+    non-BLAS kernels fall back to the "# rocblas_..." annotation.
+    """
+    if not blas_idx or not row[blas_idx['M']]:
+        return None
+    function = row[blas_idx['BlasFunction']]
+    precision = row[blas_idx['Precision']]
+    trans = row[blas_idx['TransA']] + row[blas_idx['TransB']]
+    dims = f"M={row[blas_idx['M']]}, N={row[blas_idx['N']]}"
+    if row[blas_idx['K']]:
+        dims += f", K={row[blas_idx['K']]}"
+    return f"{function} {precision} {trans} {dims}"
+
 def main():
     parser = argparse.ArgumentParser(description="Summarize RPV3 CSV trace output.")
     parser.add_argument("input_file", help="Path to the CSV trace file")
@@ -142,6 +160,7 @@ def main():
             # It starts with "KernelName"
             
             csv_headers = None
+            blas_idx = None
             
             for line in f:
                 line = line.strip()
@@ -169,6 +188,9 @@ def main():
                     except ValueError:
                         print("Error: Could not find 'KernelName' or 'DurationNs' in headers.")
                         sys.exit(1)
+                    blas_columns = ['BlasFunction', 'Precision', 'TransA', 'TransB', 'M', 'N', 'K']
+                    if all(c in csv_headers for c in blas_columns):
+                        blas_idx = {c: csv_headers.index(c) for c in blas_columns}
                     continue
                 
                 # It's potentially a data line
@@ -194,7 +216,7 @@ def main():
                         pending_kernel = {
                             'name': name,
                             'duration': duration,
-                            'mnk': None
+                            'mnk': typed_mnk(row, blas_idx)
                         }
                     except (ValueError, IndexError):
                         # Skip malformed lines